@@ -0,0 +1,1067 @@
+/*======================================================================================
+benchmark
+
+The performance suite for the pricing library. Every public pricing and interpolation
+path has a case; cases whose cost depends on the size of their inputs (grid nodes,
+expiries, batch length) are run for several sizes and named case/size. The portfolio
+engine and the Asian Monte Carlo are run with 1 to 32 threads to show how they scale.
+
+Usage: benchmark [options]
+    --min_time=s        time each case for at least s seconds (default 0.2)
+    --filter=text       only run the cases whose name contains text
+    --json=file         write the results to file as JSON
+    --baseline=file     compare with the JSON written by an earlier run
+    --threshold=x       with --baseline, a case that is more than x slower (0.1 = 10%)
+                        is a regression (default 0.1)
+
+Returns 1 if any case has regressed against the baseline, 2 on bad arguments or files and
+0 otherwise. Times are only comparable between runs on the same machine with the same
+build type (Release).
+=======================================================================================*/
+#include "benchmarkSuite.h"
+
+#include "../Maths/maths.h"
+#include "../Maths/NormalDistribution.h"
+#include "../Maths/TwoDimensionalInterpolation.h"
+#include "../Derivatives/AmericanBlack76.h"
+#include "../Derivatives/AsianBlack76.h"
+#include "../Derivatives/AsianMonteCarlo.h"
+#include "../Derivatives/BachelierFormula.h"
+#include "../Derivatives/BachelierImpliedVolatility.h"
+#include "../Derivatives/Black76Formula.h"
+#include "../Derivatives/Black76ImpliedVolatility.h"
+#include "../Derivatives/PortfolioEngine.h"
+#include "../Derivatives/SpreadOption.h"
+#include "../Derivatives/VolatilitySurfaceDelta.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+
+using namespace XLLBasicLibrary;
+using namespace XLLBasicLibraryBenchmark;
+
+namespace
+{
+    // Stops the optimiser from discarding a result that is never used
+    volatile double sink = 0;
+
+    // Number of options priced, or points looked up, per timed iteration
+    const size_t pointsPerIteration = 1000;
+
+    // n points evenly spaced over [from, to]
+    vector<double> grid(size_t n, double from, double to)
+    {
+        vector<double> points(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            points[i] = from + (to - from) * i / (n - 1);
+        }
+        return points;
+    }
+
+    // n points drawn uniformly from [from, to], the same points on every run. Unsorted
+    // inputs stop the searches from being helped by the branch predictor
+    vector<double> randomPoints(size_t n, double from, double to)
+    {
+        mt19937 generator(20161130);
+        uniform_real_distribution<double> uniform(from, to);
+        vector<double> points(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            points[i] = uniform(generator);
+        }
+        return points;
+    }
+
+    // A smooth, smile shaped volatility on a grid of days (x) and put deltas in [0.1, 0.9]
+    // (y), laid out as TwoDimensionalInterpolator expects: one row per delta
+    vector<vector<double> > smile(const vector<double> &days, const vector<double> &deltas)
+    {
+        vector<vector<double> > vols(deltas.size(), vector<double>(days.size()));
+        for (size_t j = 0; j < deltas.size(); ++j)
+        {
+            for (size_t i = 0; i < days.size(); ++i)
+            {
+                vols[j][i] = 0.2 + 0.05 * (deltas[j] - 0.5) * (deltas[j] - 0.5) + 0.00002 * days[i];
+            }
+        }
+        return vols;
+    }
+
+    /*======================================================================================
+    Black '76
+    =======================================================================================*/
+    // Forward 100, strikes across [50, 150], sd 0.25, df 0.99, alternate calls and puts
+    struct OptionInputs
+    {
+        OptionInputs(size_t n)
+            : forward(n, 100.0), strike(randomPoints(n, 50.0, 150.0)), standardDeviation(n, 0.25),
+            discountFactor(n, 0.99), premium(n), result(n), isCall(new bool[n])
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                isCall[i] = (i % 2 == 0);
+            }
+            Black76Batch::getPremium(n, &forward[0], &strike[0], &standardDeviation[0],
+                &discountFactor[0], isCall.get(), &premium[0]);
+        }
+        vector<double> forward, strike, standardDeviation, discountFactor, premium, result;
+        unique_ptr<bool[]> isCall;
+    };
+
+    template <typename Option>
+    void black76Premium(BenchmarkState &state)
+    {
+        OptionInputs in(pointsPerIteration);
+        state.setOperationsPerIteration(pointsPerIteration);
+        while (state.keepRunning())
+        {
+            double total = 0;
+            for (size_t i = 0; i < pointsPerIteration; ++i)
+            {
+                total += Option(in.forward[i], in.strike[i], in.standardDeviation[i], in.discountFactor[i]).getPremium();
+            }
+            sink = total;
+        }
+    }
+
+    template <typename Option>
+    void black76Delta(BenchmarkState &state)
+    {
+        OptionInputs in(pointsPerIteration);
+        state.setOperationsPerIteration(pointsPerIteration);
+        while (state.keepRunning())
+        {
+            double total = 0;
+            for (size_t i = 0; i < pointsPerIteration; ++i)
+            {
+                total += Option(in.forward[i], in.strike[i], in.standardDeviation[i], in.discountFactor[i]).getDelta();
+            }
+            sink = total;
+        }
+    }
+
+    template <typename Option>
+    void black76Greeks(BenchmarkState &state)
+    {
+        OptionInputs in(pointsPerIteration);
+        state.setOperationsPerIteration(pointsPerIteration);
+        while (state.keepRunning())
+        {
+            double total = 0;
+            for (size_t i = 0; i < pointsPerIteration; ++i)
+            {
+                total += Option(in.forward[i], in.strike[i], in.standardDeviation[i], in.discountFactor[i])
+                    .getPremiumAndGreeks(0.5).gamma;
+            }
+            sink = total;
+        }
+    }
+
+    void black76BatchPremium(BenchmarkState &state)
+    {
+        size_t n = state.getSize();
+        OptionInputs in(n);
+        state.setOperationsPerIteration(n);
+        while (state.keepRunning())
+        {
+            Black76Batch::getPremium(n, &in.forward[0], &in.strike[0], &in.standardDeviation[0],
+                &in.discountFactor[0], in.isCall.get(), &in.result[0]);
+            sink = in.result[n / 2];
+        }
+    }
+
+    void impliedStandardDeviation(BenchmarkState &state)
+    {
+        OptionInputs in(pointsPerIteration);
+        state.setOperationsPerIteration(pointsPerIteration);
+        while (state.keepRunning())
+        {
+            double total = 0;
+            for (size_t i = 0; i < pointsPerIteration; ++i)
+            {
+                total += Black76ImpliedVolatility::getStandardDeviation(in.premium[i], in.forward[i],
+                    in.strike[i], in.discountFactor[i], in.isCall[i]);
+            }
+            sink = total;
+        }
+    }
+
+    void impliedStandardDeviationBatch(BenchmarkState &state)
+    {
+        size_t n = state.getSize();
+        OptionInputs in(n);
+        state.setOperationsPerIteration(n);
+        while (state.keepRunning())
+        {
+            Black76ImpliedVolatility::getStandardDeviation(n, &in.premium[0], &in.forward[0],
+                &in.strike[0], &in.discountFactor[0], in.isCall.get(), &in.result[0]);
+            sink = in.result[n / 2];
+        }
+    }
+
+    /*======================================================================================
+    Bachelier
+    =======================================================================================*/
+    // Forward -5, strikes across [-30, 20], sd 10, df 0.99, alternate calls and puts
+    struct NormalOptionInputs
+    {
+        NormalOptionInputs(size_t n)
+            : forward(n, -5.0), strike(randomPoints(n, -30.0, 20.0)), standardDeviation(n, 10.0),
+            discountFactor(n, 0.99), premium(n), result(n), isCall(new bool[n])
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                isCall[i] = (i % 2 == 0);
+            }
+            BachelierBatch::getPremium(n, &forward[0], &strike[0], &standardDeviation[0],
+                &discountFactor[0], isCall.get(), &premium[0]);
+        }
+        vector<double> forward, strike, standardDeviation, discountFactor, premium, result;
+        unique_ptr<bool[]> isCall;
+    };
+
+    template <typename Option>
+    void bachelierPremium(BenchmarkState &state)
+    {
+        NormalOptionInputs in(pointsPerIteration);
+        state.setOperationsPerIteration(pointsPerIteration);
+        while (state.keepRunning())
+        {
+            double total = 0;
+            for (size_t i = 0; i < pointsPerIteration; ++i)
+            {
+                total += Option(in.forward[i], in.strike[i], in.standardDeviation[i], in.discountFactor[i]).getPremium();
+            }
+            sink = total;
+        }
+    }
+
+    template <typename Option>
+    void bachelierGreeks(BenchmarkState &state)
+    {
+        NormalOptionInputs in(pointsPerIteration);
+        state.setOperationsPerIteration(pointsPerIteration);
+        while (state.keepRunning())
+        {
+            double total = 0;
+            for (size_t i = 0; i < pointsPerIteration; ++i)
+            {
+                total += Option(in.forward[i], in.strike[i], in.standardDeviation[i], in.discountFactor[i])
+                    .getPremiumAndGreeks(0.5).gamma;
+            }
+            sink = total;
+        }
+    }
+
+    void bachelierBatchPremium(BenchmarkState &state)
+    {
+        size_t n = state.getSize();
+        NormalOptionInputs in(n);
+        state.setOperationsPerIteration(n);
+        while (state.keepRunning())
+        {
+            BachelierBatch::getPremium(n, &in.forward[0], &in.strike[0], &in.standardDeviation[0],
+                &in.discountFactor[0], in.isCall.get(), &in.result[0]);
+            sink = in.result[n / 2];
+        }
+    }
+
+    void bachelierImpliedStandardDeviation(BenchmarkState &state)
+    {
+        NormalOptionInputs in(pointsPerIteration);
+        state.setOperationsPerIteration(pointsPerIteration);
+        while (state.keepRunning())
+        {
+            double total = 0;
+            for (size_t i = 0; i < pointsPerIteration; ++i)
+            {
+                total += BachelierImpliedVolatility::getStandardDeviation(in.premium[i], in.forward[i],
+                    in.strike[i], in.discountFactor[i], in.isCall[i]);
+            }
+            sink = total;
+        }
+    }
+
+    void bachelierImpliedStandardDeviationBatch(BenchmarkState &state)
+    {
+        size_t n = state.getSize();
+        NormalOptionInputs in(n);
+        state.setOperationsPerIteration(n);
+        while (state.keepRunning())
+        {
+            BachelierImpliedVolatility::getStandardDeviation(n, &in.premium[0], &in.forward[0],
+                &in.strike[0], &in.discountFactor[0], in.isCall.get(), &in.result[0]);
+            sink = in.result[n / 2];
+        }
+    }
+
+    /*======================================================================================
+    Spread options
+    =======================================================================================*/
+    // Brent 80 / WTI 75 with strikes across [-5, 15], alternate calls and puts
+    struct SpreadInputs
+    {
+        SpreadInputs(size_t n)
+            : forward1(n, 80.0), forward2(n, 75.0), strike(randomPoints(n, -5.0, 15.0)),
+            standardDeviation1(n, 0.3), standardDeviation2(n, 0.28), correlation(n, 0.85),
+            discountFactor(n, 0.99), result(n), isCall(new bool[n])
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                isCall[i] = (i % 2 == 0);
+            }
+        }
+        vector<double> forward1, forward2, strike, standardDeviation1, standardDeviation2, correlation,
+            discountFactor, result;
+        unique_ptr<bool[]> isCall;
+    };
+
+    template <SpreadApproximation approximation>
+    void spreadPremium(BenchmarkState &state)
+    {
+        SpreadInputs in(pointsPerIteration);
+        state.setOperationsPerIteration(pointsPerIteration);
+        while (state.keepRunning())
+        {
+            double total = 0;
+            for (size_t i = 0; i < pointsPerIteration; ++i)
+            {
+                total += SpreadCall(in.forward1[i], in.forward2[i], in.strike[i], in.standardDeviation1[i],
+                    in.standardDeviation2[i], in.correlation[i], in.discountFactor[i], approximation).getPremium();
+            }
+            sink = total;
+        }
+    }
+
+    void spreadDeltas(BenchmarkState &state)
+    {
+        SpreadInputs in(pointsPerIteration);
+        state.setOperationsPerIteration(pointsPerIteration);
+        while (state.keepRunning())
+        {
+            double total = 0;
+            for (size_t i = 0; i < pointsPerIteration; ++i)
+            {
+                total += SpreadCall(in.forward1[i], in.forward2[i], in.strike[i], in.standardDeviation1[i],
+                    in.standardDeviation2[i], in.correlation[i], in.discountFactor[i]).getPremiumAndDeltas().delta2;
+            }
+            sink = total;
+        }
+    }
+
+    void spreadBatchPremium(BenchmarkState &state)
+    {
+        size_t n = state.getSize();
+        SpreadInputs in(n);
+        state.setOperationsPerIteration(n);
+        while (state.keepRunning())
+        {
+            SpreadBatch::getPremium(n, &in.forward1[0], &in.forward2[0], &in.strike[0], &in.standardDeviation1[0],
+                &in.standardDeviation2[0], &in.correlation[0], &in.discountFactor[0], in.isCall.get(),
+                BJERKSUND_STENSLAND, &in.result[0]);
+            sink = in.result[n / 2];
+        }
+    }
+
+    /*======================================================================================
+    American options on futures
+    =======================================================================================*/
+    // Brent at 80 with strikes across [50, 110], alternate calls and puts. The batch has a
+    // slice (expiry and vol) for every 20 lines, as a book sorted by expiry and strike.
+    struct AmericanInputs
+    {
+        AmericanInputs(size_t n)
+            : forward(n, 80.0), strike(randomPoints(n, 50.0, 110.0)), standardDeviation(n),
+            discountFactor(n), result(n), isCall(new bool[n])
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                double time = 0.25 + 0.25 * ((i / 20) % 8);
+                standardDeviation[i] = 0.35 * sqrt(time);
+                discountFactor[i] = exp(-0.05 * time);
+                isCall[i] = (i % 2 == 0);
+            }
+        }
+        vector<double> forward, strike, standardDeviation, discountFactor, result;
+        unique_ptr<bool[]> isCall;
+    };
+
+    // Each option builds its own slice, so includes the boundary solve
+    template <AmericanApproximation approximation>
+    void americanPremium(BenchmarkState &state)
+    {
+        AmericanInputs in(pointsPerIteration);
+        state.setOperationsPerIteration(pointsPerIteration);
+        while (state.keepRunning())
+        {
+            double total = 0;
+            for (size_t i = 0; i < pointsPerIteration; ++i)
+            {
+                total += AmericanBlack76(in.standardDeviation[i], in.discountFactor[i], approximation).getPremium(
+                    in.isCall[i], in.forward[i], in.strike[i]);
+            }
+            sink = total;
+        }
+    }
+
+    // Every option priced off one slice
+    template <AmericanApproximation approximation>
+    void americanSlicePremium(BenchmarkState &state)
+    {
+        AmericanInputs in(pointsPerIteration);
+        AmericanBlack76 slice(in.standardDeviation[0], in.discountFactor[0], approximation);
+        state.setOperationsPerIteration(pointsPerIteration);
+        while (state.keepRunning())
+        {
+            double total = 0;
+            for (size_t i = 0; i < pointsPerIteration; ++i)
+            {
+                total += slice.getPremium(in.isCall[i], in.forward[i], in.strike[i]);
+            }
+            sink = total;
+        }
+    }
+
+    void americanBatchPremium(BenchmarkState &state)
+    {
+        size_t n = state.getSize();
+        AmericanInputs in(n);
+        state.setOperationsPerIteration(n);
+        while (state.keepRunning())
+        {
+            AmericanBlack76::getPremium(n, &in.forward[0], &in.strike[0], &in.standardDeviation[0],
+                &in.discountFactor[0], in.isCall.get(), BARONE_ADESI_WHALEY, &in.result[0]);
+            sink = in.result[n / 2];
+        }
+    }
+
+    /*======================================================================================
+    Normal distribution
+    =======================================================================================*/
+    void normalCdf(BenchmarkState &state)
+    {
+        vector<double> x = randomPoints(pointsPerIteration, -8.0, 8.0);
+        state.setOperationsPerIteration(pointsPerIteration);
+        while (state.keepRunning())
+        {
+            double total = 0;
+            for (size_t i = 0; i < pointsPerIteration; ++i)
+            {
+                total += StandardNormal::cdf(x[i]);
+            }
+            sink = total;
+        }
+    }
+
+    void normalCdfBatch(BenchmarkState &state)
+    {
+        size_t n = state.getSize();
+        vector<double> x = randomPoints(n, -8.0, 8.0), result(n);
+        state.setOperationsPerIteration(n);
+        while (state.keepRunning())
+        {
+            StandardNormal::cdf(n, &x[0], &result[0]);
+            sink = result[n / 2];
+        }
+    }
+
+    /*======================================================================================
+    One dimensional interpolation, size = number of nodes
+    =======================================================================================*/
+    vector<double> curveValues(const vector<double> &x)
+    {
+        vector<double> y(x.size());
+        for (size_t i = 0; i < x.size(); ++i)
+        {
+            y[i] = 1.0 + 0.1 * x[i] + 0.05 * sin(x[i]);
+        }
+        return y;
+    }
+
+    template <typename Interpolator>
+    void arrayInterpolatorGetRate(BenchmarkState &state)
+    {
+        vector<double> x = grid(state.getSize(), 0.0, 10.0), y = curveValues(x);
+        Interpolator interpolator(x, y);
+        vector<double> points = randomPoints(pointsPerIteration, 0.0, 10.0);
+        state.setOperationsPerIteration(pointsPerIteration);
+        while (state.keepRunning())
+        {
+            double total = 0;
+            for (size_t i = 0; i < pointsPerIteration; ++i)
+            {
+                total += interpolator.getRate(points[i]);
+            }
+            sink = total;
+        }
+    }
+
+    template <typename Interpolator>
+    void arrayInterpolatorSortedBatch(BenchmarkState &state)
+    {
+        vector<double> x = grid(state.getSize(), 0.0, 10.0), y = curveValues(x);
+        Interpolator interpolator(x, y);
+        vector<double> points = grid(pointsPerIteration, 0.0, 10.0), result(pointsPerIteration);
+        state.setOperationsPerIteration(pointsPerIteration);
+        while (state.keepRunning())
+        {
+            interpolator.getRate(pointsPerIteration, &points[0], &result[0]);
+            sink = result[pointsPerIteration / 2];
+        }
+    }
+
+    void cubicSplineConstruction(BenchmarkState &state)
+    {
+        vector<double> x = grid(state.getSize(), 0.0, 10.0), y = curveValues(x);
+        while (state.keepRunning())
+        {
+            CubicSplineInterpolator interpolator(&x[0], &y[0], x.size());
+            sink = interpolator.getRate(5.0);
+        }
+    }
+
+    /*======================================================================================
+    Two dimensional interpolation, size = number of nodes along each axis
+    =======================================================================================*/
+    template <typename Interpolator>
+    void gridGetRate(BenchmarkState &state)
+    {
+        vector<double> days = grid(state.getSize(), 30.0, 720.0), deltas = grid(state.getSize(), 0.1, 0.9);
+        Interpolator interpolator(days, deltas, smile(days, deltas), false);
+        vector<double> x = randomPoints(pointsPerIteration, 30.0, 720.0);
+        vector<double> y = randomPoints(pointsPerIteration + 1, 0.1, 0.9);
+        state.setOperationsPerIteration(pointsPerIteration);
+        while (state.keepRunning())
+        {
+            double total = 0;
+            for (size_t i = 0; i < pointsPerIteration; ++i)
+            {
+                // offset by one so that x and y, drawn from the same sequence, are not paired
+                total += interpolator.getRate(x[i], y[i + 1]);
+            }
+            sink = total;
+        }
+    }
+
+    // size = number of times, with 100 deltas: surfaces up to 500 x 100, larger than L1
+    template <typename Interpolator>
+    void wideGridGetRate(BenchmarkState &state)
+    {
+        vector<double> days = grid(state.getSize(), 1.0, 3650.0), deltas = grid(100, 0.01, 0.99);
+        Interpolator interpolator(days, deltas, smile(days, deltas), false);
+        vector<double> x = randomPoints(pointsPerIteration, 1.0, 3650.0);
+        vector<double> y = randomPoints(pointsPerIteration + 1, 0.01, 0.99);
+        state.setOperationsPerIteration(pointsPerIteration);
+        while (state.keepRunning())
+        {
+            double total = 0;
+            for (size_t i = 0; i < pointsPerIteration; ++i)
+            {
+                total += interpolator.getRate(x[i], y[i + 1]);
+            }
+            sink = total;
+        }
+    }
+
+    // A strike sweep at one expiry, the case the cursor is meant for
+    template <typename Interpolator>
+    void gridCursorSweep(BenchmarkState &state)
+    {
+        vector<double> days = grid(state.getSize(), 30.0, 720.0), deltas = grid(state.getSize(), 0.1, 0.9);
+        Interpolator interpolator(days, deltas, smile(days, deltas), false);
+        vector<double> y = grid(pointsPerIteration, 0.1, 0.9);
+        state.setOperationsPerIteration(pointsPerIteration);
+        while (state.keepRunning())
+        {
+            GridCursor cursor;
+            double total = 0;
+            for (size_t i = 0; i < pointsPerIteration; ++i)
+            {
+                total += interpolator.getRate(180.0, y[i], cursor);
+            }
+            sink = total;
+        }
+    }
+
+    /*======================================================================================
+    Interpolation kernels against the virtual interface, size = number of nodes (along 
+    each axis for grids). Both see the same random points; the kernel is unchecked, as 
+    in a solver that has checked its bracket once.
+    =======================================================================================*/
+    // The interpolator as a pricer holding a base class reference sees it: the volatile
+    // read hides its dynamic type from the optimiser, so every getRate is a virtual call
+    template <typename Base>
+    const Base &throughBase(const Base &interpolator)
+    {
+        static const Base *volatile pointer;
+        pointer = &interpolator;
+        return *pointer;
+    }
+
+    template <typename Interpolator>
+    void arrayVirtualGetRate(BenchmarkState &state)
+    {
+        vector<double> x = grid(state.getSize(), 0.0, 10.0), y = curveValues(x);
+        Interpolator interpolator(x, y);
+        const ArrayInterpolator &curve = throughBase<ArrayInterpolator>(interpolator);
+        vector<double> points = randomPoints(pointsPerIteration, 0.0, 10.0);
+        state.setOperationsPerIteration(pointsPerIteration);
+        while (state.keepRunning())
+        {
+            double total = 0;
+            for (size_t i = 0; i < pointsPerIteration; ++i)
+            {
+                total += curve.getRate(points[i]);
+            }
+            sink = total;
+        }
+    }
+
+    template <typename Interpolator>
+    void arrayKernelGetRate(BenchmarkState &state)
+    {
+        vector<double> x = grid(state.getSize(), 0.0, 10.0), y = curveValues(x);
+        Interpolator interpolator(x, y);
+        auto kernel = interpolator.template getKernel<NoExtrapolation, UncheckedRange>();
+        vector<double> points = randomPoints(pointsPerIteration, 0.0, 10.0);
+        state.setOperationsPerIteration(pointsPerIteration);
+        while (state.keepRunning())
+        {
+            double total = 0;
+            for (size_t i = 0; i < pointsPerIteration; ++i)
+            {
+                total += kernel.getRate(points[i]);
+            }
+            sink = total;
+        }
+    }
+
+    template <typename Interpolator>
+    void gridVirtualGetRate(BenchmarkState &state)
+    {
+        vector<double> days = grid(state.getSize(), 30.0, 720.0), deltas = grid(state.getSize(), 0.1, 0.9);
+        Interpolator interpolator(days, deltas, smile(days, deltas), false);
+        const TwoDimensionalInterpolator &surface = throughBase<TwoDimensionalInterpolator>(interpolator);
+        vector<double> x = randomPoints(pointsPerIteration, 30.0, 720.0);
+        vector<double> y = randomPoints(pointsPerIteration + 1, 0.1, 0.9);
+        state.setOperationsPerIteration(pointsPerIteration);
+        while (state.keepRunning())
+        {
+            double total = 0;
+            for (size_t i = 0; i < pointsPerIteration; ++i)
+            {
+                total += surface.getRate(x[i], y[i + 1]);
+            }
+            sink = total;
+        }
+    }
+
+    template <typename Interpolator>
+    void gridKernelGetRate(BenchmarkState &state)
+    {
+        vector<double> days = grid(state.getSize(), 30.0, 720.0), deltas = grid(state.getSize(), 0.1, 0.9);
+        Interpolator interpolator(days, deltas, smile(days, deltas), false);
+        auto kernel = interpolator.template getKernel<NoExtrapolation, UncheckedRange>();
+        vector<double> x = randomPoints(pointsPerIteration, 30.0, 720.0);
+        vector<double> y = randomPoints(pointsPerIteration + 1, 0.1, 0.9);
+        state.setOperationsPerIteration(pointsPerIteration);
+        while (state.keepRunning())
+        {
+            double total = 0;
+            for (size_t i = 0; i < pointsPerIteration; ++i)
+            {
+                total += kernel.getRate(x[i], y[i + 1]);
+            }
+            sink = total;
+        }
+    }
+
+    /*======================================================================================
+    Delta surface, size = number of expiries (with 9 deltas)
+    =======================================================================================*/
+    SimpleDeltaSurface deltaSurface(size_t expiries)
+    {
+        vector<double> days = grid(expiries, 30.0, 720.0), deltas = grid(9, 0.1, 0.9);
+        vector<double> times(days.size()), deltaPercent(deltas.size());
+        for (size_t i = 0; i < days.size(); ++i)
+        {
+            times[i] = days[i] / 365.0;
+        }
+        for (size_t j = 0; j < deltas.size(); ++j)
+        {
+            deltaPercent[j] = 100.0 * deltas[j];
+        }
+        return SimpleDeltaSurface(times, deltaPercent, smile(days, deltas), false, "bilinear");
+    }
+
+    // size = number of times, with 100 deltas
+    void surfaceConstruction(BenchmarkState &state)
+    {
+        vector<double> days = grid(state.getSize(), 1.0, 3650.0), deltas = grid(100, 0.01, 0.99);
+        vector<double> times(days.size()), deltaPercent(deltas.size());
+        for (size_t i = 0; i < days.size(); ++i)
+        {
+            times[i] = days[i] / 365.0;
+        }
+        for (size_t j = 0; j < deltas.size(); ++j)
+        {
+            deltaPercent[j] = 100.0 * deltas[j];
+        }
+        vector<vector<double> > volatility = smile(days, deltas);
+        state.setOperationsPerIteration(1);
+        while (state.keepRunning())
+        {
+            SimpleDeltaSurface surface(times, deltaPercent, volatility, false, "bicubic");
+            sink = surface.getVolatilityForDelta(1.0, 50.0);
+        }
+    }
+
+    void surfaceVolatilityForMoneyness(BenchmarkState &state)
+    {
+        SimpleDeltaSurface surface = deltaSurface(state.getSize());
+        vector<double> time = randomPoints(pointsPerIteration, 0.1, 1.9);
+        vector<double> moneyness = randomPoints(pointsPerIteration + 1, -0.2, 0.2);
+        state.setOperationsPerIteration(pointsPerIteration);
+        while (state.keepRunning())
+        {
+            double total = 0;
+            for (size_t i = 0; i < pointsPerIteration; ++i)
+            {
+                total += surface.getVolatilityForMoneyness(time[i], moneyness[i + 1]);
+            }
+            sink = total;
+        }
+    }
+
+    // A chain of 100 strikes on each expiry, solved against the expiry's smile
+    void surfaceSmileChain(BenchmarkState &state)
+    {
+        SimpleDeltaSurface surface = deltaSurface(state.getSize());
+        vector<double> time = randomPoints(pointsPerIteration / 100, 0.1, 1.9);
+        vector<double> moneyness = grid(100, -0.2, 0.2), volatility(moneyness.size());
+        state.setOperationsPerIteration(time.size() * moneyness.size());
+        while (state.keepRunning())
+        {
+            double total = 0;
+            for (size_t i = 0; i < time.size(); ++i)
+            {
+                surface.getVolatilityForMoneyness(time[i], moneyness.size(), &moneyness[0], &volatility[0]);
+                total += volatility[i % 100];
+            }
+            sink = total;
+        }
+    }
+
+    /*======================================================================================
+    Delta from strike, size = days to expiry. Strikes from 50% to 180% of the forward, so
+    most are in the wings. The fixed point is the iteration the Newton solver replaced.
+    =======================================================================================*/
+    vector<double> wingMoneyness()
+    {
+        return grid(131, -0.5, 0.8);
+    }
+
+    void deltaSolverNewton(BenchmarkState &state)
+    {
+        SimpleDeltaSurface surface = deltaSurface(12);
+        DeltaSmile smile = surface.getSmile(state.getSize() / 365.0);
+        vector<double> moneyness = wingMoneyness();
+        state.setOperationsPerIteration(moneyness.size());
+        while (state.keepRunning())
+        {
+            double total = 0;
+            for (size_t i = 0; i < moneyness.size(); ++i)
+            {
+                total += smile.solveDeltaForMoneyness(moneyness[i]).delta;
+            }
+            sink = total;
+        }
+    }
+
+    void deltaSolverFixedPoint(BenchmarkState &state)
+    {
+        SimpleDeltaSurface surface = deltaSurface(12);
+        double time = state.getSize() / 365.0;
+        DeltaSmile smile = surface.getSmile(time);
+        vector<double> moneyness = wingMoneyness();
+        state.setOperationsPerIteration(moneyness.size());
+        while (state.keepRunning())
+        {
+            double total = 0;
+            for (size_t i = 0; i < moneyness.size(); ++i)
+            {
+                double guess1 = 50, guess2 = 50, vol = 0, diff = 1;
+                Black76Put put(1, 1 + moneyness[i], 0.2, 1);
+                for (size_t counter = 0; (counter < 20) && (diff > 1e-8); ++counter)
+                {
+                    guess1 = guess2;
+                    if (smile.isInDeltaRange(guess1))
+                    {
+                        vol = smile.getVolatilityForDelta(guess1);
+                    }
+                    put.setStandardDeviation(vol * sqrt(time));
+                    guess2 = -put.getDelta() * 100;
+                    diff = abs(guess1 - guess2);
+                }
+                total += guess2;
+            }
+            sink = total;
+        }
+    }
+
+    void surfaceVolatilityForDelta(BenchmarkState &state)
+    {
+        SimpleDeltaSurface surface = deltaSurface(state.getSize());
+        vector<double> time = randomPoints(pointsPerIteration, 0.1, 1.9);
+        vector<double> delta = randomPoints(pointsPerIteration + 1, 10.0, 90.0);
+        state.setOperationsPerIteration(pointsPerIteration);
+        while (state.keepRunning())
+        {
+            double total = 0;
+            for (size_t i = 0; i < pointsPerIteration; ++i)
+            {
+                total += surface.getVolatilityForDelta(time[i], delta[i + 1]);
+            }
+            sink = total;
+        }
+    }
+
+    /*======================================================================================
+    Portfolio engine, size = number of threads
+    =======================================================================================*/
+    // 100,000 lines, a quarter of them priced off a 12 expiry surface. Scaling is only
+    // meaningful up to the number of cores of the machine the benchmark runs on.
+    void portfolioPrice(BenchmarkState &state)
+    {
+        const size_t n = 100000;
+        SimpleDeltaSurface surface = deltaSurface(12);
+        vector<double> strike = randomPoints(n, 85.0, 115.0), time = randomPoints(n + 1, 0.1, 1.9);
+        vector<PortfolioTrade> trades(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            PortfolioTrade trade = { (i % 2 == 0), 100.0, strike[i], 0.25 * sqrt(time[i + 1]),
+                exp(-0.02 * time[i + 1]), time[i + 1], (i % 4 == 0) ? &surface : NULL };
+            trades[i] = trade;
+        }
+        vector<Black76Greeks> results(n);
+        PortfolioEngine engine(state.getSize());
+        state.setOperationsPerIteration(n);
+        while (state.keepRunning())
+        {
+            engine.price(n, &trades[0], &results[0]);
+            sink = results[n / 2].premium;
+        }
+    }
+
+    /*======================================================================================
+    Asian Monte Carlo, size = number of threads. Times are per path.
+    =======================================================================================*/
+    void asianMonteCarlo(BenchmarkState &state)
+    {
+        AsianOption option;
+        option.isCall = true;
+        option.forward = 80.0;
+        option.strike = 82.0;
+        option.volatility = 0.35;
+        option.discountFactor = 0.98;
+        for (size_t i = 0; i < 21; ++i)
+        {
+            option.fixingTimes.push_back(0.5 + (i + 1) / 252.0);
+        }
+        AsianMonteCarloSettings settings;
+        settings.paths = 100000;
+        AsianMonteCarlo engine(state.getSize());
+        state.setOperationsPerIteration(settings.paths);
+        while (state.keepRunning())
+        {
+            sink = engine.price(option, settings).premium;
+        }
+    }
+
+    /*======================================================================================
+    Moment matched APOs, size = number of trades. A book of monthly averages over 18 months
+    with strikes on a $1 grid, so the batch shares its curve and surface lookups.
+    =======================================================================================*/
+    void asianBlack76Batch(BenchmarkState &state)
+    {
+        size_t n = state.getSize();
+        SimpleDeltaSurface surface = deltaSurface(12);
+        vector<double> curveTimes = grid(8, 0.0, 2.0), forwards(curveTimes.size());
+        for (size_t i = 0; i < curveTimes.size(); ++i)
+        {
+            forwards[i] = 82.0 - 3.0 * curveTimes[i];
+        }
+        LinearArrayInterpolator curve(curveTimes, forwards);
+        vector<AsianBlack76Trade> trades(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            double monthStart = (i % 18 + 1) / 12.0;
+            trades[i].isCall = (i % 2 == 0);
+            trades[i].strike = 76.0 + (i * 7) % 9;
+            trades[i].discountFactor = exp(-0.03 * monthStart);
+            for (size_t j = 0; j < 21; ++j)
+            {
+                trades[i].fixingTimes.push_back(monthStart + (j + 1) / 252.0);
+            }
+        }
+        AsianBlack76 pricer(curve, surface);
+        vector<double> premium(n);
+        state.setOperationsPerIteration(n);
+        while (state.keepRunning())
+        {
+            pricer.getPremium(n, &trades[0], &premium[0]);
+            sink = premium[n / 2];
+        }
+    }
+
+    BenchmarkSuite createSuite()
+    {
+        vector<size_t> batchSizes = { 100, 10000 };
+        vector<size_t> curveSizes = { 8, 64, 512 };
+        vector<size_t> gridSizes = { 4, 16, 64 };
+        vector<size_t> wideGridSizes = { 20, 100, 500 };
+        vector<size_t> expiries = { 4, 12, 48 };
+        vector<size_t> days = { 2, 7, 30, 365 };
+        vector<size_t> threads = { 1, 2, 4, 8, 16, 32 };
+
+        BenchmarkSuite suite;
+        suite.add("Black76Call::getPremium", black76Premium<Black76Call>);
+        suite.add("Black76Put::getPremium", black76Premium<Black76Put>);
+        suite.add("Black76Call::getDelta", black76Delta<Black76Call>);
+        suite.add("Black76Put::getDelta", black76Delta<Black76Put>);
+        suite.add("Black76Call::getPremiumAndGreeks", black76Greeks<Black76Call>);
+        suite.add("Black76Batch::getPremium", batchSizes, black76BatchPremium);
+        suite.add("Black76ImpliedVolatility::getStandardDeviation", impliedStandardDeviation);
+        suite.add("Black76ImpliedVolatility::getStandardDeviation(batch)", batchSizes, impliedStandardDeviationBatch);
+        suite.add("BachelierCall::getPremium", bachelierPremium<BachelierCall>);
+        suite.add("BachelierPut::getPremium", bachelierPremium<BachelierPut>);
+        suite.add("BachelierCall::getPremiumAndGreeks", bachelierGreeks<BachelierCall>);
+        suite.add("BachelierBatch::getPremium", batchSizes, bachelierBatchPremium);
+        suite.add("BachelierImpliedVolatility::getStandardDeviation", bachelierImpliedStandardDeviation);
+        suite.add("BachelierImpliedVolatility::getStandardDeviation(batch)", batchSizes, bachelierImpliedStandardDeviationBatch);
+        suite.add("SpreadCall::getPremium(Kirk)", spreadPremium<KIRK>);
+        suite.add("SpreadCall::getPremium(Bjerksund Stensland)", spreadPremium<BJERKSUND_STENSLAND>);
+        suite.add("SpreadCall::getPremiumAndDeltas", spreadDeltas);
+        suite.add("SpreadBatch::getPremium", batchSizes, spreadBatchPremium);
+        suite.add("AmericanBlack76::getPremium(BAW)", americanPremium<BARONE_ADESI_WHALEY>);
+        suite.add("AmericanBlack76::getPremium(BAW, slice)", americanSlicePremium<BARONE_ADESI_WHALEY>);
+        suite.add("AmericanBlack76::getPremium(Bjerksund Stensland)", americanPremium<BJERKSUND_STENSLAND_2002>);
+        suite.add("AmericanBlack76::getPremium(Bjerksund Stensland, slice)", americanSlicePremium<BJERKSUND_STENSLAND_2002>);
+        suite.add("AmericanBlack76::getPremium(batch)", batchSizes, americanBatchPremium);
+        suite.add("StandardNormal::cdf", normalCdf);
+        suite.add("StandardNormal::cdf(batch)", batchSizes, normalCdfBatch);
+        suite.add("LinearArrayInterpolator::getRate", curveSizes, arrayInterpolatorGetRate<LinearArrayInterpolator>);
+        suite.add("LinearArrayInterpolator::getRate(sorted batch)", curveSizes, arrayInterpolatorSortedBatch<LinearArrayInterpolator>);
+        suite.add("CubicSplineInterpolator::construction", curveSizes, cubicSplineConstruction);
+        suite.add("CubicSplineInterpolator::getRate", curveSizes, arrayInterpolatorGetRate<CubicSplineInterpolator>);
+        suite.add("CubicSplineInterpolator::getRate(sorted batch)", curveSizes, arrayInterpolatorSortedBatch<CubicSplineInterpolator>);
+        suite.add("BilinearInterpolator::getRate", gridSizes, gridGetRate<BilinearInterpolator>);
+        suite.add("BilinearInterpolator::getRate(cursor sweep)", gridSizes, gridCursorSweep<BilinearInterpolator>);
+        suite.add("BicubicInterpolator::getRate", gridSizes, gridGetRate<BicubicInterpolator>);
+        suite.add("BicubicInterpolator::getRate(cursor sweep)", gridSizes, gridCursorSweep<BicubicInterpolator>);
+        suite.add("BilinearInterpolator::getRate(x 100 deltas)", wideGridSizes, wideGridGetRate<BilinearInterpolator>);
+        suite.add("BicubicInterpolator::getRate(x 100 deltas)", wideGridSizes, wideGridGetRate<BicubicInterpolator>);
+        suite.add("LinearArrayInterpolator::getRate(virtual)", curveSizes, arrayVirtualGetRate<LinearArrayInterpolator>);
+        suite.add("LinearArrayInterpolator::getRate(kernel)", curveSizes, arrayKernelGetRate<LinearArrayInterpolator>);
+        suite.add("CubicSplineInterpolator::getRate(virtual)", curveSizes, arrayVirtualGetRate<CubicSplineInterpolator>);
+        suite.add("CubicSplineInterpolator::getRate(kernel)", curveSizes, arrayKernelGetRate<CubicSplineInterpolator>);
+        suite.add("BilinearInterpolator::getRate(virtual)", gridSizes, gridVirtualGetRate<BilinearInterpolator>);
+        suite.add("BilinearInterpolator::getRate(kernel)", gridSizes, gridKernelGetRate<BilinearInterpolator>);
+        suite.add("BicubicInterpolator::getRate(virtual)", gridSizes, gridVirtualGetRate<BicubicInterpolator>);
+        suite.add("BicubicInterpolator::getRate(kernel)", gridSizes, gridKernelGetRate<BicubicInterpolator>);
+        suite.add("SimpleDeltaSurface::construction(bicubic, x 100 deltas)", wideGridSizes, surfaceConstruction);
+        suite.add("SimpleDeltaSurface::getVolatilityForMoneyness", expiries, surfaceVolatilityForMoneyness);
+        suite.add("SimpleDeltaSurface::getVolatilityForMoneyness(smile, 100 strikes)", expiries, surfaceSmileChain);
+        suite.add("SimpleDeltaSurface::getVolatilityForDelta", expiries, surfaceVolatilityForDelta);
+        suite.add("DeltaSmile::solveDeltaForMoneyness(wings)", days, deltaSolverNewton);
+        suite.add("DeltaSmile fixed point delta (wings)", days, deltaSolverFixedPoint);
+        suite.add("PortfolioEngine::price(threads)", threads, portfolioPrice);
+        suite.add("AsianMonteCarlo::price(threads, 21 fixings)", threads, asianMonteCarlo);
+        suite.add("AsianBlack76::getPremium(batch, 21 fixings)", batchSizes, asianBlack76Batch);
+        return suite;
+    }
+
+    // Sets value from an argument of the form --name=value, returning false if the
+    // argument is some other option
+    bool readOption(const string &argument, const string &name, string &value)
+    {
+        string prefix = "--" + name + "=";
+        if (argument.compare(0, prefix.size(), prefix) != 0)
+        {
+            return false;
+        }
+        value = argument.substr(prefix.size());
+        return true;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    double minimumSeconds = 0.2;
+    double threshold = 0.1;
+    string filter, jsonFile, baselineFile, value;
+    for (int i = 1; i < argc; ++i)
+    {
+        string argument = argv[i];
+        if (readOption(argument, "min_time", value))
+        {
+            minimumSeconds = atof(value.c_str());
+        }
+        else if (readOption(argument, "threshold", value))
+        {
+            threshold = atof(value.c_str());
+        }
+        else if (readOption(argument, "filter", value))
+        {
+            filter = value;
+        }
+        else if (readOption(argument, "json", value))
+        {
+            jsonFile = value;
+        }
+        else if (readOption(argument, "baseline", value))
+        {
+            baselineFile = value;
+        }
+        else
+        {
+            cerr << "Unknown argument " << argument << "\nUsage: benchmark [--min_time=s] "
+                 << "[--filter=text] [--json=file] [--baseline=file] [--threshold=x]" << endl;
+            return 2;
+        }
+    }
+
+    try
+    {
+        // Read the baseline first so that a bad file is reported before the long run
+        vector<BenchmarkResult> baseline;
+        if (!baselineFile.empty())
+        {
+            baseline = BenchmarkSuite::readJson(baselineFile);
+        }
+
+        cout << "Benchmarking XLLBasic Library (" << minimumSeconds << " s per case)" << endl;
+        vector<BenchmarkResult> results = createSuite().run(minimumSeconds, filter);
+
+        if (!jsonFile.empty())
+        {
+            BenchmarkSuite::writeJson(jsonFile, results, minimumSeconds);
+        }
+        if (!baselineFile.empty() && (BenchmarkSuite::compare(results, baseline, threshold) > 0))
+        {
+            cout << "*** Performance regressions against " << baselineFile << endl;
+            return 1;
+        }
+    }
+    catch (runtime_error &e)
+    {
+        cerr << e.what() << endl;
+        return 2;
+    }
+    return 0;
+}
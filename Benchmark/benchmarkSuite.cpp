@@ -0,0 +1,223 @@
+#include "benchmarkSuite.h"
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+namespace XLLBasicLibraryBenchmark
+{
+    namespace
+    {
+        string resultName(const string &name, size_t size)
+        {
+            ostringstream out;
+            out << name;
+            if (size > 0)
+            {
+                out << "/" << size;
+            }
+            return out.str();
+        }
+
+        // The characters in a case name that cannot appear as they are in a JSON string
+        string escapeJson(const string &text)
+        {
+            string escaped;
+            for (size_t i = 0; i < text.size(); ++i)
+            {
+                if ((text[i] == '"') || (text[i] == '\\'))
+                {
+                    escaped += '\\';
+                }
+                escaped += text[i];
+            }
+            return escaped;
+        }
+
+        double toNanoseconds(double time, const string &unit)
+        {
+            if (unit == "us")
+            {
+                return time * 1e3;
+            }
+            if (unit == "ms")
+            {
+                return time * 1e6;
+            }
+            if (unit == "s")
+            {
+                return time * 1e9;
+            }
+            return time;
+        }
+    }
+
+    /*======================================================================================
+    BenchmarkState
+    =======================================================================================*/
+    BenchmarkState::BenchmarkState(size_t size, double minimumSeconds)
+        : size(size), minimumSeconds(minimumSeconds), operationsPerIteration(1),
+        iterations(0), seconds(0), started(false)
+    {
+    }
+
+    bool BenchmarkState::keepRunning()
+    {
+        if (!started)
+        {
+            started = true;
+            start = clock::now();
+            return true;
+        }
+        ++iterations;
+        seconds = chrono::duration<double>(clock::now() - start).count();
+        return seconds < minimumSeconds;
+    }
+
+    double BenchmarkState::getNanosecondsPerOperation() const
+    {
+        if (iterations == 0)
+        {
+            return 0;
+        }
+        return 1e9 * seconds / (double(iterations) * operationsPerIteration);
+    }
+
+    /*======================================================================================
+    BenchmarkSuite
+    =======================================================================================*/
+    void BenchmarkSuite::add(const string &name, const vector<size_t> &sizes, BenchmarkFunction benchmark)
+    {
+        BenchmarkCase newCase = { name, sizes, benchmark };
+        cases.push_back(newCase);
+    }
+
+    vector<BenchmarkResult> BenchmarkSuite::run(double minimumSeconds, const string &filter) const
+    {
+        vector<BenchmarkResult> results;
+        for (size_t i = 0; i < cases.size(); ++i)
+        {
+            for (size_t j = 0; j < cases[i].sizes.size(); ++j)
+            {
+                string name = resultName(cases[i].name, cases[i].sizes[j]);
+                if (!filter.empty() && (name.find(filter) == string::npos))
+                {
+                    continue;
+                }
+                // A short untimed run first so that caches, branch predictors and any lazily
+                // built state are warm
+                BenchmarkState warmUp(cases[i].sizes[j], minimumSeconds / 10);
+                cases[i].benchmark(warmUp);
+
+                BenchmarkState state(cases[i].sizes[j], minimumSeconds);
+                cases[i].benchmark(state);
+                BenchmarkResult result = { name, state.getIterations(), state.getNanosecondsPerOperation() };
+                results.push_back(result);
+
+                cout << left << setw(64) << name
+                     << right << setw(14) << fixed << setprecision(2) << result.nanoseconds << " ns/op"
+                     << setw(12) << result.iterations << endl;
+            }
+        }
+        return results;
+    }
+
+    void BenchmarkSuite::writeJson(const string &fileName, const vector<BenchmarkResult> &results, double minimumSeconds)
+    {
+        ofstream out(fileName.c_str());
+        if (!out)
+        {
+            throw runtime_error("Unable to write benchmark results to " + fileName);
+        }
+        time_t now = time(NULL);
+        char date[32];
+        strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+#ifdef NDEBUG
+        const char *buildType = "release";
+#else
+        const char *buildType = "debug";
+#endif
+        out << "{\n"
+            << "  \"context\": {\n"
+            << "    \"date\": \"" << date << "\",\n"
+            << "    \"library_build_type\": \"" << buildType << "\",\n"
+            << "    \"min_time\": " << minimumSeconds << "\n"
+            << "  },\n"
+            << "  \"benchmarks\": [";
+        out << setprecision(4) << fixed;
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            out << (i > 0 ? "," : "") << "\n"
+                << "    {\n"
+                << "      \"name\": \"" << escapeJson(results[i].name) << "\",\n"
+                << "      \"iterations\": " << results[i].iterations << ",\n"
+                << "      \"real_time\": " << results[i].nanoseconds << ",\n"
+                << "      \"time_unit\": \"ns\"\n"
+                << "    }";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+    vector<BenchmarkResult> BenchmarkSuite::readJson(const string &fileName)
+    {
+        vector<BenchmarkResult> results;
+        try
+        {
+            boost::property_tree::ptree root;
+            boost::property_tree::read_json(fileName, root);
+            boost::property_tree::ptree &benchmarks = root.get_child("benchmarks");
+            for (boost::property_tree::ptree::iterator it = benchmarks.begin(); it != benchmarks.end(); ++it)
+            {
+                BenchmarkResult result;
+                result.name = it->second.get<string>("name");
+                result.iterations = it->second.get<size_t>("iterations", 0);
+                result.nanoseconds = toNanoseconds(it->second.get<double>("real_time"),
+                                                   it->second.get<string>("time_unit", "ns"));
+                results.push_back(result);
+            }
+        }
+        catch (boost::property_tree::ptree_error &e)
+        {
+            throw runtime_error("Unable to read benchmark results: " + string(e.what()));
+        }
+        return results;
+    }
+
+    size_t BenchmarkSuite::compare(const vector<BenchmarkResult> &results,
+                                   const vector<BenchmarkResult> &baseline,
+                                   double threshold)
+    {
+        map<string, double> baselineTimes;
+        for (size_t i = 0; i < baseline.size(); ++i)
+        {
+            baselineTimes[baseline[i].name] = baseline[i].nanoseconds;
+        }
+
+        size_t regressions = 0;
+        cout << "\nComparison with baseline (threshold " << setprecision(1) << fixed
+             << 100 * threshold << "%)" << endl;
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            map<string, double>::const_iterator it = baselineTimes.find(results[i].name);
+            if ((it == baselineTimes.end()) || (it->second <= 0))
+            {
+                cout << left << setw(64) << results[i].name << right << setw(14) << "new" << endl;
+                continue;
+            }
+            double change = results[i].nanoseconds / it->second - 1.0;
+            bool regressed = change > threshold;
+            regressions += regressed ? 1 : 0;
+            cout << left << setw(64) << results[i].name
+                 << right << setw(13) << showpos << setprecision(1) << 100 * change << noshowpos << "%"
+                 << (regressed ? "  REGRESSION" : "") << endl;
+        }
+        return regressions;
+    }
+}
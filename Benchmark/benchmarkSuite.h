@@ -0,0 +1,100 @@
+#ifndef derivativeBenchmarkSuite_INCLUDED
+#define derivativeBenchmarkSuite_INCLUDED
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace XLLBasicLibraryBenchmark
+{
+    /*======================================================================================
+    BenchmarkState
+
+    Passed to a benchmark case, in the style of Google Benchmark. The case builds whatever
+    it needs for getSize(), then times its work in a loop of the form
+
+        while (state.keepRunning())
+        {
+            ... operationsPerIteration operations ...
+        }
+
+    Only the time spent inside the loop is measured. keepRunning reads the clock once per
+    iteration so an iteration should do at least a few hundred nanoseconds of work; cheap
+    operations are repeated inside the loop and setOperationsPerIteration reports how many.
+    =======================================================================================*/
+    class BenchmarkState
+    {
+    public:
+        BenchmarkState(size_t size, double minimumSeconds);
+
+        size_t getSize() const                              {return size;};
+        void setOperationsPerIteration(size_t operations)   {operationsPerIteration = operations;};
+
+        bool keepRunning();
+
+        size_t getIterations() const                        {return iterations;};
+        double getNanosecondsPerOperation() const;
+
+    private:
+        typedef chrono::steady_clock clock;
+
+        size_t size;
+        double minimumSeconds;
+        size_t operationsPerIteration;
+        size_t iterations;
+        double seconds;
+        bool started;
+        clock::time_point start;
+    };
+
+    struct BenchmarkResult
+    {
+        string name;            // case name followed by /size, e.g. BilinearInterpolator::getRate/16
+        size_t iterations;
+        double nanoseconds;     // per operation
+    };
+
+    /*======================================================================================
+    BenchmarkSuite
+
+    A list of named cases, each run once for every size it is registered with. Results can
+    be written as JSON (laid out like Google Benchmark's, so the same tools can read them)
+    and compared with the JSON from an earlier run: a case regresses when its time per
+    operation exceeds the baseline by more than the threshold (0.1 = 10% slower).
+    =======================================================================================*/
+    class BenchmarkSuite
+    {
+    public:
+        typedef function<void(BenchmarkState &)> BenchmarkFunction;
+
+        void add(const string &name, const vector<size_t> &sizes, BenchmarkFunction benchmark);
+        void add(const string &name, BenchmarkFunction benchmark)  {add(name, vector<size_t>(1, 0), benchmark);};
+
+        // Runs the cases whose name contains filter (all of them if it is empty), printing
+        // a line per result as it goes
+        vector<BenchmarkResult> run(double minimumSeconds, const string &filter = "") const;
+
+        static void writeJson(const string &fileName, const vector<BenchmarkResult> &results, double minimumSeconds);
+        // Throws a runtime_error if the file cannot be read
+        static vector<BenchmarkResult> readJson(const string &fileName);
+        // Prints the change against baseline for every result found in it and returns the
+        // number of regressions
+        static size_t compare(const vector<BenchmarkResult> &results,
+                              const vector<BenchmarkResult> &baseline,
+                              double threshold);
+
+    private:
+        struct BenchmarkCase
+        {
+            string name;
+            vector<size_t> sizes;
+            BenchmarkFunction benchmark;
+        };
+        vector<BenchmarkCase> cases;
+    };
+}
+
+#endif
@@ -0,0 +1,324 @@
+#include "AmericanBlack76.h"
+
+#include <algorithm> // max
+#include <memory> // unique_ptr
+
+
+namespace XLLBasicLibrary
+{
+	namespace
+	{
+		// The critical forward is solved to this accuracy relative to itself. As the rate goes
+		// to 0 the call's critical forward grows without bound and the terms of its smooth
+		// pasting condition, of the order of s, can only be evaluated to a few eps * s
+		const double criticalTolerance = 1e-12;
+		const int maximumIterations = 100;
+		// t1 / T for Bjerksund Stensland
+		const double firstPeriodFraction = 0.61803398874989484820;
+		// Standard deviations below the boundary beyond which it is never reached
+		const double unreachableBoundary = 10.0;
+
+		// w * N(x) as exp(logWeight) * N(x), without overflowing when the weight is huge
+		// and the probability is tiny
+		double weighted(double logWeight, double probability)
+		{
+			return (probability > 0) ? exp(logWeight + log(probability)) : 0.0;
+		}
+
+		/*==================================================================================
+		Bjerksund Stensland 2002 with zero cost of carry (an option on a future) and time
+		scaled so that expiry is at 1: sigma = sd and r = -ln(df). See Haug, "The Complete
+		Guide to Option Pricing Formulas", for the phi and psi functions with general
+		carry. Each takes S^gamma as (S / scale)^gamma, which for gamma = beta is
+		multiplied by alpha = (I - X) I^-beta with scale = I.
+		==================================================================================*/
+		struct CarrylessParameters
+		{
+			double sigma, r;
+		};
+
+		double phi(const CarrylessParameters &p, double S, double scale, double t, double gamma, double H, double I)
+		{
+			double sigmaRootT = p.sigma * sqrt(t);
+			double lambda = (-p.r + 0.5 * gamma * (gamma - 1.0) * p.sigma * p.sigma) * t;
+			double kappa = 2.0 * gamma - 1.0;
+			double d = -(log(S / H) + (gamma - 0.5) * p.sigma * p.sigma * t) / sigmaRootT;
+			double logSpot = lambda + gamma * log(S / scale);
+			return weighted(logSpot, StandardNormal::cdf(d)) -
+				weighted(logSpot + kappa * log(I / S), StandardNormal::cdf(d - 2.0 * log(I / S) / sigmaRootT));
+		}
+
+		// With t2 = 1
+		double psi(const CarrylessParameters &p, double S, double scale, double gamma, double H, double I2, double I1, double t1)
+		{
+			double sigmaRootT1 = p.sigma * sqrt(t1), sigmaRootT2 = p.sigma;
+			double drift = (gamma - 0.5) * p.sigma * p.sigma;
+			double e1 = (log(S / I1) + drift * t1) / sigmaRootT1;
+			double e2 = (log(I2 * I2 / (S * I1)) + drift * t1) / sigmaRootT1;
+			double e3 = (log(S / I1) - drift * t1) / sigmaRootT1;
+			double e4 = (log(I2 * I2 / (S * I1)) - drift * t1) / sigmaRootT1;
+			double f1 = (log(S / H) + drift) / sigmaRootT2;
+			double f2 = (log(I2 * I2 / (S * H)) + drift) / sigmaRootT2;
+			double f3 = (log(I1 * I1 / (S * H)) + drift) / sigmaRootT2;
+			double f4 = (log(S * I1 * I1 / (H * I2 * I2)) + drift) / sigmaRootT2;
+			double rho = sqrt(t1);
+			double lambda = -p.r + 0.5 * gamma * (gamma - 1.0) * p.sigma * p.sigma;
+			double kappa = 2.0 * gamma - 1.0;
+			double logSpot = lambda + gamma * log(S / scale);
+			return weighted(logSpot, BivariateNormal::cdf(-e1, -f1, rho)) -
+				weighted(logSpot + kappa * log(I2 / S), BivariateNormal::cdf(-e2, -f2, rho)) -
+				weighted(logSpot + kappa * log(I1 / S), BivariateNormal::cdf(-e3, -f3, -rho)) +
+				weighted(logSpot + kappa * log(I1 / I2), BivariateNormal::cdf(-e4, -f4, -rho));
+		}
+	}
+
+	/*======================================================================================
+	AmericanBlack76
+	=======================================================================================*/
+	AmericanBlack76::AmericanBlack76(double standardDeviation, double discountFactor, AmericanApproximation approximationInput)
+		: sd(standardDeviation), df(discountFactor), approximation(approximationInput)
+	{
+		if (!(sd > 0))
+		{
+			throw runtime_error("AmericanBlack76->Standard Deviation is <= 0");
+		}
+		if (!(df > 0))
+		{
+			throw runtime_error("AmericanBlack76->Discount Factor is <= 0");
+		}
+		isEuropean = (df >= 1.0);
+		if (isEuropean)
+		{
+			return;
+		}
+
+		if (approximation == BJERKSUND_STENSLAND_2002)
+		{
+			// With b = 0 the boundaries B0 = X and B_infinity = beta / (beta - 1) X
+			// beta - 1 is written without the cancellation that rounds it to 0 at tiny rates
+			double r = -log(df);
+			double twoRate = 2.0 * r / (sd * sd);
+			double betaLessOne = twoRate / (sqrt(0.25 + twoRate) + 0.5);
+			beta = 1.0 + betaLessOne;
+			double h1 = -2.0 * sd * sqrt(firstPeriodFraction) * betaLessOne;
+			double h2 = -2.0 * sd * betaLessOne;
+			secondBoundaryRatio = 1.0 - expm1(h1) / betaLessOne;
+			firstBoundaryRatio = 1.0 - expm1(h2) / betaLessOne;
+			return;
+		}
+
+		// Barone-Adesi Whaley with b = 0: M = 2r / sigma^2 and K = 1 - exp(-rT), so that M
+		// and M / K only depend on sd and df. The critical forward per unit strike s
+		// solves, for the call,
+		//		s - 1 = c(s) + (1 - df N(d1(s))) s / q2
+		// which is solved by Newton's method from Barone-Adesi and Whaley's starting value
+		double M = -2.0 * log(df) / (sd * sd);
+		double K = 1.0 - df;
+		callExponent = (1.0 + sqrt(1.0 + 4.0 * M / K)) / 2.0;
+		putExponent = (1.0 - sqrt(1.0 + 4.0 * M / K)) / 2.0;
+
+		// The limit as T -> infinity is 1 / (1 - 2 / (1 + sqrt(1 + 4M))), less 1 written so
+		// that it does not divide by a rounded zero at tiny rates
+		double callExcess = (1.0 + sqrt(1.0 + 4.0 * M)) / (2.0 * M);
+		double s = 1.0 + callExcess * (1.0 - exp(-2.0 * sd / callExcess));
+		double q = callExponent;
+		int iterations = 0;
+		double Nd1;
+		while (true)
+		{
+			double d1 = (log(s) + sd * sd / 2.0) / sd;
+			Nd1 = StandardNormal::cdf(d1);
+			double call = df * (s * Nd1 - StandardNormal::cdf(d1 - sd));
+			double rhs = call + (1.0 - df * Nd1) * s / q;
+			if (fabs(s - 1.0 - rhs) < criticalTolerance * s)
+			{
+				break;
+			}
+			if (++iterations > maximumIterations)
+			{
+				throw runtime_error("AmericanBlack76->Critical forward of the call did not converge");
+			}
+			double slope = df * Nd1 * (1.0 - 1.0 / q) + (1.0 - df * StandardNormal::pdf(d1) / sd) / q;
+			s = (1.0 + rhs - slope * s) / (1.0 - slope);
+		}
+		callCriticalRatio = s;
+		callCoefficient = (s / q) * (1.0 - df * Nd1);
+
+		// For the put 1 - s = p(s) - (1 - df N(-d1(s))) s / q1
+		double putLimit = 1.0 / (1.0 - 2.0 / (1.0 - sqrt(1.0 + 4.0 * M)));
+		s = putLimit + (1.0 - putLimit) * exp(-2.0 * sd / (1.0 - putLimit));
+		q = putExponent;
+		iterations = 0;
+		double Nminusd1;
+		while (true)
+		{
+			double d1 = (log(s) + sd * sd / 2.0) / sd;
+			Nminusd1 = StandardNormal::cdf(-d1);
+			double put = df * (StandardNormal::cdf(sd - d1) - s * Nminusd1);
+			double rhs = put - (1.0 - df * Nminusd1) * s / q;
+			if (fabs(1.0 - s - rhs) < criticalTolerance)
+			{
+				break;
+			}
+			if (++iterations > maximumIterations)
+			{
+				throw runtime_error("AmericanBlack76->Critical forward of the put did not converge");
+			}
+			double slope = -df * Nminusd1 * (1.0 - 1.0 / q) - (1.0 + df * StandardNormal::pdf(d1) / sd) / q;
+			s = (1.0 - rhs + slope * s) / (1.0 + slope);
+		}
+		putCriticalRatio = s;
+		putCoefficient = -(s / q) * (1.0 - df * Nminusd1);
+	}
+
+	double AmericanBlack76::getPremium(bool isCall, double F, double X) const
+	{
+		if (!(F > 0))
+		{
+			throw runtime_error("AmericanBlack76->Forward is <= 0");
+		}
+		if (!(X > 0))
+		{
+			throw runtime_error("AmericanBlack76->Strike is <= 0");
+		}
+		if (isEuropean)
+		{
+			return isCall ? Black76Call(F, X, sd, df).getPremium() : Black76Put(F, X, sd, df).getPremium();
+		}
+		if (approximation == BJERKSUND_STENSLAND_2002)
+		{
+			// With zero carry the put is the call with the forward and strike exchanged. Both
+			// this and never exercising are the values of exercise rules, so the larger is
+			// still a lower bound; as the rate goes to 0 the flat boundaries tend to
+			// X (1 + 2 sd) rather than infinity and exercise deep in the money options too early
+			double european = isCall ? Black76Call(F, X, sd, df).getPremium() : Black76Put(F, X, sd, df).getPremium();
+			double premium = isCall ? getBjerksundStenslandCallPremium(F, X) : getBjerksundStenslandCallPremium(X, F);
+			// max() would pass on a NaN from the formula where the terms overflow
+			if (!(fabs(premium) < numeric_limits<double>::infinity()))
+			{
+				return european;
+			}
+			return max(premium, european);
+		}
+		return getBaroneAdesiWhaleyPremium(isCall, F, X);
+	}
+
+	void AmericanBlack76::getPremium(size_t n, const double *F, const double *X, const bool *isCall, double *premium) const
+	{
+		for (size_t i = 0; i < n; ++i)
+		{
+			// The negated tests also catch NaN
+			if (!(F[i] > 0) || !(X[i] > 0))
+			{
+				premium[i] = numeric_limits<double>::quiet_NaN();
+				continue;
+			}
+			premium[i] = getPremium(isCall[i], F[i], X[i]);
+		}
+	}
+
+	double AmericanBlack76::getExerciseBoundary(bool isCall, double X) const
+	{
+		if (isEuropean)
+		{
+			return isCall ? numeric_limits<double>::infinity() : 0.0;
+		}
+		if (approximation == BJERKSUND_STENSLAND_2002)
+		{
+			// The put's boundary in the forward is the call's boundary in the strike
+			return isCall ? X * firstBoundaryRatio : X / firstBoundaryRatio;
+		}
+		return X * (isCall ? callCriticalRatio : putCriticalRatio);
+	}
+
+	double AmericanBlack76::getBaroneAdesiWhaleyPremium(bool isCall, double F, double X) const
+	{
+		if (isCall)
+		{
+			double critical = X * callCriticalRatio;
+			if (F >= critical)
+			{
+				return F - X;
+			}
+			return Black76Call(F, X, sd, df).getPremium() + X * callCoefficient * pow(F / critical, callExponent);
+		}
+		double critical = X * putCriticalRatio;
+		if (F <= critical)
+		{
+			return X - F;
+		}
+		return Black76Put(F, X, sd, df).getPremium() + X * putCoefficient * pow(F / critical, putExponent);
+	}
+
+	double AmericanBlack76::getBjerksundStenslandCallPremium(double S, double X) const
+	{
+		double I1 = X * secondBoundaryRatio, I2 = X * firstBoundaryRatio;
+		if (S >= I2)
+		{
+			return S - X;
+		}
+		// Neither boundary can be reached, so the rule is never to exercise, which
+		// getPremium() prices anyway. This also keeps clear of small sd, where beta is
+		// large and the terms below are huge weights times tail probabilities
+		if (log(I1 / S) > unreachableBoundary * sd)
+		{
+			return 0.0;
+		}
+		CarrylessParameters p = { sd, -log(df) };
+		double t1 = firstPeriodFraction;
+		// alpha_i S^beta = (I_i - X) (S / I_i)^beta
+		double alpha1 = I1 - X, alpha2 = I2 - X;
+		return alpha2 * pow(S / I2, beta)
+			- alpha2 * phi(p, S, I2, t1, beta, I2, I2)
+			+ phi(p, S, 1.0, t1, 1.0, I2, I2)
+			- phi(p, S, 1.0, t1, 1.0, I1, I2)
+			- X * phi(p, S, 1.0, t1, 0.0, I2, I2)
+			+ X * phi(p, S, 1.0, t1, 0.0, I1, I2)
+			+ alpha1 * phi(p, S, I1, t1, beta, I1, I2)
+			- alpha1 * psi(p, S, I1, beta, I1, I2, I1, t1)
+			+ psi(p, S, 1.0, 1.0, I1, I2, I1, t1)
+			- psi(p, S, 1.0, 1.0, X, I2, I1, t1)
+			- X * psi(p, S, 1.0, 0.0, I1, I2, I1, t1)
+			+ X * psi(p, S, 1.0, 0.0, X, I2, I1, t1);
+	}
+
+	void AmericanBlack76::getPremium(
+		size_t n,
+		const double *F,
+		const double *X,
+		const double *sd,
+		const double *df,
+		const bool *isCall,
+		AmericanApproximation approximation,
+		double *premium)
+	{
+		// The slice is rebuilt only when the standard deviation or discount factor changes
+		// from one line to the next, so a book sorted by expiry and volatility solves each
+		// slice's boundary once. A slice that cannot be built is left empty and its lines are
+		// NaN; the NaN key makes the first line build one.
+		unique_ptr<AmericanBlack76> slice;
+		double sliceSd = numeric_limits<double>::quiet_NaN(), sliceDf = numeric_limits<double>::quiet_NaN();
+		for (size_t i = 0; i < n; ++i)
+		{
+			if (!(sd[i] > 0) || !(df[i] > 0) || !(F[i] > 0) || !(X[i] > 0))
+			{
+				premium[i] = numeric_limits<double>::quiet_NaN();
+				continue;
+			}
+			if ((sd[i] != sliceSd) || (df[i] != sliceDf))
+			{
+				sliceSd = sd[i];
+				sliceDf = df[i];
+				try
+				{
+					slice.reset(new AmericanBlack76(sd[i], df[i], approximation));
+				}
+				catch (runtime_error &)
+				{
+					slice.reset();
+				}
+			}
+			premium[i] = slice ? slice->getPremium(isCall[i], F[i], X[i]) : numeric_limits<double>::quiet_NaN();
+		}
+	}
+}
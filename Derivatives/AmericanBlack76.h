@@ -0,0 +1,111 @@
+#ifndef XLLBASIC_AMERICANBLACK76_INCLUDED
+#define XLLBASIC_AMERICANBLACK76_INCLUDED
+#pragma once
+
+#include <math.h>
+#include <limits> // quiet_NaN
+#include <stdexcept> // runtime_error
+
+#include "../Maths/NormalDistribution.h"
+#include "Black76Formula.h"
+
+using namespace std;
+
+namespace XLLBasicLibrary
+{
+	/*======================================================================================
+	As American approximations are defined, add them here
+	=======================================================================================*/
+	enum AmericanApproximation
+	{
+		BARONE_ADESI_WHALEY,
+		BJERKSUND_STENSLAND_2002
+	};
+
+	/*======================================================================================
+	AmericanBlack76: American options on a future, which can be exercised at any time up
+	to expiry into F - X (call) or X - F (put). The premium is approximated by
+
+		- BARONE_ADESI_WHALEY: Barone-Adesi and Whaley (1987). The early exercise premium
+		  is A (F / F*)^q below (calls) / above (puts) a critical forward F*, beyond which
+		  the option is exercised. F* is found by Newton's method on the smooth pasting
+		  condition.
+		- BJERKSUND_STENSLAND_2002: Bjerksund and Stensland (2002), the exact value of
+		  exercising at a flat boundary in each of two periods [0, t1] and [t1, T], with
+		  t1 = (sqrt(5) - 1) T / 2, or of never exercising if that is worth more (at low
+		  rates the flat boundaries are too low). This is a lower bound on the premium
+		  and needs the bivariate normal, but no solve.
+
+	Against a binomial tree both are within about 0.3% of the strike up to a year at vols
+	of 20% - 60%, and within 1.5% at three years, where BAW overprices at high rates and
+	Bjerksund Stensland underprices at low rates. BAW can also exceed the undiscounted
+	European premium out of the money, which no American premium does.
+
+	The inputs are those of Black76Option: sd is the standard deviation of ln(F) at expiry
+	(= vol * sqrt(time)) and df the discount factor to expiry, which with a constant rate
+	and volatility is all that the premium depends on. With df >= 1 (rates <= 0) there is
+	nothing to gain from exercising early and the premium is that of Black76Call /
+	Black76Put.
+
+	Everything except the forward and the strike is fixed per slice, i.e. per sd and df,
+	and the exercise boundary is proportional to the strike (BAW: F* = X f(sd, df)) so
+	the object holds the solved boundaries of one slice and prices any forward and strike
+	against them without solving again. Build one per expiry and volatility and price the
+	strikes of that slice through it; the static batch form does this for a structure of
+	arrays, reusing the slice for consecutive lines with the same sd and df.
+	=======================================================================================*/
+	class AmericanBlack76
+	{
+	public :
+		// sd and df must be > 0
+		AmericanBlack76(double standardDeviation, double discountFactor,
+			AmericanApproximation approximation = BARONE_ADESI_WHALEY);
+
+		// forward and strike must be > 0
+		double getPremium(bool isCall, double forward, double strike) const;
+		// Writes the premiums of n options of this slice to premium
+		void getPremium(size_t n, const double *forward, const double *strike, const bool *isCall, double *premium) const;
+
+		// The forward at or above which a call (at or below which a put) is exercised now:
+		// F* for BAW, the boundary of the first period for Bjerksund Stensland. Infinite
+		// (zero for puts) if early exercise is never optimal.
+		double getExerciseBoundary(bool isCall, double strike) const;
+
+		double getStandardDeviation() const        {return sd;};
+		double getDiscountFactor() const           {return df;};
+		AmericanApproximation getApproximation() const  {return approximation;};
+
+		// All arrays must hold (at least) n elements. A line with inputs outside those of
+		// the single option form (or any NaN input), or on a slice whose constructor
+		// throws, is priced as NaN so that one bad line does not fail the whole batch.
+		static void getPremium(
+			size_t n,
+			const double *forward,
+			const double *strike,
+			const double *standardDeviation,
+			const double *discountFactor,
+			const bool *isCall,
+			AmericanApproximation approximation,
+			double *premium);
+
+	private :
+		double getBaroneAdesiWhaleyPremium(bool isCall, double F, double X) const;
+		// The call premium; a put is the call with the forward and strike exchanged
+		double getBjerksundStenslandCallPremium(double F, double X) const;
+
+		double sd, df;
+		AmericanApproximation approximation;
+		bool isEuropean;
+
+		// BAW: the exponents q, the critical forwards per unit strike and the coefficients
+		// A per unit strike
+		double callExponent, putExponent;
+		double callCriticalRatio, putCriticalRatio;
+		double callCoefficient, putCoefficient;
+
+		// Bjerksund Stensland: the exponent beta and the two boundaries per unit strike
+		double beta, firstBoundaryRatio, secondBoundaryRatio;
+	};
+}
+
+#endif
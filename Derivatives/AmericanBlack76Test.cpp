@@ -0,0 +1,282 @@
+#include "AmericanBlack76Test.h"
+
+#include <memory>
+
+using namespace std;
+using namespace boost::unit_test_framework;
+using namespace XLLBasicLibrary;
+
+namespace
+{
+    // An American option on a future on a Cox Ross Rubinstein tree, which has no drift in
+    // the future. The premiums of n and n + 1 steps straddle the limit, so their average
+    // is taken.
+    double treeStepsPremium(bool isCall, double F, double X, double sd, double df, int steps)
+    {
+        double u = exp(sd / sqrt(double(steps))), d = 1.0 / u;
+        double p = (1.0 - d) / (u - d), stepDf = pow(df, 1.0 / steps);
+        double w = isCall ? 1.0 : -1.0;
+        vector<double> value(steps + 1);
+        for (int i = 0; i <= steps; ++i)
+        {
+            value[i] = max(w * (F * pow(u, 2 * i - steps) - X), 0.0);
+        }
+        for (int step = steps - 1; step >= 0; --step)
+        {
+            double node = F * pow(u, -step);
+            for (int i = 0; i <= step; ++i, node *= u * u)
+            {
+                double held = stepDf * (p * value[i + 1] + (1.0 - p) * value[i]);
+                value[i] = max(held, w * (node - X));
+            }
+        }
+        return value[0];
+    }
+
+    double treePremium(bool isCall, double F, double X, double sd, double df)
+    {
+        int steps = 2000;
+        return 0.5 * (treeStepsPremium(isCall, F, X, sd, df, steps) + treeStepsPremium(isCall, F, X, sd, df, steps + 1));
+    }
+
+    double europeanPremium(bool isCall, double F, double X, double sd, double df)
+    {
+        return isCall ? Black76Call(F, X, sd, df).getPremium() : Black76Put(F, X, sd, df).getPremium();
+    }
+}
+
+void AmericanBlack76Test::testEuropeanBounds() 
+{
+    BOOST_TEST_MESSAGE("Testing American Black 76 premiums against their European and intrinsic bounds ...");
+
+    double F = 80, sds[] = { 0.05, 0.3, 1.0 }, dfs[] = { 0.999, 0.95, 0.7 };
+    double strikes[] = { 40, 70, 80, 90, 160 };
+    for (int k = 0; k < 2; ++k)
+    {
+        AmericanApproximation approximation = (k == 0) ? BARONE_ADESI_WHALEY : BJERKSUND_STENSLAND_2002;
+        for (size_t i = 0; i < sizeof(sds) / sizeof(double); ++i)
+        {
+            for (size_t j = 0; j < sizeof(dfs) / sizeof(double); ++j)
+            {
+                AmericanBlack76 slice(sds[i], dfs[j], approximation);
+                for (size_t m = 0; m < sizeof(strikes) / sizeof(double); ++m)
+                {
+                    double X = strikes[m];
+                    for (int c = 0; c < 2; ++c)
+                    {
+                        bool isCall = (c == 0);
+                        double american = slice.getPremium(isCall, F, X);
+                        double european = europeanPremium(isCall, F, X, sds[i], dfs[j]);
+                        double intrinsic = max(isCall ? F - X : X - F, 0.0);
+                        BOOST_CHECK(american >= european - 1e-12 * X);
+                        BOOST_CHECK(american >= intrinsic - 1e-12 * X);
+                        // At most the undiscounted European premium. BAW overprices out of
+                        // the money options at high rates, beyond this bound.
+                        if (approximation == BJERKSUND_STENSLAND_2002)
+                        {
+                            BOOST_CHECK(american <= european / dfs[j] + 1e-12 * X);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // With rates <= 0 there is no early exercise
+    for (int k = 0; k < 2; ++k)
+    {
+        AmericanApproximation approximation = (k == 0) ? BARONE_ADESI_WHALEY : BJERKSUND_STENSLAND_2002;
+        AmericanBlack76 slice(0.3, 1.01, approximation);
+        BOOST_CHECK(abs(slice.getPremium(true, F, 70) - Black76Call(F, 70, 0.3, 1.01).getPremium()) < 1e-14);
+        BOOST_CHECK(abs(slice.getPremium(false, F, 90) - Black76Put(F, 90, 0.3, 1.01).getPremium()) < 1e-14);
+    }
+    BOOST_REQUIRE_THROW(AmericanBlack76(0, 0.95), runtime_error);
+    BOOST_REQUIRE_THROW(AmericanBlack76(0.3, 0), runtime_error);
+    BOOST_REQUIRE_THROW(AmericanBlack76(0.3, 0.95).getPremium(true, 0, 80), runtime_error);
+    BOOST_REQUIRE_THROW(AmericanBlack76(0.3, 0.95).getPremium(true, 80, -1), runtime_error);
+}
+
+void AmericanBlack76Test::testAgainstTree()
+{
+    BOOST_TEST_MESSAGE("Testing American Black 76 approximations against a binomial tree ...");
+
+    // An 80 forward with vols of 20% - 60% from 3 months to 3 years and rates of 2% - 10%.
+    // The approximations are least accurate for long dated options, where BAW overprices
+    // at high rates and Bjerksund Stensland's flat boundaries underprice at low rates.
+    double F = 80, strikes[] = { 60, 75, 80, 85, 100 };
+    double vols[] = { 0.2, 0.6 }, times[] = { 0.25, 1.0, 3.0 }, rates[] = { 0.02, 0.1 };
+    for (size_t i = 0; i < sizeof(vols) / sizeof(double); ++i)
+    {
+        for (size_t j = 0; j < sizeof(times) / sizeof(double); ++j)
+        {
+            for (size_t k = 0; k < sizeof(rates) / sizeof(double); ++k)
+            {
+                double sd = vols[i] * sqrt(times[j]), df = exp(-rates[k] * times[j]);
+                double tolerance = (times[j] <= 1.0) ? 3e-3 : 1.5e-2;
+                AmericanBlack76 baw(sd, df, BARONE_ADESI_WHALEY), bs(sd, df, BJERKSUND_STENSLAND_2002);
+                for (size_t m = 0; m < sizeof(strikes) / sizeof(double); ++m)
+                {
+                    for (int c = 0; c < 2; ++c)
+                    {
+                        bool isCall = (c == 0);
+                        double X = strikes[m];
+                        double tree = treePremium(isCall, F, X, sd, df);
+                        double bawPremium = baw.getPremium(isCall, F, X);
+                        double bsPremium = bs.getPremium(isCall, F, X);
+                        BOOST_CHECK(abs(bawPremium - tree) < tolerance * X);
+                        BOOST_CHECK(abs(bsPremium - tree) < tolerance * X);
+                        // Bjerksund Stensland is the value of an exercise rule, and so a
+                        // lower bound (to within the error of the tree)
+                        BOOST_CHECK(bsPremium < tree + 1e-4 * X);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void AmericanBlack76Test::testExerciseBoundary()
+{
+    BOOST_TEST_MESSAGE("Testing American Black 76 exercise boundaries ...");
+
+    double sd = 0.35, df = 0.93, X = 80, h = 1e-6;
+    AmericanBlack76 baw(sd, df, BARONE_ADESI_WHALEY), bs(sd, df, BJERKSUND_STENSLAND_2002);
+    for (int c = 0; c < 2; ++c)
+    {
+        bool isCall = (c == 0);
+        double w = isCall ? 1.0 : -1.0;
+
+        // BAW's premium meets the intrinsic value smoothly at the critical forward
+        double critical = baw.getExerciseBoundary(isCall, X);
+        BOOST_CHECK(w * (critical - X) > 0);
+        double inside = critical - w * h;
+        BOOST_CHECK(abs(baw.getPremium(isCall, critical, X) - w * (critical - X)) < 1e-12 * X);
+        BOOST_CHECK(abs(baw.getPremium(isCall, inside, X) - w * (inside - X)) < 1e-9 * X);
+        double slope = (baw.getPremium(isCall, critical, X) - baw.getPremium(isCall, inside, X)) / (w * h);
+        BOOST_CHECK(abs(slope - w) < 1e-4);
+        // ... and the option is worth more than exercising before it
+        BOOST_CHECK(baw.getPremium(isCall, critical - w * 1.0, X) > w * (critical - w * 1.0 - X));
+
+        // The boundaries are proportional to the strike
+        BOOST_CHECK(abs(baw.getExerciseBoundary(isCall, 2 * X) - 2 * critical) < 1e-12 * X);
+        BOOST_CHECK(abs(bs.getExerciseBoundary(isCall, 2 * X) - 2 * bs.getExerciseBoundary(isCall, X)) < 1e-12 * X);
+
+        // Bjerksund Stensland exercises at and beyond its boundary
+        double boundary = bs.getExerciseBoundary(isCall, X);
+        BOOST_CHECK(w * (boundary - X) > 0);
+        BOOST_CHECK(abs(bs.getPremium(isCall, boundary * (1 + w * 1e-9), X) - w * (boundary * (1 + w * 1e-9) - X)) < 1e-12 * X);
+        BOOST_CHECK(bs.getPremium(isCall, boundary * (1 - w * 1e-2), X) > w * (boundary * (1 - w * 1e-2) - X));
+    }
+
+    // With df >= 1 an option is never exercised early
+    AmericanBlack76 european(sd, 1.0);
+    BOOST_CHECK(european.getExerciseBoundary(true, X) == numeric_limits<double>::infinity());
+    BOOST_CHECK(european.getExerciseBoundary(false, X) == 0);
+}
+
+void AmericanBlack76Test::testSmallRates()
+{
+    BOOST_TEST_MESSAGE("Testing American Black 76 at rates close to 0 ...");
+
+    // As the rate goes to 0 BAW's critical forward grows without bound and Bjerksund
+    // Stensland's beta tends to 1. Both premiums tend to the European one.
+    double sds[] = { 2.01, 1.75, 2.32, 3.0, 1.1 };
+    double rateTimes[] = { 1e-10, 3e-10, 5.6e-7, 1e-16, 1e-15 };
+    double X = 100;
+    for (size_t i = 0; i < sizeof(sds) / sizeof(double); ++i)
+    {
+        double df = (rateTimes[i] < 1e-15) ? 1.0 - rateTimes[i] : exp(-rateTimes[i]);
+        for (int k = 0; k < 2; ++k)
+        {
+            AmericanApproximation approximation = (k == 0) ? BARONE_ADESI_WHALEY : BJERKSUND_STENSLAND_2002;
+            AmericanBlack76 american(sds[i], df, approximation);
+            for (double F = 50; F <= 200; F *= 2)
+            {
+                double call = american.getPremium(true, F, X), put = american.getPremium(false, F, X);
+                double europeanCall = Black76Call(F, X, sds[i], df).getPremium();
+                double europeanPut = Black76Put(F, X, sds[i], df).getPremium();
+                BOOST_CHECK_MESSAGE(call >= europeanCall - 1e-12 * X && call - europeanCall < 1e-5 * X,
+                    "sd " << sds[i] << ", rT " << rateTimes[i] << ", F " << F << ": call " << call << " against " << europeanCall);
+                BOOST_CHECK_MESSAGE(put >= europeanPut - 1e-12 * X && put - europeanPut < 1e-5 * X,
+                    "sd " << sds[i] << ", rT " << rateTimes[i] << ", F " << F << ": put " << put << " against " << europeanPut);
+            }
+        }
+    }
+}
+
+void AmericanBlack76Test::testBatchPricing()
+{
+    BOOST_TEST_MESSAGE("Testing American Black 76 batch pricing against the single option form ...");
+
+    // Runs of lines on the same slice, as in a book sorted by expiry and vol, and a
+    // slice which comes back after another
+    size_t n = 1000;
+    vector<double> F(n), X(n), sd(n), df(n), result(n);
+    unique_ptr<bool[]> isCall(new bool[n]);
+    for (size_t i = 0; i < n; ++i)
+    {
+        size_t slice = (i / 50) % 7;
+        F[i] = 70 + (i % 11) * 2.0;
+        X[i] = 50 + (i % 23) * 3.0;
+        sd[i] = 0.1 + slice * 0.1;
+        df[i] = 0.99 - slice * 0.02;
+        isCall[i] = (i % 2 == 0);
+    }
+    for (int k = 0; k < 2; ++k)
+    {
+        AmericanApproximation approximation = (k == 0) ? BARONE_ADESI_WHALEY : BJERKSUND_STENSLAND_2002;
+        AmericanBlack76::getPremium(n, &F[0], &X[0], &sd[0], &df[0], isCall.get(), approximation, &result[0]);
+        for (size_t i = 0; i < n; ++i)
+        {
+            double expected = AmericanBlack76(sd[i], df[i], approximation).getPremium(isCall[i], F[i], X[i]);
+            BOOST_CHECK(result[i] == expected);
+        }
+
+        // The batch of one slice
+        AmericanBlack76 slice(sd[0], df[0], approximation);
+        slice.getPremium(50, &F[0], &X[0], isCall.get(), &result[0]);
+        for (size_t i = 0; i < 50; ++i)
+        {
+            BOOST_CHECK(result[i] == slice.getPremium(isCall[i], F[i], X[i]));
+        }
+    }
+
+    // A bad line is flagged as NaN without affecting its neighbours
+    X[1] = 0;
+    sd[3] = -0.2;
+    df[4] = numeric_limits<double>::quiet_NaN();
+    AmericanBlack76::getPremium(6, &F[0], &X[0], &sd[0], &df[0], isCall.get(), BARONE_ADESI_WHALEY, &result[0]);
+    BOOST_CHECK(!boost::math::isnan(result[0]));
+    BOOST_CHECK(boost::math::isnan(result[1]));
+    BOOST_CHECK(!boost::math::isnan(result[2]));
+    BOOST_CHECK(boost::math::isnan(result[3]));
+    BOOST_CHECK(boost::math::isnan(result[4]));
+    BOOST_CHECK(!boost::math::isnan(result[5]));
+    AmericanBlack76(sd[0], df[0]).getPremium(3, &F[0], &X[0], isCall.get(), &result[0]);
+    BOOST_CHECK(!boost::math::isnan(result[0]));
+    BOOST_CHECK(boost::math::isnan(result[1]));
+    BOOST_CHECK(!boost::math::isnan(result[2]));
+
+    // As is a slice whose boundary cannot be solved, and the lines after it are priced
+    sd[1] = sd[2] = 1e10;
+    BOOST_CHECK_THROW(AmericanBlack76(sd[1], df[1]), runtime_error);
+    AmericanBlack76::getPremium(6, &F[0], &X[0], &sd[0], &df[0], isCall.get(), BARONE_ADESI_WHALEY, &result[0]);
+    BOOST_CHECK(!boost::math::isnan(result[0]));
+    BOOST_CHECK(boost::math::isnan(result[1]));
+    BOOST_CHECK(boost::math::isnan(result[2]));
+    BOOST_CHECK(boost::math::isnan(result[3]));
+    BOOST_CHECK(boost::math::isnan(result[4]));
+    BOOST_CHECK(!boost::math::isnan(result[5]));
+}
+
+test_suite* AmericanBlack76Test::suite() 
+{
+    test_suite* suite = BOOST_TEST_SUITE("American Black 76 Pricing Suite");
+    suite->add(BOOST_TEST_CASE(&AmericanBlack76Test::testEuropeanBounds));
+    suite->add(BOOST_TEST_CASE(&AmericanBlack76Test::testAgainstTree));
+    suite->add(BOOST_TEST_CASE(&AmericanBlack76Test::testExerciseBoundary));
+    suite->add(BOOST_TEST_CASE(&AmericanBlack76Test::testSmallRates));
+    suite->add(BOOST_TEST_CASE(&AmericanBlack76Test::testBatchPricing));
+
+    return suite;
+}
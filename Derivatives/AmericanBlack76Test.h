@@ -0,0 +1,24 @@
+#ifndef XLLBASIC_american_black76_test
+#define XLLBASIC_american_black76_test
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <boost/math/special_functions/fpclassify.hpp> // boost::math::isnan
+#include "AmericanBlack76.h"
+#include "Black76Formula.h"
+
+class AmericanBlack76Test 
+{
+  public:
+    static void testEuropeanBounds();
+    static void testAgainstTree();
+    static void testExerciseBoundary();
+    static void testSmallRates();
+    static void testBatchPricing();
+
+    static boost::unit_test_framework::test_suite* suite();
+};
+
+#endif
@@ -0,0 +1,231 @@
+#include "AsianBlack76.h"
+
+#include <cmath>
+#include <algorithm>
+#include <map>
+
+namespace XLLBasicLibrary
+{
+	namespace
+	{
+		// Throws if the trade is not one that can be priced. Returns the number of fixed prices
+		size_t checkTrade(const AsianBlack76Trade &trade)
+		{
+			if ((trade.strike <= 0) || (trade.discountFactor <= 0))
+			{
+				throw runtime_error("AsianBlack76->Strike or discount factor is <= 0");
+			}
+			size_t n = trade.fixingTimes.size(), k = trade.fixedPrices.size();
+			if ((n == 0) || (k > n))
+			{
+				throw runtime_error("AsianBlack76->There must be at least one fixing and no more fixed prices than fixings");
+			}
+			if ((k < n) && (trade.fixingTimes[k] <= 0))
+			{
+				throw runtime_error("AsianBlack76->Fixings that have not been set must have a time > 0");
+			}
+			for (size_t i = k + 1; i < n; ++i)
+			{
+				if (trade.fixingTimes[i] <= trade.fixingTimes[i - 1])
+				{
+					throw runtime_error("AsianBlack76->Fixing times must be strictly increasing");
+				}
+			}
+			return k;
+		}
+
+		double sum(const vector<double> &values)
+		{
+			double total = 0;
+			for (size_t i = 0; i < values.size(); ++i)
+			{
+				total += values[i];
+			}
+			return total;
+		}
+
+		double checkVolatility(double vol)
+		{
+			if (!(vol > 0))
+			{
+				throw runtime_error("AsianBlack76->No volatility on the surface for a fixing");
+			}
+			return vol;
+		}
+	}
+
+	AsianBlack76::AsianBlack76(const ArrayInterpolator &forwardCurve, const SimpleDeltaSurface &surface)
+		: forwardCurve(forwardCurve), surface(surface)
+	{
+	}
+
+	double AsianBlack76::getMomentMatchedPremium(
+		bool isCall,
+		double strike,
+		double discountFactor,
+		size_t numberOfFixings,
+		double fixedSum,
+		size_t m,
+		const double *forward,
+		const double *volatility,
+		const double *time)
+	{
+		double n = (double)numberOfFixings;
+		double adjustedStrike = strike - fixedSum / n;
+		if (m == 0)
+		{
+			double average = fixedSum / n;
+			return discountFactor * (isCall ? max(average - strike, 0.0) : max(strike - average, 0.0));
+		}
+
+		// Walking back from the last fixing, laterForwards = sum_j>i F_j
+		double laterForwards = 0, secondMoment = 0;
+		for (size_t i = m; i-- > 0;)
+		{
+			secondMoment += forward[i] * exp(volatility[i] * volatility[i] * time[i]) * (forward[i] + 2.0 * laterForwards);
+			laterForwards += forward[i];
+		}
+		double firstMoment = laterForwards / n;
+		secondMoment /= n * n;
+
+		if (adjustedStrike <= 0)
+		{
+			return isCall ? discountFactor * (firstMoment - adjustedStrike) : 0.0;
+		}
+		double sd = sqrt(log(secondMoment / (firstMoment * firstMoment)));
+		if (isCall)
+		{
+			return Black76Call(firstMoment, adjustedStrike, sd, discountFactor).getPremium();
+		}
+		return Black76Put(firstMoment, adjustedStrike, sd, discountFactor).getPremium();
+	}
+
+	double AsianBlack76::getPremium(const AsianBlack76Trade &trade) const
+	{
+		size_t k = checkTrade(trade);
+		size_t m = trade.fixingTimes.size() - k;
+		vector<double> forward(m), volatility(m);
+		const double *time = m > 0 ? &trade.fixingTimes[k] : NULL;
+		for (size_t i = 0; i < m; ++i)
+		{
+			if (!forwardCurve.isInRange(time[i]))
+			{
+				throw runtime_error("AsianBlack76->A fixing is outside the forward curve");
+			}
+			forward[i] = forwardCurve.getRate(time[i]);
+			if (!(forward[i] > 0))
+			{
+				throw runtime_error("AsianBlack76->A forward on the curve is <= 0");
+			}
+			volatility[i] = checkVolatility(surface.getVolatilityForMoneyness(time[i], (trade.strike - forward[i]) / forward[i]));
+		}
+		return getMomentMatchedPremium(trade.isCall, trade.strike, trade.discountFactor,
+			trade.fixingTimes.size(), sum(trade.fixedPrices), m,
+			m > 0 ? &forward[0] : NULL, m > 0 ? &volatility[0] : NULL, time);
+	}
+
+	void AsianBlack76::getPremium(size_t n, const AsianBlack76Trade *trades, double *premium) const
+	{
+		double nan = numeric_limits<double>::quiet_NaN();
+
+		// The distinct unfixed fixing times of the valid trades, in order
+		vector<bool> valid(n, false);
+		vector<double> times;
+		for (size_t t = 0; t < n; ++t)
+		{
+			try
+			{
+				size_t k = checkTrade(trades[t]);
+				times.insert(times.end(), trades[t].fixingTimes.begin() + k, trades[t].fixingTimes.end());
+				valid[t] = true;
+			}
+			catch (runtime_error &)
+			{
+				premium[t] = nan;
+			}
+		}
+		sort(times.begin(), times.end());
+		times.erase(unique(times.begin(), times.end()), times.end());
+
+		// One sorted batch lookup for the times on the curve. Being sorted, the times off
+		// the curve are at either end.
+		vector<double> forwards(times.size(), nan);
+		size_t first = 0, last = times.size();
+		while ((first < last) && !forwardCurve.isInRange(times[first]))
+		{
+			++first;
+		}
+		while ((last > first) && !forwardCurve.isInRange(times[last - 1]))
+		{
+			--last;
+		}
+		if (last > first)
+		{
+			forwardCurve.getRate(last - first, &times[first], &forwards[first]);
+		}
+
+		// Smiles by the index of the fixing time, built when first needed, and volatilities
+		// by (index of the fixing time, strike)
+		map<size_t, DeltaSmile> smiles;
+		map<pair<size_t, double>, double> volatilities;
+		vector<double> forward, volatility;
+		for (size_t t = 0; t < n; ++t)
+		{
+			if (!valid[t])
+			{
+				continue;
+			}
+			const AsianBlack76Trade &trade = trades[t];
+			size_t k = trade.fixedPrices.size();
+			size_t m = trade.fixingTimes.size() - k;
+			const double *time = m > 0 ? &trade.fixingTimes[k] : NULL;
+			forward.resize(m);
+			volatility.resize(m);
+			try
+			{
+				vector<double>::iterator position = times.begin();
+				for (size_t i = 0; i < m; ++i)
+				{
+					// The trade's times are increasing, so each search starts at the last
+					position = lower_bound(position, times.end(), time[i]);
+					size_t index = position - times.begin();
+					forward[i] = forwards[index];
+					if (!(forward[i] > 0))
+					{
+						throw runtime_error("AsianBlack76->A fixing is outside the forward curve or its forward is <= 0");
+					}
+					pair<size_t, double> key(index, trade.strike);
+					map<pair<size_t, double>, double>::iterator cached = volatilities.find(key);
+					if (cached == volatilities.end())
+					{
+						map<size_t, DeltaSmile>::iterator smile = smiles.find(index);
+						if (smile == smiles.end())
+						{
+							smile = smiles.insert(make_pair(index, surface.getSmile(time[i]))).first;
+						}
+						double vol = smile->second.getVolatilityForMoneyness((trade.strike - forward[i]) / forward[i]);
+						cached = volatilities.insert(make_pair(key, checkVolatility(vol))).first;
+					}
+					volatility[i] = cached->second;
+				}
+				premium[t] = getMomentMatchedPremium(trade.isCall, trade.strike, trade.discountFactor,
+					trade.fixingTimes.size(), sum(trade.fixedPrices), m,
+					m > 0 ? &forward[0] : NULL, m > 0 ? &volatility[0] : NULL, time);
+			}
+			catch (runtime_error &)
+			{
+				premium[t] = nan;
+			}
+		}
+	}
+
+	vector<double> AsianBlack76::getPremium(const vector<AsianBlack76Trade> &trades) const
+	{
+		vector<double> premium(trades.size());
+		if (!trades.empty())
+		{
+			getPremium(trades.size(), &trades[0], &premium[0]);
+		}
+		return premium;
+	}
+}
@@ -0,0 +1,94 @@
+#ifndef XLLBASIC_ASIANBLACK76_INCLUDED
+#define XLLBASIC_ASIANBLACK76_INCLUDED
+#pragma once
+
+#include <vector>
+#include "../Maths/maths.h"
+#include "Black76Formula.h"
+#include "VolatilitySurfaceDelta.h"
+
+using namespace std;
+
+namespace XLLBasicLibrary
+{
+	/*======================================================================================
+	AsianBlack76Trade
+
+	An average price option (APO): at settlement it pays df * max(A - X, 0) for a call
+	(max(X - A, 0) for a put), where A is the arithmetic average of the prices at the
+	fixing times (year fractions, strictly increasing).
+
+	A partially fixed average lists the prices already set in fixedPrices; these are the
+	first fixedPrices.size() fixings and their times are not used. The remaining fixing
+	times must be > 0.
+	=======================================================================================*/
+	struct AsianBlack76Trade
+	{
+		bool isCall;
+		double strike;
+		double discountFactor;
+		vector<double> fixingTimes;
+		vector<double> fixedPrices;
+	};
+
+	/*======================================================================================
+	AsianBlack76
+
+	Prices average price options by moment matching (Turnbull and Wakeman, Levy): the
+	unfixed part of the average is replaced by a lognormal with the same first two moments
+	and priced with Black76Call / Black76Put.
+
+	With k of the n fixings set (sum S) and F_i, vol_i and t_i the forward, volatility and
+	time of the m = n - k remaining fixings in time order
+		M1 = sum_i F_i / n
+		M2 = sum_ij F_i F_j exp(vol_min(i,j)^2 t_min(i,j)) / n^2
+		   = sum_i F_i exp(vol_i^2 t_i) (F_i + 2 sum_j>i F_j) / n^2
+	and the premium is Black76(M1, X - S / n, sqrt(ln(M2 / M1^2)), df). The covariance of
+	two fixings is the variance of the earlier one, i.e. the fixings are of one price
+	moving with a single factor. If X - S / n <= 0 a call is certain to be exercised and is
+	worth df * (E[A] - X); a put is worthless. Once every fixing is set the option is worth
+	its discounted intrinsic value.
+
+	The forward of a fixing is read off the forward curve at its time and its volatility
+	off the surface at its time and the trade's moneyness (X - F_i) / F_i. Close to a
+	fixing any strike away from the money has a delta near 0 or 100, so a surface for an
+	APO book should normally be built with extrapolate set. The pricer keeps references to
+	the curve and the surface, which must outlive it.
+
+	The batch form looks up each distinct fixing time on the curve once, as one sorted
+	batch, takes the surface's smile at each distinct fixing time once and solves each
+	distinct (fixing time, strike) pair against it once, so a book of APOs on the same
+	months costs little more than its distinct fixings and strikes. As in
+	Black76Batch a trade that cannot be priced (bad inputs, a fixing off the curve or the
+	surface) is returned as NaN; the single trade form throws a runtime_error instead.
+	=======================================================================================*/
+	class AsianBlack76
+	{
+	public:
+		AsianBlack76(const ArrayInterpolator &forwardCurve, const SimpleDeltaSurface &surface);
+
+		double getPremium(const AsianBlack76Trade &trade) const;
+		void getPremium(size_t n, const AsianBlack76Trade *trades, double *premium) const;
+		vector<double> getPremium(const vector<AsianBlack76Trade> &trades) const;
+
+		// The moment matched premium given the forward, volatility and time of each of the
+		// m unfixed fixings (in time order), numberOfFixings in all and the sum of the
+		// fixed prices
+		static double getMomentMatchedPremium(
+			bool isCall,
+			double strike,
+			double discountFactor,
+			size_t numberOfFixings,
+			double fixedSum,
+			size_t m,
+			const double *forward,
+			const double *volatility,
+			const double *time);
+
+	private:
+		const ArrayInterpolator &forwardCurve;
+		const SimpleDeltaSurface &surface;
+	};
+}
+
+#endif
@@ -0,0 +1,198 @@
+#include "AsianBlack76Test.h"
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+using namespace std;
+using namespace boost::unit_test_framework;
+using namespace XLLBasicLibrary;
+
+namespace
+{
+    // A surface with the same volatility everywhere, so that results can be compared with
+    // the flat volatility Monte Carlo. The surfaces extrapolate so that fixings a few days
+    // away, whose deltas are near 0 or 100, still have a volatility.
+    shared_ptr<SimpleDeltaSurface> flatSurface(double vol)
+    {
+        vector<double> times = { 0.01, 0.5, 1.0, 3.0 };
+        vector<double> delta = { 5, 50, 95 };
+        vector<vector<double>> volatility(delta.size(), vector<double>(times.size(), vol));
+        return shared_ptr<SimpleDeltaSurface>(new SimpleDeltaSurface(times, delta, volatility, true, "bilinear"));
+    }
+
+    shared_ptr<SimpleDeltaSurface> smileSurface()
+    {
+        vector<double> times = { 1.0 / 12.0, 0.25, 0.5, 1.0, 2.0 };
+        vector<double> delta = { 10, 25, 50, 75, 90 };
+        vector<vector<double>> volatility = {
+            { .38, .36, .34, .32, .30 },
+            { .35, .33, .31, .29, .28 },
+            { .34, .32, .30, .28, .27 },
+            { .36, .34, .32, .30, .29 },
+            { .40, .38, .35, .33, .31 } };
+        return shared_ptr<SimpleDeltaSurface>(new SimpleDeltaSurface(times, delta, volatility, true, "bilinear"));
+    }
+
+    // A Brent curve in backwardation out to two years
+    LinearArrayInterpolator brentCurve()
+    {
+        vector<double> times = { 0.0, 0.25, 0.5, 1.0, 2.0 };
+        vector<double> forwards = { 82.0, 81.0, 80.0, 78.5, 76.0 };
+        return LinearArrayInterpolator(times, forwards);
+    }
+
+    // 21 daily fixings through the calendar month starting at monthStart
+    vector<double> monthOfFixings(double monthStart)
+    {
+        vector<double> times;
+        for (size_t i = 0; i < 21; ++i)
+        {
+            times.push_back(monthStart + (i + 1) / 252.0);
+        }
+        return times;
+    }
+
+    AsianBlack76Trade apo(bool isCall, double strike, double monthStart)
+    {
+        AsianBlack76Trade trade;
+        trade.isCall = isCall;
+        trade.strike = strike;
+        trade.discountFactor = exp(-0.03 * (monthStart + 0.1));
+        trade.fixingTimes = monthOfFixings(monthStart);
+        return trade;
+    }
+}
+
+void AsianBlack76Test::testAgainstBlack76AndMonteCarlo()
+{
+    BOOST_TEST_MESSAGE("Testing AsianBlack76 against Black 76 and Monte Carlo ...");
+
+    // One fixing is a European option
+    double F = 80.0, vol = 0.3, t = 0.75;
+    double black76 = Black76Call(F, 78.0, vol * sqrt(t), 0.98).getPremium();
+    BOOST_CHECK(abs(AsianBlack76::getMomentMatchedPremium(true, 78.0, 0.98, 1, 0.0, 1, &F, &vol, &t) - black76) < 1e-12);
+
+    // A flat curve and surface against the control variate Monte Carlo, which is exact to
+    // its standard error
+    shared_ptr<SimpleDeltaSurface> surface = flatSurface(0.35);
+    LinearArrayInterpolator curve(vector<double>({ 0.0, 3.0 }), vector<double>({ 80.0, 80.0 }));
+    AsianBlack76 pricer(curve, *surface);
+    AsianMonteCarlo monteCarlo(0);
+    AsianMonteCarloSettings settings;
+    settings.paths = 200000;
+
+    double strikes[3] = { 70.0, 80.0, 92.0 };
+    double monthStarts[2] = { 0.05, 1.0 };
+    for (size_t s = 0; s < 3; ++s)
+    {
+        for (size_t m = 0; m < 2; ++m)
+        {
+            for (int isCall = 0; isCall < 2; ++isCall)
+            {
+                AsianBlack76Trade trade = apo(isCall == 1, strikes[s], monthStarts[m]);
+                AsianOption option = { trade.isCall, 80.0, trade.strike, 0.35, trade.discountFactor, trade.fixingTimes };
+                double matched = pricer.getPremium(trade);
+                AsianMonteCarloResult simulated = monteCarlo.price(option, settings);
+                // Moment matching is an approximation; for a one month average it is well
+                // within a cent on an $80 underlying
+                BOOST_CHECK_MESSAGE(abs(matched - simulated.premium) < 0.01 + 4 * simulated.standardError,
+                    "Strike " << strikes[s] << ", month " << monthStarts[m] << (isCall ? " call " : " put ")
+                    << matched << " against Monte Carlo " << simulated.premium << " +/- " << simulated.standardError);
+            }
+        }
+    }
+}
+
+void AsianBlack76Test::testPartiallyFixed()
+{
+    BOOST_TEST_MESSAGE("Testing AsianBlack76 with partially fixed averages ...");
+
+    shared_ptr<SimpleDeltaSurface> surface = smileSurface();
+    LinearArrayInterpolator curve = brentCurve();
+    AsianBlack76 pricer(curve, *surface);
+
+    // Ten of the 21 fixings of the current month are set
+    AsianBlack76Trade call = apo(true, 81.0, -10.0 / 252.0);
+    call.fixedPrices = vector<double>(10, 83.0);
+    AsianBlack76Trade put = call;
+    put.isCall = false;
+    double c = pricer.getPremium(call), p = pricer.getPremium(put);
+
+    // Put call parity: C - P = df (E[A] - X)
+    double expectedAverage = 10 * 83.0;
+    for (size_t i = 10; i < 21; ++i)
+    {
+        expectedAverage += curve.getRate(call.fixingTimes[i]);
+    }
+    expectedAverage /= 21;
+    BOOST_CHECK(abs(c - p - call.discountFactor * (expectedAverage - 81.0)) < 1e-10);
+
+    // With the fixed part alone above the strike the call is certain to be exercised
+    AsianBlack76Trade deep = call;
+    deep.strike = 40.0;
+    AsianBlack76Trade deepPut = deep;
+    deepPut.isCall = false;
+    BOOST_CHECK(abs(pricer.getPremium(deep) - deep.discountFactor * (expectedAverage - 40.0)) < 1e-10);
+    BOOST_CHECK(pricer.getPremium(deepPut) == 0.0);
+
+    // Fully fixed: the discounted intrinsic value
+    AsianBlack76Trade fixed = call;
+    fixed.fixedPrices = vector<double>(21, 83.0);
+    BOOST_CHECK(abs(pricer.getPremium(fixed) - fixed.discountFactor * 2.0) < 1e-12);
+
+    // Bad trades throw
+    AsianBlack76Trade bad = call;
+    bad.fixedPrices = vector<double>(22, 83.0);
+    BOOST_CHECK_THROW(pricer.getPremium(bad), runtime_error);
+    bad = apo(true, 81.0, 2.5);
+    BOOST_CHECK_THROW(pricer.getPremium(bad), runtime_error);
+}
+
+void AsianBlack76Test::testBatch()
+{
+    BOOST_TEST_MESSAGE("Testing AsianBlack76 batch against single trades ...");
+
+    shared_ptr<SimpleDeltaSurface> surface = smileSurface();
+    LinearArrayInterpolator curve = brentCurve();
+    AsianBlack76 pricer(curve, *surface);
+
+    vector<AsianBlack76Trade> book;
+    for (size_t i = 0; i < 300; ++i)
+    {
+        AsianBlack76Trade trade = apo(i % 2 == 0, 70.0 + (i % 5) * 5.0, (i % 12) / 12.0 + 0.05);
+        if (i % 7 == 0)
+        {
+            trade.fixedPrices = vector<double>(5, 80.0 + i % 3);
+            trade.fixingTimes = apo(true, 80, -5.0 / 252.0).fixingTimes;
+        }
+        book.push_back(trade);
+    }
+    // Invalid trades: a non positive strike and a month beyond the end of the curve
+    book[10].strike = 0;
+    book[11] = apo(true, 80.0, 2.5);
+
+    vector<double> batch = pricer.getPremium(book);
+    BOOST_REQUIRE(batch.size() == book.size());
+    for (size_t i = 0; i < book.size(); ++i)
+    {
+        if ((i == 10) || (i == 11))
+        {
+            BOOST_CHECK(std::isnan(batch[i]));
+            continue;
+        }
+        double single = pricer.getPremium(book[i]);
+        BOOST_CHECK_MESSAGE(abs(batch[i] - single) < 1e-12 * max(1.0, single),
+            "Trade " << i << ": batch " << batch[i] << ", single " << single);
+    }
+}
+
+test_suite* AsianBlack76Test::suite()
+{
+    test_suite* suite = BOOST_TEST_SUITE("Asian Black 76 Suite");
+    suite->add(BOOST_TEST_CASE(&AsianBlack76Test::testAgainstBlack76AndMonteCarlo));
+    suite->add(BOOST_TEST_CASE(&AsianBlack76Test::testPartiallyFixed));
+    suite->add(BOOST_TEST_CASE(&AsianBlack76Test::testBatch));
+
+    return suite;
+}
@@ -0,0 +1,20 @@
+#ifndef XLLBASIC_asian_black76_test
+#define XLLBASIC_asian_black76_test
+#pragma once
+
+#include <iostream>
+#include <boost/test/unit_test.hpp>
+#include "AsianBlack76.h"
+#include "AsianMonteCarlo.h"
+
+class AsianBlack76Test 
+{
+  public:
+    static void testAgainstBlack76AndMonteCarlo();
+    static void testPartiallyFixed();
+    static void testBatch();
+
+    static boost::unit_test_framework::test_suite* suite();
+};
+
+#endif
@@ -0,0 +1,200 @@
+#include "AsianMonteCarlo.h"
+#include "../Maths/RandomNumbers.h"
+
+#include <cmath>
+
+namespace XLLBasicLibrary
+{
+	const size_t AsianMonteCarlo::pathsPerBlock;
+
+	namespace
+	{
+		// Blocks handed to a thread at a time
+		const size_t blocksPerChunk = 8;
+
+		// Sums over the samples of one block of the arithmetic (y) and geometric (z) payoffs
+		struct BlockStatistics
+		{
+			double sumY, sumYY, sumZ, sumZZ, sumYZ;
+		};
+
+		void checkInputs(const AsianOption &option)
+		{
+			if ((option.forward <= 0) || (option.strike <= 0))
+			{
+				throw runtime_error("AsianMonteCarlo->Forward or strike is <= 0");
+			}
+			if ((option.volatility <= 0) || (option.discountFactor <= 0))
+			{
+				throw runtime_error("AsianMonteCarlo->Volatility or discount factor is <= 0");
+			}
+			if (option.fixingTimes.empty() || (option.fixingTimes[0] <= 0))
+			{
+				throw runtime_error("AsianMonteCarlo->The first fixing time must be > 0");
+			}
+			for (size_t i = 1; i < option.fixingTimes.size(); ++i)
+			{
+				if (option.fixingTimes[i] <= option.fixingTimes[i - 1])
+				{
+					throw runtime_error("AsianMonteCarlo->Fixing times must be strictly increasing");
+				}
+			}
+		}
+
+		double payoff(bool isCall, double average, double strike)
+		{
+			return isCall ? max(average - strike, 0.0) : max(strike - average, 0.0);
+		}
+	}
+
+	AsianMonteCarlo::AsianMonteCarlo(size_t threadCount)
+		: pool(threadCount)
+	{
+	}
+
+	double AsianMonteCarlo::getGeometricAveragePremium(const AsianOption &option)
+	{
+		checkInputs(option);
+		const vector<double> &t = option.fixingTimes;
+		size_t n = t.size();
+		double variance = option.volatility * option.volatility;
+		// sum_ij min(t_i, t_j), where t_i is the smaller of the pair for the 2(n-i)-1 pairs
+		// (i, j >= i) and (j > i, i)
+		double sumOfMinima = 0, sumOfTimes = 0;
+		for (size_t i = 0; i < n; ++i)
+		{
+			sumOfMinima += t[i] * (2.0 * (n - i) - 1.0);
+			sumOfTimes += t[i];
+		}
+		double geometricVariance = variance * sumOfMinima / ((double)n * n);
+		double meanLog = log(option.forward) - 0.5 * variance * sumOfTimes / n;
+		double geometricForward = exp(meanLog + 0.5 * geometricVariance);
+		double sd = sqrt(geometricVariance);
+		if (option.isCall)
+		{
+			return Black76Call(geometricForward, option.strike, sd, option.discountFactor).getPremium();
+		}
+		return Black76Put(geometricForward, option.strike, sd, option.discountFactor).getPremium();
+	}
+
+	AsianMonteCarloResult AsianMonteCarlo::price(const AsianOption &option, const AsianMonteCarloSettings &settings)
+	{
+		checkInputs(option);
+		size_t samples = settings.antithetic ? settings.paths / 2 : settings.paths;
+		if (samples < 2)
+		{
+			throw runtime_error("AsianMonteCarlo->At least two samples (four antithetic paths) are needed");
+		}
+
+		// Per fixing: log F(t_k) = log F(t_k-1) + drift[k] + diffusion[k] * z_k
+		size_t n = option.fixingTimes.size();
+		vector<double> drift(n), diffusion(n);
+		double previousTime = 0;
+		for (size_t k = 0; k < n; ++k)
+		{
+			double dt = option.fixingTimes[k] - previousTime;
+			drift[k] = -0.5 * option.volatility * option.volatility * dt;
+			diffusion[k] = option.volatility * sqrt(dt);
+			previousTime = option.fixingTimes[k];
+		}
+
+		const size_t B = pathsPerBlock;
+		size_t blocks = (samples + B - 1) / B;
+		vector<BlockStatistics> statistics(blocks);
+		Philox4x32 generator(settings.seed);
+		double logForward = log(option.forward);
+		double strike = option.strike;
+		bool isCall = option.isCall;
+		int directions = settings.antithetic ? 2 : 1;
+		double weight = 1.0 / directions;
+
+		pool.parallelFor(blocks, blocksPerChunk, [&](size_t firstBlock, size_t lastBlock)
+		{
+			// normals[k * B + p] is the normal for fixing k of path p
+			vector<double> normals(n * B), pathNormals(n);
+			vector<double> logF(B), arithmeticSum(B), logSum(B), y(B), z(B);
+			for (size_t block = firstBlock; block < lastBlock; ++block)
+			{
+				size_t first = block * B;
+				size_t count = min(B, samples - first);
+				for (size_t p = 0; p < count; ++p)
+				{
+					generator.getNormals(first + p, n, &pathNormals[0]);
+					for (size_t k = 0; k < n; ++k)
+					{
+						normals[k * B + p] = pathNormals[k];
+					}
+				}
+
+				fill(y.begin(), y.end(), 0.0);
+				fill(z.begin(), z.end(), 0.0);
+				for (int direction = 0; direction < directions; ++direction)
+				{
+					double sign = (direction == 0) ? 1.0 : -1.0;
+					fill(logF.begin(), logF.end(), logForward);
+					fill(arithmeticSum.begin(), arithmeticSum.end(), 0.0);
+					fill(logSum.begin(), logSum.end(), 0.0);
+					for (size_t k = 0; k < n; ++k)
+					{
+						const double *zk = &normals[k * B];
+						double shock = sign * diffusion[k];
+						for (size_t p = 0; p < count; ++p)
+						{
+							logF[p] += drift[k] + shock * zk[p];
+							arithmeticSum[p] += exp(logF[p]);
+							logSum[p] += logF[p];
+						}
+					}
+					for (size_t p = 0; p < count; ++p)
+					{
+						y[p] += weight * payoff(isCall, arithmeticSum[p] / n, strike);
+						z[p] += weight * payoff(isCall, exp(logSum[p] / n), strike);
+					}
+				}
+
+				BlockStatistics sums = { 0, 0, 0, 0, 0 };
+				for (size_t p = 0; p < count; ++p)
+				{
+					sums.sumY += y[p];
+					sums.sumYY += y[p] * y[p];
+					sums.sumZ += z[p];
+					sums.sumZZ += z[p] * z[p];
+					sums.sumYZ += y[p] * z[p];
+				}
+				statistics[block] = sums;
+			}
+		});
+
+		// Added in block order so that the result does not depend on the threads
+		BlockStatistics total = { 0, 0, 0, 0, 0 };
+		for (size_t block = 0; block < blocks; ++block)
+		{
+			total.sumY += statistics[block].sumY;
+			total.sumYY += statistics[block].sumYY;
+			total.sumZ += statistics[block].sumZ;
+			total.sumZZ += statistics[block].sumZZ;
+			total.sumYZ += statistics[block].sumYZ;
+		}
+		double N = (double)samples;
+		double meanY = total.sumY / N;
+		double varianceY = (total.sumYY - N * meanY * meanY) / (N - 1);
+		double estimate = meanY, variance = varianceY, beta = 0;
+		if (settings.controlVariate)
+		{
+			double meanZ = total.sumZ / N;
+			double varianceZ = (total.sumZZ - N * meanZ * meanZ) / (N - 1);
+			double covariance = (total.sumYZ - N * meanY * meanZ) / (N - 1);
+			double expectedZ = getGeometricAveragePremium(option) / option.discountFactor;
+			beta = (varianceZ > 0) ? covariance / varianceZ : 0;
+			estimate = meanY - beta * (meanZ - expectedZ);
+			variance = varianceY - 2 * beta * covariance + beta * beta * varianceZ;
+		}
+
+		AsianMonteCarloResult result;
+		result.premium = option.discountFactor * estimate;
+		result.standardError = option.discountFactor * sqrt(max(variance, 0.0) / N);
+		result.paths = samples * directions;
+		result.controlVariateBeta = beta;
+		return result;
+	}
+}
@@ -0,0 +1,102 @@
+#ifndef XLLBASIC_ASIANMONTECARLO_INCLUDED
+#define XLLBASIC_ASIANMONTECARLO_INCLUDED
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "Black76Formula.h"
+#include "WorkStealingPool.h"
+
+using namespace std;
+
+namespace XLLBasicLibrary
+{
+	/*======================================================================================
+	AsianOption
+
+	An average price option on a futures contract, the usual ICE Brent structure: at
+	settlement it pays df * max(A - X, 0) for a call (max(X - A, 0) for a put) where A is
+	the arithmetic average of the futures price at the fixing times.
+
+	A path needs the standard deviation of the futures price at every fixing, so unlike
+	Black76Option the inputs are a volatility and the fixing times (year fractions, > 0
+	and increasing) rather than a single standard deviation. The futures price follows
+	the Black '76 dynamics dF = vol * F dW.
+	=======================================================================================*/
+	struct AsianOption
+	{
+		bool isCall;
+		double forward;
+		double strike;
+		double volatility;
+		double discountFactor;
+		vector<double> fixingTimes;
+	};
+
+	struct AsianMonteCarloSettings
+	{
+		AsianMonteCarloSettings()
+			: paths(100000), seed(1), antithetic(true), controlVariate(true) {};
+
+		// Number of paths simulated, including the antithetic ones
+		size_t paths;
+		uint64_t seed;
+		bool antithetic;
+		// Use the geometric average option, which Black '76 prices exactly, as a control
+		bool controlVariate;
+	};
+
+	struct AsianMonteCarloResult
+	{
+		double premium;
+		double standardError;
+		size_t paths;
+		// The weight given to the control; 0 without the control variate
+		double controlVariateBeta;
+	};
+
+	/*======================================================================================
+	AsianMonteCarlo
+
+	Prices AsianOptions by simulation on the threads of a WorkStealingPool.
+
+	Paths are simulated pathsPerBlock at a time, fixing by fixing across the block, so the
+	inner loops run over contiguous arrays of paths. The normals of path i are drawn from
+	stream i of a Philox4x32 generator keyed on the seed, and the statistics of each block
+	are added up in block order. A given seed therefore gives exactly the same premium on
+	any number of threads.
+
+	Variance reduction:
+		- antithetic: every path with normals z is paired with the path with -z and the
+		  pair's average payoff is one sample
+		- control variate: the geometric average G of the fixings is lognormal, so an
+		  option on G is priced exactly by Black76 with
+				ln F_G = mean(ln F) + var / 2,  sd_G^2 = var,
+				mean(ln F) = ln F - vol^2 mean(t_i) / 2,  var = vol^2 / n^2 sum_ij min(t_i, t_j)
+		  The simulated geometric payoffs, with the estimated regression weight, remove
+		  most of the noise from the arithmetic payoffs.
+
+	The standard error is that of the estimator actually used. Throws a runtime_error if
+	the option inputs are not valid.
+	=======================================================================================*/
+	class AsianMonteCarlo
+	{
+	public:
+		static const size_t pathsPerBlock = 64;
+
+		// threadCount includes the calling thread; 0 uses one thread per core
+		explicit AsianMonteCarlo(size_t threadCount = 0);
+
+		size_t getThreadCount() const		{return pool.getThreadCount();};
+
+		AsianMonteCarloResult price(const AsianOption &option, const AsianMonteCarloSettings &settings);
+
+		// The exact premium of the option on the geometric average of the fixings
+		static double getGeometricAveragePremium(const AsianOption &option);
+
+	private:
+		WorkStealingPool pool;
+	};
+}
+
+#endif
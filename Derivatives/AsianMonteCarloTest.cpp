@@ -0,0 +1,124 @@
+#include "AsianMonteCarloTest.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace std;
+using namespace boost::unit_test_framework;
+using namespace XLLBasicLibrary;
+
+namespace
+{
+    // A Brent average price option: daily fixings (21 business days) through the month
+    // starting in six months
+    AsianOption monthlyAverage(bool isCall, double strike)
+    {
+        AsianOption option;
+        option.isCall = isCall;
+        option.forward = 80.0;
+        option.strike = strike;
+        option.volatility = 0.35;
+        option.discountFactor = exp(-0.03 * 0.6);
+        for (size_t i = 0; i < 21; ++i)
+        {
+            option.fixingTimes.push_back(0.5 + (i + 1) / 252.0);
+        }
+        return option;
+    }
+
+    AsianMonteCarloSettings settings(size_t paths, bool antithetic, bool controlVariate)
+    {
+        AsianMonteCarloSettings s;
+        s.paths = paths;
+        s.antithetic = antithetic;
+        s.controlVariate = controlVariate;
+        return s;
+    }
+}
+
+void AsianMonteCarloTest::testSingleFixing()
+{
+    BOOST_TEST_MESSAGE("Testing AsianMonteCarlo with one fixing against Black 76 ...");
+
+    AsianMonteCarlo engine(2);
+    AsianOption option;
+    option.isCall = false;
+    option.forward = 80.0;
+    option.strike = 75.0;
+    option.volatility = 0.3;
+    option.discountFactor = 0.98;
+    option.fixingTimes.push_back(0.75);
+    double black76 = Black76Put(80.0, 75.0, 0.3 * sqrt(0.75), 0.98).getPremium();
+
+    // The geometric and arithmetic averages of one fixing are the same, so the control
+    // removes all of the noise
+    BOOST_CHECK(abs(AsianMonteCarlo::getGeometricAveragePremium(option) - black76) < 1e-12);
+    AsianMonteCarloResult exact = engine.price(option, settings(20000, true, true));
+    BOOST_CHECK(abs(exact.premium - black76) < 1e-9);
+    BOOST_CHECK(exact.standardError < 1e-9);
+    BOOST_CHECK(abs(exact.controlVariateBeta - 1) < 1e-9);
+
+    AsianMonteCarloResult plain = engine.price(option, settings(200000, false, false));
+    BOOST_CHECK_MESSAGE(abs(plain.premium - black76) < 4 * plain.standardError,
+        "Monte Carlo " << plain.premium << " +/- " << plain.standardError << ", Black 76 " << black76);
+    BOOST_CHECK(plain.paths == 200000);
+
+    option.fixingTimes.push_back(0.5);
+    BOOST_CHECK_THROW(engine.price(option, settings(1000, true, true)), runtime_error);
+    option.fixingTimes.clear();
+    BOOST_CHECK_THROW(AsianMonteCarlo::getGeometricAveragePremium(option), runtime_error);
+}
+
+void AsianMonteCarloTest::testVarianceReduction()
+{
+    BOOST_TEST_MESSAGE("Testing AsianMonteCarlo antithetic and control variate estimators ...");
+
+    AsianMonteCarlo engine(0);
+    for (int isCall = 0; isCall < 2; ++isCall)
+    {
+        AsianOption option = monthlyAverage(isCall == 1, 82.0);
+        AsianMonteCarloResult plain = engine.price(option, settings(100000, false, false));
+        AsianMonteCarloResult antithetic = engine.price(option, settings(100000, true, false));
+        AsianMonteCarloResult control = engine.price(option, settings(100000, true, true));
+
+        // All three estimate the same premium
+        BOOST_CHECK(abs(plain.premium - control.premium) < 4 * (plain.standardError + control.standardError));
+        BOOST_CHECK(abs(antithetic.premium - control.premium) < 4 * (antithetic.standardError + control.standardError));
+        // with less noise from each technique
+        BOOST_CHECK(antithetic.standardError < plain.standardError);
+        BOOST_CHECK(control.standardError < plain.standardError / 10);
+
+        // The arithmetic average is at least the geometric one
+        double geometric = AsianMonteCarlo::getGeometricAveragePremium(option);
+        BOOST_CHECK(isCall ? (control.premium > geometric) : (control.premium < geometric));
+    }
+}
+
+void AsianMonteCarloTest::testReproducibility()
+{
+    BOOST_TEST_MESSAGE("Testing AsianMonteCarlo gives the same result on any number of threads ...");
+
+    AsianOption option = monthlyAverage(true, 78.0);
+    AsianMonteCarloSettings s = settings(30001, true, true);
+    AsianMonteCarloResult single = AsianMonteCarlo(1).price(option, s);
+    BOOST_CHECK(single.paths == 30000);
+    size_t threadCounts[3] = { 2, 3, 8 };
+    for (size_t k = 0; k < 3; ++k)
+    {
+        AsianMonteCarloResult threaded = AsianMonteCarlo(threadCounts[k]).price(option, s);
+        BOOST_CHECK(threaded.premium == single.premium);
+        BOOST_CHECK(threaded.standardError == single.standardError);
+    }
+    s.seed = 2;
+    BOOST_CHECK(AsianMonteCarlo(1).price(option, s).premium != single.premium);
+}
+
+test_suite* AsianMonteCarloTest::suite()
+{
+    test_suite* suite = BOOST_TEST_SUITE("Asian Monte Carlo Suite");
+    suite->add(BOOST_TEST_CASE(&AsianMonteCarloTest::testSingleFixing));
+    suite->add(BOOST_TEST_CASE(&AsianMonteCarloTest::testVarianceReduction));
+    suite->add(BOOST_TEST_CASE(&AsianMonteCarloTest::testReproducibility));
+
+    return suite;
+}
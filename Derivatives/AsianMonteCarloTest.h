@@ -0,0 +1,19 @@
+#ifndef XLLBASIC_asian_monte_carlo_test
+#define XLLBASIC_asian_monte_carlo_test
+#pragma once
+
+#include <iostream>
+#include <boost/test/unit_test.hpp>
+#include "AsianMonteCarlo.h"
+
+class AsianMonteCarloTest 
+{
+  public:
+    static void testSingleFixing();
+    static void testVarianceReduction();
+    static void testReproducibility();
+
+    static boost::unit_test_framework::test_suite* suite();
+};
+
+#endif
@@ -0,0 +1,184 @@
+#include "BachelierFormula.h"
+
+
+namespace XLLBasicLibrary
+{
+
+   /*======================================================================================
+   BachelierOption
+   =======================================================================================*/
+	void BachelierOption::setParameters(double forward, double strike, double standardDeviation, double discountFactor)
+	{
+		setForward(forward);
+		setStrike(strike);
+		setStandardDeviation(standardDeviation);
+		setDiscountFactor(discountFactor);
+	}
+
+	void BachelierOption::calculateInternalOptionParameters()
+	{
+		d = (F - X) / sd;
+		// Both tails from N(-|d|), so that neither is found as 1 - N(.) of a value close
+		// to 1, which would lose the premium of an option far out of the money
+		double lowerTail = StandardNormal::cdf(-fabs(d));
+		Nd = (d < 0) ? lowerTail : 1.0 - lowerTail;
+		Nminusd = (d < 0) ? 1.0 - lowerTail : lowerTail;
+		nd = StandardNormal::pdf(d);
+	}
+
+	BachelierGreeks BachelierOption::calculateGreeks(double premium, double delta, double time)
+	{
+		if (time <= 0)
+		{
+			throw runtime_error("BachelierOption->Time is <= 0");
+		}
+		double rate = -log(df) / time;
+
+		BachelierGreeks greeks;
+		greeks.premium = premium;
+		greeks.delta = delta;
+		greeks.gamma = df * nd / sd;
+		// dOP/dsd = df * n(d) and sd = vol * sqrt(T)
+		greeks.vega = df * nd * sqrt(time);
+		greeks.theta = -df * nd * sd / (2.0 * time) + rate * premium;
+		greeks.rho = -time * premium;
+		return greeks;
+	}
+
+	void BachelierOption::setForward(double forwardInput)
+	{
+		if (!(fabs(forwardInput) < numeric_limits<double>::infinity()))
+		{
+			throw runtime_error("BachelierOption->Forward is not a finite number");
+		}
+		F = forwardInput;
+	}
+
+	void BachelierOption::setStrike(double strikeInput)
+	{
+		if (!(fabs(strikeInput) < numeric_limits<double>::infinity()))
+		{
+			throw runtime_error("BachelierOption->Strike is not a finite number");
+		}
+		X = strikeInput;
+	}
+
+	void BachelierOption::setStandardDeviation(double standardDeviation)
+	{
+		if (!(standardDeviation > 0))
+		{
+			throw runtime_error("BachelierOption->Standard Deviation is <= 0");
+		}
+		sd = standardDeviation;
+	}
+
+	void BachelierOption::setDiscountFactor(double discountFactor)
+	{
+		if (!(discountFactor > 0))
+		{
+			throw runtime_error("BachelierOption->Discount Factor is <= 0");
+		}
+		df = discountFactor;
+	}
+
+
+	/*======================================================================================
+	BachelierCall
+	=======================================================================================*/
+	BachelierCall::BachelierCall(double f, double x, double sd, double df)
+	{
+		setParameters(f, x, sd, df);
+	}
+
+	double BachelierCall::getPremium()
+	{
+		calculateInternalOptionParameters();
+		return df * ((F - X) * Nd + sd * nd);
+	}
+
+	double BachelierCall::getDelta()
+	{
+		calculateInternalOptionParameters();
+		return Nd * df;
+	}
+
+	BachelierGreeks BachelierCall::getPremiumAndGreeks(double time)
+	{
+		calculateInternalOptionParameters();
+		return calculateGreeks(df * ((F - X) * Nd + sd * nd), Nd * df, time);
+	}
+
+
+	/*======================================================================================
+	BachelierPut
+	=======================================================================================*/
+	BachelierPut::BachelierPut(double f, double x, double sd, double df)
+	{
+		setParameters(f, x, sd, df);
+	}
+
+	double BachelierPut::getPremium()
+	{
+		calculateInternalOptionParameters();
+		return df * ((X - F) * Nminusd + sd * nd);
+	}
+
+	double BachelierPut::getDelta()
+	{
+		calculateInternalOptionParameters();
+		return -Nminusd * df;
+	}
+
+	BachelierGreeks BachelierPut::getPremiumAndGreeks(double time)
+	{
+		calculateInternalOptionParameters();
+		return calculateGreeks(df * ((X - F) * Nminusd + sd * nd), -Nminusd * df, time);
+	}
+
+
+	/*======================================================================================
+	BachelierBatch
+	=======================================================================================*/
+	namespace
+	{
+		// The batch is processed in blocks so the intermediate values can live on the stack
+		const size_t batchBlockSize = 256;
+	}
+
+	void BachelierBatch::getPremium(
+		size_t n,
+		const double *F,
+		const double *X,
+		const double *sd,
+		const double *df,
+		const bool *isCall,
+		double *premium)
+	{
+		// N(w d) is a single vectorised call per block
+		double w[batchBlockSize], d[batchBlockSize], Nwd[batchBlockSize];
+		for (size_t start = 0; start < n; start += batchBlockSize)
+		{
+			size_t blockSize = min(batchBlockSize, n - start);
+			const double *f = F + start, *x = X + start, *s = sd + start, *discount = df + start;
+			const bool *c = isCall + start;
+			double *p = premium + start;
+
+			for (size_t i = 0; i < blockSize; ++i)
+			{
+				w[i] = c[i] ? 1.0 : -1.0;
+				d[i] = (f[i] - x[i]) / s[i];
+				Nwd[i] = w[i] * d[i];
+			}
+			StandardNormal::cdf(blockSize, Nwd, Nwd);
+			for (size_t i = 0; i < blockSize; ++i)
+			{
+				p[i] = discount[i] * (w[i] * (f[i] - x[i]) * Nwd[i] + s[i] * StandardNormal::pdf(d[i]));
+				// The negated tests also catch NaN inputs
+				if (!(s[i] > 0) || !(discount[i] > 0) || !(p[i] == p[i]))
+				{
+					p[i] = numeric_limits<double>::quiet_NaN();
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,136 @@
+#ifndef XLLBASIC_BACHELIER_INCLUDED
+#define XLLBASIC_BACHELIER_INCLUDED
+#pragma once
+
+#include <math.h>
+#include <algorithm> // max
+#include <limits> // quiet_NaN
+#include <stdexcept> // runtime_error
+
+#include "../Maths/NormalDistribution.h"
+
+using namespace std;
+
+namespace XLLBasicLibrary
+{
+   /*======================================================================================
+    BachelierGreeks: the premium and the analytic greeks of a BachelierOption. With T the
+    time to expiry (year fraction), normal vol = sd / sqrt(T) and r = -ln(df) / T
+
+        - delta: dOP/dF
+        - gamma: d2OP/dF2
+        - vega:  dOP/dvol for a change of 1.00 in the normal vol, which is in the units of
+                 the forward (e.g. $/bbl per sqrt(year)), not a percentage
+        - theta: -dOP/dT per year, holding F, vol and r constant
+        - rho:   dOP/dr for a change of 1.00 in the continuously compounded rate r
+    =======================================================================================*/
+    struct BachelierGreeks
+    {
+		double premium, delta, gamma, vega, theta, rho;
+    };
+
+   /*======================================================================================
+    BachelierOption: the Bachelier (normal) model for options on a future / forward,
+    dF = vol dW. With d = (F - X) / sd
+
+        call = df * ((F - X) N(d) + sd n(d))
+        put  = df * ((X - F) N(-d) + sd n(d))
+
+    The forward and the strike can have any sign, or be zero, so the model prices options
+    on prices that go negative (WTI in April 2020) and on spreads, which Black76Option
+    cannot. As in Black76Option the inputs are unitless where that is possible: sd is the
+    standard deviation of the forward at expiry (= normal vol * sqrt(time)), in the units
+    of the forward, and df is a discount factor. sd and df must be > 0.
+
+    The class layout follows Black76Call / Black76Put: calls and puts are separate objects
+    and getPremiumAndGreeks calculates the premium and every greek from one d, N(d) and
+    n(d). Its time input only turns sd and df into vol and rate.
+    =======================================================================================*/
+    class BachelierOption
+    {
+    public :
+		void setParameters(double forward, double strike, double standardDeviation, double discountFactor);
+
+		double getForward()                     {return F;};
+		void setForward(double forwardInput);
+		double getStrike()                      {return X;};
+		void setStrike(double strikeInput);
+		double getStandardDeviation()           {return sd;};
+		void setStandardDeviation(double sd);
+		double getDiscountFactor()              {return df;};
+		void setDiscountFactor(double df);
+
+		virtual double getPremium() = 0;
+		// After maturity but before settlement
+		virtual double getPremiumAfterMaturity(double rateSetRate, double discountFactor) = 0;
+		virtual double getPremiumAfterSettlement() {return 0;};
+		virtual double getDelta() = 0;
+
+		// time is the year fraction to expiry and must be > 0
+		virtual BachelierGreeks getPremiumAndGreeks(double time) = 0;
+
+    protected :
+		void calculateInternalOptionParameters();
+		// The greeks which are the same for puts and calls, given the option's premium and
+		// delta. Assumes calculateInternalOptionParameters() has been called.
+		BachelierGreeks calculateGreeks(double premium, double delta, double time);
+
+		double F, sd, df, X;
+		// Nd = N(d), Nminusd = N(-d), nd = n(d)
+		double d, Nd, Nminusd, nd;
+    };
+
+    /*======================================================================================
+    BachelierCall
+    =======================================================================================*/
+    class BachelierCall : public BachelierOption
+    {
+    public :
+		BachelierCall(double forward, double strike, double standardDeviation, double discountFactor);
+		double getPremium();
+		double getPremiumAfterMaturity(double rateSetRate, double discountFactor)
+		{return max(rateSetRate - X, 0.0) * discountFactor;};
+		double getDelta();
+		BachelierGreeks getPremiumAndGreeks(double time);
+    };
+
+    /*======================================================================================
+    BachelierPut
+    =======================================================================================*/
+    class BachelierPut : public BachelierOption
+    {
+    public :
+		BachelierPut(double forward, double strike, double standardDeviation, double discountFactor);
+		double getPremium();
+		double getPremiumAfterMaturity(double rateSetRate, double discountFactor)
+		{return max(X - rateSetRate, 0.0) * discountFactor;};
+		double getDelta();
+		BachelierGreeks getPremiumAndGreeks(double time);
+    };
+
+   /*======================================================================================
+    BachelierBatch: Bachelier pricing for large numbers of options held as a structure of
+    arrays, with the same interface as Black76Batch.
+
+    All arrays must hold (at least) n elements. isCall[i] selects the call (true) or put
+    (false) formula for line i, applied as a sign w = +1 / -1 so that calls and puts can be
+    mixed freely:
+        premium = df * (w (F - X) N(w d) + sd n(d))
+    Forwards and strikes may have any sign; a line with sd or df <= 0 (or any NaN input)
+    is priced as NaN so that one bad line does not fail the whole batch.
+    =======================================================================================*/
+    class BachelierBatch
+    {
+    public :
+		static void getPremium(
+			size_t n,
+			const double *forward,
+			const double *strike,
+			const double *standardDeviation,
+			const double *discountFactor,
+			const bool *isCall,
+			double *premium);
+    };
+}
+
+#endif
@@ -0,0 +1,169 @@
+#include "BachelierFormulaTest.h"
+
+#include <memory>
+
+using namespace std;
+using namespace boost::unit_test_framework;
+using namespace XLLBasicLibrary;
+
+namespace
+{
+    // Premium in terms of vol, time and rate so the greeks can be checked by bumping
+    double premium(bool isCall, double F, double X, double vol, double T, double r)
+    {
+        double sd = vol * sqrt(T), df = exp(-r * T);
+        if (isCall)
+        {
+            return BachelierCall(F, X, sd, df).getPremium();
+        }
+        return BachelierPut(F, X, sd, df).getPremium();
+    }
+
+    // The expected payoff over F + sd z by Simpson's rule on z in [-12, 12]
+    double integratedPremium(bool isCall, double F, double X, double sd, double df)
+    {
+        int steps = 24000;
+        double h = 24.0 / steps, sum = 0;
+        for (int i = 0; i <= steps; ++i)
+        {
+            double z = -12.0 + i * h;
+            double payoff = isCall ? max(F + sd * z - X, 0.0) : max(X - F - sd * z, 0.0);
+            double weight = (i == 0 || i == steps) ? 1.0 : ((i % 2 == 1) ? 4.0 : 2.0);
+            sum += weight * payoff * StandardNormal::pdf(z);
+        }
+        return df * sum * h / 3.0;
+    }
+}
+
+void BachelierTest::testPutCallParity() 
+{
+    BOOST_TEST_MESSAGE("Testing Bachelier Put / Call parity ...");
+
+    double sd = 8.0, df = 0.97;
+    double forwards[] = { 100, 0.25, 0, -37.63 };
+    double strikes[] = { 110, -5, 0, 20 };
+    for (size_t i = 0; i < sizeof(forwards) / sizeof(double); ++i)
+    {
+        double F = forwards[i], X = strikes[i];
+        BachelierCall call(F, X, sd, df);
+        BachelierPut put(F, X, sd, df);
+        BOOST_CHECK(abs(call.getPremium() - put.getPremium() - (F - X) * df) < 1e-12);
+        BOOST_CHECK(abs(call.getDelta() - put.getDelta() - df) < 1e-15);
+    }
+    // At the money both are sd / sqrt(2 pi)
+    BOOST_CHECK(abs(BachelierCall(-3, -3, sd, df).getPremium() - df * sd / sqrt(2 * M_PI)) < 1e-14);
+}
+
+void BachelierTest::testNegativeForward()
+{
+    BOOST_TEST_MESSAGE("Testing Bachelier premiums on negative forwards against integration ...");
+
+    double df = 0.99;
+    // WTI on 20 April 2020, and far out of the money where a put found from the call by
+    // parity would have lost its premium
+    double F[] = { -37.63, -37.63, -37.63, 0.0, 50.0 };
+    double X[] = { -40.0, 10.0, -60.0, 1.0, 0.0 };
+    double sd[] = { 15.0, 15.0, 15.0, 0.5, 6.0 };
+    for (size_t i = 0; i < sizeof(F) / sizeof(double); ++i)
+    {
+        for (int k = 0; k < 2; ++k)
+        {
+            bool isCall = (k == 0);
+            double p = isCall ? BachelierCall(F[i], X[i], sd[i], df).getPremium() : BachelierPut(F[i], X[i], sd[i], df).getPremium();
+            double expected = integratedPremium(isCall, F[i], X[i], sd[i], df);
+            BOOST_CHECK(p > 0);
+            BOOST_CHECK(abs(p - expected) < 1e-9 * max(expected, 1.0));
+            BOOST_CHECK(abs(p / expected - 1.0) < 1e-6);
+        }
+    }
+    BOOST_REQUIRE_THROW(BachelierCall(-37.63, 10, 0, df), runtime_error);
+    BOOST_REQUIRE_THROW(BachelierCall(-37.63, 10, 15, 0), runtime_error);
+    BOOST_REQUIRE_THROW(BachelierPut(numeric_limits<double>::quiet_NaN(), 10, 15, df), runtime_error);
+}
+
+void BachelierTest::testGreeks()
+{
+    BOOST_TEST_MESSAGE("Testing Bachelier analytic greeks against bumped premiums ...");
+
+    double F = -2.5, X = 1.5, vol = 6.0, T = 0.75, r = 0.05;
+    double sd = vol * sqrt(T), df = exp(-r * T);
+    double h = 1e-4;
+    for (int i = 0; i < 2; ++i)
+    {
+        bool isCall = (i == 0);
+        BachelierGreeks greeks;
+        if (isCall)
+        {
+            greeks = BachelierCall(F, X, sd, df).getPremiumAndGreeks(T);
+        }
+        else
+        {
+            greeks = BachelierPut(F, X, sd, df).getPremiumAndGreeks(T);
+        }
+        double p = premium(isCall, F, X, vol, T, r);
+        BOOST_CHECK(abs(greeks.premium - p) < 1e-12);
+        double delta = (premium(isCall, F + h, X, vol, T, r) - premium(isCall, F - h, X, vol, T, r)) / (2 * h);
+        BOOST_CHECK(abs(greeks.delta - delta) < 1e-7);
+        double gamma = (premium(isCall, F + h, X, vol, T, r) - 2 * p + premium(isCall, F - h, X, vol, T, r)) / (h * h);
+        BOOST_CHECK(abs(greeks.gamma - gamma) < 1e-5);
+        double vega = (premium(isCall, F, X, vol + h, T, r) - premium(isCall, F, X, vol - h, T, r)) / (2 * h);
+        BOOST_CHECK(abs(greeks.vega - vega) < 1e-6);
+        double theta = -(premium(isCall, F, X, vol, T + h, r) - premium(isCall, F, X, vol, T - h, r)) / (2 * h);
+        BOOST_CHECK(abs(greeks.theta - theta) < 1e-6);
+        double rho = (premium(isCall, F, X, vol, T, r + h) - premium(isCall, F, X, vol, T, r - h)) / (2 * h);
+        BOOST_CHECK(abs(greeks.rho - rho) < 1e-6);
+    }
+    BOOST_REQUIRE_THROW(BachelierCall(F, X, sd, df).getPremiumAndGreeks(0), runtime_error);
+}
+
+void BachelierTest::testBatchPricing()
+{
+    BOOST_TEST_MESSAGE("Testing Bachelier batch pricing against the option objects ...");
+
+    size_t n = 1000;
+    vector<double> F(n), X(n), sd(n), df(n), premium(n);
+    unique_ptr<bool[]> isCall(new bool[n]);
+    for (size_t i = 0; i < n; ++i)
+    {
+        F[i] = -30 + (i % 7) * 10.0;
+        X[i] = -40 + (i % 41) * 2.0;
+        sd[i] = 0.5 + (i % 13) * 2.0;
+        df[i] = 1.0 - (i % 5) * 0.01;
+        isCall[i] = (i % 2 == 0);
+    }
+    BachelierBatch::getPremium(n, &F[0], &X[0], &sd[0], &df[0], isCall.get(), &premium[0]);
+    for (size_t i = 0; i < n; ++i)
+    {
+        double expected;
+        if (isCall[i])
+        {
+            expected = BachelierCall(F[i], X[i], sd[i], df[i]).getPremium();
+        }
+        else
+        {
+            expected = BachelierPut(F[i], X[i], sd[i], df[i]).getPremium();
+        }
+        BOOST_CHECK(abs(premium[i] - expected) < 1e-12 * max(expected, 1.0));
+    }
+
+    // A bad line is flagged as NaN without affecting its neighbours
+    sd[1] = 0;
+    df[3] = -1;
+    BachelierBatch::getPremium(5, &F[0], &X[0], &sd[0], &df[0], isCall.get(), &premium[0]);
+    BOOST_CHECK(!boost::math::isnan(premium[0]));
+    BOOST_CHECK(boost::math::isnan(premium[1]));
+    BOOST_CHECK(!boost::math::isnan(premium[2]));
+    BOOST_CHECK(boost::math::isnan(premium[3]));
+    BOOST_CHECK(!boost::math::isnan(premium[4]));
+}
+
+test_suite* BachelierTest::suite() 
+{
+    test_suite* suite = BOOST_TEST_SUITE("Bachelier Option Pricing Suite");
+    suite->add(BOOST_TEST_CASE(&BachelierTest::testPutCallParity));
+    suite->add(BOOST_TEST_CASE(&BachelierTest::testNegativeForward));
+    suite->add(BOOST_TEST_CASE(&BachelierTest::testGreeks));
+    suite->add(BOOST_TEST_CASE(&BachelierTest::testBatchPricing));
+
+    return suite;
+}
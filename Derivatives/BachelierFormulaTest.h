@@ -0,0 +1,22 @@
+#ifndef XLLBASIC_bachelier_test
+#define XLLBASIC_bachelier_test
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <boost/math/special_functions/fpclassify.hpp> // boost::math::isnan
+#include "BachelierFormula.h"
+
+class BachelierTest 
+{
+  public:
+    static void testPutCallParity();
+    static void testNegativeForward();
+    static void testGreeks();
+    static void testBatchPricing();
+
+    static boost::unit_test_framework::test_suite* suite();
+};
+
+#endif
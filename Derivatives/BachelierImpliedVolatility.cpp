@@ -0,0 +1,199 @@
+#include "BachelierImpliedVolatility.h"
+
+#include <algorithm> // max, min
+
+
+namespace XLLBasicLibrary
+{
+	namespace
+	{
+		const double rootTwoPi = 2.50662827463100050242;
+		const double epsilon = numeric_limits<double>::epsilon();
+		const int maximumIterations = 100;
+		// The batch is solved in blocks so the intermediate values can live on the stack
+		const size_t solverBlockSize = 256;
+		// The initial guess uses the expansion about the money where a / s is below this
+		const double nearMoney = 1.0;
+		const int substitutions = 4;
+
+		// Everything needed to iterate on one quote
+		struct SolverState
+		{
+			double a, logTarget;
+			BracketedHalley solver;
+		};
+
+		// Near the money phi(x) ~ 1/sqrt(2 pi) + x/2 + x^2 / (2 sqrt(2 pi)) so that s solves
+		//      s^2 - sqrt(2 pi) (v + a/2) s + a^2 / 2 = 0
+		// Further out, with y = a / s, phi(-y) = n(y) (1 - y M(y)) where M is Mills' ratio.
+		// Birnbaum's M(y) ~ 2 / (y + sqrt(y^2 + 4)) gives 1 - y M(y) ~ h(y) = 4 / (y + 
+		// sqrt(y^2 + 4))^2, right at y = 0 and as y -> infinity, and v = b(s) becomes
+		//      y^2 = -2 ln(sqrt(2 pi) v / a) + 2 ln(h(y) / y)
+		// which is solved by a few substitutions. Either guess is clamped to the bracket.
+		double initialGuess(double a, double v, double lower, double upper)
+		{
+			double c = rootTwoPi * (v + a / 2.0);
+			double root = c * c - 2.0 * a * a;
+			if (root >= 0.0)
+			{
+				double s = (c + sqrt(root)) / 2.0;
+				if (a < nearMoney * s)
+				{
+					return min(max(s, lower), upper);
+				}
+			}
+			double lowerY = a / upper;
+			double logRatio = -2.0 * log(rootTwoPi * v / a);
+			double y = sqrt(max(logRatio, 1.0));
+			for (int i = 0; i < substitutions; ++i)
+			{
+				double sum = y + sqrt(y * y + 4.0);
+				y = sqrt(max(logRatio + 2.0 * log(4.0 / (sum * sum * y)), lowerY * lowerY));
+			}
+			return min(max(a / y, lower), upper);
+		}
+
+		// Reduces the quote to the normalised problem. Returns true if the answer is known
+		// without iterating, in which case it is written to standardDeviation.
+		bool setUp(
+			double premium,
+			double F,
+			double X,
+			double df,
+			bool isCall,
+			SolverState &state,
+			double &standardDeviation)
+		{
+			standardDeviation = numeric_limits<double>::quiet_NaN();
+			// The negated tests also catch NaN
+			if (!(df > 0) || !(premium >= 0) || !(F == F) || !(X == X))
+			{
+				return true;
+			}
+			double undiscounted = premium / df;
+			double intrinsic = isCall ? max(F - X, 0.0) : max(X - F, 0.0);
+			if (!(undiscounted >= intrinsic) || (undiscounted == numeric_limits<double>::infinity()))
+			{
+				return true;
+			}
+			double timeValue = undiscounted - intrinsic;
+			state.a = fabs(F - X);
+			if (timeValue == 0.0)
+			{
+				standardDeviation = 0.0;
+				return true;
+			}
+			if (state.a == 0.0)
+			{
+				standardDeviation = rootTwoPi * timeValue;
+				return true;
+			}
+			state.logTarget = log(timeValue);
+			double lower = rootTwoPi * timeValue;
+			double upper = rootTwoPi * (timeValue + state.a / 2.0);
+			state.solver.start(initialGuess(state.a, timeValue, lower, upper), lower, upper);
+			return false;
+		}
+
+		// One iteration from state.solver.s given Nx = N(x) at x = -a / s. Returns true once
+		// converged, in which case the answer is in standardDeviation.
+		bool iterate(SolverState &state, double Nx, double &standardDeviation)
+		{
+			BracketedHalley &solver = state.solver;
+			double s = solver.s;
+			double x = -state.a / s;
+			// b = s phi(x) is the difference of s n(x) and a N(x)
+			double nx = StandardNormal::pdf(x);
+			double densityTerm = s * nx, strikeTerm = state.a * Nx;
+			double b = densityTerm - strikeTerm;
+			bool done;
+			if (b <= 0.0)
+			{
+				// Underflow, or cancellation far out of the money: s is certainly too small
+				done = solver.stepUp(maximumIterations);
+			}
+			else
+			{
+				// Halley on g(s) = ln(b(s)) - ln(target), with b' = n(x), b'' = n(x) x^2 / s.
+				// Far out of the money each term of b has the relative error (1 + x^2 / 2) eps
+				// of N(x) in the tail, so that is as close as g can be brought to 0
+				double g = log(b) - state.logTarget;
+				double g1 = nx / b;
+				double g2 = nx * x * x / (s * b) - g1 * g1;
+				double tolerance = 4.0 * epsilon * (1.0 + (1.0 + x * x / 2.0) * (densityTerm + strikeTerm) / b);
+				done = solver.step(g, g1, g2, tolerance, maximumIterations);
+			}
+			standardDeviation = solver.s;
+			return done;
+		}
+	}
+
+	/*======================================================================================
+	BachelierImpliedVolatility
+	=======================================================================================*/
+	double BachelierImpliedVolatility::getStandardDeviation(
+		double premium,
+		double F,
+		double X,
+		double df,
+		bool isCall)
+	{
+		SolverState state;
+		double sd;
+		bool done = setUp(premium, F, X, df, isCall, state, sd);
+		while (!done)
+		{
+			done = iterate(state, StandardNormal::cdf(-state.a / state.solver.s), sd);
+		}
+		return sd;
+	}
+
+	void BachelierImpliedVolatility::getStandardDeviation(
+		size_t n,
+		const double *premium,
+		const double *F,
+		const double *X,
+		const double *df,
+		const bool *isCall,
+		double *sd)
+	{
+		// All the unconverged quotes in a block are iterated together so that N(.) is one
+		// vectorised call per iteration
+		SolverState state[solverBlockSize];
+		size_t active[solverBlockSize];
+		double Nx[solverBlockSize];
+		for (size_t start = 0; start < n; start += solverBlockSize)
+		{
+			size_t blockSize = min(solverBlockSize, n - start);
+			size_t activeSize = 0;
+			for (size_t i = 0; i < blockSize; ++i)
+			{
+				size_t line = start + i;
+				if (!setUp(premium[line], F[line], X[line], df[line], isCall[line], state[i], sd[line]))
+				{
+					active[activeSize++] = i;
+				}
+			}
+			while (activeSize > 0)
+			{
+				for (size_t j = 0; j < activeSize; ++j)
+				{
+					const SolverState &lineState = state[active[j]];
+					Nx[j] = -lineState.a / lineState.solver.s;
+				}
+				StandardNormal::cdf(activeSize, Nx, Nx);
+				// Converged quotes are dropped from the active list
+				size_t stillActive = 0;
+				for (size_t j = 0; j < activeSize; ++j)
+				{
+					size_t i = active[j];
+					if (!iterate(state[i], Nx[j], sd[start + i]))
+					{
+						active[stillActive++] = i;
+					}
+				}
+				activeSize = stillActive;
+			}
+		}
+	}
+}
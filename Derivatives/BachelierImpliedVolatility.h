@@ -0,0 +1,66 @@
+#ifndef XLLBASIC_BACHELIERIMPLIEDVOLATILITY_INCLUDED
+#define XLLBASIC_BACHELIERIMPLIEDVOLATILITY_INCLUDED
+#pragma once
+
+#include <math.h>
+#include <limits> // quiet_NaN
+
+#include "../Maths/BracketedHalley.h"
+#include "../Maths/NormalDistribution.h"
+
+using namespace std;
+
+namespace XLLBasicLibrary
+{
+
+   /*======================================================================================
+    BachelierImpliedVolatility: the inverse of BachelierCall::getPremium() and
+    BachelierPut::getPremium() with respect to the standard deviation.
+
+    As in Black76ImpliedVolatility the result is the standard deviation (= normal vol *
+    sqrt(time)), in the units of the forward. Forwards and strikes may have any sign.
+
+    The premium is reduced to the time value v of the out-of-the-money option. With
+    a = |F - X| > 0 every quote then solves
+        b(s) = s phi(-a/s) = v,     phi(x) = x N(x) + n(x)
+    where b'(s) = n(a/s) and b''(s) = n(a/s) a^2 / s^3, and the root is bracketed by
+        sqrt(2 pi) v <= s <= sqrt(2 pi) (v + a/2)
+    because phi is convex with phi(0) = 1/sqrt(2 pi) and phi'(0) = 1/2. Starting from an
+    expansion of b about the money or, further out, an approximate inverse using
+    Birnbaum's bound for Mills' ratio, Halley steps are applied to ln(b(s)) and a step
+    that would leave the bracket is replaced by a bisection (see BracketedHalley). It
+    typically takes 3-4 iterations. At the money (a = 0) the answer is sqrt(2 pi) v without iterating.
+
+    Where no standard deviation reproduces the premium (premium below the intrinsic
+    value), or df <= 0, or any input is NaN, the result is NaN. A premium equal to the
+    intrinsic value gives 0. Far out of the money, where phi(x) is the small difference of
+    x N(x) and n(x), the iteration stops once ln(b(s)) matches the target to within that
+    difference's rounding error; the result is still within about 1e-14 relative at
+    a / s = 12, where the premium is below 1e-34 * a.
+
+    The batch form solves n quotes held as a structure of arrays, as
+    Black76ImpliedVolatility, iterating the unconverged quotes of each block together so
+    that N(.) is evaluated with one vectorised call per iteration.
+    =======================================================================================*/
+    class BachelierImpliedVolatility
+    {
+    public :
+		static double getStandardDeviation(
+			double premium,
+			double forward,
+			double strike,
+			double discountFactor,
+			bool isCall);
+
+		static void getStandardDeviation(
+			size_t n,
+			const double *premium,
+			const double *forward,
+			const double *strike,
+			const double *discountFactor,
+			const bool *isCall,
+			double *standardDeviation);
+    };
+}
+
+#endif
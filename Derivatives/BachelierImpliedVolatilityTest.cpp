@@ -0,0 +1,160 @@
+#include "BachelierImpliedVolatilityTest.h"
+
+#include <memory>
+#include <vector>
+
+using namespace std;
+using namespace boost::unit_test_framework;
+using namespace XLLBasicLibrary;
+
+namespace
+{
+    double premium(bool isCall, double F, double X, double sd, double df)
+    {
+        if (isCall)
+        {
+            return BachelierCall(F, X, sd, df).getPremium();
+        }
+        return BachelierPut(F, X, sd, df).getPremium();
+    }
+
+    // A strike / expiry grid either side of a forward near zero, calls above and puts
+    // below the forward
+    void buildChain(
+        size_t n,
+        vector<double> &F,
+        vector<double> &X,
+        vector<double> &sd,
+        vector<double> &df,
+        bool *isCall)
+    {
+        F.resize(n); X.resize(n); sd.resize(n); df.resize(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            double T = 0.05 + 0.1 * (i % 40);
+            F[i] = -5.0 + 0.25 * (i % 40);
+            X[i] = -30.0 + 60.0 * ((i * 7) % 50) / 49.0;
+            sd[i] = (8.0 + 12.0 * ((i * 3) % 11) / 10.0) * sqrt(T);
+            df[i] = exp(-0.03 * T);
+            isCall[i] = (X[i] >= F[i]);
+        }
+    }
+}
+
+void BachelierImpliedVolatilityTest::testRoundTrip()
+{
+    BOOST_TEST_MESSAGE("Testing Bachelier implied standard deviation recovers the input ...");
+
+    double df = 0.97;
+    double forwards[] = { -37.63, 0.0, 2.5 };
+    double moneyness[] = { -60, -20, -3, -0.1, 0, 0.1, 3, 20, 60 };
+    double sds[] = { 0.01, 0.5, 3.0, 10.0, 40.0 };
+    for (size_t f = 0; f < sizeof(forwards) / sizeof(double); ++f)
+    {
+        for (size_t i = 0; i < sizeof(moneyness) / sizeof(double); ++i)
+        {
+            for (size_t j = 0; j < sizeof(sds) / sizeof(double); ++j)
+            {
+                for (int k = 0; k < 2; ++k)
+                {
+                    bool isCall = (k == 0);
+                    double F = forwards[f], X = F + moneyness[i], sd = sds[j];
+                    double p = premium(isCall, F, X, sd, df);
+                    double intrinsic = isCall ? max(F - X, 0.0) : max(X - F, 0.0);
+                    // Skip premiums whose time value is lost against the intrinsic value,
+                    // or which have underflowed
+                    double timeValue = p / df - intrinsic;
+                    if (timeValue < 1e-6 * p / df || timeValue < 1e-280)
+                    {
+                        continue;
+                    }
+                    double implied = BachelierImpliedVolatility::getStandardDeviation(p, F, X, df, isCall);
+                    BOOST_CHECK(abs(premium(isCall, F, X, implied, df) - p) < 1e-12 * max(p, 1.0));
+                    // Only compare standard deviations where vega is material
+                    double vega = (premium(isCall, F, X, sd * 1.001, df) - premium(isCall, F, X, sd * 0.999, df)) / (0.002 * sd);
+                    if (vega > 1e-3)
+                    {
+                        BOOST_CHECK(abs(implied - sd) < 1e-9 * sd);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void BachelierImpliedVolatilityTest::testArbitrageBounds()
+{
+    BOOST_TEST_MESSAGE("Testing Bachelier implied standard deviation outside the arbitrage bounds ...");
+
+    double F = -10, X = -20, df = 0.97;
+    // Intrinsic value gives zero standard deviation
+    BOOST_CHECK(BachelierImpliedVolatility::getStandardDeviation((F - X) * df, F, X, df, true) == 0.0);
+    BOOST_CHECK(BachelierImpliedVolatility::getStandardDeviation(0.0, F, X, df, false) == 0.0);
+    // At the money the answer is exact
+    BOOST_CHECK(abs(BachelierImpliedVolatility::getStandardDeviation(2.0 * df, F, F, df, true) - 2.0 * sqrt(2 * M_PI)) < 1e-14);
+    // Unlike Black 76 there is no upper bound, only the lower one and invalid inputs
+    BOOST_CHECK(boost::math::isnan(BachelierImpliedVolatility::getStandardDeviation((F - X) * df - 0.01, F, X, df, true)));
+    BOOST_CHECK(boost::math::isnan(BachelierImpliedVolatility::getStandardDeviation(-1.0, F, X, df, false)));
+    BOOST_CHECK(boost::math::isnan(BachelierImpliedVolatility::getStandardDeviation(5.0, F, X, 0.0, false)));
+    BOOST_CHECK(boost::math::isnan(BachelierImpliedVolatility::getStandardDeviation(5.0, numeric_limits<double>::quiet_NaN(), X, df, false)));
+    BOOST_CHECK(boost::math::isnan(BachelierImpliedVolatility::getStandardDeviation(numeric_limits<double>::infinity(), F, X, df, false)));
+}
+
+void BachelierImpliedVolatilityTest::testFarOutOfTheMoney()
+{
+    BOOST_TEST_MESSAGE("Testing Bachelier implied standard deviation far out of the money ...");
+
+    // The time value is the small difference of s n(x) and a N(x), but the iteration runs
+    // on ln(b) until the residual is at that difference's rounding error
+    double F = 1.5, df = 0.98;
+    for (double y = 2.0; y <= 12.0; y += 1.0)
+    {
+        for (int k = 0; k < 2; ++k)
+        {
+            bool isCall = (k == 0);
+            double sd = 0.8, X = isCall ? F + y * sd : F - y * sd;
+            double p = premium(isCall, F, X, sd, df);
+            double implied = BachelierImpliedVolatility::getStandardDeviation(p, F, X, df, isCall);
+            BOOST_CHECK_MESSAGE(abs(implied - sd) < 1e-13 * sd,
+                "a / s = " << y << (isCall ? " call " : " put ") << implied << " against " << sd);
+        }
+    }
+}
+
+void BachelierImpliedVolatilityTest::testBatch()
+{
+    BOOST_TEST_MESSAGE("Testing Bachelier batch implied standard deviation against the single quote ...");
+
+    size_t n = 2000;
+    vector<double> F, X, sd, df;
+    unique_ptr<bool[]> isCall(new bool[n]);
+    buildChain(n, F, X, sd, df, isCall.get());
+    vector<double> p(n), implied(n);
+    BachelierBatch::getPremium(n, &F[0], &X[0], &sd[0], &df[0], isCall.get(), &p[0]);
+    // One bad quote must not affect its neighbours
+    p[1] = -1.0;
+    BachelierImpliedVolatility::getStandardDeviation(n, &p[0], &F[0], &X[0], &df[0], isCall.get(), &implied[0]);
+    for (size_t i = 0; i < n; ++i)
+    {
+        double single = BachelierImpliedVolatility::getStandardDeviation(p[i], F[i], X[i], df[i], isCall[i]);
+        if (i == 1)
+        {
+            BOOST_CHECK(boost::math::isnan(implied[i]));
+            continue;
+        }
+        // The vectorised N(.) can differ from the scalar one in the last bit or two
+        BOOST_CHECK(abs(implied[i] - single) < 1e-12 * sd[i]);
+        BOOST_CHECK(abs(implied[i] - sd[i]) < 1e-9 * sd[i]);
+    }
+}
+
+test_suite* BachelierImpliedVolatilityTest::suite()
+{
+    test_suite* suite = BOOST_TEST_SUITE("Bachelier Implied Volatility Suite");
+    suite->add(BOOST_TEST_CASE(&BachelierImpliedVolatilityTest::testRoundTrip));
+    suite->add(BOOST_TEST_CASE(&BachelierImpliedVolatilityTest::testArbitrageBounds));
+    suite->add(BOOST_TEST_CASE(&BachelierImpliedVolatilityTest::testFarOutOfTheMoney));
+    suite->add(BOOST_TEST_CASE(&BachelierImpliedVolatilityTest::testBatch));
+
+    return suite;
+}
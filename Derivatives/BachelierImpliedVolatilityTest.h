@@ -0,0 +1,22 @@
+#ifndef XLLBASIC_bachelier_implied_volatility_test
+#define XLLBASIC_bachelier_implied_volatility_test
+#pragma once
+
+#include <iostream>
+#include <boost/test/unit_test.hpp>
+#include <boost/math/special_functions/fpclassify.hpp> // boost::math::isnan
+#include "BachelierFormula.h"
+#include "BachelierImpliedVolatility.h"
+
+class BachelierImpliedVolatilityTest 
+{
+  public:
+    static void testRoundTrip();
+    static void testArbitrageBounds();
+    static void testFarOutOfTheMoney();
+    static void testBatch();
+
+    static boost::unit_test_framework::test_suite* suite();
+};
+
+#endif
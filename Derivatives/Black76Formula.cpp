@@ -19,8 +19,28 @@ namespace XLLBasicLibrary
     {
        d1 = (log(F/X) / sd + sd / 2.0);
        d2 = d1 - (sd);     
-       Nd1 = cdf(n_0_1, d1);
-       Nd2 = cdf(n_0_1, d2);
+       Nd1 = StandardNormal::cdf(d1);
+       Nd2 = StandardNormal::cdf(d2);
+    }
+
+    Black76Greeks Black76Option::calculateGreeks(double premium, double delta, double time)
+    {
+		if (time <= 0)
+		{
+			throw runtime_error("Black76Option->Time is <= 0");
+		}
+		double nd1 = StandardNormal::pdf(d1);
+		double rate = -log(df) / time;
+
+		Black76Greeks greeks;
+		greeks.premium = premium;
+		greeks.delta = delta;
+		greeks.gamma = df * nd1 / (F * sd);
+		// dOP/dsd = df * F * n(d1) and sd = vol * sqrt(T)
+		greeks.vega = df * F * nd1 * sqrt(time);
+		greeks.theta = -df * F * nd1 * sd / (2.0 * time) + rate * premium;
+		greeks.rho = -time * premium;
+		return greeks;
     }
 
     void Black76Option::setForward(double forwardInput)    
@@ -80,6 +100,12 @@ namespace XLLBasicLibrary
 		return Nd1 * df;
 	}
 
+	Black76Greeks Black76Call::getPremiumAndGreeks(double time)
+	{
+		calculateInternalOptionParameters();
+		return calculateGreeks(df * (F *  Nd1 - X * Nd2), Nd1 * df, time);
+	}
+
 
 	/*======================================================================================
 	EuropeanPutBlack76
@@ -92,7 +118,7 @@ namespace XLLBasicLibrary
 	double Black76Put::getPremium()
 	{
 		calculateInternalOptionParameters();
-			return df * (- F * (1-Nd1) + X * (1-Nd2));
+		return calculatePremium();
 	}
 
 	double Black76Put::getDelta()
@@ -101,4 +127,68 @@ namespace XLLBasicLibrary
 		return (Nd1 - 1.0) * df;
 	}
 
+	Black76Greeks Black76Put::getPremiumAndGreeks(double time)
+	{
+		calculateInternalOptionParameters();
+		return calculateGreeks(calculatePremium(), (Nd1 - 1.0) * df, time);
+	}
+
+	double Black76Put::calculatePremium()
+	{
+		// N(-d) rather than 1 - N(d), which keeps only the absolute accuracy of N(d) and
+		// loses the premium far out of the money. Once both terms are subnormal the 
+		// difference can round below zero.
+		return max(df * (X * StandardNormal::cdf(-d2) - F * StandardNormal::cdf(-d1)), 0.0);
+	}
+
+
+	/*======================================================================================
+	Black76Batch
+	=======================================================================================*/
+	namespace
+	{
+		// The batch is processed in blocks so the intermediate d1 / d2 values can live on
+		// the stack rather than the heap
+		const size_t batchBlockSize = 256;
+	}
+
+	void Black76Batch::getPremium(
+		size_t n,
+		const double *F,
+		const double *X,
+		const double *sd,
+		const double *df,
+		const bool *isCall,
+		double *premium)
+	{
+		// d1 and d2 are held back to back in one array so N(.) is a single vectorised call
+		// per block
+		double w[batchBlockSize], d[2 * batchBlockSize];
+		for (size_t start = 0; start < n; start += batchBlockSize)
+		{
+			size_t blockSize = min(batchBlockSize, n - start);
+			double *d1 = d, *d2 = d + blockSize;
+			const double *f = F + start, *x = X + start, *s = sd + start, *discount = df + start;
+			const bool *c = isCall + start;
+			double *p = premium + start;
+
+			// w = +1 for a call and -1 for a put so that 
+			//      premium = w * df * (F * N(w * d1) - X * N(w * d2))
+			for (size_t i = 0; i < blockSize; ++i)
+			{
+				w[i] = c[i] ? 1.0 : -1.0;
+				d1[i] = w[i] * (log(f[i] / x[i]) / s[i] + s[i] / 2.0);
+				d2[i] = d1[i] - w[i] * s[i];
+			}
+			StandardNormal::cdf(2 * blockSize, d, d);
+			for (size_t i = 0; i < blockSize; ++i)
+			{
+				p[i] = w[i] * discount[i] * (f[i] * d1[i] - x[i] * d2[i]);
+				if ((f[i] <= 0) || (x[i] <= 0) || (s[i] <= 0) || (discount[i] <= 0))
+				{
+					p[i] = numeric_limits<double>::quiet_NaN();
+				}
+			}
+		}
+	}
 }
\ No newline at end of file
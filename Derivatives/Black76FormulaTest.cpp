@@ -18,11 +18,99 @@ void Black76Test::testPutCallParity()
     BOOST_CHECK(abs(put.getPremium() - call.getPremium() - (X-F) * df) < 1e-12);
 }
 
+namespace
+{
+    // Premium in terms of vol, time and rate so the greeks can be checked by bumping
+    double premium(bool isCall, double F, double X, double vol, double T, double r)
+    {
+        double sd = vol * sqrt(T), df = exp(-r * T);
+        if (isCall)
+        {
+            return Black76Call(F, X, sd, df).getPremium();
+        }
+        return Black76Put(F, X, sd, df).getPremium();
+    }
+}
+
+void Black76Test::testGreeks()
+{
+    BOOST_TEST_MESSAGE("Testing Black 76 analytic greeks against bumped premiums ...");
+
+    double F = 100, X = 110, vol = 0.3, T = 0.75, r = 0.05;
+    double sd = vol * sqrt(T), df = exp(-r * T);
+    double h = 1e-4;
+    for (int i = 0; i < 2; ++i)
+    {
+        bool isCall = (i == 0);
+        Black76Greeks greeks;
+        if (isCall)
+        {
+            greeks = Black76Call(F, X, sd, df).getPremiumAndGreeks(T);
+        }
+        else
+        {
+            greeks = Black76Put(F, X, sd, df).getPremiumAndGreeks(T);
+        }
+        double p = premium(isCall, F, X, vol, T, r);
+        BOOST_CHECK(abs(greeks.premium - p) < 1e-12);
+        double delta = (premium(isCall, F + h, X, vol, T, r) - premium(isCall, F - h, X, vol, T, r)) / (2 * h);
+        BOOST_CHECK(abs(greeks.delta - delta) < 1e-7);
+        double gamma = (premium(isCall, F + h, X, vol, T, r) - 2 * p + premium(isCall, F - h, X, vol, T, r)) / (h * h);
+        BOOST_CHECK(abs(greeks.gamma - gamma) < 1e-5);
+        double vega = (premium(isCall, F, X, vol + h, T, r) - premium(isCall, F, X, vol - h, T, r)) / (2 * h);
+        BOOST_CHECK(abs(greeks.vega - vega) < 1e-6);
+        double theta = -(premium(isCall, F, X, vol, T + h, r) - premium(isCall, F, X, vol, T - h, r)) / (2 * h);
+        BOOST_CHECK(abs(greeks.theta - theta) < 1e-6);
+        double rho = (premium(isCall, F, X, vol, T, r + h) - premium(isCall, F, X, vol, T, r - h)) / (2 * h);
+        BOOST_CHECK(abs(greeks.rho - rho) < 1e-6);
+    }
+    BOOST_REQUIRE_THROW(Black76Call(F, X, sd, df).getPremiumAndGreeks(0), runtime_error);
+}
+
+void Black76Test::testBatchPricing()
+{
+    BOOST_TEST_MESSAGE("Testing Black 76 batch pricing against the option objects ...");
+
+    size_t n = 1000;
+    vector<double> F(n), X(n), sd(n), df(n), premium(n);
+    unique_ptr<bool[]> isCall(new bool[n]);
+    for (size_t i = 0; i < n; ++i)
+    {
+        F[i] = 60 + (i % 7) * 5.0;
+        X[i] = 40 + (i % 41) * 1.5;
+        sd[i] = 0.02 + (i % 13) * 0.05;
+        df[i] = 1.0 - (i % 5) * 0.01;
+        isCall[i] = (i % 2 == 0);
+    }
+    Black76Batch::getPremium(n, &F[0], &X[0], &sd[0], &df[0], isCall.get(), &premium[0]);
+    for (size_t i = 0; i < n; ++i)
+    {
+        double expected;
+        if (isCall[i])
+        {
+            expected = Black76Call(F[i], X[i], sd[i], df[i]).getPremium();
+        }
+        else
+        {
+            expected = Black76Put(F[i], X[i], sd[i], df[i]).getPremium();
+        }
+        BOOST_CHECK(abs(premium[i] - expected) < 1e-12);
+    }
+
+    // A bad line is flagged as NaN without affecting its neighbours
+    sd[1] = 0;
+    Black76Batch::getPremium(3, &F[0], &X[0], &sd[0], &df[0], isCall.get(), &premium[0]);
+    BOOST_CHECK(!boost::math::isnan(premium[0]));
+    BOOST_CHECK(boost::math::isnan(premium[1]));
+    BOOST_CHECK(!boost::math::isnan(premium[2]));
+}
 
 test_suite* Black76Test::suite() 
 {
     test_suite* suite = BOOST_TEST_SUITE("Black 76 Option Pricing Suite");
     suite->add(BOOST_TEST_CASE(&Black76Test::testPutCallParity));
+    suite->add(BOOST_TEST_CASE(&Black76Test::testGreeks));
+    suite->add(BOOST_TEST_CASE(&Black76Test::testBatchPricing));
 
     return suite;
 }
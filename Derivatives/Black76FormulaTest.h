@@ -3,14 +3,18 @@
 #pragma once
 
 #include <iostream>
-#include <boost\test\unit_test.hpp>
-#include <boost\math\special_functions\fpclassify.hpp> // boost::math::isnan
+#include <memory> // unique_ptr
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <boost/math/special_functions/fpclassify.hpp> // boost::math::isnan
 #include "Black76Formula.h"
 
 class Black76Test 
 {
   public:
     static void testPutCallParity();
+    static void testGreeks();
+    static void testBatchPricing();
 
     static boost::unit_test_framework::test_suite* suite();
 };
@@ -0,0 +1,191 @@
+#include "Black76ImpliedVolatility.h"
+
+#include <algorithm> // max, min
+
+
+namespace XLLBasicLibrary
+{
+	namespace
+	{
+		const double twoPi = 6.28318530717958647692;
+		const double epsilon = numeric_limits<double>::epsilon();
+		const int maximumIterations = 100;
+		// The batch is solved in blocks so the intermediate values can live on the stack
+		const size_t solverBlockSize = 256;
+
+		// Everything needed to iterate on one quote
+		struct SolverState
+		{
+			double x, halfForward, logTarget;
+			BracketedHalley solver;
+		};
+
+		// Corrado-Miller approximation with F = exp(x/2), X = exp(-x/2). The square root
+		// can go negative far from the money in which case it is dropped.
+		double initialGuess(double x, double b)
+		{
+			double forward = exp(x / 2.0), strike = 1.0 / forward;
+			double halfDifference = (forward - strike) / 2.0;
+			double c = b - halfDifference;
+			double root = c * c - 4.0 * halfDifference * halfDifference / (twoPi / 2.0);
+			return sqrt(twoPi) / (forward + strike) * (c + sqrt(max(root, 0.0)));
+		}
+
+		// Reduces the quote to the normalised problem. Returns true if the answer is known
+		// without iterating, in which case it is written to standardDeviation.
+		bool setUp(
+			double premium,
+			double F,
+			double X,
+			double df,
+			bool isCall,
+			SolverState &state,
+			double &standardDeviation)
+		{
+			standardDeviation = numeric_limits<double>::quiet_NaN();
+			if ((F <= 0) || (X <= 0) || (df <= 0) || !(premium >= 0))
+			{
+				return true;
+			}
+			double undiscounted = premium / df;
+			double intrinsic = isCall ? max(F - X, 0.0) : max(X - F, 0.0);
+			double upperBound = isCall ? F : X;
+			if ((undiscounted < intrinsic) || (undiscounted >= upperBound))
+			{
+				return true;
+			}
+			double timeValue = undiscounted - intrinsic;
+			if (timeValue == 0.0)
+			{
+				standardDeviation = 0.0;
+				return true;
+			}
+			state.x = -fabs(log(F / X));
+			state.halfForward = exp(state.x / 2.0);
+			double target = timeValue / sqrt(F * X);
+			// The time value is bounded by min(F, X) so the normalised target can only reach
+			// exp(x/2) through rounding
+			if (target >= state.halfForward)
+			{
+				return true;
+			}
+			state.logTarget = log(target);
+			double guess = initialGuess(state.x, target);
+			state.solver.start((guess > 0.0) ? guess : 1.0, 0.0, numeric_limits<double>::infinity());
+			return false;
+		}
+
+		// One iteration from state.solver.s given Nd1 = N(d1) and Nd2 = N(d2) there, where
+		//      d1 = x/s + s/2, d2 = d1 - s
+		// Returns true once converged, in which case the answer is in standardDeviation.
+		bool iterate(SolverState &state, double d1, double Nd1, double Nd2, double &standardDeviation)
+		{
+			BracketedHalley &solver = state.solver;
+			double s = solver.s;
+			// The normalised out-of-the-money call premium and its first two derivatives 
+			// with respect to s. Note exp(x/2) n(d1) = exp(-x/2) n(d2)
+			double callTerm = state.halfForward * Nd1, strikeTerm = Nd2 / state.halfForward;
+			double b = callTerm - strikeTerm;
+			bool done;
+			if (b <= 0.0)
+			{
+				// Underflow: s is certainly too small
+				done = solver.stepUp(maximumIterations);
+			}
+			else
+			{
+				double dbds = state.halfForward * StandardNormal::pdf(d1);
+				double d2bds2 = dbds * d1 * (d1 - s) / s;
+				// Halley on g(s) = ln(b(s)) - ln(target). Far out of the money b is the small
+				// difference of two terms, each with the relative error (1 + d^2 / 2) eps of
+				// N(d) in the tail, so that is as close as g can be brought to 0
+				double g = log(b) - state.logTarget;
+				double g1 = dbds / b;
+				double g2 = d2bds2 / b - g1 * g1;
+				double d2 = d1 - s;
+				double tolerance = 4.0 * epsilon * (1.0 +
+					((1.0 + d1 * d1 / 2.0) * callTerm + (1.0 + d2 * d2 / 2.0) * strikeTerm) / b);
+				done = solver.step(g, g1, g2, tolerance, maximumIterations);
+			}
+			standardDeviation = solver.s;
+			return done;
+		}
+
+		double getD1(const SolverState &state)
+		{
+			return state.x / state.solver.s + state.solver.s / 2.0;
+		}
+	}
+
+	/*======================================================================================
+	Black76ImpliedVolatility
+	=======================================================================================*/
+	double Black76ImpliedVolatility::getStandardDeviation(
+		double premium,
+		double F,
+		double X,
+		double df,
+		bool isCall)
+	{
+		SolverState state;
+		double sd;
+		bool done = setUp(premium, F, X, df, isCall, state, sd);
+		while (!done)
+		{
+			double d1 = getD1(state);
+			done = iterate(state, d1, StandardNormal::cdf(d1), StandardNormal::cdf(d1 - state.solver.s), sd);
+		}
+		return sd;
+	}
+
+	void Black76ImpliedVolatility::getStandardDeviation(
+		size_t n,
+		const double *premium,
+		const double *F,
+		const double *X,
+		const double *df,
+		const bool *isCall,
+		double *sd)
+	{
+		// All the unconverged quotes in a block are iterated together so that N(.) is one
+		// vectorised call per iteration. d1 and d2 are held back to back in one array.
+		SolverState state[solverBlockSize];
+		size_t active[solverBlockSize];
+		double d[2 * solverBlockSize], d1[solverBlockSize];
+		for (size_t start = 0; start < n; start += solverBlockSize)
+		{
+			size_t blockSize = min(solverBlockSize, n - start);
+			size_t activeSize = 0;
+			for (size_t i = 0; i < blockSize; ++i)
+			{
+				size_t line = start + i;
+				if (!setUp(premium[line], F[line], X[line], df[line], isCall[line], state[i], sd[line]))
+				{
+					active[activeSize++] = i;
+				}
+			}
+			while (activeSize > 0)
+			{
+				for (size_t j = 0; j < activeSize; ++j)
+				{
+					const SolverState &lineState = state[active[j]];
+					d1[j] = getD1(lineState);
+					d[j] = d1[j];
+					d[activeSize + j] = d1[j] - lineState.solver.s;
+				}
+				StandardNormal::cdf(2 * activeSize, d, d);
+				// Converged quotes are dropped from the active list
+				size_t stillActive = 0;
+				for (size_t j = 0; j < activeSize; ++j)
+				{
+					size_t i = active[j];
+					if (!iterate(state[i], d1[j], d[j], d[activeSize + j], sd[start + i]))
+					{
+						active[stillActive++] = i;
+					}
+				}
+				activeSize = stillActive;
+			}
+		}
+	}
+}
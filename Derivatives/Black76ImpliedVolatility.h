@@ -0,0 +1,63 @@
+#ifndef XLLBASIC_BLACK76IMPLIEDVOLATILITY_INCLUDED
+#define XLLBASIC_BLACK76IMPLIEDVOLATILITY_INCLUDED
+#pragma once
+
+#include <math.h>
+#include <limits> // quiet_NaN
+
+#include "../Maths/BracketedHalley.h"
+#include "../Maths/NormalDistribution.h"
+
+using namespace std;
+
+namespace XLLBasicLibrary
+{
+
+   /*======================================================================================
+    Black76ImpliedVolatility: the inverse of Black76Call::getPremium() and
+    Black76Put::getPremium() with respect to the standard deviation.
+
+    In keeping with the formula the inputs and the output are unitless: the result is the
+    standard deviation (= vol * sqrt(time)), not the volatility.
+
+    The given premium is first reduced to the time value of the out-of-the-money option
+    and normalised by df * sqrt(F * X). Puts and calls, in or out of the money, then all
+    solve the same equation
+        b(s) = exp(x/2) N(x/s + s/2) - exp(-x/2) N(x/s - s/2),    x = -|ln(F/X)|
+    Starting from the Corrado-Miller approximation, BracketedHalley is applied to ln(b(s))
+    which is close to linear in s for both very small and very large premiums. It stops
+    once ln(b(s)) matches the target to within the rounding error of b, which far out of
+    the money is the small difference of two larger terms. It typically takes 3-4
+    iterations.
+
+    Where no standard deviation reproduces the premium (premium below the intrinsic value
+    or at least the discounted forward for a call / strike for a put), or any of F, X, df
+    are <= 0, the result is NaN. A premium equal to the intrinsic value gives 0.
+
+    The batch form solves n quotes held as a structure of arrays, as Black76Batch. The 
+    unconverged quotes in each block are iterated together so that N(.) is evaluated with
+    one vectorised call per iteration. Each line converges independently so a bad quote
+    only gives NaN on its own line.
+    =======================================================================================*/
+    class Black76ImpliedVolatility
+    {
+    public :
+		static double getStandardDeviation(
+			double premium,
+			double forward,
+			double strike,
+			double discountFactor,
+			bool isCall);
+
+		static void getStandardDeviation(
+			size_t n,
+			const double *premium,
+			const double *forward,
+			const double *strike,
+			const double *discountFactor,
+			const bool *isCall,
+			double *standardDeviation);
+    };
+}
+
+#endif
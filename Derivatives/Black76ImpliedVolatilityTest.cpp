@@ -0,0 +1,157 @@
+#include "Black76ImpliedVolatilityTest.h"
+
+#include <memory> // unique_ptr
+#include <vector>
+
+using namespace std;
+using namespace boost::unit_test_framework;
+using namespace XLLBasicLibrary;
+
+namespace
+{
+    double premium(bool isCall, double F, double X, double sd, double df)
+    {
+        if (isCall)
+        {
+            return Black76Call(F, X, sd, df).getPremium();
+        }
+        return Black76Put(F, X, sd, df).getPremium();
+    }
+
+    // A strike / expiry grid around F = 100 with calls above and puts below the forward,
+    // as in a quoted chain
+    void buildChain(
+        size_t n,
+        vector<double> &F,
+        vector<double> &X,
+        vector<double> &sd,
+        vector<double> &df,
+        bool *isCall)
+    {
+        F.resize(n); X.resize(n); sd.resize(n); df.resize(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            double T = 0.05 + 0.1 * (i % 40);
+            F[i] = 100.0 + 0.5 * (i % 40);
+            X[i] = 50.0 + 100.0 * ((i * 7) % 50) / 49.0;
+            sd[i] = (0.2 + 0.3 * ((i * 3) % 11) / 10.0) * sqrt(T);
+            df[i] = exp(-0.03 * T);
+            isCall[i] = (X[i] >= F[i]);
+        }
+    }
+}
+
+void Black76ImpliedVolatilityTest::testRoundTrip()
+{
+    BOOST_TEST_MESSAGE("Testing Black 76 implied standard deviation recovers the input ...");
+
+    double F = 100, df = 0.97;
+    double strikes[] = { 20, 60, 90, 99, 100, 101, 110, 150, 400 };
+    double sds[] = { 0.005, 0.05, 0.2, 0.5, 1.0, 2.0, 4.0 };
+    for (size_t i = 0; i < sizeof(strikes) / sizeof(double); ++i)
+    {
+        for (size_t j = 0; j < sizeof(sds) / sizeof(double); ++j)
+        {
+            for (int k = 0; k < 2; ++k)
+            {
+                bool isCall = (k == 0);
+                double X = strikes[i], sd = sds[j];
+                double p = premium(isCall, F, X, sd, df);
+                double intrinsic = isCall ? max(F - X, 0.0) : max(X - F, 0.0);
+                // Skip premiums with no time value left in double precision
+                if (p / df - intrinsic < 1e-12 * F)
+                {
+                    continue;
+                }
+                double implied = Black76ImpliedVolatility::getStandardDeviation(p, F, X, df, isCall);
+                BOOST_CHECK(abs(premium(isCall, F, X, implied, df) - p) < 1e-12 * F);
+                // The premium is insensitive to sd deep in / out of the money, so only 
+                // compare standard deviations where vega is material
+                double vega = (premium(isCall, F, X, sd * 1.001, df) - premium(isCall, F, X, sd * 0.999, df)) / (0.002 * sd);
+                if (vega > 1e-3)
+                {
+                    BOOST_CHECK(abs(implied - sd) < 1e-10);
+                }
+            }
+        }
+    }
+}
+
+void Black76ImpliedVolatilityTest::testFarOutOfTheMoney()
+{
+    BOOST_TEST_MESSAGE("Testing Black 76 implied standard deviation far out of the money ...");
+
+    // Premiums of 1e-10 and below, where the normalised premium is the small difference
+    // of two larger terms and the solver must not stop on a small step alone
+    double F = 100, df = 0.97;
+    double logMoneyness[] = { 0.31, 0.5, 1.0 };
+    double sds[] = { 0.05, 0.1, 0.15 };
+    for (size_t i = 0; i < sizeof(logMoneyness) / sizeof(double); ++i)
+    {
+        for (int k = 0; k < 2; ++k)
+        {
+            bool isCall = (k == 0);
+            double X = isCall ? F * exp(logMoneyness[i]) : F * exp(-logMoneyness[i]);
+            double sd = sds[i];
+            double p = premium(isCall, F, X, sd, df);
+            double implied = Black76ImpliedVolatility::getStandardDeviation(p, F, X, df, isCall);
+            BOOST_CHECK(abs(implied / sd - 1.0) < 1e-10);
+            BOOST_CHECK(abs(premium(isCall, F, X, implied, df) / p - 1.0) < 1e-10);
+        }
+    }
+}
+
+void Black76ImpliedVolatilityTest::testArbitrageBounds()
+{
+    BOOST_TEST_MESSAGE("Testing Black 76 implied standard deviation outside the arbitrage bounds ...");
+
+    double F = 100, X = 90, df = 0.97;
+    // Intrinsic value gives zero standard deviation
+    BOOST_CHECK(Black76ImpliedVolatility::getStandardDeviation((F - X) * df, F, X, df, true) == 0.0);
+    BOOST_CHECK(Black76ImpliedVolatility::getStandardDeviation(0.0, F, X, df, false) == 0.0);
+    // Below intrinsic, at or above the upper bound, or with invalid inputs
+    BOOST_CHECK(boost::math::isnan(Black76ImpliedVolatility::getStandardDeviation((F - X) * df - 0.01, F, X, df, true)));
+    BOOST_CHECK(boost::math::isnan(Black76ImpliedVolatility::getStandardDeviation(F * df, F, X, df, true)));
+    BOOST_CHECK(boost::math::isnan(Black76ImpliedVolatility::getStandardDeviation(X * df, F, X, df, false)));
+    BOOST_CHECK(boost::math::isnan(Black76ImpliedVolatility::getStandardDeviation(-1.0, F, X, df, false)));
+    BOOST_CHECK(boost::math::isnan(Black76ImpliedVolatility::getStandardDeviation(5.0, 0.0, X, df, false)));
+    BOOST_CHECK(boost::math::isnan(Black76ImpliedVolatility::getStandardDeviation(5.0, F, X, 0.0, false)));
+}
+
+void Black76ImpliedVolatilityTest::testBatch()
+{
+    BOOST_TEST_MESSAGE("Testing Black 76 batch implied standard deviation against the single quote ...");
+
+    size_t n = 2000;
+    vector<double> F, X, sd, df;
+    unique_ptr<bool[]> isCall(new bool[n]);
+    buildChain(n, F, X, sd, df, isCall.get());
+    vector<double> p(n), implied(n);
+    Black76Batch::getPremium(n, &F[0], &X[0], &sd[0], &df[0], isCall.get(), &p[0]);
+    // One bad quote must not affect its neighbours
+    p[1] = -1.0;
+    Black76ImpliedVolatility::getStandardDeviation(n, &p[0], &F[0], &X[0], &df[0], isCall.get(), &implied[0]);
+    for (size_t i = 0; i < n; ++i)
+    {
+        double single = Black76ImpliedVolatility::getStandardDeviation(p[i], F[i], X[i], df[i], isCall[i]);
+        if (i == 1)
+        {
+            BOOST_CHECK(boost::math::isnan(implied[i]));
+            continue;
+        }
+        // The vectorised N(.) can differ from the scalar one in the last bit or two
+        BOOST_CHECK(abs(implied[i] - single) < 1e-12);
+        BOOST_CHECK(abs(premium(isCall[i], F[i], X[i], implied[i], df[i]) - p[i]) < 1e-10);
+    }
+}
+
+test_suite* Black76ImpliedVolatilityTest::suite()
+{
+    test_suite* suite = BOOST_TEST_SUITE("Black 76 Implied Volatility Suite");
+    suite->add(BOOST_TEST_CASE(&Black76ImpliedVolatilityTest::testRoundTrip));
+    suite->add(BOOST_TEST_CASE(&Black76ImpliedVolatilityTest::testFarOutOfTheMoney));
+    suite->add(BOOST_TEST_CASE(&Black76ImpliedVolatilityTest::testArbitrageBounds));
+    suite->add(BOOST_TEST_CASE(&Black76ImpliedVolatilityTest::testBatch));
+
+    return suite;
+}
@@ -0,0 +1,22 @@
+#ifndef XLLBASIC_black76_implied_volatility_test
+#define XLLBASIC_black76_implied_volatility_test
+#pragma once
+
+#include <iostream>
+#include <boost/test/unit_test.hpp>
+#include <boost/math/special_functions/fpclassify.hpp> // boost::math::isnan
+#include "Black76Formula.h"
+#include "Black76ImpliedVolatility.h"
+
+class Black76ImpliedVolatilityTest 
+{
+  public:
+    static void testRoundTrip();
+    static void testFarOutOfTheMoney();
+    static void testArbitrageBounds();
+    static void testBatch();
+
+    static boost::unit_test_framework::test_suite* suite();
+};
+
+#endif
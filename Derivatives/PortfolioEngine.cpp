@@ -0,0 +1,64 @@
+#include "PortfolioEngine.h"
+
+#include <cmath>
+#include <limits> // quiet_NaN
+#include <stdexcept>
+
+namespace XLLBasicLibrary
+{
+	const size_t PortfolioEngine::linesPerChunk;
+
+	PortfolioEngine::PortfolioEngine(size_t threadCount)
+		: pool(threadCount)
+	{
+	}
+
+	void PortfolioEngine::price(size_t n, const PortfolioTrade *trades, Black76Greeks *results)
+	{
+		pool.parallelFor(n, linesPerChunk, [trades, results](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				results[i] = priceTrade(trades[i]);
+			}
+		});
+	}
+
+	vector<Black76Greeks> PortfolioEngine::price(const vector<PortfolioTrade> &trades)
+	{
+		vector<Black76Greeks> results(trades.size());
+		if (!trades.empty())
+		{
+			price(trades.size(), &trades[0], &results[0]);
+		}
+		return results;
+	}
+
+	Black76Greeks PortfolioEngine::priceTrade(const PortfolioTrade &trade)
+	{
+		try
+		{
+			double sd = trade.standardDeviation;
+			if (trade.surface != NULL)
+			{
+				if ((trade.forward <= 0) || (trade.time <= 0))
+				{
+					throw runtime_error("PortfolioEngine->Forward or time is <= 0");
+				}
+				sd = trade.surface->getVolatilityForMoneyness(trade.time, (trade.strike - trade.forward) / trade.forward)
+					* sqrt(trade.time);
+			}
+			if (trade.isCall)
+			{
+				return Black76Call(trade.forward, trade.strike, sd, trade.discountFactor).getPremiumAndGreeks(trade.time);
+			}
+			return Black76Put(trade.forward, trade.strike, sd, trade.discountFactor).getPremiumAndGreeks(trade.time);
+		}
+		catch (runtime_error &)
+		{
+			double nan = numeric_limits<double>::quiet_NaN();
+			Black76Greeks greeks = { nan, nan, nan, nan, nan, nan };
+			return greeks;
+		}
+	}
+}
@@ -0,0 +1,73 @@
+#ifndef XLLBASIC_PORTFOLIOENGINE_INCLUDED
+#define XLLBASIC_PORTFOLIOENGINE_INCLUDED
+#pragma once
+
+#include <vector>
+#include "Black76Formula.h"
+#include "VolatilitySurfaceDelta.h"
+#include "WorkStealingPool.h"
+
+using namespace std;
+
+namespace XLLBasicLibrary
+{
+	/*======================================================================================
+	PortfolioTrade
+
+	One line of a portfolio of European options on a forward, with the same unitless
+	inputs as Black76Option. time (a year fraction) is needed for the greeks.
+
+	If surface is set the standard deviation input is ignored and replaced by
+	vol * sqrt(time), with vol read off the surface at the trade's moneyness. The surface
+	is not owned by the trade and must outlive the call to PortfolioEngine::price.
+	=======================================================================================*/
+	struct PortfolioTrade
+	{
+		bool isCall;
+		double forward;
+		double strike;
+		double standardDeviation;
+		double discountFactor;
+		double time;
+		const SimpleDeltaSurface *surface;
+	};
+
+	/*======================================================================================
+	PortfolioEngine
+
+	Prices a portfolio of Black '76 options, and their greeks, on all the cores of the
+	machine. The trades are split into blocks of linesPerChunk lines which are spread over
+	the threads of a WorkStealingPool, so a block of slow (surface) lines is shared out
+	rather than holding up the thread that happened to get it. Every line is priced with
+	Black76Call::getPremiumAndGreeks or Black76Put::getPremiumAndGreeks, so the results are
+	identical to pricing the lines one at a time, whatever the number of threads.
+
+	As in Black76Batch, a line with invalid inputs (F, X, sd, df or time <= 0, or a strike
+	that is off its surface) is returned as NaN rather than failing the whole portfolio.
+
+	The threads are created with the engine and kept between calls, so an engine should
+	be constructed once and reused.
+	=======================================================================================*/
+	class PortfolioEngine
+	{
+	public:
+		static const size_t linesPerChunk = 512;
+
+		// threadCount includes the calling thread; 0 uses one thread per core
+		explicit PortfolioEngine(size_t threadCount = 0);
+
+		size_t getThreadCount() const		{return pool.getThreadCount();};
+
+		// results must hold n elements
+		void price(size_t n, const PortfolioTrade *trades, Black76Greeks *results);
+		vector<Black76Greeks> price(const vector<PortfolioTrade> &trades);
+
+		// The price of a single line, as used by the engine
+		static Black76Greeks priceTrade(const PortfolioTrade &trade);
+
+	private:
+		WorkStealingPool pool;
+	};
+}
+
+#endif
@@ -0,0 +1,198 @@
+#include "PortfolioEngineTest.h"
+
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+using namespace boost::unit_test_framework;
+using namespace XLLBasicLibrary;
+
+namespace
+{
+    // A small surface in the layout of VolatilitySurfacesDeltaTest
+    shared_ptr<SimpleDeltaSurface> buildSurface()
+    {
+        vector<double> times = { 1.0 / 12.0, 0.25, 0.5, 1.0, 2.0 };
+        vector<double> delta = { 10, 25, 50, 75, 90 };
+        vector<vector<double>> volatility = {
+            { .18, .19, .22, .25, .26 },
+            { .17, .18, .21, .23, .25 },
+            { .17, .18, .20, .23, .24 },
+            { .18, .19, .22, .22, .27 },
+            { .20, .21, .25, .29, .31 } };
+        return shared_ptr<SimpleDeltaSurface>(
+            new SimpleDeltaSurface(times, delta, volatility, false, "bilinear"));
+    }
+
+    // Calls and puts across strikes and expiries, every third line priced off the surface
+    // and every hundredth line invalid
+    vector<PortfolioTrade> buildPortfolio(size_t n, const SimpleDeltaSurface *surface)
+    {
+        vector<PortfolioTrade> trades(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            double time = 0.1 + 0.15 * (i % 12);
+            PortfolioTrade trade = { (i % 2 == 0), 100.0, 85.0 + (i * 7) % 31,
+                0.25 * sqrt(time), exp(-0.02 * time), time, (i % 3 == 0) ? surface : NULL };
+            if (i % 100 == 99)
+            {
+                trade.discountFactor = 0;
+            }
+            trades[i] = trade;
+        }
+        return trades;
+    }
+
+    bool sameGreeks(const Black76Greeks &a, const Black76Greeks &b)
+    {
+        if (std::isnan(a.premium))
+        {
+            return std::isnan(b.premium) && std::isnan(b.delta) && std::isnan(b.rho);
+        }
+        return (a.premium == b.premium) && (a.delta == b.delta) && (a.gamma == b.gamma)
+            && (a.vega == b.vega) && (a.theta == b.theta) && (a.rho == b.rho);
+    }
+}
+
+void PortfolioEngineTest::testWorkStealingPool()
+{
+    BOOST_TEST_MESSAGE("Testing WorkStealingPool covers every index once ...");
+
+    size_t threadCounts[4] = { 1, 2, 3, 8 };
+    for (size_t k = 0; k < 4; ++k)
+    {
+        WorkStealingPool pool(threadCounts[k]);
+        BOOST_CHECK(pool.getThreadCount() == threadCounts[k]);
+
+        // Uneven work, concentrated at the start, so the later threads have to steal
+        const size_t n = 10007;
+        vector<atomic<int>> visits(n);
+        // Boost.Test is not thread safe, so the body only counts and checks come afterwards
+        atomic<size_t> oversized(0);
+        for (size_t repeat = 0; repeat < 3; ++repeat)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                visits[i] = 0;
+            }
+            pool.parallelFor(n, 16, [&](size_t begin, size_t end)
+            {
+                oversized += (end - begin > 16) ? 1 : 0;
+                volatile double work = 0;
+                for (size_t i = begin; i < end; ++i)
+                {
+                    for (size_t j = 0; j < (i < n / 8 ? 2000 : 10); ++j)
+                    {
+                        work = work + sqrt((double)j);
+                    }
+                    ++visits[i];
+                }
+            });
+            size_t wrong = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                wrong += (visits[i] != 1) ? 1 : 0;
+            }
+            BOOST_CHECK(oversized == 0);
+            BOOST_CHECK_MESSAGE(wrong == 0, wrong << " indices not visited exactly once with "
+                << threadCounts[k] << " threads");
+        }
+
+        // Fewer chunks than threads, and nothing to do
+        atomic<size_t> total(0);
+        pool.parallelFor(5, 16, [&](size_t begin, size_t end) {total += end - begin;});
+        pool.parallelFor(0, 16, [&](size_t begin, size_t end) {total += 100;});
+        BOOST_CHECK(total == 5);
+
+        // An exception is passed back to the caller and the pool stays usable
+        bool thrown = false;
+        try
+        {
+            pool.parallelFor(1000, 10, [](size_t begin, size_t)
+            {
+                if (begin == 500)
+                {
+                    throw runtime_error("chunk failed");
+                }
+            });
+        }
+        catch (runtime_error &e)
+        {
+            thrown = (string(e.what()) == "chunk failed");
+        }
+        BOOST_CHECK(thrown);
+        total = 0;
+        pool.parallelFor(1000, 10, [&](size_t begin, size_t end) {total += end - begin;});
+        BOOST_CHECK(total == 1000);
+    }
+}
+
+void PortfolioEngineTest::testPortfolioPricing()
+{
+    BOOST_TEST_MESSAGE("Testing PortfolioEngine against line by line pricing ...");
+
+    shared_ptr<SimpleDeltaSurface> surface = buildSurface();
+    vector<PortfolioTrade> trades = buildPortfolio(5000, surface.get());
+
+    // Line by line, as a caller would have done it
+    vector<Black76Greeks> expected(trades.size());
+    for (size_t i = 0; i < trades.size(); ++i)
+    {
+        const PortfolioTrade &trade = trades[i];
+        double sd = trade.standardDeviation;
+        if (trade.surface)
+        {
+            sd = trade.surface->getVolatilityForMoneyness(trade.time, (trade.strike - trade.forward) / trade.forward)
+                * sqrt(trade.time);
+        }
+        try
+        {
+            expected[i] = trade.isCall ? 
+                Black76Call(trade.forward, trade.strike, sd, trade.discountFactor).getPremiumAndGreeks(trade.time) :
+                Black76Put(trade.forward, trade.strike, sd, trade.discountFactor).getPremiumAndGreeks(trade.time);
+        }
+        catch (runtime_error &)
+        {
+            expected[i].premium = expected[i].delta = expected[i].rho = numeric_limits<double>::quiet_NaN();
+        }
+    }
+
+    size_t threadCounts[4] = { 1, 2, 4, 7 };
+    for (size_t k = 0; k < 4; ++k)
+    {
+        PortfolioEngine engine(threadCounts[k]);
+        vector<Black76Greeks> results = engine.price(trades);
+        BOOST_REQUIRE(results.size() == trades.size());
+        size_t wrong = 0, invalid = 0;
+        for (size_t i = 0; i < trades.size(); ++i)
+        {
+            wrong += sameGreeks(expected[i], results[i]) ? 0 : 1;
+            invalid += std::isnan(results[i].premium) ? 1 : 0;
+        }
+        BOOST_CHECK_MESSAGE(wrong == 0, wrong << " lines differ from line by line pricing with "
+            << threadCounts[k] << " threads");
+        // The lines with a zero discount factor, and surface lines whose strike is off the
+        // surface, are NaN
+        BOOST_CHECK(invalid >= trades.size() / 100);
+        BOOST_CHECK_MESSAGE(invalid < trades.size() / 10, invalid << " lines are NaN");
+    }
+
+    // Surface lines pick up the smile rather than the input standard deviation
+    PortfolioTrade flat = { false, 100, 80, 0.25, 1.0, 1.0, NULL };
+    PortfolioTrade smile = flat;
+    smile.surface = surface.get();
+    BOOST_CHECK(PortfolioEngine::priceTrade(flat).premium != PortfolioEngine::priceTrade(smile).premium);
+    BOOST_CHECK(PortfolioEngine(2).price(vector<PortfolioTrade>()).empty());
+}
+
+test_suite* PortfolioEngineTest::suite()
+{
+    test_suite* suite = BOOST_TEST_SUITE("Portfolio Engine Suite");
+    suite->add(BOOST_TEST_CASE(&PortfolioEngineTest::testWorkStealingPool));
+    suite->add(BOOST_TEST_CASE(&PortfolioEngineTest::testPortfolioPricing));
+
+    return suite;
+}
@@ -0,0 +1,19 @@
+#ifndef XLLBASIC_portfolio_engine_test
+#define XLLBASIC_portfolio_engine_test
+#pragma once
+
+#include <iostream>
+#include <boost/test/unit_test.hpp>
+#include "PortfolioEngine.h"
+#include "WorkStealingPool.h"
+
+class PortfolioEngineTest 
+{
+  public:
+    static void testWorkStealingPool();
+    static void testPortfolioPricing();
+
+    static boost::unit_test_framework::test_suite* suite();
+};
+
+#endif
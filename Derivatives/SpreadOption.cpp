@@ -0,0 +1,291 @@
+#include "SpreadOption.h"
+
+#include <algorithm> // min
+
+
+namespace XLLBasicLibrary
+{
+	namespace
+	{
+		// Everything about one spread that does not depend on N(.)
+		struct SpreadTerms
+		{
+			double a, b, sd;
+			// d[0] = d1, d[1] = d2, d[2] = d3
+			double d[3];
+		};
+
+		// Returns false where neither approximation applies: F2 + X <= 0, a spread with no
+		// variance, or NaN inputs
+		bool setUpSpread(
+			double F1,
+			double F2,
+			double X,
+			double sd1,
+			double sd2,
+			double rho,
+			SpreadApproximation approximation,
+			SpreadTerms &terms)
+		{
+			terms.a = F2 + X;
+			if (!(terms.a > 0) || !(F1 > 0))
+			{
+				return false;
+			}
+			double b = F2 / terms.a;
+			double variance = sd1 * sd1 - 2.0 * b * rho * sd1 * sd2 + b * b * sd2 * sd2;
+			if (!(variance > 0))
+			{
+				return false;
+			}
+			terms.b = b;
+			terms.sd = sqrt(variance);
+			double logMoneyness = log(F1 / terms.a);
+			terms.d[0] = (logMoneyness + variance / 2.0) / terms.sd;
+			if (approximation == KIRK)
+			{
+				terms.d[1] = terms.d[2] = terms.d[0] - terms.sd;
+			}
+			else
+			{
+				terms.d[1] = (logMoneyness - sd1 * sd1 / 2.0 + rho * sd1 * sd2 + b * b * sd2 * sd2 / 2.0 - b * sd2 * sd2) / terms.sd;
+				terms.d[2] = (logMoneyness - sd1 * sd1 / 2.0 + b * b * sd2 * sd2 / 2.0) / terms.sd;
+			}
+			return true;
+		}
+
+		// Nwd[i] = N(w d[i])
+		double spreadPremium(double w, double F1, double F2, double X, double df, const double *Nwd)
+		{
+			return w * df * (F1 * Nwd[0] - F2 * Nwd[1] - X * Nwd[2]);
+		}
+
+		// The derivatives of the premium to F1 and F2. Each d_i is (ln(F1 / a) + c_i) / sd with
+		// c_i and sd functions of b, and a and b functions of F2, so that
+		//		dd_i/dF1 = 1 / (F1 sd)
+		//		dd_i/dF2 = (-1 / a + (c_i' - d_i sd') db/dF2) / sd,		db/dF2 = X / a^2
+		// where ' is d/db
+		void spreadDeltas(
+			double w,
+			double F1,
+			double F2,
+			double X,
+			double sd1,
+			double sd2,
+			double rho,
+			double df,
+			SpreadApproximation approximation,
+			const SpreadTerms &terms,
+			const double *Nwd,
+			SpreadOptionDeltas &deltas)
+		{
+			double b = terms.b, sd = terms.sd;
+			double sdPrime = (b * sd2 * sd2 - rho * sd1 * sd2) / sd;
+			double cPrime[3];
+			cPrime[0] = sd * sdPrime;
+			if (approximation == KIRK)
+			{
+				cPrime[1] = cPrime[2] = -sd * sdPrime;
+			}
+			else
+			{
+				cPrime[1] = (b - 1.0) * sd2 * sd2;
+				cPrime[2] = b * sd2 * sd2;
+			}
+			double dbdF2 = X / (terms.a * terms.a);
+			double weight[3] = { F1, -F2, -X };
+			double sumF1 = 0, sumF2 = 0;
+			for (int i = 0; i < 3; ++i)
+			{
+				double nd = weight[i] * StandardNormal::pdf(terms.d[i]);
+				sumF1 += nd;
+				sumF2 += nd * (-1.0 / terms.a + (cPrime[i] - terms.d[i] * sdPrime) * dbdF2);
+			}
+			deltas.delta1 = df * (w * Nwd[0] + sumF1 / (F1 * sd));
+			deltas.delta2 = df * (-w * Nwd[1] + sumF2 / sd);
+		}
+	}
+
+	/*======================================================================================
+	SpreadOption
+	=======================================================================================*/
+	void SpreadOption::setParameters(double forward1, double forward2, double strike, double standardDeviation1,
+		double standardDeviation2, double correlation, double discountFactor)
+	{
+		setForward1(forward1);
+		setForward2(forward2);
+		setStrike(strike);
+		setStandardDeviation1(standardDeviation1);
+		setStandardDeviation2(standardDeviation2);
+		setCorrelation(correlation);
+		setDiscountFactor(discountFactor);
+	}
+
+	SpreadOptionDeltas SpreadOption::calculate(double w, bool withDeltas)
+	{
+		SpreadTerms terms;
+		if (!setUpSpread(F1, F2, X, sd1, sd2, rho, approximation, terms))
+		{
+			if (!(F2 + X > 0))
+			{
+				throw runtime_error("SpreadOption->Forward 2 + Strike is <= 0");
+			}
+			throw runtime_error("SpreadOption->The spread has no variance");
+		}
+		double Nwd[3];
+		for (int i = 0; i < 3; ++i)
+		{
+			Nwd[i] = StandardNormal::cdf(w * terms.d[i]);
+		}
+		SpreadOptionDeltas result;
+		result.premium = spreadPremium(w, F1, F2, X, df, Nwd);
+		result.delta1 = result.delta2 = numeric_limits<double>::quiet_NaN();
+		if (withDeltas)
+		{
+			spreadDeltas(w, F1, F2, X, sd1, sd2, rho, df, approximation, terms, Nwd, result);
+		}
+		return result;
+	}
+
+	void SpreadOption::setForward1(double forward)
+	{
+		if (!(forward > 0))
+		{
+			throw runtime_error("SpreadOption->Forward 1 is <= 0");
+		}
+		F1 = forward;
+	}
+
+	void SpreadOption::setForward2(double forward)
+	{
+		if (!(forward > 0))
+		{
+			throw runtime_error("SpreadOption->Forward 2 is <= 0");
+		}
+		F2 = forward;
+	}
+
+	void SpreadOption::setStrike(double strike)
+	{
+		if (!(fabs(strike) < numeric_limits<double>::infinity()))
+		{
+			throw runtime_error("SpreadOption->Strike is not a finite number");
+		}
+		X = strike;
+	}
+
+	void SpreadOption::setStandardDeviation1(double standardDeviation)
+	{
+		if (!(standardDeviation > 0))
+		{
+			throw runtime_error("SpreadOption->Standard Deviation 1 is <= 0");
+		}
+		sd1 = standardDeviation;
+	}
+
+	void SpreadOption::setStandardDeviation2(double standardDeviation)
+	{
+		if (!(standardDeviation > 0))
+		{
+			throw runtime_error("SpreadOption->Standard Deviation 2 is <= 0");
+		}
+		sd2 = standardDeviation;
+	}
+
+	void SpreadOption::setCorrelation(double correlation)
+	{
+		if (!(correlation >= -1.0 && correlation <= 1.0))
+		{
+			throw runtime_error("SpreadOption->Correlation is not in [-1, 1]");
+		}
+		rho = correlation;
+	}
+
+	void SpreadOption::setDiscountFactor(double discountFactor)
+	{
+		if (!(discountFactor > 0))
+		{
+			throw runtime_error("SpreadOption->Discount Factor is <= 0");
+		}
+		df = discountFactor;
+	}
+
+
+	/*======================================================================================
+	SpreadCall
+	=======================================================================================*/
+	SpreadCall::SpreadCall(double f1, double f2, double x, double s1, double s2, double correlation, double discount,
+		SpreadApproximation approximationInput)
+	{
+		setParameters(f1, f2, x, s1, s2, correlation, discount);
+		setApproximation(approximationInput);
+	}
+
+
+	/*======================================================================================
+	SpreadPut
+	=======================================================================================*/
+	SpreadPut::SpreadPut(double f1, double f2, double x, double s1, double s2, double correlation, double discount,
+		SpreadApproximation approximationInput)
+	{
+		setParameters(f1, f2, x, s1, s2, correlation, discount);
+		setApproximation(approximationInput);
+	}
+
+
+	/*======================================================================================
+	SpreadBatch
+	=======================================================================================*/
+	namespace
+	{
+		// The batch is processed in blocks so the intermediate values can live on the stack
+		const size_t batchBlockSize = 256;
+	}
+
+	void SpreadBatch::getPremium(
+		size_t n,
+		const double *F1,
+		const double *F2,
+		const double *X,
+		const double *sd1,
+		const double *sd2,
+		const double *rho,
+		const double *df,
+		const bool *isCall,
+		SpreadApproximation approximation,
+		double *premium)
+	{
+		// The three N(w d) of every line in a block are a single vectorised call
+		double Nwd[3 * batchBlockSize];
+		bool valid[batchBlockSize];
+		for (size_t start = 0; start < n; start += batchBlockSize)
+		{
+			size_t blockSize = min(batchBlockSize, n - start);
+			for (size_t i = 0; i < blockSize; ++i)
+			{
+				size_t line = start + i;
+				SpreadTerms terms;
+				valid[i] = setUpSpread(F1[line], F2[line], X[line], sd1[line], sd2[line], rho[line], approximation, terms) &&
+					(rho[line] >= -1.0) && (rho[line] <= 1.0);
+				double w = isCall[line] ? 1.0 : -1.0;
+				for (int k = 0; k < 3; ++k)
+				{
+					Nwd[3 * i + k] = valid[i] ? w * terms.d[k] : 0.0;
+				}
+			}
+			StandardNormal::cdf(3 * blockSize, Nwd, Nwd);
+			for (size_t i = 0; i < blockSize; ++i)
+			{
+				size_t line = start + i;
+				double p = spreadPremium(isCall[line] ? 1.0 : -1.0, F1[line], F2[line], X[line], df[line], &Nwd[3 * i]);
+				// The negated tests also catch NaN inputs
+				if (!valid[i] || !(F2[line] > 0) || !(fabs(X[line]) < numeric_limits<double>::infinity()) ||
+					!(sd1[line] > 0) || !(sd2[line] > 0) || !(df[line] > 0) || !(p == p))
+				{
+					p = numeric_limits<double>::quiet_NaN();
+				}
+				premium[line] = p;
+			}
+		}
+	}
+}
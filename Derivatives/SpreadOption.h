@@ -0,0 +1,149 @@
+#ifndef XLLBASIC_SPREADOPTION_INCLUDED
+#define XLLBASIC_SPREADOPTION_INCLUDED
+#pragma once
+
+#include <math.h>
+#include <limits> // quiet_NaN
+#include <stdexcept> // runtime_error
+
+#include "../Maths/NormalDistribution.h"
+
+using namespace std;
+
+namespace XLLBasicLibrary
+{
+	/*======================================================================================
+	As spread option approximations are defined, add them here
+	=======================================================================================*/
+	enum SpreadApproximation
+	{
+		KIRK,
+		BJERKSUND_STENSLAND
+	};
+
+	/*======================================================================================
+	SpreadOptionDeltas: the premium of a SpreadOption and its analytic deltas dOP/dF1 and
+	dOP/dF2 to the forward of each leg
+	=======================================================================================*/
+	struct SpreadOptionDeltas
+	{
+		double premium, delta1, delta2;
+	};
+
+	/*======================================================================================
+	SpreadOption: an option on the spread of two futures / forwards, paying
+	max(F1 - F2 - X, 0) for a call and max(X - (F1 - F2), 0) for a put, where each forward
+	is lognormal as in Black76Option and the two are correlated. sd1 and sd2 are the
+	standard deviations (= vol * sqrt(time)) of the logs of the forwards, as in
+	Black76Option, and correlation is the correlation of the logs.
+
+	There is no closed form unless X = 0 (Margrabe), so the premium is approximated. With
+	a = F2 + X, b = F2 / a and sd^2 = sd1^2 - 2 b correlation sd1 sd2 + b^2 sd2^2 both
+	approximations are
+		call = df * (F1 N(d1) - F2 N(d2) - X N(d3)),     d1 = (ln(F1 / a) + sd^2 / 2) / sd
+	(puts with N(-d) and the signs reversed) and differ in d2 and d3
+
+		- KIRK: Kirk (1995) treats F2 + X as lognormal, so that d2 = d3 = d1 - sd and the
+		  premium is Black 76 on F1 / a.
+		- BJERKSUND_STENSLAND: Bjerksund and Stensland (2011) price the exercise rule
+		  F1(T) > a F2(T)^b / E[F2(T)^b] exactly, so that
+			d2 = (ln(F1 / a) - sd1^2 / 2 + correlation sd1 sd2 + b^2 sd2^2 / 2 - b sd2^2) / sd
+			d3 = (ln(F1 / a) - sd1^2 / 2 + b^2 sd2^2 / 2) / sd
+		  As the value of one exercise rule this is a lower bound on the premium. It
+		  is usually several times more accurate than Kirk's, at the same cost, though not
+		  always for highly correlated legs.
+
+	Both are exact at X = 0. The deltas are the exact derivatives of the approximate
+	premium, including the dependence of a, b and sd on F2. F1 and F2 must be > 0, F2 + X
+	must be > 0 (a strike below -F2 is outside both approximations), sd1, sd2 and df must
+	be > 0 and the correlation must be in [-1, 1]. As in Black76Option, calls and puts
+	are separate objects.
+	=======================================================================================*/
+	class SpreadOption
+	{
+	public :
+		void setParameters(double forward1, double forward2, double strike, double standardDeviation1,
+			double standardDeviation2, double correlation, double discountFactor);
+
+		double getForward1()                    {return F1;};
+		void setForward1(double forward);
+		double getForward2()                    {return F2;};
+		void setForward2(double forward);
+		double getStrike()                      {return X;};
+		void setStrike(double strike);
+		double getStandardDeviation1()          {return sd1;};
+		void setStandardDeviation1(double standardDeviation);
+		double getStandardDeviation2()          {return sd2;};
+		void setStandardDeviation2(double standardDeviation);
+		double getCorrelation()                 {return rho;};
+		void setCorrelation(double correlation);
+		double getDiscountFactor()              {return df;};
+		void setDiscountFactor(double discountFactor);
+		SpreadApproximation getApproximation()  {return approximation;};
+		void setApproximation(SpreadApproximation approximationInput) {approximation = approximationInput;};
+
+		virtual double getPremium() = 0;
+		virtual SpreadOptionDeltas getPremiumAndDeltas() = 0;
+
+	protected :
+		// w = 1 for a call, -1 for a put
+		SpreadOptionDeltas calculate(double w, bool withDeltas);
+
+		double F1, F2, X, sd1, sd2, rho, df;
+		SpreadApproximation approximation;
+	};
+
+	/*======================================================================================
+	SpreadCall
+	=======================================================================================*/
+	class SpreadCall : public SpreadOption
+	{
+	public :
+		SpreadCall(double forward1, double forward2, double strike, double standardDeviation1,
+			double standardDeviation2, double correlation, double discountFactor,
+			SpreadApproximation approximation = BJERKSUND_STENSLAND);
+		double getPremium()                     {return calculate(1.0, false).premium;};
+		SpreadOptionDeltas getPremiumAndDeltas()    {return calculate(1.0, true);};
+	};
+
+	/*======================================================================================
+	SpreadPut
+	=======================================================================================*/
+	class SpreadPut : public SpreadOption
+	{
+	public :
+		SpreadPut(double forward1, double forward2, double strike, double standardDeviation1,
+			double standardDeviation2, double correlation, double discountFactor,
+			SpreadApproximation approximation = BJERKSUND_STENSLAND);
+		double getPremium()                     {return calculate(-1.0, false).premium;};
+		SpreadOptionDeltas getPremiumAndDeltas()    {return calculate(-1.0, true);};
+	};
+
+	/*======================================================================================
+	SpreadBatch: spread option pricing for large numbers of options held as a structure of
+	arrays, as Black76Batch.
+
+	All arrays must hold (at least) n elements and isCall[i] selects the call (true) or put
+	(false) for line i. Every line uses the same approximation. A line outside the inputs
+	allowed by SpreadOption (or with any NaN input) is priced as NaN so that one bad line
+	does not fail the whole batch.
+	=======================================================================================*/
+	class SpreadBatch
+	{
+	public :
+		static void getPremium(
+			size_t n,
+			const double *forward1,
+			const double *forward2,
+			const double *strike,
+			const double *standardDeviation1,
+			const double *standardDeviation2,
+			const double *correlation,
+			const double *discountFactor,
+			const bool *isCall,
+			SpreadApproximation approximation,
+			double *premium);
+	};
+}
+
+#endif
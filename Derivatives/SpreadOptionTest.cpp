@@ -0,0 +1,245 @@
+#include "SpreadOptionTest.h"
+
+#include <memory>
+
+using namespace std;
+using namespace boost::unit_test_framework;
+using namespace XLLBasicLibrary;
+
+namespace
+{
+    double premium(bool isCall, double F1, double F2, double X, double sd1, double sd2, double rho, double df,
+        SpreadApproximation approximation)
+    {
+        if (isCall)
+        {
+            return SpreadCall(F1, F2, X, sd1, sd2, rho, df, approximation).getPremium();
+        }
+        return SpreadPut(F1, F2, X, sd1, sd2, rho, df, approximation).getPremium();
+    }
+
+    // The premium of the call which is exercised when F1(T) > boundary(F2(T)), by Simpson's
+    // rule over the normal driving F2. Given F2(T), F1(T) is lognormal and the call is a
+    // Black 76 call on it with strike max(boundary, F2(T) + X) plus, when the boundary is
+    // above F2(T) + X, the payoff forgone between the two.
+    template <typename Boundary>
+    double integratedCall(double F1, double F2, double X, double sd1, double sd2, double rho, double df,
+        Boundary boundary)
+    {
+        int steps = 4000;
+        double h = 20.0 / steps, sum = 0;
+        double conditionalSd = sd1 * sqrt(1.0 - rho * rho);
+        for (int i = 0; i <= steps; ++i)
+        {
+            double z = -10.0 + i * h;
+            double F2T = F2 * exp(-0.5 * sd2 * sd2 + sd2 * z);
+            double F1Conditional = F1 * exp(-0.5 * rho * rho * sd1 * sd1 + rho * sd1 * z);
+            double exerciseStrike = boundary(F2T), payoffStrike = F2T + X;
+            // E[(F1(T) - payoffStrike) 1{F1(T) > exerciseStrike}]
+            double value;
+            if (exerciseStrike <= 0)
+            {
+                value = F1Conditional - payoffStrike;
+            }
+            else
+            {
+                double d1 = (std::log(F1Conditional / exerciseStrike) + 0.5 * conditionalSd * conditionalSd) / conditionalSd;
+                double d2 = d1 - conditionalSd;
+                value = F1Conditional * StandardNormal::cdf(d1) - payoffStrike * StandardNormal::cdf(d2);
+            }
+            double weight = (i == 0 || i == steps) ? 1.0 : ((i % 2 == 1) ? 4.0 : 2.0);
+            sum += weight * value * StandardNormal::pdf(z);
+        }
+        return df * sum * h / 3.0;
+    }
+
+    // The optimal rule: exercise when the spread is above the strike
+    struct OptimalBoundary
+    {
+        double X;
+        double operator()(double F2T) const   {return F2T + X;};
+    };
+
+    // The rule which Bjerksund and Stensland price
+    struct BjerksundStenslandBoundary
+    {
+        double F2, X, sd2;
+        double operator()(double F2T) const
+        {
+            double a = F2 + X, b = F2 / a;
+            return a * pow(F2T / F2, b) * exp(-0.5 * b * (b - 1.0) * sd2 * sd2);
+        }
+    };
+}
+
+void SpreadOptionTest::testPutCallParity() 
+{
+    BOOST_TEST_MESSAGE("Testing spread option Put / Call parity ...");
+
+    double F1 = 80, F2 = 75, sd1 = 0.3, sd2 = 0.25, rho = 0.6, df = 0.97;
+    double strikes[] = { -20, 0, 5, 30 };
+    for (size_t i = 0; i < sizeof(strikes) / sizeof(double); ++i)
+    {
+        for (int k = 0; k < 2; ++k)
+        {
+            SpreadApproximation approximation = (k == 0) ? KIRK : BJERKSUND_STENSLAND;
+            double X = strikes[i];
+            SpreadOptionDeltas call = SpreadCall(F1, F2, X, sd1, sd2, rho, df, approximation).getPremiumAndDeltas();
+            SpreadOptionDeltas put = SpreadPut(F1, F2, X, sd1, sd2, rho, df, approximation).getPremiumAndDeltas();
+            BOOST_CHECK(abs(call.premium - put.premium - (F1 - F2 - X) * df) < 1e-12);
+            BOOST_CHECK(abs(call.delta1 - put.delta1 - df) < 1e-12);
+            BOOST_CHECK(abs(call.delta2 - put.delta2 + df) < 1e-12);
+        }
+    }
+    BOOST_REQUIRE_THROW(SpreadCall(F1, F2, -F2, sd1, sd2, rho, df).getPremium(), runtime_error);
+    BOOST_REQUIRE_THROW(SpreadCall(F1, F2, 5, sd1, sd2, 1.5, df), runtime_error);
+    BOOST_REQUIRE_THROW(SpreadCall(F1, 0, 5, sd1, sd2, rho, df), runtime_error);
+}
+
+void SpreadOptionTest::testMargrabe()
+{
+    BOOST_TEST_MESSAGE("Testing spread options struck at zero against Margrabe ...");
+
+    double F1 = 80, F2 = 75, sd1 = 0.3, sd2 = 0.25, df = 0.97;
+    double correlations[] = { -0.9, 0, 0.5, 0.95 };
+    for (size_t i = 0; i < sizeof(correlations) / sizeof(double); ++i)
+    {
+        double rho = correlations[i];
+        double sd = sqrt(sd1 * sd1 - 2 * rho * sd1 * sd2 + sd2 * sd2);
+        double margrabe = Black76Call(F1, F2, sd, df).getPremium();
+        BOOST_CHECK(abs(SpreadCall(F1, F2, 0, sd1, sd2, rho, df, KIRK).getPremium() - margrabe) < 1e-12);
+        BOOST_CHECK(abs(SpreadCall(F1, F2, 0, sd1, sd2, rho, df, BJERKSUND_STENSLAND).getPremium() - margrabe) < 1e-12);
+    }
+}
+
+void SpreadOptionTest::testAgainstIntegration()
+{
+    BOOST_TEST_MESSAGE("Testing spread option approximations against numerical integration ...");
+
+    double F1 = 80, F2 = 75, df = 0.97;
+    double strikes[] = { -20, 5, 20 };
+    double correlations[] = { -0.5, 0, 0.5, 0.9 };
+    double sds[] = { 0.1, 0.3 };
+    double kirkError = 0, bjerksundStenslandError = 0;
+    for (size_t i = 0; i < sizeof(strikes) / sizeof(double); ++i)
+    {
+        for (size_t j = 0; j < sizeof(correlations) / sizeof(double); ++j)
+        {
+            for (size_t k = 0; k < sizeof(sds) / sizeof(double); ++k)
+            {
+                double X = strikes[i], rho = correlations[j], sd1 = sds[k], sd2 = 0.9 * sds[k];
+                OptimalBoundary optimal = { X };
+                BjerksundStenslandBoundary rule = { F2, X, sd2 };
+                double exact = integratedCall(F1, F2, X, sd1, sd2, rho, df, optimal);
+                double kirk = premium(true, F1, F2, X, sd1, sd2, rho, df, KIRK);
+                double bjerksundStensland = premium(true, F1, F2, X, sd1, sd2, rho, df, BJERKSUND_STENSLAND);
+                // Bjerksund Stensland is exactly the value of its exercise rule, and so a
+                // lower bound
+                BOOST_CHECK(abs(bjerksundStensland - integratedCall(F1, F2, X, sd1, sd2, rho, df, rule)) < 1e-8);
+                BOOST_CHECK(bjerksundStensland < exact + 1e-8);
+                BOOST_CHECK(abs(bjerksundStensland - exact) < 1e-2);
+                BOOST_CHECK(abs(kirk - exact) < 2e-1);
+                kirkError += abs(kirk - exact);
+                bjerksundStenslandError += abs(bjerksundStensland - exact);
+            }
+        }
+    }
+    BOOST_CHECK(bjerksundStenslandError < 0.25 * kirkError);
+}
+
+void SpreadOptionTest::testDeltas()
+{
+    BOOST_TEST_MESSAGE("Testing spread option analytic deltas against bumped premiums ...");
+
+    double F1 = 80, F2 = 75, sd1 = 0.35, sd2 = 0.3, rho = 0.7, df = 0.97;
+    double strikes[] = { -10, 0, 7 };
+    double h = 1e-4;
+    for (size_t i = 0; i < sizeof(strikes) / sizeof(double); ++i)
+    {
+        for (int k = 0; k < 4; ++k)
+        {
+            bool isCall = (k % 2 == 0);
+            SpreadApproximation approximation = (k < 2) ? KIRK : BJERKSUND_STENSLAND;
+            double X = strikes[i];
+            SpreadOptionDeltas deltas = isCall ?
+                SpreadCall(F1, F2, X, sd1, sd2, rho, df, approximation).getPremiumAndDeltas() :
+                SpreadPut(F1, F2, X, sd1, sd2, rho, df, approximation).getPremiumAndDeltas();
+            BOOST_CHECK(abs(deltas.premium - premium(isCall, F1, F2, X, sd1, sd2, rho, df, approximation)) < 1e-12);
+            double delta1 = (premium(isCall, F1 + h, F2, X, sd1, sd2, rho, df, approximation) -
+                premium(isCall, F1 - h, F2, X, sd1, sd2, rho, df, approximation)) / (2 * h);
+            double delta2 = (premium(isCall, F1, F2 + h, X, sd1, sd2, rho, df, approximation) -
+                premium(isCall, F1, F2 - h, X, sd1, sd2, rho, df, approximation)) / (2 * h);
+            BOOST_CHECK(abs(deltas.delta1 - delta1) < 1e-8);
+            BOOST_CHECK(abs(deltas.delta2 - delta2) < 1e-8);
+        }
+    }
+}
+
+void SpreadOptionTest::testBatchPricing()
+{
+    BOOST_TEST_MESSAGE("Testing spread option batch pricing against the option objects ...");
+
+    size_t n = 1000;
+    vector<double> F1(n), F2(n), X(n), sd1(n), sd2(n), rho(n), df(n), result(n);
+    unique_ptr<bool[]> isCall(new bool[n]);
+    for (size_t i = 0; i < n; ++i)
+    {
+        F1[i] = 70 + (i % 7) * 3.0;
+        F2[i] = 65 + (i % 11) * 2.0;
+        X[i] = -10 + (i % 23) * 1.5;
+        sd1[i] = 0.1 + (i % 13) * 0.03;
+        sd2[i] = 0.1 + (i % 5) * 0.05;
+        rho[i] = -0.5 + (i % 17) * 0.09;
+        df[i] = 1.0 - (i % 5) * 0.01;
+        isCall[i] = (i % 2 == 0);
+    }
+    for (int k = 0; k < 2; ++k)
+    {
+        SpreadApproximation approximation = (k == 0) ? KIRK : BJERKSUND_STENSLAND;
+        SpreadBatch::getPremium(n, &F1[0], &F2[0], &X[0], &sd1[0], &sd2[0], &rho[0], &df[0], isCall.get(),
+            approximation, &result[0]);
+        for (size_t i = 0; i < n; ++i)
+        {
+            double expected = premium(isCall[i], F1[i], F2[i], X[i], sd1[i], sd2[i], rho[i], df[i], approximation);
+            BOOST_CHECK(abs(result[i] - expected) < 1e-12 * max(expected, 1.0));
+        }
+    }
+
+    // A bad line is flagged as NaN without affecting its neighbours
+    X[1] = -F2[1] - 1;
+    rho[3] = 1.5;
+    SpreadBatch::getPremium(5, &F1[0], &F2[0], &X[0], &sd1[0], &sd2[0], &rho[0], &df[0], isCall.get(),
+        BJERKSUND_STENSLAND, &result[0]);
+    BOOST_CHECK(!boost::math::isnan(result[0]));
+    BOOST_CHECK(boost::math::isnan(result[1]));
+    BOOST_CHECK(!boost::math::isnan(result[2]));
+    BOOST_CHECK(boost::math::isnan(result[3]));
+    BOOST_CHECK(!boost::math::isnan(result[4]));
+
+    // As are a negative forward 2 with F2 + X still > 0, and an infinite strike, which
+    // the option objects reject
+    F2[1] = -5;
+    X[1] = 20;
+    X[3] = numeric_limits<double>::infinity();
+    rho[3] = 0.5;
+    SpreadBatch::getPremium(5, &F1[0], &F2[0], &X[0], &sd1[0], &sd2[0], &rho[0], &df[0], isCall.get(),
+        KIRK, &result[0]);
+    BOOST_CHECK_THROW(SpreadCall(F1[1], F2[1], X[1], sd1[1], sd2[1], rho[1], df[1]), runtime_error);
+    BOOST_CHECK(!boost::math::isnan(result[0]));
+    BOOST_CHECK(boost::math::isnan(result[1]));
+    BOOST_CHECK(!boost::math::isnan(result[2]));
+    BOOST_CHECK(boost::math::isnan(result[3]));
+    BOOST_CHECK(!boost::math::isnan(result[4]));
+}
+
+test_suite* SpreadOptionTest::suite() 
+{
+    test_suite* suite = BOOST_TEST_SUITE("Spread Option Pricing Suite");
+    suite->add(BOOST_TEST_CASE(&SpreadOptionTest::testPutCallParity));
+    suite->add(BOOST_TEST_CASE(&SpreadOptionTest::testMargrabe));
+    suite->add(BOOST_TEST_CASE(&SpreadOptionTest::testAgainstIntegration));
+    suite->add(BOOST_TEST_CASE(&SpreadOptionTest::testDeltas));
+    suite->add(BOOST_TEST_CASE(&SpreadOptionTest::testBatchPricing));
+
+    return suite;
+}
@@ -0,0 +1,24 @@
+#ifndef XLLBASIC_spread_option_test
+#define XLLBASIC_spread_option_test
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <boost/math/special_functions/fpclassify.hpp> // boost::math::isnan
+#include "Black76Formula.h"
+#include "SpreadOption.h"
+
+class SpreadOptionTest 
+{
+  public:
+    static void testPutCallParity();
+    static void testMargrabe();
+    static void testAgainstIntegration();
+    static void testDeltas();
+    static void testBatchPricing();
+
+    static boost::unit_test_framework::test_suite* suite();
+};
+
+#endif
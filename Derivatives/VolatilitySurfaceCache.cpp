@@ -0,0 +1,210 @@
+#include "VolatilitySurfaceCache.h"
+
+#include <string.h> // memcmp
+
+namespace XLLBasicLibrary
+{
+	/*======================================================================================
+	SurfaceCacheKey
+
+	=======================================================================================*/
+	SurfaceCacheKey::SurfaceCacheKey(string interpolationType, bool extrapolate)
+		: interpolationType(interpolationType), extrapolate(extrapolate), size(0)
+	{
+		boost::algorithm::to_lower(this->interpolationType);
+		boost::algorithm::trim(this->interpolationType);
+		// 64 bit FNV-1a offset basis, truncated on 32 bit builds
+		hash = (size_t)14695981039346656037ULL;
+		addToHash(this->interpolationType.c_str(), this->interpolationType.size());
+		addToHash(&extrapolate, sizeof(bool));
+	}
+
+	void SurfaceCacheKey::addArray(size_t rows, size_t columns, const double *array)
+	{
+		Block block = {rows, columns, array};
+		blocks.push_back(block);
+		size += rows * columns;
+		addToHash(&rows, sizeof(size_t));
+		addToHash(&columns, sizeof(size_t));
+		addToHash(array, rows * columns * sizeof(double));
+	}
+
+	void SurfaceCacheKey::copyValues()
+	{
+		if (values.size() == size)
+		{
+			return;
+		}
+		values.reserve(size);
+		for (size_t i = 0; i < blocks.size(); ++i)
+		{
+			values.insert(values.end(), blocks[i].array, blocks[i].array + blocks[i].rows * blocks[i].columns);
+			blocks[i].array = NULL;
+		}
+	}
+
+	const double *SurfaceCacheKey::getValues(const Block &block, size_t offset) const
+	{
+		return (block.array != NULL) ? block.array : values.data() + offset;
+	}
+
+	bool SurfaceCacheKey::operator==(const SurfaceCacheKey &other) const
+	{
+		if ((hash != other.hash) ||
+			(extrapolate != other.extrapolate) ||
+			(size != other.size) ||
+			(blocks.size() != other.blocks.size()) ||
+			(interpolationType != other.interpolationType))
+		{
+			return false;
+		}
+		size_t offset = 0;
+		for (size_t i = 0; i < blocks.size(); ++i)
+		{
+			const Block &block = blocks[i], &otherBlock = other.blocks[i];
+			size_t length = block.rows * block.columns;
+			if ((block.rows != otherBlock.rows) || (block.columns != otherBlock.columns) ||
+				((length > 0) &&
+				(memcmp(getValues(block, offset), other.getValues(otherBlock, offset), length * sizeof(double)) != 0)))
+			{
+				return false;
+			}
+			offset += length;
+		}
+		return true;
+	}
+
+	// FNV-1a
+	void SurfaceCacheKey::addToHash(const void *bytes, size_t length)
+	{
+		const unsigned char *p = static_cast<const unsigned char*>(bytes);
+		for (size_t i = 0; i < length; ++i)
+		{
+			hash ^= p[i];
+			hash *= (size_t)1099511628211ULL;
+		}
+	}
+
+	/*======================================================================================
+	SimpleDeltaSurfaceCache
+
+	=======================================================================================*/
+	SimpleDeltaSurfaceCache::SimpleDeltaSurfaceCache(size_t maximumSurfaces, size_t maximumValues)
+		: maximumSurfaces(max(maximumSurfaces, (size_t)1)), maximumValues(maximumValues),
+		numberOfValues(0), hits(0), misses(0), evictions(0)
+	{
+	}
+
+	shared_ptr<SimpleDeltaSurface> SimpleDeltaSurfaceCache::find(const SurfaceCacheKey &key)
+	{
+		lock_guard<mutex> guard(lock);
+		EntryList::iterator entry = locate(key);
+		if (entry == entries.end())
+		{
+			++misses;
+			return shared_ptr<SimpleDeltaSurface>();
+		}
+		++hits;
+		entries.splice(entries.begin(), entries, entry);
+		return entry->second;
+	}
+
+	void SimpleDeltaSurfaceCache::insert(const SurfaceCacheKey &key, shared_ptr<SimpleDeltaSurface> surface)
+	{
+		lock_guard<mutex> guard(lock);
+		EntryList::iterator entry = locate(key);
+		if (entry != entries.end())
+		{
+			entry->second = surface;
+			entries.splice(entries.begin(), entries, entry);
+			return;
+		}
+		entries.push_front(Entry(key, surface));
+		entries.front().first.copyValues();
+		index.insert(make_pair(key.getHash(), entries.begin()));
+		numberOfValues += key.getSize();
+		evict();
+	}
+
+	void SimpleDeltaSurfaceCache::clear()
+	{
+		lock_guard<mutex> guard(lock);
+		entries.clear();
+		index.clear();
+		numberOfValues = 0;
+	}
+
+	size_t SimpleDeltaSurfaceCache::getHits() const
+	{
+		lock_guard<mutex> guard(lock);
+		return hits;
+	}
+
+	size_t SimpleDeltaSurfaceCache::getMisses() const
+	{
+		lock_guard<mutex> guard(lock);
+		return misses;
+	}
+
+	size_t SimpleDeltaSurfaceCache::getEvictions() const
+	{
+		lock_guard<mutex> guard(lock);
+		return evictions;
+	}
+
+	size_t SimpleDeltaSurfaceCache::getNumberOfSurfaces() const
+	{
+		lock_guard<mutex> guard(lock);
+		return entries.size();
+	}
+
+	void SimpleDeltaSurfaceCache::resetCounters()
+	{
+		lock_guard<mutex> guard(lock);
+		hits = 0;
+		misses = 0;
+		evictions = 0;
+	}
+
+	SimpleDeltaSurfaceCache &SimpleDeltaSurfaceCache::getGlobalCache()
+	{
+		static SimpleDeltaSurfaceCache cache;
+		return cache;
+	}
+
+	SimpleDeltaSurfaceCache::EntryList::iterator SimpleDeltaSurfaceCache::locate(const SurfaceCacheKey &key)
+	{
+		typedef unordered_multimap<size_t, EntryList::iterator>::iterator IndexIterator;
+		pair<IndexIterator, IndexIterator> candidates = index.equal_range(key.getHash());
+		for (IndexIterator candidate = candidates.first; candidate != candidates.second; ++candidate)
+		{
+			if (candidate->second->first == key)
+			{
+				return candidate->second;
+			}
+		}
+		return entries.end();
+	}
+
+	void SimpleDeltaSurfaceCache::evict()
+	{
+		while ((entries.size() > 1) && 
+			((entries.size() > maximumSurfaces) || (numberOfValues > maximumValues)))
+		{
+			EntryList::iterator oldest = --entries.end();
+			typedef unordered_multimap<size_t, EntryList::iterator>::iterator IndexIterator;
+			pair<IndexIterator, IndexIterator> candidates = index.equal_range(oldest->first.getHash());
+			for (IndexIterator candidate = candidates.first; candidate != candidates.second; ++candidate)
+			{
+				if (candidate->second == oldest)
+				{
+					index.erase(candidate);
+					break;
+				}
+			}
+			numberOfValues -= oldest->first.getSize();
+			entries.erase(oldest);
+			++evictions;
+		}
+	}
+}
@@ -0,0 +1,115 @@
+#ifndef XLLBASIC_VOLATILITYSURFACECACHE_INCLUDED
+#define XLLBASIC_VOLATILITYSURFACECACHE_INCLUDED
+#pragma once
+
+#include <list>
+#include <memory> // shared_ptr
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "VolatilitySurfaceDelta.h"
+
+using namespace std;
+
+namespace XLLBasicLibrary
+{
+	/*======================================================================================
+	SurfaceCacheKey
+
+	The content of the inputs a surface is built from. The arrays are added as raw 
+	(rows, columns, data) blocks, in order, so that the key can be built straight from the
+	excel inputs before any of them is parsed, transposed or converted. Two keys are only 
+	equal if every value is bitwise equal; the hash is only used to find candidates.
+
+	addArray only refers to the caller's memory, so a lookup hashes and compares the 
+	inputs where they are without copying them. The arrays must outlive the key until 
+	copyValues() is called, which the cache does for the keys it holds.
+	=======================================================================================*/
+	class SurfaceCacheKey
+	{
+	public:
+		// The interpolation type is compared ignoring case and surrounding spaces, as in
+		// SimpleDeltaSurface
+		SurfaceCacheKey(string interpolationType, bool extrapolate);
+
+		void addArray(size_t rows, size_t columns, const double *array);
+		// Copies the arrays into the key so that it no longer refers to the caller's memory
+		void copyValues();
+
+		size_t getHash() const      {return hash;};
+		// The number of values in the key
+		size_t getSize() const      {return size;};
+		bool operator==(const SurfaceCacheKey &other) const;
+
+	private:
+		struct Block
+		{
+			size_t rows, columns;
+			// The caller's memory, or NULL once the values have been copied
+			const double *array;
+		};
+
+		void addToHash(const void *bytes, size_t length);
+		// The values of the block starting offset values into the key
+		const double *getValues(const Block &block, size_t offset) const;
+
+		string interpolationType;
+		bool extrapolate;
+		vector<Block> blocks;
+		vector<double> values;
+		size_t size, hash;
+	};
+
+	/*======================================================================================
+	SimpleDeltaSurfaceCache
+
+	Constructed SimpleDeltaSurfaces keyed on the content of their inputs. Thousands of
+	excel cells typically point at the same surface range; with the cache the surface (and
+	for bicubic interpolation its splines) is built once rather than on every evaluation.
+
+	Memory is bounded by both the number of surfaces and the total number of values held 
+	in their keys. When either bound is exceeded the least recently used surface is evicted.
+	The most recently inserted surface is always kept. 
+
+	Surfaces are shared, not copied, so callers must not modify a surface they get from 
+	the cache. All methods are safe to call from more than one thread.
+	=======================================================================================*/
+	class SimpleDeltaSurfaceCache
+	{
+	public:
+		SimpleDeltaSurfaceCache(size_t maximumSurfaces = 64, size_t maximumValues = 1000000);
+
+		// Returns an empty pointer (and counts a miss) if the key is not in the cache
+		shared_ptr<SimpleDeltaSurface> find(const SurfaceCacheKey &key);
+		// Replaces the surface if the key is already in the cache
+		void insert(const SurfaceCacheKey &key, shared_ptr<SimpleDeltaSurface> surface);
+		void clear();
+
+		size_t getHits() const;
+		size_t getMisses() const;
+		size_t getEvictions() const;
+		size_t getNumberOfSurfaces() const;
+		void resetCounters();
+
+		// The cache shared by the excel functions
+		static SimpleDeltaSurfaceCache &getGlobalCache();
+
+	private:
+		typedef pair<SurfaceCacheKey, shared_ptr<SimpleDeltaSurface>> Entry;
+		typedef list<Entry> EntryList;
+
+		// Returns entries.end() if the key is not in the cache. Assumes the lock is held.
+		EntryList::iterator locate(const SurfaceCacheKey &key);
+		void evict();
+
+		size_t maximumSurfaces, maximumValues;
+		// Most recently used first
+		EntryList entries;
+		unordered_multimap<size_t, EntryList::iterator> index;
+		size_t numberOfValues, hits, misses, evictions;
+		mutable mutex lock;
+	};
+}
+
+#endif
@@ -2,23 +2,226 @@
 
 namespace XLLBasicLibrary
 {
+	namespace
+	{
+		const double deltaAccuracy = 1.0e-8;
+
+		// Reads a vector of vectors the way a MatrixView is read
+		class NestedRows
+		{
+		public:
+			NestedRows(const vector<vector<double>> &rows) : rows(rows) {};
+			double operator()(size_t i, size_t j) const		{return rows[i][j];};
+
+		private:
+			const vector<vector<double>> &rows;
+		};
+
+		// Throws if the volatility is not one row per delta and one column per time
+		void checkDimensions(const vector<double> &times, const vector<double> &delta, size_t rows, size_t columns)
+		{
+			if (times.empty() || delta.empty())
+			{
+				throw runtime_error("SimpleDeltaSurface: times and delta must not be empty");
+			}
+			if ((rows != delta.size()) || (columns != times.size()))
+			{
+				throw runtime_error("SimpleDeltaSurface: volatility must have a row per delta and a column per time");
+			}
+		}
+
+		// The volatility in one Matrix, with a copy of the first column in front when a 
+		// time 0 is to be added
+		template <class Source>
+		Matrix copyVolatility(const Source &volatility, size_t rows, size_t columns, bool addTimeZero)
+		{
+			size_t offset = addTimeZero ? 1 : 0;
+			Matrix result(rows, columns + offset);
+			for (size_t i = 0; i < rows; ++i)
+			{
+				double *row = result.getRow(i);
+				for (size_t j = 0; j < columns; ++j)
+				{
+					row[j + offset] = volatility(i, j);
+				}
+				row[0] = volatility(i, 0);
+			}
+			return result;
+		}
+
+		// The surface at one time, read in place: the same curve as the GridSlice of a 
+		// DeltaSmile, for a single lookup where building the slice would cost more than
+		// the solve
+		class SurfaceSection
+		{
+		public:
+			SurfaceSection(const TwoDimensionalInterpolator &interpolator, double time)
+				: interpolator(interpolator), time(time), xIndex(interpolator.locateX(time)) {};
+
+			bool isInRange(double delta) const		{return interpolator.isInRange(time, delta);};
+			double getYStart() const				{return interpolator.getYStart();};
+			double getYEnd() const					{return interpolator.getYEnd();};
+
+			double getRate(double delta, size_t &yIndex) const
+			{
+				double slope;
+				return getRate(delta, yIndex, slope);
+			}
+
+			double getRate(double delta, size_t &yIndex, double &slope) const
+			{
+				GridCursor cursor;
+				cursor.xIndex = xIndex;
+				cursor.yIndex = yIndex;
+				double rate = interpolator.getRate(time, delta, cursor, slope);
+				yIndex = cursor.yIndex;
+				return rate;
+			}
+
+		private:
+			const TwoDimensionalInterpolator &interpolator;
+			double time;
+			size_t xIndex;
+		};
+
+		// The delta solver of DeltaSmile on any smile curve, i.e. a GridSlice or a 
+		// SurfaceSection
+		template <class Smile>
+		DeltaSolverResult solveDelta(const Smile &smile, double time, double moneyness)
+		{
+			DeltaSolverResult result = { numeric_limits<double>::quiet_NaN(), 0, false };
+			double strike = 1 + moneyness;
+			if ((time <= 0) || !(strike > 0))
+			{
+				return result;
+			}
+			double logMoneyness = -log(strike); // ln(F / X) with F = 1
+			double sqrtTime = sqrt(time);
+			double lowestDelta = smile.getYStart(), highestDelta = smile.getYEnd();
+
+			// g(low) < 0 < g(high)
+			double low = 0, high = 100, delta = 50;
+			size_t index = 0;
+			while (result.iterations < DeltaSmile::maximumIterations)
+			{
+				++result.iterations;
+				double vol, slope = 0;
+				if (smile.isInRange(delta))
+				{
+					vol = smile.getRate(delta, index, slope);
+				}
+				else
+				{
+					// Flat beyond the smile. NaN if the time is beyond the surface
+					vol = smile.getRate(min(max(delta, lowestDelta), highestDelta), index);
+				}
+				if (!(vol > 0))
+				{
+					return result;
+				}
+				double sd = vol * sqrtTime;
+				double d1 = logMoneyness / sd + sd / 2.0;
+				double g = delta - 100.0 * StandardNormal::cdf(-d1);
+				if (g == 0)
+				{
+					result.delta = delta;
+					result.converged = true;
+					return result;
+				}
+				if (g < 0)
+				{
+					low = delta;
+				}
+				else
+				{
+					high = delta;
+				}
+
+				// dg/dD = 1 + 100 n(d1) dd1/dsd dsd/dD
+				double gradient = 1.0 + 100.0 * StandardNormal::pdf(d1) * (0.5 - logMoneyness / (sd * sd)) * slope * sqrtTime;
+				// Far in the wings the root is 0 or 100 to double precision, so the ends of the
+				// bracket are allowed
+				double next = delta - g / gradient;
+				if (!(next >= low) || !(next <= high))
+				{
+					next = 0.5 * (low + high);
+				}
+				if (abs(next - delta) < deltaAccuracy)
+				{
+					result.delta = next;
+					result.converged = true;
+					return result;
+				}
+				delta = next;
+			}
+			result.delta = delta;
+			return result;
+		}
+	}
+
 	/*======================================================================================
 	SimpleDeltaSurface
 
 	=======================================================================================*/
 	SimpleDeltaSurface::SimpleDeltaSurface(
-		vector<double> timesInput,
-		vector<double> deltaInput,
-		vector<vector<double>> volatilityInput,
+		vector<double> times,
+		vector<double> delta,
+		const vector<vector<double>> &volatility,
+		bool extrapolate,
+		string interpolationType)
+		: extrapolate(extrapolate)
+	{
+		className = "SimpleDeltaSurface";
+		size_t columns = volatility.empty() ? 0 : volatility[0].size();
+		checkDimensions(times, delta, volatility.size(), columns);
+		for (size_t i = 0; i < volatility.size(); ++i)
+		{
+			if (volatility[i].size() != columns)
+			{
+				throw runtime_error(className + ": Columns do not have consistent dimension");
+			}
+		}
+		Matrix matrix = copyVolatility(NestedRows(volatility), volatility.size(), columns, times[0] > 0);
+		initialise(times, delta, matrix, interpolationType);
+	}
+
+	SimpleDeltaSurface::SimpleDeltaSurface(
+		vector<double> times,
+		vector<double> delta,
+		const MatrixView &volatility,
+		bool extrapolate,
+		string interpolationType)
+		: extrapolate(extrapolate)
+	{
+		className = "SimpleDeltaSurface";
+		checkDimensions(times, delta, volatility.getRows(), volatility.getColumns());
+		Matrix matrix = copyVolatility(volatility, volatility.getRows(), volatility.getColumns(), times[0] > 0);
+		initialise(times, delta, matrix, interpolationType);
+	}
+
+	SimpleDeltaSurface::SimpleDeltaSurface(
+		vector<double> times,
+		vector<double> delta,
+		Matrix volatility,
 		bool extrapolate,
 		string interpolationType)
-		: extrapolate(extrapolate), times(timesInput), delta(deltaInput), volatility(volatilityInput)
+		: extrapolate(extrapolate)
 	{
 		className = "SimpleDeltaSurface";
-		string errorMessage;
-		if (!checkAndTransformInputs(errorMessage))
+		checkDimensions(times, delta, volatility.getRows(), volatility.getColumns());
+		if (times[0] > 0)
 		{
-			throw runtime_error(errorMessage);
+			volatility = copyVolatility(volatility, volatility.getRows(), volatility.getColumns(), true);
+		}
+		initialise(times, delta, volatility, interpolationType);
+	}
+
+	void SimpleDeltaSurface::initialise(vector<double> &times, vector<double> &delta, Matrix &volatility, string interpolationType)
+	{
+		string reasonForFailure;
+		if (!checkAndTransformInputs(times, delta, volatility, reasonForFailure))
+		{
+			throw runtime_error(reasonForFailure);
 		}
 
 		boost::algorithm::to_lower(interpolationType);
@@ -28,18 +231,18 @@ namespace XLLBasicLibrary
 		{
 			interpolator = shared_ptr<TwoDimensionalInterpolator>(
 				new BilinearInterpolator(
-					times,
-					delta,
-					volatility,
+					std::move(times),
+					std::move(delta),
+					std::move(volatility),
 					extrapolate));
 		}
 		else if (interpolationType.compare("bicubic") == 0)
 		{
 			interpolator = shared_ptr<TwoDimensionalInterpolator>(
 				new BicubicInterpolator(
-					times,
-					delta,
-					volatility,
+					std::move(times),
+					std::move(delta),
+					std::move(volatility),
 					extrapolate));
 		}
 		else
@@ -50,6 +253,23 @@ namespace XLLBasicLibrary
 
 	bool SimpleDeltaSurface::checkAndTransformInputs(string &reasonForFailure)
 	{
+		// The interpolator only ever holds inputs that have been through the static form
+		reasonForFailure = "";
+		return true;
+	}
+
+	bool SimpleDeltaSurface::checkAndTransformInputs(
+		vector<double> &times, 
+		vector<double> &delta, 
+		Matrix &volatility, 
+		string &reasonForFailure)
+	{
+		size_t columns = (!times.empty() && (times[0] > 0)) ? times.size() + 1 : times.size();
+		if (times.empty() || delta.empty() || (volatility.getRows() != delta.size()) || (volatility.getColumns() != columns))
+		{
+			reasonForFailure = "SimpleDeltaSurface: volatility must have a row per delta and a column per time";
+			return false;
+		}
 		if (delta[0] < 1.0)
 		{
 			for (size_t i = 0; i < delta.size(); ++i)
@@ -57,24 +277,21 @@ namespace XLLBasicLibrary
 				delta[i] *= 100;
 			}
 		}
-		// insert data at time 0 to ensure we can find sort dated volatility
+		// insert data at time 0 to ensure we can find sort dated volatility. The column
+		// for it is already in the volatility
 		if (times[0] > 0)
 		{
 			times.insert(times.begin(), 0);
-			for (size_t i = 0; i < volatility.size(); ++i)
-			{
-				double vol = volatility[i][0];
-				volatility[i].insert(volatility[i].begin(), vol);
-			}
 		}
 		// Vol is probably an integer not a decimal so change it
-		if (volatility[0][0] > 2.0)
+		if (volatility(0, 0) > 2.0)
 		{
-			for (size_t i = 0; i < volatility.size(); ++i)
+			for (size_t i = 0; i < volatility.getRows(); ++i)
 			{
-				for (size_t j = 0; j < volatility[i].size(); ++j)
+				double *row = volatility.getRow(i);
+				for (size_t j = 0; j < volatility.getColumns(); ++j)
 				{
-					volatility[i][j] /= 100;
+					row[j] /= 100;
 				}
 			}
 		}
@@ -92,24 +309,13 @@ namespace XLLBasicLibrary
 
 	bool SimpleDeltaSurface::isInMoneynessRange(double time, double moneyness)
 	{
-		if (extrapolate)
-		{
-			return true;
-		}
-		double fwd = 1;
-		double strike = moneyness + fwd;
-		double vol = calculateDeltaFromStrike(fwd, strike, time);
-		if (abs(vol)<1e-8)
-		{
-			return false;
-		}
-		return true;
+		DeltaSolverResult result = solveDeltaForMoneyness(time, moneyness);
+		return result.converged && interpolator->isInRange(time, result.delta);
 	}
 
 	double SimpleDeltaSurface::getVolatility(double time) const
 	{
-		double delta = calculateDeltaFromStrike(1, 1, time);
-		return getVolatilityForDelta(time, delta);
+		return getVolatilityForMoneyness(time, 0);
 	}
 
 	double SimpleDeltaSurface::getVolatilityForDelta(double time, double delta) const
@@ -127,35 +333,82 @@ namespace XLLBasicLibrary
 		{
 			return 0;
 		}
-		double fwd = 1;
-		double strike = moneyness + fwd;
-		double delta = calculateDeltaFromStrike(fwd, strike, time);
-		return getVolatilityForDelta(time, delta);
+		// As DeltaSmile::getVolatilityForMoneyness, on the surface itself
+		DeltaSolverResult result = solveDeltaForMoneyness(time, moneyness);
+		if (!result.converged)
+		{
+			return numeric_limits<double>::quiet_NaN();
+		}
+		return interpolator->getRate(time, result.delta);
 	}
 
-	// will return 0 if outside the interpolation range
-	double SimpleDeltaSurface::calculateDeltaFromStrike(double forward, double strike, double time) const
+	void SimpleDeltaSurface::getVolatilityForMoneyness(double time, size_t n, const double *moneyness, double *volatility) const
 	{
-		double accuracy = 1.0e-8;
-		size_t maxItterates = 20;
-		double sqrtttm = sqrt(time);
-		double guess1 = 50, guess2 = 50;
-		double vol1 = 0, sd1 = 0.2, diff = accuracy + 1;
-		Black76Put put(forward, strike, sd1, 1);
-		size_t counter = 0;
-		while ((counter < maxItterates) && (diff > accuracy))
+		DeltaSmile smile = getSmile(time);
+		for (size_t i = 0; i < n; ++i)
 		{
-			guess1 = guess2;
-			if (interpolator->isInRange(time, guess1))
-			{
-				vol1 = (*interpolator).getRate(time, guess1);
-			}
-			sd1 = vol1 * sqrtttm;
-			put.setStandardDeviation(sd1);
-			guess2 = -put.getDelta() * 100;
-			diff = abs(guess1 - guess2);
-			++counter;
+			volatility[i] = smile.getVolatilityForMoneyness(moneyness[i]);
+		}
+	}
+
+	DeltaSolverResult SimpleDeltaSurface::solveDeltaForMoneyness(double time, double moneyness) const
+	{
+		return solveDelta(SurfaceSection(*interpolator, time), time, moneyness);
+	}
+
+	DeltaSmile SimpleDeltaSurface::getSmile(double time) const
+	{
+		return DeltaSmile(time, interpolator->getSlice(time), extrapolate);
+	}
+
+	/*======================================================================================
+	DeltaSmile
+
+	=======================================================================================*/
+	const size_t DeltaSmile::maximumIterations;
+
+	DeltaSmile::DeltaSmile(double time, GridSlice slice, bool extrapolate)
+		: time(time), slice(std::move(slice)), extrapolate(extrapolate)
+	{
+	}
+
+	bool DeltaSmile::isInDeltaRange(double delta) const
+	{
+		return slice.isInRange(delta);
+	}
+
+	bool DeltaSmile::isInMoneynessRange(double moneyness) const
+	{
+		DeltaSolverResult result = solveDeltaForMoneyness(moneyness);
+		return result.converged && slice.isInRange(result.delta);
+	}
+
+	double DeltaSmile::getVolatility() const
+	{
+		return getVolatilityForMoneyness(0);
+	}
+
+	double DeltaSmile::getVolatilityForDelta(double delta) const
+	{
+		return slice.getRate(delta);
+	}
+
+	double DeltaSmile::getVolatilityForMoneyness(double moneyness) const
+	{
+		if (time <= 0)
+		{
+			return 0;
+		}
+		DeltaSolverResult result = solveDeltaForMoneyness(moneyness);
+		if (!result.converged)
+		{
+			return numeric_limits<double>::quiet_NaN();
 		}
-		return guess2;
+		return getVolatilityForDelta(result.delta);
+	}
+
+	DeltaSolverResult DeltaSmile::solveDeltaForMoneyness(double moneyness) const
+	{
+		return solveDelta(slice, time, moneyness);
 	}
-}
\ No newline at end of file
+}
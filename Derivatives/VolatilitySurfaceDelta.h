@@ -3,8 +3,8 @@
 #pragma once
 
 #include <vector>
-#include <boost\algorithm\string.hpp>
-#include "..\Maths\TwoDimensionalInterpolation.h"
+#include <boost/algorithm/string.hpp>
+#include "../Maths/TwoDimensionalInterpolation.h"
 #include "Black76Formula.h"
 
 using namespace std;
@@ -12,6 +12,60 @@ using namespace std;
 namespace XLLBasicLibrary
 {
 
+	struct DeltaSolverResult
+	{
+		// NaN if no volatility could be found for the strike
+		double delta;
+		size_t iterations;
+		bool converged;
+	};
+
+	/*======================================================================================
+	DeltaSmile
+
+	The smile of a SimpleDeltaSurface at one time, from SimpleDeltaSurface::getSmile. The
+	surface is interpolated in time once, when the smile is built, so every strike of an
+	expiry is solved for its delta against the same one dimensional delta -> volatility 
+	curve. The surface's own single lookups use the same solver on the surface itself.
+
+	The delta of a strike is the root of
+		g(D) = D - 100 N(-d1(D)),  d1 = ln(F / X) / sd + sd / 2,  sd = vol(D) sqrt(t)
+	g(0) < 0 < g(100), so the root is bracketed. It is found by Newton's method, with the 
+	slope of the smile from the interpolating polynomial, falling back to bisection when a 
+	step leaves the bracket. It typically takes 3 to 5 iterations where the fixed point
+	D -> 100 N(-d1(D)) it replaces needed up to 20, and could stop unconverged, in the wings
+	and at short expiries. The volatility is held flat beyond the smile's deltas unless 
+	the surface extrapolates. A strike whose solve does not converge, or converges outside
+	the smile, has a NaN volatility and is not in the moneyness range. With extrapolation
+	this happens where the smile reaches zero volatility before the strike's delta, e.g.
+	far in the wing of a steep skew. Callers that need the reason should solve once with 
+	solveDeltaForMoneyness and read the volatility for the delta found.
+	=======================================================================================*/
+	class DeltaSmile
+	{
+	public:
+		static const size_t maximumIterations = 60;
+
+		DeltaSmile(double time, GridSlice slice, bool extrapolate);
+
+		double getTime() const		{return time;};
+
+		bool isInDeltaRange(double delta) const;
+		bool isInMoneynessRange(double moneyness) const;
+
+		double getVolatility() const;
+		double getVolatilityForDelta(double delta) const;
+		double getVolatilityForMoneyness(double moneyness) const;
+
+		// The (put) delta, as a percentage, of the strike (1 + moneyness) * F
+		DeltaSolverResult solveDeltaForMoneyness(double moneyness) const;
+
+	private:
+		double time;
+		GridSlice slice;
+		bool extrapolate;
+	};
+
 	/*======================================================================================
 	SimpleDeltaSurface
 
@@ -21,19 +75,46 @@ namespace XLLBasicLibrary
 	- Time is assumed to be a year fraction.
 
 	Moneyness = (strike - forward) / forward
+
+	A moneyness lookup solves for the delta of the strike as DeltaSmile does, reading the
+	surface's cells in place so that a single lookup allocates nothing. For many strikes on
+	one expiry get the DeltaSmile at that time, which interpolates in time once, or use the
+	batch getVolatilityForMoneyness, which does so.
+
+	The volatility has a row per delta and a column per time. The surface keeps it as one
+	Matrix, inside its interpolator, adding a column at time 0 (a copy of the first) if 
+	the first time is > 0. The view and vector of vectors constructors build that Matrix 
+	in a single copy of the input. A Matrix passed as an rvalue is moved straight into the 
+	interpolator when no column needs adding. Throws a runtime_error if the dimensions do
+	not match.
 	=======================================================================================*/
 	class SimpleDeltaSurface
 	{
 	public:
 		SimpleDeltaSurface(vector<double> times,
 			vector<double> delta,
-			vector<vector<double>> volatility,
+			const vector<vector<double>> &volatility,
+			bool extrapolate,
+			string interpolationType);
+		SimpleDeltaSurface(vector<double> times,
+			vector<double> delta,
+			const MatrixView &volatility,
+			bool extrapolate,
+			string interpolationType);
+		SimpleDeltaSurface(vector<double> times,
+			vector<double> delta,
+			Matrix volatility,
 			bool extrapolate,
 			string interpolationType);
 
 		// try to change inputs so they are consistent with the class requirements
-		// return false if unable to do this
+		// return false if unable to do this. The constructors do this to their inputs, and
+		// throw if unable, so for a constructed surface it always returns true.
 		bool checkAndTransformInputs(string &reasonForFailure);
+		// As above on the constructor inputs, with the volatility already holding the 
+		// column for time 0 when times[0] > 0
+		static bool checkAndTransformInputs(vector<double> &times, vector<double> &delta, Matrix &volatility, 
+			string &reasonForFailure);
 
 		bool isInDeltaRange(double time, double delta);
 		bool isInMoneynessRange(double time, double moneyness);
@@ -41,15 +122,21 @@ namespace XLLBasicLibrary
 		double getVolatility(double time) const;
 		double getVolatilityForDelta(double time, double delta) const;
 		double getVolatilityForMoneyness(double time, double moneyness) const;
+		// n strikes on the one expiry
+		void getVolatilityForMoneyness(double time, size_t n, const double *moneyness, double *volatility) const;
+
+		// As DeltaSmile::solveDeltaForMoneyness at the time
+		DeltaSolverResult solveDeltaForMoneyness(double time, double moneyness) const;
+
+		DeltaSmile getSmile(double time) const;
 
 	private:
-		double calculateDeltaFromStrike(double forward, double strike, double time) const;
+		// Converts the inputs to the class's conventions and builds the interpolator
+		void initialise(vector<double> &times, vector<double> &delta, Matrix &volatility, string interpolationType);
 
 		bool extrapolate;
-		vector<double> times, delta;
-		vector<vector<double>> volatility;
 		shared_ptr<TwoDimensionalInterpolator> interpolator;
-		string interpolationType, className;
+		string className;
 	};
 }
 
@@ -48,6 +48,334 @@ void VolatilitySurfacesDeltaTest::testSimpleDeltaSurfaceConstruction()
 	BOOST_REQUIRE(vs->isInMoneynessRange(time, moneyness));
 	cout << "Vol: " << vs->getVolatilityForMoneyness(time, moneyness);
 	BOOST_CHECK(abs(vs->getVolatilityForMoneyness(time, moneyness) - 0.234807) < 1e-6);
+
+	// The same surface from a view of the volatility stored time by time, i.e. transposed,
+	// and from a Matrix moved in
+	vector<double> byTime;
+	for (size_t j = 0; j < observationTimes.size(); ++j)
+	{
+		for (size_t i = 0; i < delta.size(); ++i)
+		{
+			byTime.push_back(volatility[i][j]);
+		}
+	}
+	MatrixView view(&byTime[0], delta.size(), observationTimes.size(), true);
+	SimpleDeltaSurface fromView(observationTimes, delta, view, false, "bilinear");
+	SimpleDeltaSurface fromMatrix(observationTimes, delta, Matrix(volatility), false, "bilinear");
+	for (double t = 0.05; t < 2; t += 0.1)
+	{
+		for (double d = 10; d <= 90; d += 5)
+		{
+			BOOST_CHECK(fromView.getVolatilityForDelta(t, d) == vs->getVolatilityForDelta(t, d));
+			BOOST_CHECK(fromMatrix.getVolatilityForDelta(t, d) == vs->getVolatilityForDelta(t, d));
+		}
+	}
+	BOOST_CHECK_THROW(SimpleDeltaSurface(observationTimes, delta, Matrix(5, 5, 0.2), false, "bilinear"), runtime_error);
+
+	// Deltas as fractions and volatilities as percentages are converted, with a time 0 added
+	string reason;
+	BOOST_CHECK(vs->checkAndTransformInputs(reason));
+	vector<double> fractionTimes(1, 0.5), fractionDeltas(2);
+	fractionDeltas[0] = 0.25;
+	fractionDeltas[1] = 0.75;
+	Matrix percentages(2, 2, 20.0);
+	BOOST_REQUIRE(SimpleDeltaSurface::checkAndTransformInputs(fractionTimes, fractionDeltas, percentages, reason));
+	BOOST_CHECK((fractionTimes.size() == 2) && (fractionTimes[0] == 0));
+	BOOST_CHECK((fractionDeltas[0] == 25) && (fractionDeltas[1] == 75));
+	BOOST_CHECK(percentages(1, 1) == 0.2);
+	Matrix wrongShape(3, 2, 0.2);
+	BOOST_CHECK(!SimpleDeltaSurface::checkAndTransformInputs(fractionTimes, fractionDeltas, wrongShape, reason));
+	BOOST_CHECK(!reason.empty());
+}
+
+void VolatilitySurfacesDeltaTest::testSurfaceCache()
+{
+    BOOST_TEST_MESSAGE("Testing SimpleDeltaSurfaceCache hits, misses and LRU eviction ...");
+
+    vector<double> observationTimes;
+    observationTimes += 1.0 / 12.0, 0.25, 1.0;
+    vector<double> delta;
+    delta += 25, 50, 75;
+    vector<double> v1, v2, v3;
+    v1 += .18, .19, .22;
+    v2 += .17, .18, .20;
+    v3 += .19, .21, .25;
+    vector<vector<double>> volatility;
+    volatility += v1, v2, v3;
+    double flatVolatility[9];
+    for (size_t i = 0; i < 3; ++i)
+    {
+        for (size_t j = 0; j < 3; ++j)
+        {
+            flatVolatility[3 * i + j] = volatility[i][j];
+        }
+    }
+
+    SimpleDeltaSurfaceCache cache(2);
+    SurfaceCacheKey key("Bicubic", true);
+    key.addArray(1, 3, &observationTimes[0]);
+    key.addArray(3, 1, &delta[0]);
+    key.addArray(3, 3, flatVolatility);
+    BOOST_CHECK(!cache.find(key));
+    shared_ptr<SimpleDeltaSurface> surface(
+        new SimpleDeltaSurface(observationTimes, delta, volatility, true, "bicubic"));
+    cache.insert(key, surface);
+
+    // Same content built from different memory, with the type spelt differently
+    vector<double> timesCopy(observationTimes);
+    SurfaceCacheKey sameKey(" bicubic", true);
+    sameKey.addArray(1, 3, &timesCopy[0]);
+    sameKey.addArray(3, 1, &delta[0]);
+    sameKey.addArray(3, 3, flatVolatility);
+    BOOST_CHECK(cache.find(sameKey) == surface);
+
+    // The cache holds its own copy of the values: key still refers to flatVolatility, so
+    // changing that makes it a different key
+    double savedVolatility = flatVolatility[4];
+    flatVolatility[4] = 0.5;
+    BOOST_CHECK(!cache.find(key));
+    flatVolatility[4] = savedVolatility;
+
+    // The same values in a different shape, or with a different flag, are different keys
+    SurfaceCacheKey transposedKey("bicubic", true);
+    transposedKey.addArray(3, 1, &observationTimes[0]);
+    transposedKey.addArray(3, 1, &delta[0]);
+    transposedKey.addArray(3, 3, flatVolatility);
+    BOOST_CHECK(!cache.find(transposedKey));
+    SurfaceCacheKey bilinearKey("bilinear", true);
+    bilinearKey.addArray(1, 3, &observationTimes[0]);
+    bilinearKey.addArray(3, 1, &delta[0]);
+    bilinearKey.addArray(3, 3, flatVolatility);
+    BOOST_CHECK(!cache.find(bilinearKey));
+    BOOST_CHECK(cache.getHits() == 1);
+    BOOST_CHECK(cache.getMisses() == 4);
+
+    // With room for two surfaces, touching the first makes the second the one evicted
+    cache.insert(transposedKey, surface);
+    BOOST_CHECK(cache.find(key));
+    cache.insert(bilinearKey, surface);
+    BOOST_CHECK(cache.getNumberOfSurfaces() == 2);
+    BOOST_CHECK(cache.getEvictions() == 1);
+    BOOST_CHECK(cache.find(key));
+    BOOST_CHECK(!cache.find(transposedKey));
+
+    // A bound on the number of values keeps only the latest surface
+    SimpleDeltaSurfaceCache smallCache(10, 20);
+    smallCache.insert(key, surface);
+    smallCache.insert(bilinearKey, surface);
+    BOOST_CHECK(smallCache.getNumberOfSurfaces() == 1);
+    BOOST_CHECK(smallCache.find(bilinearKey));
+}
+
+void VolatilitySurfacesDeltaTest::testSmiles()
+{
+    BOOST_TEST_MESSAGE("Testing DeltaSmile against SimpleDeltaSurface ...");
+
+    vector<double> observationTimes;
+    observationTimes += 1.0 / 12.0, 2.0 / 12.0, 0.25, 0.5, 1.0, 2.0;
+    vector<double> delta;
+    delta += 10, 25, 50, 75, 90;
+    vector<double> v1, v2, v3, v4, v5;
+    v1 += .17938,   .182884,    .193908,    .219688,    .248396,    .263268;
+    v2 += .17575,   .17575,     .18247,     .206225,    .234775,    .2475;
+    v3 += .175,     .175,       .18,        .205,       .235,       .2475;
+    v4 += .18825,   .18825,     .19547,     .223725,    .223725,    .2725;
+    v5 += .20128,   .204784,    .216708,    .250288,    .287796,    .307068;
+    vector<vector<double>> volatility;
+    volatility += v1, v2, v3, v4, v5;
+
+    // A chain of 100 strikes from 70 to 130 on a forward of 100
+    vector<double> moneyness(100);
+    for (size_t i = 0; i < moneyness.size(); ++i)
+    {
+        moneyness[i] = -0.3 + 0.6 * i / 99.0;
+    }
+
+    string types[2] = { "bilinear", "bicubic" };
+    double times[] = { 0.0, 0.05, 1.0 / 12.0, 0.3, 1.0, 1.7, 2.5 };
+    for (int extrapolate = 0; extrapolate < 2; ++extrapolate)
+    {
+        for (size_t k = 0; k < 2; ++k)
+        {
+            SimpleDeltaSurface surface(observationTimes, delta, volatility, extrapolate == 1, types[k]);
+            for (size_t t = 0; t < sizeof(times) / sizeof(double); ++t)
+            {
+                DeltaSmile smile = surface.getSmile(times[t]);
+                if (times[t] == 0)
+                {
+                    BOOST_CHECK(smile.getVolatilityForMoneyness(0.1) == 0);
+                    continue;
+                }
+                // Beyond the last time without extrapolation there is no volatility to solve with
+                if ((extrapolate == 0) && (times[t] > 2))
+                {
+                    BOOST_CHECK(boost::math::isnan(surface.getVolatilityForMoneyness(times[t], 0.1)));
+                    BOOST_CHECK(!smile.isInMoneynessRange(0.1));
+                    DeltaSolverResult result = smile.solveDeltaForMoneyness(0.1);
+                    BOOST_CHECK(!result.converged && boost::math::isnan(result.delta));
+                    continue;
+                }
+                BOOST_CHECK(smile.getTime() == times[t]);
+                vector<double> batch(moneyness.size());
+                surface.getVolatilityForMoneyness(times[t], moneyness.size(), &moneyness[0], &batch[0]);
+                for (size_t i = 0; i < moneyness.size(); ++i)
+                {
+                    double expected = surface.getVolatilityForMoneyness(times[t], moneyness[i]);
+                    BOOST_CHECK(smile.isInMoneynessRange(moneyness[i]) == surface.isInMoneynessRange(times[t], moneyness[i]));
+                    if (boost::math::isnan(expected))
+                    {
+                        BOOST_CHECK(boost::math::isnan(smile.getVolatilityForMoneyness(moneyness[i])));
+                        BOOST_CHECK(boost::math::isnan(batch[i]));
+                        continue;
+                    }
+                    BOOST_CHECK_MESSAGE(abs(smile.getVolatilityForMoneyness(moneyness[i]) - expected) < 1e-12,
+                        types[k] << " smile at " << times[t] << ", moneyness " << moneyness[i] << ": "
+                        << smile.getVolatilityForMoneyness(moneyness[i]) << " against " << expected);
+                    BOOST_CHECK(batch[i] == smile.getVolatilityForMoneyness(moneyness[i]));
+                }
+                for (double d = 5; d <= 95; d += 5)
+                {
+                    BOOST_CHECK(smile.isInDeltaRange(d) == surface.isInDeltaRange(times[t], d));
+                }
+                BOOST_CHECK(abs(smile.getVolatility() - surface.getVolatility(times[t])) < 1e-12);
+            }
+        }
+    }
+
+    // The chain solved against the surface and against one smile
+    SimpleDeltaSurface surface(observationTimes, delta, volatility, false, "bicubic");
+    vector<double> chain(moneyness.size());
+    surface.getVolatilityForMoneyness(0.75, moneyness.size(), &moneyness[0], &chain[0]);
+    double total = 0, smileTotal = 0;
+    for (size_t i = 0; i < moneyness.size(); ++i)
+    {
+        double vol = surface.getVolatilityForMoneyness(0.75, moneyness[i]);
+        total += boost::math::isnan(vol) ? 0 : vol;
+        smileTotal += boost::math::isnan(chain[i]) ? 0 : chain[i];
+    }
+    BOOST_CHECK(abs(total - smileTotal) < 1e-9 * total);
+}
+
+namespace
+{
+    // The fixed point iteration the Newton solver replaced, for comparison
+    double fixedPointDelta(SimpleDeltaSurface &surface, double time, double moneyness, size_t &iterations, bool &converged)
+    {
+        double guess1 = 50, guess2 = 50;
+        double vol1 = 0, diff = 1;
+        for (iterations = 0; (iterations < 20) && (diff > 1e-8); ++iterations)
+        {
+            guess1 = guess2;
+            if (surface.isInDeltaRange(time, guess1))
+            {
+                vol1 = surface.getVolatilityForDelta(time, guess1);
+            }
+            Black76Put put(1, 1 + moneyness, vol1 * sqrt(time), 1);
+            guess2 = -put.getDelta() * 100;
+            diff = abs(guess1 - guess2);
+        }
+        converged = diff <= 1e-8;
+        return guess2;
+    }
+}
+
+void VolatilitySurfacesDeltaTest::testDeltaSolver()
+{
+    BOOST_TEST_MESSAGE("Testing the delta solver against the fixed point iteration ...");
+
+    vector<double> observationTimes;
+    observationTimes += 1.0 / 12.0, 2.0 / 12.0, 0.25, 0.5, 1.0, 2.0;
+    vector<double> delta;
+    delta += 10, 25, 50, 75, 90;
+    vector<double> v1, v2, v3, v4, v5;
+    v1 += .27938,   .252884,    .233908,    .219688,    .248396,    .263268;
+    v2 += .20575,   .19575,     .18247,     .206225,    .234775,    .2475;
+    v3 += .175,     .175,       .18,        .205,       .235,       .2475;
+    v4 += .22825,   .20825,     .19547,     .223725,    .223725,    .2725;
+    v5 += .35128,   .304784,    .266708,    .250288,    .287796,    .307068;
+    vector<vector<double>> volatility;
+    volatility += v1, v2, v3, v4, v5;
+
+    string types[2] = { "bilinear", "bicubic" };
+    // Two days to two years, with strikes from deep in the put wing to deep in the call wing
+    double times[] = { 2.0 / 365.0, 7.0 / 365.0, 1.0 / 12.0, 0.5, 1.0, 2.0 };
+    for (size_t k = 0; k < 2; ++k)
+    {
+        SimpleDeltaSurface surface(observationTimes, delta, volatility, false, types[k]);
+        size_t solves = 0, iterations = 0, maximumIterations = 0;
+        size_t referenceIterations = 0;
+        for (size_t t = 0; t < sizeof(times) / sizeof(double); ++t)
+        {
+            DeltaSmile smile = surface.getSmile(times[t]);
+            for (double moneyness = -0.5; moneyness <= 0.8; moneyness += 0.01)
+            {
+                DeltaSolverResult result = smile.solveDeltaForMoneyness(moneyness);
+                BOOST_REQUIRE(result.converged);
+                ++solves;
+                iterations += result.iterations;
+                maximumIterations = max(maximumIterations, result.iterations);
+
+                // The result is a root: the delta of the strike at the volatility for its delta
+                double vol = surface.getVolatilityForDelta(times[t], min(max(result.delta, 10.0), 90.0));
+                Black76Put put(1, 1 + moneyness, vol * sqrt(times[t]), 1);
+                BOOST_CHECK_MESSAGE(abs(result.delta + 100 * put.getDelta()) < 1e-7,
+                    types[k] << " at " << times[t] << ", moneyness " << moneyness << ": delta " << result.delta
+                    << " is not a root");
+
+                size_t fixedPointIterations;
+                bool fixedPointConverged;
+                double fixedPoint = fixedPointDelta(surface, times[t], moneyness, fixedPointIterations, fixedPointConverged);
+                referenceIterations += fixedPointIterations;
+                if (fixedPointConverged && (fixedPoint >= 10) && (fixedPoint <= 90))
+                {
+                    BOOST_CHECK(abs(fixedPoint - result.delta) < 1e-6);
+                }
+            }
+        }
+        BOOST_CHECK(iterations < referenceIterations);
+        BOOST_CHECK(maximumIterations <= 10);
+    }
+}
+
+void VolatilitySurfacesDeltaTest::testSteepSkew()
+{
+    BOOST_TEST_MESSAGE("Testing strikes beyond where an extrapolated steep skew reaches zero volatility ...");
+
+    // Extrapolated past 90 delta the smile goes through zero, so no volatility gives a 
+    // strike far above the forward its delta
+    vector<double> observationTimes;
+    observationTimes += 30.0 / 365.0, 90.0 / 365.0;
+    vector<double> delta;
+    delta += 10, 25, 50, 75, 90;
+    vector<double> v1, v2, v3, v4, v5;
+    v1 += 20, 20;
+    v2 += 18, 18;
+    v3 += 14, 14;
+    v4 += 10, 10;
+    v5 += 2, 2;
+    vector<vector<double>> volatility;
+    volatility += v1, v2, v3, v4, v5;
+
+    string types[2] = { "bilinear", "bicubic" };
+    double time = 60.0 / 365.0;
+    for (size_t k = 0; k < 2; ++k)
+    {
+        SimpleDeltaSurface surface(observationTimes, delta, volatility, true, types[k]);
+        DeltaSmile smile = surface.getSmile(time);
+        BOOST_CHECK(surface.solveDeltaForMoneyness(time, 0).converged);
+        BOOST_CHECK(surface.getVolatilityForMoneyness(time, 0) > 0);
+        double moneyness[] = { 0.3, 1.0 };
+        for (size_t i = 0; i < 2; ++i)
+        {
+            DeltaSolverResult result = surface.solveDeltaForMoneyness(time, moneyness[i]);
+            BOOST_CHECK(!result.converged && boost::math::isnan(result.delta));
+            BOOST_CHECK(!smile.solveDeltaForMoneyness(moneyness[i]).converged);
+            BOOST_CHECK(!surface.isInMoneynessRange(time, moneyness[i]));
+            BOOST_CHECK(!smile.isInMoneynessRange(moneyness[i]));
+            BOOST_CHECK(boost::math::isnan(surface.getVolatilityForMoneyness(time, moneyness[i])));
+            BOOST_CHECK(boost::math::isnan(smile.getVolatilityForMoneyness(moneyness[i])));
+        }
+    }
 }
 
 test_suite* VolatilitySurfacesDeltaTest::suite() 
@@ -55,6 +383,10 @@ test_suite* VolatilitySurfacesDeltaTest::suite()
     test_suite* suite = BOOST_TEST_SUITE("Volatility Surfaces");
         
     suite->add(BOOST_TEST_CASE(&VolatilitySurfacesDeltaTest::testSimpleDeltaSurfaceConstruction));
+    suite->add(BOOST_TEST_CASE(&VolatilitySurfacesDeltaTest::testSurfaceCache));
+    suite->add(BOOST_TEST_CASE(&VolatilitySurfacesDeltaTest::testSmiles));
+    suite->add(BOOST_TEST_CASE(&VolatilitySurfacesDeltaTest::testDeltaSolver));
+    suite->add(BOOST_TEST_CASE(&VolatilitySurfacesDeltaTest::testSteepSkew));
     
     return suite;
 }
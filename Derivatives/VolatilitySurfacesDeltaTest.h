@@ -2,15 +2,20 @@
 #define sjdvolatilitysurfaces_test_maths
 
 #include <iostream>
-#include <boost\test\unit_test.hpp>
-#include <boost\math\special_functions\fpclassify.hpp> // boost::math::isnan
+#include <boost/test/unit_test.hpp>
+#include <boost/math/special_functions/fpclassify.hpp> // boost::math::isnan
 #include "VolatilitySurfaceDelta.h"
+#include "VolatilitySurfaceCache.h"
 
 
 class VolatilitySurfacesDeltaTest 
 {
   public:      
     static void testSimpleDeltaSurfaceConstruction();
+    static void testSurfaceCache();
+    static void testSmiles();
+    static void testDeltaSolver();
+    static void testSteepSkew();
 
     static boost::unit_test_framework::test_suite* suite();
 
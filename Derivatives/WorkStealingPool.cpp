@@ -0,0 +1,179 @@
+#include "WorkStealingPool.h"
+
+#include <algorithm> // min
+
+namespace XLLBasicLibrary
+{
+	WorkStealingPool::WorkStealingPool(size_t threadCount)
+		: threadCount(threadCount), body(NULL), n(0), grainSize(1), failed(false),
+		generation(0), busyWorkers(0), stopping(false)
+	{
+		if (this->threadCount == 0)
+		{
+			this->threadCount = max(thread::hardware_concurrency(), 1u);
+		}
+		queues.reset(new ChunkQueue[this->threadCount]);
+		// Thread 0 is whichever thread calls parallelFor
+		for (size_t i = 1; i < this->threadCount; ++i)
+		{
+			threads.push_back(thread(&WorkStealingPool::workerLoop, this, i));
+		}
+	}
+
+	WorkStealingPool::~WorkStealingPool()
+	{
+		{
+			lock_guard<mutex> guard(stateLock);
+			stopping = true;
+		}
+		loopStarted.notify_all();
+		for (size_t i = 0; i < threads.size(); ++i)
+		{
+			threads[i].join();
+		}
+	}
+
+	void WorkStealingPool::parallelFor(size_t n, size_t grainSize, const function<void(size_t, size_t)> &body)
+	{
+		if (n == 0)
+		{
+			return;
+		}
+		lock_guard<mutex> loopGuard(loopLock);
+		this->body = &body;
+		this->n = n;
+		this->grainSize = max(grainSize, (size_t)1);
+		failed = false;
+		error = exception_ptr();
+
+		size_t chunks = (n + this->grainSize - 1) / this->grainSize;
+		size_t workers = min(threadCount, chunks);
+		for (size_t i = 0; i < threadCount; ++i)
+		{
+			lock_guard<mutex> guard(queues[i].lock);
+			queues[i].begin = min(chunks * i / workers, chunks);
+			queues[i].end = min(chunks * (i + 1) / workers, chunks);
+		}
+
+		if (workers > 1)
+		{
+			{
+				lock_guard<mutex> guard(stateLock);
+				busyWorkers = threads.size();
+				++generation;
+			}
+			loopStarted.notify_all();
+			runChunks(0);
+			unique_lock<mutex> state(stateLock);
+			loopFinished.wait(state, [this]() {return busyWorkers == 0;});
+		}
+		else
+		{
+			runChunks(0);
+		}
+
+		this->body = NULL;
+		if (error)
+		{
+			exception_ptr thrown = error;
+			error = exception_ptr();
+			rethrow_exception(thrown);
+		}
+	}
+
+	void WorkStealingPool::workerLoop(size_t worker)
+	{
+		size_t lastGeneration = 0;
+		unique_lock<mutex> state(stateLock);
+		while (true)
+		{
+			loopStarted.wait(state, [&]() {return stopping || (generation != lastGeneration);});
+			if (stopping)
+			{
+				return;
+			}
+			lastGeneration = generation;
+			state.unlock();
+			runChunks(worker);
+			state.lock();
+			if (--busyWorkers == 0)
+			{
+				loopFinished.notify_one();
+			}
+		}
+	}
+
+	void WorkStealingPool::runChunks(size_t worker)
+	{
+		size_t chunk;
+		do
+		{
+			while (takeChunk(worker, chunk))
+			{
+				runChunk(chunk);
+			}
+		} while (steal(worker));
+	}
+
+	bool WorkStealingPool::takeChunk(size_t worker, size_t &chunk)
+	{
+		ChunkQueue &queue = queues[worker];
+		lock_guard<mutex> guard(queue.lock);
+		if (queue.begin >= queue.end)
+		{
+			return false;
+		}
+		chunk = queue.begin++;
+		return true;
+	}
+
+	// Only the owner adds to its queue, and only when it is empty, so chunks are never
+	// lost. A thread that finds every queue empty while another thread is moving a stolen
+	// share into its own queue simply stops early; the thief runs those chunks itself.
+	bool WorkStealingPool::steal(size_t thief)
+	{
+		for (size_t k = 1; k < threadCount; ++k)
+		{
+			ChunkQueue &victim = queues[(thief + k) % threadCount];
+			size_t begin, end;
+			{
+				lock_guard<mutex> guard(victim.lock);
+				if (victim.begin >= victim.end)
+				{
+					continue;
+				}
+				end = victim.end;
+				begin = end - (end - victim.begin + 1) / 2;
+				victim.end = begin;
+			}
+			ChunkQueue &queue = queues[thief];
+			lock_guard<mutex> guard(queue.lock);
+			queue.begin = begin;
+			queue.end = end;
+			return true;
+		}
+		return false;
+	}
+
+	void WorkStealingPool::runChunk(size_t chunk)
+	{
+		if (failed)
+		{
+			return;
+		}
+		try
+		{
+			size_t begin = chunk * grainSize;
+			(*body)(begin, min(begin + grainSize, n));
+		}
+		catch (...)
+		{
+			lock_guard<mutex> guard(errorLock);
+			if (!error)
+			{
+				error = current_exception();
+			}
+			failed = true;
+		}
+	}
+}
@@ -0,0 +1,87 @@
+#ifndef XLLBASIC_WORKSTEALINGPOOL_INCLUDED
+#define XLLBASIC_WORKSTEALINGPOOL_INCLUDED
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace XLLBasicLibrary
+{
+	/*======================================================================================
+	WorkStealingPool
+
+	A fixed set of threads that run data parallel loops. parallelFor splits [0, n) into
+	chunks of grainSize indices and gives each thread an equal, contiguous share of the
+	chunks. A thread works through its own share from the front; when it runs out it steals
+	the back half of the share of another thread. Lines that take longer than others (a
+	surface lookup against a flat volatility, say) therefore do not leave threads idle,
+	while each thread still mostly walks through memory in order.
+
+	The calling thread is one of the threads of the pool, so a pool of one thread runs the
+	loop inline. Calls to parallelFor from several threads are run one after another.
+	=======================================================================================*/
+	class WorkStealingPool
+	{
+	public:
+		// threadCount includes the calling thread; 0 uses one thread per core
+		explicit WorkStealingPool(size_t threadCount = 0);
+		~WorkStealingPool();
+
+		size_t getThreadCount() const		{return threadCount;};
+
+		// Calls body(begin, end) for consecutive ranges covering [0, n), each of at most
+		// grainSize indices, and returns once all of them have completed. If body throws,
+		// the ranges not yet started are skipped and the first exception is rethrown here.
+		void parallelFor(size_t n, size_t grainSize, const function<void(size_t, size_t)> &body);
+
+	private:
+		WorkStealingPool(const WorkStealingPool &);
+		WorkStealingPool &operator=(const WorkStealingPool &);
+
+		// The chunks [begin, end) not yet taken from one thread's share. Padded so that the
+		// queues of different threads do not share a cache line.
+		struct ChunkQueue
+		{
+			ChunkQueue() : begin(0), end(0) {};
+			mutex lock;
+			size_t begin, end;
+			char padding[64];
+		};
+
+		void workerLoop(size_t worker);
+		// Runs chunks, stealing when its own queue is empty, until no queue has any left
+		void runChunks(size_t worker);
+		bool takeChunk(size_t worker, size_t &chunk);
+		bool steal(size_t thief);
+		void runChunk(size_t chunk);
+
+		size_t threadCount;
+		vector<thread> threads;
+		unique_ptr<ChunkQueue[]> queues;
+
+		// The loop being run
+		const function<void(size_t, size_t)> *body;
+		size_t n, grainSize;
+		atomic<bool> failed;
+		exception_ptr error;
+		mutex errorLock;
+
+		// Serialises parallelFor
+		mutex loopLock;
+		// Guards generation, busyWorkers and stopping
+		mutex stateLock;
+		condition_variable loopStarted, loopFinished;
+		size_t generation, busyWorkers;
+		bool stopping;
+	};
+}
+
+#endif
@@ -46,9 +46,19 @@ test_suite* init_unit_test_suite(int, char* [])
     test->add(BOOST_TEST_CASE(startTimer));
 
     test->add(MathsFunctionsTest::suite());
+    test->add(NormalDistributionTest::suite());
+    test->add(RandomNumbersTest::suite());
     test->add(Maths2DInterpTest::suite());    
 	test->add(Black76Test::suite());
+	test->add(Black76ImpliedVolatilityTest::suite());
 	test->add(VolatilitySurfacesDeltaTest::suite());
+	test->add(PortfolioEngineTest::suite());
+	test->add(AsianMonteCarloTest::suite());
+	test->add(AsianBlack76Test::suite());
+	test->add(BachelierTest::suite());
+	test->add(BachelierImpliedVolatilityTest::suite());
+	test->add(SpreadOptionTest::suite());
+	test->add(AmericanBlack76Test::suite());
 
     test->add(BOOST_TEST_CASE(stopTimer));
     return test;
@@ -1,10 +1,20 @@
-#include <boost\test\unit_test.hpp>
-#include <boost\timer.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/timer.hpp>
 
 #include <iostream>
 #include <iomanip>
 
-#include "..\Maths\MathsTest.h"
-#include "..\Maths\TwoDimensionalInterpolationTest.h"
-#include "..\Derivatives\Black76FormulaTest.h"
-#include "..\Derivatives\VolatilitySurfacesDeltaTest.h"
\ No newline at end of file
+#include "../Maths/MathsTest.h"
+#include "../Maths/NormalDistributionTest.h"
+#include "../Maths/RandomNumbersTest.h"
+#include "../Maths/TwoDimensionalInterpolationTest.h"
+#include "../Derivatives/Black76FormulaTest.h"
+#include "../Derivatives/Black76ImpliedVolatilityTest.h"
+#include "../Derivatives/VolatilitySurfacesDeltaTest.h"
+#include "../Derivatives/PortfolioEngineTest.h"
+#include "../Derivatives/AsianMonteCarloTest.h"
+#include "../Derivatives/AsianBlack76Test.h"
+#include "../Derivatives/BachelierFormulaTest.h"
+#include "../Derivatives/BachelierImpliedVolatilityTest.h"
+#include "../Derivatives/SpreadOptionTest.h"
+#include "../Derivatives/AmericanBlack76Test.h"
\ No newline at end of file
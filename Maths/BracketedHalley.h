@@ -0,0 +1,97 @@
+#ifndef XLLBASIC_BRACKETEDHALLEY_INCLUDED
+#define XLLBASIC_BRACKETEDHALLEY_INCLUDED
+#pragma once
+
+#include <math.h>
+#include <limits> // infinity
+
+using namespace std;
+
+namespace XLLBasicLibrary
+{
+    /*======================================================================================
+    BracketedHalley: the root of an increasing function g(s) by Halley's method,
+        s -> s + h,     h = d / (1 + d g'' / (2 g')),     d = -g / g'
+    safeguarded by a bracket [lower, upper] around the root, which every evaluation
+    narrows. A step that would leave the bracket is replaced by a bisection (or a
+    doubling while upper is infinite), so the iteration always converges.
+
+    The caller evaluates g and its derivatives at s and hands them to step(), which
+    returns true once |g| is within the caller's tolerance. The tolerance is on the
+    residual, not on the step: a small step only shows that the iteration has slowed
+    down, not that it has arrived. It should allow for the rounding error in g, or the
+    iteration runs until the bracket can no longer be split in double precision, where
+    it also stops.
+
+    The state is a plain struct so that a batch solver can hold one per line and iterate
+    many lines together.
+    =======================================================================================*/
+    struct BracketedHalley
+    {
+        double s, lower, upper;
+        int iterations;
+
+        void start(double initialGuess, double lowerBound, double upperBound)
+        {
+            s = initialGuess;
+            lower = lowerBound;
+            upper = upperBound;
+            iterations = 0;
+        }
+
+        // g, g1 = g' and g2 = g'' at s. Returns true if s is the answer, otherwise moves s
+        // to the next point to evaluate
+        bool step(double g, double g1, double g2, double tolerance, int maximumIterations)
+        {
+            ++iterations;
+            if (fabs(g) <= tolerance)
+            {
+                return true;
+            }
+            if (g < 0.0)
+            {
+                lower = s;
+            }
+            else
+            {
+                upper = s;
+            }
+            double newton = -g / g1;
+            double next = s + newton / (1.0 + newton * g2 / (2.0 * g1));
+            if (!(next > lower && next < upper))
+            {
+                next = bisect();
+            }
+            return move(next, maximumIterations);
+        }
+
+        // Where g cannot be evaluated at s because s is certainly below the root (e.g. the
+        // function underflows)
+        bool stepUp(int maximumIterations)
+        {
+            ++iterations;
+            lower = s;
+            return move(bisect(), maximumIterations);
+        }
+
+    private :
+        double bisect() const
+        {
+            return (upper < numeric_limits<double>::infinity()) ? lower + (upper - lower) / 2.0 : 2.0 * s;
+        }
+
+        // Stops when there is no double strictly inside the bracket left to try, as s is
+        // then as close to the root as double precision allows
+        bool move(double next, int maximumIterations)
+        {
+            if (!(next > lower && next < upper))
+            {
+                return true;
+            }
+            s = next;
+            return (iterations >= maximumIterations);
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,405 @@
+#ifndef XLLBASIC_INTERPOLATIONKERNELS_INCLUDED
+#define XLLBASIC_INTERPOLATIONKERNELS_INCLUDED
+#pragma once
+
+/**
+* Interpolation kernels: the arithmetic of the interpolators as class templates whose
+* behaviour is fixed at compile time by policies, so that a kernel's getRate has no
+* virtual call, no error state and no tests other than the ones its policies ask for,
+* and can be inlined into the loop that calls it. The polymorphic interpolators in
+* maths.h and TwoDimensionalInterpolation.h are thin wrappers over these kernels and
+* hand them out through getKernel().
+*
+* A kernel is a view: it holds pointers to the nodes and values of the interpolator it
+* came from, which must outlive it and not be changed while it is used.
+*/
+
+#include <cstddef> // size_t
+#include <limits> // quiet_NaN
+#include <stdexcept> // runtime_error
+
+using namespace std;
+
+namespace XLLBasicLibrary
+{
+    /*======================================================================================
+    Extrapolation policies
+
+    Whether points outside the nodes are interpolated with the nearest segment (or cell)
+    or are out of range
+    =======================================================================================*/
+    struct Extrapolate
+    {
+        static const bool allowExtrapolation = true;
+    };
+
+    struct NoExtrapolation
+    {
+        static const bool allowExtrapolation = false;
+    };
+
+    /*======================================================================================
+    Range check policies
+
+    What getRate does with a point that is out of range (only possible without
+    extrapolation): throw a runtime_error as the ArrayInterpolators do, return NaN as the
+    TwoDimensionalInterpolators do, or nothing at all. An unchecked kernel interpolates
+    every point with the nearest segment; it is for callers that have already checked
+    their points, e.g. with isInRange once for a whole batch.
+    =======================================================================================*/
+    struct ThrowOutOfRange
+    {
+        static const bool checked = true;
+        static double outOfRange()
+        {
+            throw runtime_error("Allow extrapolation set to false and point is outside range");
+        }
+    };
+
+    struct NaNOutOfRange
+    {
+        static const bool checked = true;
+        static double outOfRange()   {return numeric_limits<double>::quiet_NaN();};
+    };
+
+    struct UncheckedRange
+    {
+        static const bool checked = false;
+        static double outOfRange()   {return 0.0;};
+    };
+
+    /*======================================================================================
+    Segment policies for ArrayKernel
+
+    interpolate(x, y, secondDerivatives, i, xInput) is the value at xInput of the segment
+    [x_i, x_i+1]. secondDerivatives is only read by the cubic spline.
+    =======================================================================================*/
+    struct LinearSegment
+    {
+        static double interpolate(const double *x, const double *y, const double *, size_t i, double xInput)
+        {
+            double m = (y[i + 1] - y[i]) / (x[i + 1] - x[i]);
+            double c = y[i] - m * x[i];
+            return m * xInput + c;
+        }
+    };
+
+    // The cubic spline of "Numerical Recipes in C", see CubicSplineInterpolator
+    struct CubicSplineSegment
+    {
+        static double interpolate(const double *x, const double *y, const double *secondDerivatives, size_t i, double xInput)
+        {
+            double h = x[i + 1] - x[i];
+            double a = (x[i + 1] - xInput) / h;
+            double b = (xInput - x[i]) / h;
+            return a * y[i] + b * y[i + 1] +
+                ((a*a*a - a) * secondDerivatives[i] + (b*b*b - b) * secondDerivatives[i + 1]) * (h*h) / 6.0;
+        }
+    };
+
+    /*======================================================================================
+    ArrayKernel
+
+    One dimensional interpolation over n >= 2 strictly increasing nodes x with values y.
+    The segment used for a point is found by bisection, or for a sorted batch by one
+    forward walk. A checked batch that throws may already have written the points before
+    the one out of range.
+    =======================================================================================*/
+    template <class Segment, class Extrapolation = NoExtrapolation, class Bounds = ThrowOutOfRange>
+    class ArrayKernel
+    {
+    public:
+        ArrayKernel() : x(NULL), y(NULL), secondDerivatives(NULL), n(0) {};
+        ArrayKernel(const double *x, const double *y, const double *secondDerivatives, size_t n)
+            : x(x), y(y), secondDerivatives(secondDerivatives), n(n) {};
+
+        bool isInRange(double xInput) const
+        {
+            return Extrapolation::allowExtrapolation || ((xInput >= x[0]) && (xInput <= x[n - 1]));
+        }
+
+        double getRate(double xInput) const
+        {
+            if (Bounds::checked && !isInRange(xInput))
+            {
+                return Bounds::outOfRange();
+            }
+            return Segment::interpolate(x, y, secondDerivatives, locate(xInput), xInput);
+        }
+
+        // Sorted runs of x are located with a single forward walk from the segment of the
+        // last point interpolated; a point smaller than that one, or the first after an out
+        // of range point, is bisected
+        void getRate(size_t count, const double *xInput, double *result) const
+        {
+            size_t i = 0;
+            bool haveLast = false;
+            double last = 0.0;
+            for (size_t k = 0; k < count; ++k)
+            {
+                if (Bounds::checked && !isInRange(xInput[k]))
+                {
+                    result[k] = Bounds::outOfRange();
+                    haveLast = false;
+                    continue;
+                }
+                // The negated test also sends NaN to the bisection
+                i = (haveLast && (xInput[k] >= last)) ? locateForward(xInput[k], i) : locate(xInput[k]);
+                result[k] = Segment::interpolate(x, y, secondDerivatives, i, xInput[k]);
+                haveLast = true;
+                last = xInput[k];
+            }
+        }
+
+        // The index i of the segment [x_i, x_i+1] used to interpolate xInput, found by
+        // bisection. Points outside the range use the first or last segment.
+        size_t locate(double xInput) const
+        {
+            size_t ilo = 0;
+            size_t ihi = n - 1;
+            while (ihi - ilo > 1)
+            {
+                size_t i = (ihi + ilo) >> 1;
+                if (x[i] > xInput)
+                {
+                    ihi = i;
+                }
+                else
+                {
+                    ilo = i;
+                }
+            }
+            return ilo;
+        }
+
+        // As locate(xInput) for an xInput no smaller than an earlier input which used
+        // segment i, found by walking forward from i
+        size_t locateForward(double xInput, size_t i) const
+        {
+            while ((i + 2 < n) && (x[i + 1] <= xInput))
+            {
+                ++i;
+            }
+            return i;
+        }
+
+        double getRangeStart() const   {return x[0];};
+        double getRangeEnd() const   {return x[n - 1];};
+
+    private:
+        const double *x, *y, *secondDerivatives;
+        size_t n;
+    };
+
+    /*======================================================================================
+    GridCursor
+
+    The cell found by the last lookup. Passing the same cursor to successive lookups makes
+    a query in the same or a neighbouring cell O(1), which is the common case when sweeping
+    strikes or iterating a solver. Other queries fall back to a binary search. A default
+    constructed cursor is valid for any interpolator.
+    ======================================================================================*/
+    struct GridCursor
+    {
+        GridCursor() : xIndex(0), yIndex(0) {};
+        size_t xIndex, yIndex;
+    };
+
+    /*======================================================================================
+    Grid interval search
+
+    The index i of the interval [v_i, v_i+1] of the n >= 2 strictly increasing nodes v
+    containing the input, by binary search. An input equal to a node v_i (i > 0) belongs
+    to the interval on its left and inputs outside the nodes, or NaN, to the first or last
+    interval. With a hint, an input in or next to the hinted interval is found in O(1).
+    =======================================================================================*/
+    inline size_t locateGridInterval(const double *v, size_t n, double input)
+    {
+        // Also catches NaN
+        if (!(input > v[0]))
+        {
+            return 0;
+        }
+        else if (input > v[n - 1])
+        {
+            return n - 2;
+        }
+        size_t low = 0, high = n - 1;
+        // v[low] < input <= v[high]
+        while (high - low > 1)
+        {
+            size_t middle = (low + high) >> 1;
+            if (v[middle] < input)
+            {
+                low = middle;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+        return low;
+    }
+
+    // true if locateGridInterval(v, n, input) would return i
+    inline bool isInGridInterval(const double *v, size_t n, size_t i, double input)
+    {
+        bool aboveLower = (i == 0) || (v[i] < input);
+        bool belowUpper = (i == n - 2) || (input <= v[i + 1]);
+        return aboveLower && belowUpper;
+    }
+
+    inline size_t locateGridInterval(const double *v, size_t n, double input, size_t hint)
+    {
+        size_t last = n - 2;
+        if (hint <= last)
+        {
+            if (isInGridInterval(v, n, hint, input))
+            {
+                return hint;
+            }
+            if ((hint < last) && isInGridInterval(v, n, hint + 1, input))
+            {
+                return hint + 1;
+            }
+            if ((hint > 0) && isInGridInterval(v, n, hint - 1, input))
+            {
+                return hint - 1;
+            }
+        }
+        return locateGridInterval(v, n, input);
+    }
+
+    /*======================================================================================
+    Cell policies for GridKernel
+
+    interpolate(x, nx, y, values, i, j, xInput, yInput) is the value at (xInput, yInput)
+    of the cell [x_i, x_i+1] x [y_j, y_j+1]. The overload with a derivative also sets it
+    to dz/dy there.
+    =======================================================================================*/
+    // values is z row major with a row of nx values per y node, as Matrix
+    struct BilinearCell
+    {
+        static double interpolate(const double *x, size_t nx, const double *y, const double *values,
+            size_t i, size_t j, double xInput, double yInput)
+        {
+            const double *lowerRow = values + j * nx, *upperRow = lowerRow + nx;
+            double z1 = lowerRow[i],
+                   z2 = upperRow[i],
+                   z3 = lowerRow[i + 1],
+                   z4 = upperRow[i + 1];
+            double t = (xInput - x[i]) / (x[i + 1] - x[i]);
+            double u = (yInput - y[j]) / (y[j + 1] - y[j]);
+            return (1-t)*(1-u)*z1 + t*(1-u)*z3 + t*u*z4 + (1-t)*u*z2;
+        }
+
+        static double interpolate(const double *x, size_t nx, const double *y, const double *values,
+            size_t i, size_t j, double xInput, double yInput, double &derivative)
+        {
+            const double *lowerRow = values + j * nx, *upperRow = lowerRow + nx;
+            double t = (xInput - x[i]) / (x[i + 1] - x[i]);
+            derivative = ((1-t)*(upperRow[i] - lowerRow[i]) + t*(upperRow[i + 1] - lowerRow[i + 1])) / (y[j + 1] - y[j]);
+            return interpolate(x, nx, y, values, i, j, xInput, yInput);
+        }
+    };
+
+    // values[16 * (j * (nx - 1) + i) + 4 * a + b] multiplies t^a u^b on the cell, see
+    // BicubicInterpolator
+    struct BicubicCell
+    {
+        static double interpolate(const double *x, size_t nx, const double *y, const double *values,
+            size_t i, size_t j, double xInput, double yInput)
+        {
+            const double *c = values + 16 * (j * (nx - 1) + i);
+            double t = (xInput - x[i]) / (x[i + 1] - x[i]);
+            double u = (yInput - y[j]) / (y[j + 1] - y[j]);
+            double result = 0;
+            for (int a = 3; a >= 0; --a)
+            {
+                const double *row = c + 4 * a;
+                result = result * t + (((row[3] * u + row[2]) * u + row[1]) * u + row[0]);
+            }
+            return result;
+        }
+
+        static double interpolate(const double *x, size_t nx, const double *y, const double *values,
+            size_t i, size_t j, double xInput, double yInput, double &derivative)
+        {
+            const double *c = values + 16 * (j * (nx - 1) + i);
+            double t = (xInput - x[i]) / (x[i + 1] - x[i]);
+            double h = y[j + 1] - y[j];
+            double u = (yInput - y[j]) / h;
+            double result = 0, slope = 0;
+            for (int a = 3; a >= 0; --a)
+            {
+                const double *row = c + 4 * a;
+                result = result * t + (((row[3] * u + row[2]) * u + row[1]) * u + row[0]);
+                slope = slope * t + ((3.0 * row[3] * u + 2.0 * row[2]) * u + row[1]);
+            }
+            derivative = slope / h;
+            return result;
+        }
+    };
+
+    /*======================================================================================
+    GridKernel
+
+    Two dimensional interpolation over nx x ny >= 2 x 2 strictly increasing nodes. The
+    cell used for a point is found by binary search or, from a GridCursor, in O(1) when
+    the point is in or next to the cell of the last lookup.
+    =======================================================================================*/
+    template <class Cell, class Extrapolation = NoExtrapolation, class Bounds = NaNOutOfRange>
+    class GridKernel
+    {
+    public:
+        GridKernel() : x(NULL), y(NULL), values(NULL), nx(0), ny(0) {};
+        GridKernel(const double *x, size_t nx, const double *y, size_t ny, const double *values)
+            : x(x), y(y), values(values), nx(nx), ny(ny) {};
+
+        bool isInRange(double xInput, double yInput) const
+        {
+            return Extrapolation::allowExtrapolation ||
+                ((xInput >= x[0]) && (xInput <= x[nx - 1]) && (yInput >= y[0]) && (yInput <= y[ny - 1]));
+        }
+
+        double getRate(double xInput, double yInput) const
+        {
+            if (Bounds::checked && !isInRange(xInput, yInput))
+            {
+                return Bounds::outOfRange();
+            }
+            return Cell::interpolate(x, nx, y, values,
+                locateGridInterval(x, nx, xInput), locateGridInterval(y, ny, yInput), xInput, yInput);
+        }
+
+        double getRate(double xInput, double yInput, GridCursor &cursor) const
+        {
+            if (Bounds::checked && !isInRange(xInput, yInput))
+            {
+                return Bounds::outOfRange();
+            }
+            cursor.xIndex = locateGridInterval(x, nx, xInput, cursor.xIndex);
+            cursor.yIndex = locateGridInterval(y, ny, yInput, cursor.yIndex);
+            return Cell::interpolate(x, nx, y, values, cursor.xIndex, cursor.yIndex, xInput, yInput);
+        }
+
+        // As above, also setting derivative to dz/dy (NaN out of range)
+        double getRate(double xInput, double yInput, GridCursor &cursor, double &derivative) const
+        {
+            if (Bounds::checked && !isInRange(xInput, yInput))
+            {
+                derivative = Bounds::outOfRange();
+                return derivative;
+            }
+            cursor.xIndex = locateGridInterval(x, nx, xInput, cursor.xIndex);
+            cursor.yIndex = locateGridInterval(y, ny, yInput, cursor.yIndex);
+            return Cell::interpolate(x, nx, y, values, cursor.xIndex, cursor.yIndex, xInput, yInput, derivative);
+        }
+
+    private:
+        const double *x, *y, *values;
+        size_t nx, ny;
+    };
+}
+
+#endif
@@ -147,6 +147,163 @@ void MathsFunctionsTest::testCubicSplineInterpolator()
     BOOST_CHECK(cSplineInpterp1.getRate(1.73) == -8.24323396243094);
 }
 
+void MathsFunctionsTest::testInterpolatorViews() 
+{
+    BOOST_TEST_MESSAGE("Testing array interpolators over caller owned arrays ...");
+
+    double x[6], y[6];
+    for (size_t i = 0; i < 6; ++i) 
+    {
+        x[i] = (double) i;
+        y[i] = 2.4 * x[i] * x[i] - 3.1 * x[i] - 10;
+    }
+    vector<double> xVector(x, x + 6), yVector(y, y + 6);
+    CubicSplineInterpolator owner(xVector, yVector, true);
+    CubicSplineInterpolator view(x, y, 6, true);
+    LinearArrayInterpolator linearOwner(xVector, yVector, true);
+    LinearArrayInterpolator linearView(x, y, 6, true);
+    BOOST_REQUIRE(view.isOk());
+    BOOST_CHECK(view.getRate(1.73) == owner.getRate(1.73));
+    BOOST_CHECK(linearView.getRate(1.73) == linearOwner.getRate(1.73));
+
+    // Batch lookups into a caller supplied buffer
+    double xInputs[4] = { -0.5, 0.73, 2.0, 5.9 }, result[4];
+    view.getRate(4, xInputs, result);
+    for (size_t i = 0; i < 4; ++i)
+    {
+        BOOST_CHECK(result[i] == owner.getRate(xInputs[i]));
+    }
+    BOOST_CHECK(view.isInRange(4, xInputs));
+    BOOST_CHECK(!CubicSplineInterpolator(x, y, 6, false).isInRange(4, xInputs));
+
+    // Copies and moves of an owner keep working once the original has gone; a copy of a
+    // view still looks at the caller's arrays
+    CubicSplineInterpolator copy(xVector, yVector, true);
+    {
+        CubicSplineInterpolator temporary(xVector, yVector, true);
+        copy = temporary;
+    }
+    BOOST_CHECK(copy.getRate(1.73) == owner.getRate(1.73));
+    CubicSplineInterpolator moved(std::move(copy));
+    BOOST_CHECK(moved.getRate(1.73) == owner.getRate(1.73));
+    CubicSplineInterpolator viewCopy(view);
+    y[5] = 0;
+    BOOST_CHECK(viewCopy.getRate(5.0) == 0);
+
+    // Setting a vector takes ownership of it
+    linearView.setYVector(yVector);
+    y[1] = 100;
+    BOOST_CHECK(linearView.getRate(1.0) == linearOwner.getRate(1.0));
+}
+
+void MathsFunctionsTest::testSortedBatchInterpolation() 
+{
+    BOOST_TEST_MESSAGE("Testing batch interpolation of sorted and unsorted inputs ...");
+
+    // Monthly pillars out to five years
+    vector<double> xVector, yVector;
+    for (size_t i = 0; i <= 60; ++i) 
+    {
+        xVector.push_back(i / 12.0);
+        yVector.push_back(0.05 + 0.01 * sin(xVector[i] * 3.0) + 0.002 * xVector[i]);
+    }
+    LinearArrayInterpolator linear(xVector, yVector, true);
+    CubicSplineInterpolator spline(xVector, yVector, true);
+
+    // A sorted run that starts before and ends after the pillars and lands on every pillar, 
+    // then an unsorted tail, a repeated point and a NaN
+    vector<double> xInputs;
+    for (size_t i = 0; i <= 1300; ++i) 
+    {
+        xInputs.push_back(-0.25 + i * 5.5 / 1300);
+    }
+    xInputs.insert(xInputs.end(), xVector.begin(), xVector.end());
+    xInputs += 3.3, 0.1, 4.9, 4.9, 2.0, -1.0, 7.0, 1.5;
+    xInputs.push_back(numeric_limits<double>::quiet_NaN());
+    xInputs += 0.4, 0.2;
+
+    vector<double> linearBatch = linear.getRate(xInputs);
+    vector<double> splineBatch = spline.getRate(xInputs);
+    for (size_t i = 0; i < xInputs.size(); ++i)
+    {
+        if (boost::math::isnan(xInputs[i]))
+        {
+            BOOST_CHECK(boost::math::isnan(linearBatch[i]));
+            BOOST_CHECK(boost::math::isnan(splineBatch[i]));
+        }
+        else 
+        {
+            BOOST_CHECK(linearBatch[i] == linear.getRate(xInputs[i]));
+            BOOST_CHECK(splineBatch[i] == spline.getRate(xInputs[i]));
+        }
+    }
+
+    // Out of range points still throw when extrapolation is not allowed
+    LinearArrayInterpolator noExtrapolation(xVector, yVector, false);
+    double result[3], xInRange[3] = { 0.5, 1.5, 2.5 }, xOutOfRange[3] = { 0.5, 1.5, 5.5 };
+    noExtrapolation.getRate(3, xInRange, result);
+    BOOST_CHECK(result[2] == noExtrapolation.getRate(2.5));
+    BOOST_CHECK_THROW(noExtrapolation.getRate(3, xOutOfRange, result), runtime_error);
+}
+
+void MathsFunctionsTest::testInterpolationKernels() 
+{
+    BOOST_TEST_MESSAGE("Testing ArrayKernel against the interpolators it implements ...");
+
+    vector<double> xVector, yVector;
+    for (size_t i = 0; i <= 24; ++i) 
+    {
+        xVector.push_back(i / 12.0);
+        yVector.push_back(0.05 + 0.01 * sin(xVector[i] * 3.0));
+    }
+    LinearArrayInterpolator linear(xVector, yVector, true);
+    CubicSplineInterpolator spline(xVector, yVector, true);
+
+    ArrayKernel<LinearSegment, Extrapolate, UncheckedRange> linearKernel = linear.getKernel<Extrapolate, UncheckedRange>();
+    ArrayKernel<CubicSplineSegment, Extrapolate, UncheckedRange> splineKernel = spline.getKernel<Extrapolate, UncheckedRange>();
+    vector<double> xInputs;
+    for (double x = -0.5; x < 2.5; x += 0.01)
+    {
+        xInputs.push_back(x);
+    }
+    xInputs.insert(xInputs.end(), xVector.begin(), xVector.end());
+    vector<double> linearBatch(xInputs.size()), splineBatch(xInputs.size());
+    linearKernel.getRate(xInputs.size(), &xInputs[0], &linearBatch[0]);
+    splineKernel.getRate(xInputs.size(), &xInputs[0], &splineBatch[0]);
+    for (size_t i = 0; i < xInputs.size(); ++i)
+    {
+        BOOST_CHECK(linearKernel.getRate(xInputs[i]) == linear.getRate(xInputs[i]));
+        BOOST_CHECK(splineKernel.getRate(xInputs[i]) == spline.getRate(xInputs[i]));
+        BOOST_CHECK(linearBatch[i] == linear.getRate(xInputs[i]));
+        BOOST_CHECK(splineBatch[i] == spline.getRate(xInputs[i]));
+    }
+
+    // Out of range: thrown, NaN or, unchecked, the nearest segment
+    ArrayKernel<LinearSegment, NoExtrapolation, ThrowOutOfRange> throwing = linear.getKernel<NoExtrapolation, ThrowOutOfRange>();
+    ArrayKernel<LinearSegment, NoExtrapolation, NaNOutOfRange> nan = linear.getKernel<NoExtrapolation, NaNOutOfRange>();
+    ArrayKernel<LinearSegment, NoExtrapolation, UncheckedRange> unchecked = linear.getKernel<NoExtrapolation, UncheckedRange>();
+    BOOST_CHECK(throwing.getRate(1.5) == linear.getRate(1.5));
+    BOOST_CHECK(!throwing.isInRange(2.5) && unchecked.isInRange(2.0));
+    BOOST_CHECK_THROW(throwing.getRate(2.5), runtime_error);
+    BOOST_CHECK(boost::math::isnan(nan.getRate(-0.1)));
+    BOOST_CHECK(unchecked.getRate(2.5) == linear.getRate(2.5));
+    double result[3], xOutOfRange[3] = { 0.5, 2.5, 1.5 };
+    nan.getRate(3, xOutOfRange, result);
+    BOOST_CHECK((result[0] == linear.getRate(0.5)) && boost::math::isnan(result[1]) && (result[2] == linear.getRate(1.5)));
+    // A point skipped below the range must not let the next point walk forward from the
+    // segment of the point before it
+    double xBelowRange[3] = { 1.5, -1.0, 0.5 };
+    nan.getRate(3, xBelowRange, result);
+    BOOST_CHECK((result[0] == linear.getRate(1.5)) && boost::math::isnan(result[1]) && (result[2] == linear.getRate(0.5)));
+    ArrayKernel<CubicSplineSegment, NoExtrapolation, NaNOutOfRange> nanSpline = spline.getKernel<NoExtrapolation, NaNOutOfRange>();
+    nanSpline.getRate(3, xBelowRange, result);
+    BOOST_CHECK((result[0] == spline.getRate(1.5)) && boost::math::isnan(result[1]) && (result[2] == spline.getRate(0.5)));
+
+    // An interpolator with an error has no kernel
+    xVector.pop_back();
+    LinearArrayInterpolator broken(xVector, yVector, true);
+    BOOST_CHECK_THROW((broken.getKernel<Extrapolate, UncheckedRange>()), runtime_error);
+}
 
 test_suite* MathsFunctionsTest::suite() 
 {
@@ -155,6 +312,9 @@ test_suite* MathsFunctionsTest::suite()
     suite->add(BOOST_TEST_CASE(&MathsFunctionsTest::testArrayInterpolator));   
     suite->add(BOOST_TEST_CASE(&MathsFunctionsTest::testLinearArrayInterpolator));
     suite->add(BOOST_TEST_CASE(&MathsFunctionsTest::testCubicSplineInterpolator));
+    suite->add(BOOST_TEST_CASE(&MathsFunctionsTest::testInterpolatorViews));
+    suite->add(BOOST_TEST_CASE(&MathsFunctionsTest::testSortedBatchInterpolation));
+    suite->add(BOOST_TEST_CASE(&MathsFunctionsTest::testInterpolationKernels));
 
     return suite;
 }
@@ -2,8 +2,8 @@
 #define XLLBASIC_test_maths
 
 #include <iostream>
-#include <boost\test\unit_test.hpp>
-#include <boost\math\special_functions\fpclassify.hpp> // boost::math::isnan
+#include <boost/test/unit_test.hpp>
+#include <boost/math/special_functions/fpclassify.hpp> // boost::math::isnan
 #include "maths.h"
 
 class MathsFunctionsTest 
@@ -14,6 +14,9 @@ public:
     static void testArrayInterpolator();
     static void testLinearArrayInterpolator();
     static void testCubicSplineInterpolator();   
+    static void testInterpolatorViews();
+    static void testSortedBatchInterpolation();
+    static void testInterpolationKernels();
 
     static boost::unit_test_framework::test_suite* suite();
 };
@@ -0,0 +1,109 @@
+#include "Matrix.h"
+
+#include <stdint.h> // uintptr_t
+
+namespace XLLBasicLibrary
+{
+    namespace
+    {
+        const size_t alignment = 64;
+    }
+
+    /*======================================================================================
+    MatrixView
+    
+    ======================================================================================*/
+    MatrixView::MatrixView(const double *values, size_t rows, size_t columns, bool columnMajor) :
+        values(values), rows(rows), columns(columns), 
+        rowStride(columnMajor ? 1 : columns), columnStride(columnMajor ? rows : 1)
+    {
+    }
+
+    /*======================================================================================
+    Matrix
+    
+    ======================================================================================*/
+    Matrix::Matrix() : values(NULL), rows(0), columns(0)
+    {
+    }
+
+    Matrix::Matrix(size_t rows, size_t columns, double value)
+    {
+        allocate(rows, columns);
+        for (size_t k = 0; k < rows * columns; ++k)
+        {
+            values[k] = value;
+        }
+    }
+
+    Matrix::Matrix(const vector<vector<double> > &rowsOfValues)
+    {
+        size_t n = rowsOfValues.size(), m = rowsOfValues.empty() ? 0 : rowsOfValues[0].size();
+        for (size_t i = 1; i < n; ++i)
+        {
+            if (rowsOfValues[i].size() != m)
+            {
+                throw runtime_error("Matrix->Columns do not have consistent dimension");
+            }
+        }
+        allocate(n, m);
+        for (size_t i = 0; i < n; ++i)
+        {
+            for (size_t j = 0; j < m; ++j)
+            {
+                (*this)(i, j) = rowsOfValues[i][j];
+            }
+        }
+    }
+
+    Matrix::Matrix(const MatrixView &view)
+    {
+        allocate(view.getRows(), view.getColumns());
+        for (size_t i = 0; i < rows; ++i)
+        {
+            double *row = getRow(i);
+            for (size_t j = 0; j < columns; ++j)
+            {
+                row[j] = view(i, j);
+            }
+        }
+    }
+
+    // Moving a vector keeps its buffer, so values stays aligned
+    Matrix::Matrix(Matrix &&other) :
+        storage(std::move(other.storage)), values(other.values), rows(other.rows), columns(other.columns)
+    {
+        other.values = NULL;
+        other.rows = other.columns = 0;
+    }
+
+    Matrix &Matrix::operator=(Matrix &&other)
+    {
+        if (this != &other)
+        {
+            storage = std::move(other.storage);
+            values = other.values;
+            rows = other.rows;
+            columns = other.columns;
+            other.values = NULL;
+            other.rows = other.columns = 0;
+        }
+        return *this;
+    }
+
+    Matrix Matrix::clone() const
+    {
+        return Matrix(getView());
+    }
+
+    void Matrix::allocate(size_t rowsInput, size_t columnsInput)
+    {
+        rows = rowsInput;
+        columns = columnsInput;
+        size_t padding = alignment / sizeof(double) - 1;
+        storage.assign(rows * columns + padding, 0.0);
+        uintptr_t address = (uintptr_t)&storage[0];
+        size_t offset = ((alignment - address % alignment) % alignment) / sizeof(double);
+        values = &storage[0] + offset;
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef XLLBASIC_MATRIX_INCLUDED
+#define XLLBASIC_MATRIX_INCLUDED
+#pragma once
+
+#include <cstddef> // size_t
+#include <stdexcept> // runtime_error
+#include <vector>
+
+using namespace std;
+
+namespace XLLBasicLibrary
+{
+    /*======================================================================================
+    MatrixView
+
+    A read only view of a rows x columns block of doubles owned by someone else, without 
+    copying them. The block is row major by default: element (i, j) is values[i * columns 
+    + j]. A column major view reads the same memory as its transpose, e.g. an excel range 
+    whose rows are the columns wanted. The memory must outlive the view.
+    =======================================================================================*/
+    class MatrixView
+    {
+    public:
+        MatrixView() : values(NULL), rows(0), columns(0), rowStride(0), columnStride(0) {};
+        MatrixView(const double *values, size_t rows, size_t columns, bool columnMajor = false);
+
+        size_t getRows() const                  {return rows;};
+        size_t getColumns() const               {return columns;};
+        double operator()(size_t i, size_t j) const {return values[i * rowStride + j * columnStride];};
+
+    private:
+        const double *values;
+        size_t rows, columns;
+        size_t rowStride, columnStride;
+    };
+
+    /*======================================================================================
+    Matrix
+
+    A rows x columns matrix in one row major buffer whose first element is aligned to a 64
+    byte cache line, so that row i is the contiguous run getRow(i) and the elements (i, j),
+    (i, j+1), (i+1, j), (i+1, j+1) of a grid cell are two adjacent pairs one row apart 
+    rather than in separately allocated rows.
+
+    A Matrix can only be moved, which keeps its buffer, so a matrix handed to an
+    interpolator is built once and never copied by accident. clone() makes an explicit 
+    copy. Throws a runtime_error if the rows of a vector of vectors are not all the same
+    length.
+    =======================================================================================*/
+    class Matrix
+    {
+    public:
+        Matrix();
+        Matrix(size_t rows, size_t columns, double value = 0.0);
+        explicit Matrix(const vector<vector<double> > &rowsOfValues);
+        explicit Matrix(const MatrixView &view);
+        Matrix(Matrix &&other);
+        Matrix &operator=(Matrix &&other);
+        Matrix(const Matrix &other) = delete;
+        Matrix &operator=(const Matrix &other) = delete;
+
+        Matrix clone() const;
+
+        size_t getRows() const                  {return rows;};
+        size_t getColumns() const               {return columns;};
+        bool empty() const                      {return rows * columns == 0;};
+
+        double operator()(size_t i, size_t j) const {return values[i * columns + j];};
+        double &operator()(size_t i, size_t j)  {return values[i * columns + j];};
+        const double *getRow(size_t i) const    {return values + i * columns;};
+        double *getRow(size_t i)                {return values + i * columns;};
+        MatrixView getView() const              {return MatrixView(values, rows, columns);};
+
+    private:
+        void allocate(size_t rows, size_t columns);
+
+        // values points into storage at the first 64 byte boundary
+        vector<double> storage;
+        double *values;
+        size_t rows, columns;
+    };
+}
+
+#endif
@@ -0,0 +1,413 @@
+
+#include "NormalDistribution.h"
+
+#include <math.h>
+#include <string.h> // memcpy
+#include <algorithm>
+#include <atomic>
+
+// The AVX2 and AVX-512 loops are compiled with function level target attributes, which
+// only GCC and Clang support
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define XLLBASIC_SIMD_TARGETS
+#endif
+
+// The kernel must be inlined into each of the instruction set specific loops to be
+// compiled for that instruction set
+#if defined(_MSC_VER)
+#define XLLBASIC_FORCE_INLINE __forceinline
+#elif defined(__GNUC__) || defined(__clang__)
+#define XLLBASIC_FORCE_INLINE inline __attribute__((always_inline))
+#else
+#define XLLBASIC_FORCE_INLINE inline
+#endif
+
+using namespace std;
+
+namespace XLLBasicLibrary
+{
+    namespace
+    {
+        const double oneOverRootTwo = 0.70710678118654752440;
+        const double oneOverRootTwoPi = 0.39894228040143267794;
+        // Adding 1.5 * 2^52 to a double of magnitude < 2^51 rounds it to an integer which
+        // is left in the low bits of the mantissa
+        const double shifter = 6755399441055744.0;
+        // N(-38) is below the smallest normal double so inputs are clamped to [-38, 38]
+        const double inputBound = 38.0;
+        const size_t cdfBlockSize = 256;
+
+        // Chebyshev coefficients of g(z) = exp(z^2) * erfc(z) in t = (z - K) / (z + K) for
+        // z in [0, 27], with t mapped onto s in [-1, 1]
+        const double chebyshevK = 4.0;
+        const double chebyshevZMax = 27.0;
+        const double chebyshevTMax = (chebyshevZMax - chebyshevK) / (chebyshevZMax + chebyshevK);
+        const double chebyshev[23] =
+        {
+             3.27005628452274211e-01,
+            -4.30698965950842616e-01,
+             1.67281657535209433e-01,
+            -5.51051627975847683e-02,
+             1.54301411885223016e-02,
+            -3.64479325751901687e-03,
+             7.11524942320312329e-04,
+            -1.09751059765578364e-04,
+             1.19415754717746877e-05,
+            -5.42268135794481338e-07,
+            -8.89853339567639109e-08,
+             1.95935889313916494e-08,
+            -7.48844845549869496e-10,
+            -2.67044188373638882e-10,
+             3.64659572110455207e-11,
+             2.52240756493798940e-12,
+            -8.94289511692812622e-13,
+            -8.53557675928318136e-15,
+             2.00604845777309360e-14,
+            -4.10722887991821217e-16,
+            -4.66551168358531074e-16,
+             1.57846283786733383e-17,
+             1.14302014034284302e-17
+        };
+
+        XLLBASIC_FORCE_INLINE double clampInput(double x)
+        {
+            return (x < -inputBound) ? -inputBound : ((x > inputBound) ? inputBound : x);
+        }
+
+        // 2^n for integer valued n in [-1022, 1023]. The biased exponent n + 1023 is read
+        // out of the mantissa of n + 1023 + shifter rather than converted with a cast,
+        // which has no vector form before AVX-512
+        XLLBASIC_FORCE_INLINE double powerOfTwo(double n)
+        {
+            double biased = n + 1023.0 + shifter;
+            long long biasedBits, shifterBits;
+            memcpy(&biasedBits, &biased, sizeof(double));
+            memcpy(&shifterBits, &shifter, sizeof(double));
+            long long bits = (biasedBits - shifterBits) << 52;
+            double result;
+            memcpy(&result, &bits, sizeof(double));
+            return result;
+        }
+
+        // exp(a) for -745 < a <= 0 using a Cody-Waite reduction a = n * ln(2) + r, 
+        // |r| <= ln(2) / 2, and a degree 13 Taylor polynomial for exp(r). 2^n is applied 
+        // as 2^(n/2) * 2^(n - n/2) so that denormal results need no special handling.
+        XLLBASIC_FORCE_INLINE double expNonPositive(double a)
+        {
+            const double log2e = 1.4426950408889634074;
+            const double ln2Hi = 6.93147180369123816490e-01;
+            const double ln2Lo = 1.90821492927058770002e-10;
+
+            double n = (a * log2e + shifter) - shifter;
+            double r = (a - n * ln2Hi) - n * ln2Lo;
+
+            double p = 1.0 / 6227020800.0;
+            p = p * r + 1.0 / 479001600.0;
+            p = p * r + 1.0 / 39916800.0;
+            p = p * r + 1.0 / 3628800.0;
+            p = p * r + 1.0 / 362880.0;
+            p = p * r + 1.0 / 40320.0;
+            p = p * r + 1.0 / 5040.0;
+            p = p * r + 1.0 / 720.0;
+            p = p * r + 1.0 / 120.0;
+            p = p * r + 1.0 / 24.0;
+            p = p * r + 1.0 / 6.0;
+            p = p * r + 0.5;
+            p = p * r + 1.0;
+            p = p * r + 1.0;
+
+            double n1 = (0.5 * n + shifter) - shifter;
+            return p * powerOfTwo(n1) * powerOfTwo(n - n1);
+        }
+
+        XLLBASIC_FORCE_INLINE void clenshawStep(double twoS, double c, double &b1, double &b2)
+        {
+            double b0 = twoS * b1 - b2 + c;
+            b2 = b1;
+            b1 = b0;
+        }
+
+        // N(x) for |x| <= 38. There are no comparisons in here: a comparison feeding a 
+        // select is all it takes for the optimiser to split the loop into branches, at
+        // which point it is no longer vectorised.
+        XLLBASIC_FORCE_INLINE double cdfKernel(double x)
+        {
+            double z = fabs(x) * oneOverRootTwo;
+            double t = (z - chebyshevK) / (z + chebyshevK);
+            double s = 2.0 * (t + 1.0) / (chebyshevTMax + 1.0) - 1.0;
+
+            // Clenshaw recurrence, written out in full for the same reason
+            double twoS = 2.0 * s, b1 = 0, b2 = 0;
+            clenshawStep(twoS, chebyshev[22], b1, b2);
+            clenshawStep(twoS, chebyshev[21], b1, b2);
+            clenshawStep(twoS, chebyshev[20], b1, b2);
+            clenshawStep(twoS, chebyshev[19], b1, b2);
+            clenshawStep(twoS, chebyshev[18], b1, b2);
+            clenshawStep(twoS, chebyshev[17], b1, b2);
+            clenshawStep(twoS, chebyshev[16], b1, b2);
+            clenshawStep(twoS, chebyshev[15], b1, b2);
+            clenshawStep(twoS, chebyshev[14], b1, b2);
+            clenshawStep(twoS, chebyshev[13], b1, b2);
+            clenshawStep(twoS, chebyshev[12], b1, b2);
+            clenshawStep(twoS, chebyshev[11], b1, b2);
+            clenshawStep(twoS, chebyshev[10], b1, b2);
+            clenshawStep(twoS, chebyshev[9], b1, b2);
+            clenshawStep(twoS, chebyshev[8], b1, b2);
+            clenshawStep(twoS, chebyshev[7], b1, b2);
+            clenshawStep(twoS, chebyshev[6], b1, b2);
+            clenshawStep(twoS, chebyshev[5], b1, b2);
+            clenshawStep(twoS, chebyshev[4], b1, b2);
+            clenshawStep(twoS, chebyshev[3], b1, b2);
+            clenshawStep(twoS, chebyshev[2], b1, b2);
+            clenshawStep(twoS, chebyshev[1], b1, b2);
+            double g = s * b1 - b2 + chebyshev[0];
+
+            // N(x) = lowerTail for x < 0 and 1 - lowerTail otherwise
+            double lowerTail = 0.5 * expNonPositive(-z * z) * g;
+            double isUpper = 0.5 + copysign(0.5, x);
+            return lowerTail + isUpper * (1.0 - 2.0 * lowerTail);
+        }
+
+        // The inputs are clamped in a separate pass for the same reason
+        XLLBASIC_FORCE_INLINE void cdfBlocks(size_t n, const double *x, double *result)
+        {
+            double clamped[cdfBlockSize];
+            for (size_t start = 0; start < n; start += cdfBlockSize)
+            {
+                size_t blockSize = min(cdfBlockSize, n - start);
+                for (size_t i = 0; i < blockSize; ++i)
+                {
+                    clamped[i] = clampInput(x[start + i]);
+                }
+                for (size_t i = 0; i < blockSize; ++i)
+                {
+                    result[start + i] = cdfKernel(clamped[i]);
+                }
+            }
+        }
+
+        void cdfScalar(size_t n, const double *x, double *result)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                result[i] = StandardNormal::cdf(x[i]);
+            }
+        }
+
+        // SSE2 is part of the x64 baseline so the plain loop is vectorised two wide
+        void cdfSse2(size_t n, const double *x, double *result)
+        {
+            cdfBlocks(n, x, result);
+        }
+
+#ifdef XLLBASIC_SIMD_TARGETS
+        __attribute__((target("avx2,fma")))
+        void cdfAvx2(size_t n, const double *x, double *result)
+        {
+            cdfBlocks(n, x, result);
+        }
+
+        __attribute__((target("avx512f,avx512dq")))
+        void cdfAvx512(size_t n, const double *x, double *result)
+        {
+            cdfBlocks(n, x, result);
+        }
+#endif
+
+        typedef void (*CdfArrayFunction)(size_t, const double *, double *);
+
+        CdfArrayFunction getCdfFunction(SimdInstructionSet instructionSet)
+        {
+            switch (instructionSet)
+            {
+#ifdef XLLBASIC_SIMD_TARGETS
+            case SIMD_AVX512:
+                return &cdfAvx512;
+            case SIMD_AVX2:
+                return &cdfAvx2;
+#endif
+            case SIMD_SSE2:
+                return &cdfSse2;
+            default:
+                return &cdfScalar;
+            }
+        }
+
+        SimdInstructionSet widestSupportedInstructionSet()
+        {
+            if (StandardNormal::isSupported(SIMD_AVX512))
+            {
+                return SIMD_AVX512;
+            }
+            if (StandardNormal::isSupported(SIMD_AVX2))
+            {
+                return SIMD_AVX2;
+            }
+            if (StandardNormal::isSupported(SIMD_SSE2))
+            {
+                return SIMD_SSE2;
+            }
+            return SIMD_SCALAR;
+        }
+
+        // Read by every array call, possibly on several threads at once, while
+        // setInstructionSet may change it, so it is atomic. The kernel is looked up from it
+        // on each call so that the two can never disagree.
+        atomic<SimdInstructionSet> &currentInstructionSet()
+        {
+            static atomic<SimdInstructionSet> instructionSet(widestSupportedInstructionSet());
+            return instructionSet;
+        }
+    }
+
+    /*======================================================================================
+    StandardNormal
+    =======================================================================================*/
+    double StandardNormal::pdf(double x)
+    {
+        x = clampInput(x);
+        return oneOverRootTwoPi * expNonPositive(-0.5 * x * x);
+    }
+
+    double StandardNormal::cdf(double x)
+    {
+        return cdfKernel(clampInput(x));
+    }
+
+    void StandardNormal::cdf(size_t n, const double *x, double *result)
+    {
+        getCdfFunction(currentInstructionSet().load(memory_order_relaxed))(n, x, result);
+    }
+
+    SimdInstructionSet StandardNormal::getInstructionSet()
+    {
+        return currentInstructionSet().load();
+    }
+
+    bool StandardNormal::isSupported(SimdInstructionSet instructionSet)
+    {
+        switch (instructionSet)
+        {
+        case SIMD_SCALAR:
+            return true;
+#if defined(__x86_64__) || defined(_M_X64)
+        case SIMD_SSE2:
+            return true;
+#endif
+#ifdef XLLBASIC_SIMD_TARGETS
+        case SIMD_AVX2:
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        case SIMD_AVX512:
+            return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq");
+#endif
+        default:
+            return false;
+        }
+    }
+
+    bool StandardNormal::setInstructionSet(SimdInstructionSet instructionSet)
+    {
+        if (!isSupported(instructionSet))
+        {
+            return false;
+        }
+        currentInstructionSet().store(instructionSet);
+        return true;
+    }
+}
+
+namespace XLLBasicLibrary
+{
+    namespace
+    {
+        const double twoPi = 6.28318530717958647693;
+
+        // Gauss-Legendre abscissae (on [-1, 0)) and weights for 6, 12 and 20 points; each
+        // abscissa is used with its reflection
+        const int legendreSizes[3] = { 3, 6, 10 };
+        const double legendreWeights[3][10] = {
+            { 0.1713244923791705, 0.3607615730481384, 0.4679139345726904 },
+            { 0.04717533638651177, 0.1069393259953183, 0.1600783285433464,
+              0.2031674267230659, 0.2334925365383547, 0.2491470458134029 },
+            { 0.01761400713915212, 0.04060142980038694, 0.06267204833410906,
+              0.08327674157670475, 0.1019301198172404, 0.1181945319615184,
+              0.1316886384491766, 0.1420961093183821, 0.1491729864726037,
+              0.1527533871307259 } };
+        const double legendreAbscissae[3][10] = {
+            { -0.9324695142031522, -0.6612093864662647, -0.2386191860831970 },
+            { -0.9815606342467191, -0.9041172563704750, -0.7699026741943050,
+              -0.5873179542866171, -0.3678314989981802, -0.1252334085114692 },
+            { -0.9931285991850949, -0.9639719272779138, -0.9122344282513259,
+              -0.8391169718222188, -0.7463319064601508, -0.6360536807265150,
+              -0.5108670019508271, -0.3737060887154196, -0.2277858511416451,
+              -0.07652652113349733 } };
+
+        // P(X > h, Y > k), Genz's BVND
+        double upperBivariateNormal(double h, double k, double r)
+        {
+            int ng = (fabs(r) < 0.3) ? 0 : ((fabs(r) < 0.75) ? 1 : 2);
+            int lg = legendreSizes[ng];
+            const double *w = legendreWeights[ng], *x = legendreAbscissae[ng];
+            double hk = h * k;
+            double bvn = 0;
+            if (fabs(r) < 0.925)
+            {
+                double hs = (h * h + k * k) / 2.0;
+                double asr = asin(r);
+                for (int i = 0; i < lg; ++i)
+                {
+                    double sn = sin(asr * (x[i] + 1.0) / 2.0);
+                    bvn += w[i] * exp((sn * hk - hs) / (1.0 - sn * sn));
+                    sn = sin(asr * (-x[i] + 1.0) / 2.0);
+                    bvn += w[i] * exp((sn * hk - hs) / (1.0 - sn * sn));
+                }
+                return bvn * asr / (2.0 * twoPi) + StandardNormal::cdf(-h) * StandardNormal::cdf(-k);
+            }
+            if (r < 0)
+            {
+                k = -k;
+                hk = -hk;
+            }
+            if (fabs(r) < 1.0)
+            {
+                double as = (1.0 - r) * (1.0 + r);
+                double a = sqrt(as);
+                double bs = (h - k) * (h - k);
+                double c = (4.0 - hk) / 8.0;
+                double d = (12.0 - hk) / 16.0;
+                bvn = a * exp(-(bs / as + hk) / 2.0) * (1.0 - c * (bs - as) * (1.0 - d * bs / 5.0) / 3.0 + c * d * as * as / 5.0);
+                if (hk > -160.0)
+                {
+                    double b = sqrt(bs);
+                    bvn -= exp(-hk / 2.0) * sqrt(twoPi) * StandardNormal::cdf(-b / a) * b * (1.0 - c * bs * (1.0 - d * bs / 5.0) / 3.0);
+                }
+                a /= 2.0;
+                for (int i = 0; i < lg; ++i)
+                {
+                    double xs = (a * (x[i] + 1.0)) * (a * (x[i] + 1.0));
+                    double rs = sqrt(1.0 - xs);
+                    bvn += a * w[i] * (exp(-bs / (2.0 * xs) - hk / (1.0 + rs)) / rs - exp(-(bs / xs + hk) / 2.0) * (1.0 + c * xs * (1.0 + d * xs)));
+                    xs = as * (-x[i] + 1.0) * (-x[i] + 1.0) / 4.0;
+                    rs = sqrt(1.0 - xs);
+                    bvn += a * w[i] * exp(-(bs / xs + hk) / 2.0) * (exp(-hk * (1.0 - rs) / (2.0 * (1.0 + rs))) / rs - (1.0 + c * xs * (1.0 + d * xs)));
+                }
+                bvn = -bvn / twoPi;
+            }
+            if (r > 0)
+            {
+                return bvn + StandardNormal::cdf(-max(h, k));
+            }
+            bvn = -bvn;
+            if (k > h)
+            {
+                bvn += (h < 0) ? StandardNormal::cdf(k) - StandardNormal::cdf(h) : StandardNormal::cdf(-h) - StandardNormal::cdf(-k);
+            }
+            return bvn;
+        }
+    }
+
+    double BivariateNormal::cdf(double a, double b, double rho)
+    {
+        return upperBivariateNormal(-a, -b, rho);
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef XLLBASIC_NORMALDISTRIBUTION_INCLUDED
+#define XLLBASIC_NORMALDISTRIBUTION_INCLUDED
+#pragma once
+
+#include <cstddef> // size_t
+
+namespace XLLBasicLibrary
+{
+    /*======================================================================================
+    As instruction sets are supported by the vectorised kernels, add them here
+    =======================================================================================*/
+    enum SimdInstructionSet
+    {
+        SIMD_SCALAR,
+        SIMD_SSE2,
+        SIMD_AVX2,
+        SIMD_AVX512
+    };
+
+    /*======================================================================================
+    StandardNormal
+
+    The N(0,1) distribution used in the pricing formula. The cumulative distribution N(x)
+    is evaluated as
+        N(-|x|) = 0.5 * exp(-z^2) * g(z),       z = |x| / sqrt(2)
+    where g(z) = exp(z^2) * erfc(z) is a smooth, bounded function which is approximated by
+    a Chebyshev expansion in t = (z - 4) / (z + 4). The kernel has no branches so that the
+    compiler can evaluate 2, 4 or 8 values per instruction. Against boost::math::cdf(normal)
+    the absolute error is below 1e-15 over the whole real line; the relative error in the
+    lower tail grows with |x| (about 1e-14 at x = -10) because exp(-z^2) is not split.
+
+    The array form dispatches at run time to the widest instruction set supported by the
+    CPU. The AVX2 and AVX-512 variants are only compiled by GCC and Clang on x86; other
+    compilers use the SSE2 / scalar paths. All paths give the same results to within an
+    ulp or two (fused multiply-adds change the rounding).
+    =======================================================================================*/
+    class StandardNormal
+    {
+    public:
+        static double pdf(double x);
+        static double cdf(double x);
+        // Writes N(x[i]) to result[i] for i = 0,...,n-1. x and result may be the same array
+        static void cdf(size_t n, const double *x, double *result);
+
+        // The instruction set used by cdf(n, x, result). This is the widest one the CPU
+        // supports unless it has been changed with setInstructionSet
+        static SimdInstructionSet getInstructionSet();
+        static bool isSupported(SimdInstructionSet instructionSet);
+        // Returns false, leaving the current instruction set unchanged, if the CPU or the
+        // compiler does not support the input. Mainly used for testing. It is safe to call
+        // while other threads price: each array call uses either the old or the new set.
+        static bool setInstructionSet(SimdInstructionSet instructionSet);
+    };
+
+    /*======================================================================================
+    BivariateNormal
+
+    M(a, b, rho) = P(X <= a, Y <= b) for standard normals X and Y with correlation rho in
+    [-1, 1], by Genz's algorithm ("Numerical computation of rectangular bivariate and
+    trivariate normal and t probabilities", 2004): Drezner and Wesolowsky's integral over
+    the correlation, with 6 to 20 point Gauss-Legendre quadrature depending on |rho|,
+    and for |rho| > 0.925 an expansion about rho = +/-1. The absolute error is about 1e-15.
+    =======================================================================================*/
+    class BivariateNormal
+    {
+    public:
+        static double cdf(double a, double b, double rho);
+    };
+}
+
+#endif
@@ -0,0 +1,147 @@
+#include "NormalDistributionTest.h"
+
+using namespace std;
+using namespace boost::unit_test_framework;
+using namespace XLLBasicLibrary;
+
+
+void NormalDistributionTest::testCdfAgainstBoost()
+{
+    BOOST_TEST_MESSAGE("Testing StandardNormal::cdf against boost ...");
+
+    // Black76Call uses d1 = ln(F/X)/sd + sd/2 which, for any sensible combination of 
+    // inputs, lies well inside [-40, 40]
+    boost::math::normal n_0_1;
+    double maxError = 0;
+    for (double x = -40; x <= 40; x += 0.0005)
+    {
+        double error = abs(StandardNormal::cdf(x) - boost::math::cdf(n_0_1, x));
+        maxError = max(maxError, error);
+    }
+    BOOST_CHECK(maxError < 1e-15);
+
+    // Relative accuracy in the lower tail, where put premiums come from
+    for (double x = -10; x < 0; x += 0.001)
+    {
+        double expected = boost::math::cdf(n_0_1, x);
+        BOOST_CHECK(abs(StandardNormal::cdf(x) - expected) / expected < 5e-14);
+    }
+
+    BOOST_CHECK(StandardNormal::cdf(0) == 0.5);
+    BOOST_CHECK(StandardNormal::cdf(1e300) == 1.0);
+    BOOST_CHECK(StandardNormal::cdf(-1e300) < 1e-300);
+}
+
+void NormalDistributionTest::testCdfInstructionSets()
+{
+    BOOST_TEST_MESSAGE("Testing StandardNormal::cdf for each supported instruction set ...");
+
+    vector<double> x, result;
+    for (double v = -40; v <= 40; v += 0.0011)
+    {
+        x.push_back(v);
+    }
+    result.resize(x.size());
+
+    SimdInstructionSet original = StandardNormal::getInstructionSet();
+    BOOST_CHECK(StandardNormal::isSupported(original));
+    BOOST_CHECK(StandardNormal::setInstructionSet(SIMD_SCALAR));
+
+    SimdInstructionSet instructionSets[] = {SIMD_SCALAR, SIMD_SSE2, SIMD_AVX2, SIMD_AVX512};
+    for (size_t k = 0; k < 4; ++k)
+    {
+        if (!StandardNormal::setInstructionSet(instructionSets[k]))
+        {
+            BOOST_CHECK(StandardNormal::getInstructionSet() != instructionSets[k]);
+            continue;
+        }
+        BOOST_CHECK(StandardNormal::getInstructionSet() == instructionSets[k]);
+        StandardNormal::cdf(x.size(), &x[0], &result[0]);
+        for (size_t i = 0; i < x.size(); ++i)
+        {
+            BOOST_CHECK(abs(result[i] - StandardNormal::cdf(x[i])) < 1e-15);
+        }
+        // in place
+        vector<double> y = x;
+        StandardNormal::cdf(y.size(), &y[0], &y[0]);
+        BOOST_CHECK(y == result);
+    }
+    StandardNormal::setInstructionSet(original);
+}
+
+void NormalDistributionTest::testPdf()
+{
+    BOOST_TEST_MESSAGE("Testing StandardNormal::pdf against boost ...");
+
+    boost::math::normal n_0_1;
+    for (double x = -20; x <= 20; x += 0.01)
+    {
+        double expected = boost::math::pdf(n_0_1, x);
+        BOOST_CHECK(abs(StandardNormal::pdf(x) - expected) <= 1e-15 * expected + 1e-300);
+    }
+}
+
+void NormalDistributionTest::testBivariateCdf()
+{
+    BOOST_TEST_MESSAGE("Testing BivariateNormal::cdf against numerical integration ...");
+
+    double limits[] = { -5, -1.5, -0.3, 0, 0.7, 2, 4 };
+    double correlations[] = { -1, -0.99, -0.8, -0.4, 0, 0.2, 0.6, 0.93, 0.99, 1 };
+    size_t nLimits = sizeof(limits) / sizeof(double);
+    for (size_t k = 0; k < sizeof(correlations) / sizeof(double); ++k)
+    {
+        double rho = correlations[k];
+        for (size_t i = 0; i < nLimits; ++i)
+        {
+            for (size_t j = 0; j < nLimits; ++j)
+            {
+                double a = limits[i], b = limits[j];
+                double expected;
+                if (rho == 1)
+                {
+                    expected = StandardNormal::cdf(min(a, b));
+                }
+                else if (rho == -1)
+                {
+                    expected = max(StandardNormal::cdf(a) + StandardNormal::cdf(b) - 1.0, 0.0);
+                }
+                else
+                {
+                    // M(a, b, rho) = integral of n(x) N((b - rho x) / sqrt(1 - rho^2)) up to a,
+                    // by Simpson's rule
+                    int steps = 20000;
+                    double lower = -12.0, h = (a - lower) / steps, sum = 0;
+                    for (int s = 0; s <= steps; ++s)
+                    {
+                        double x = lower + s * h;
+                        double weight = (s == 0 || s == steps) ? 1.0 : ((s % 2 == 1) ? 4.0 : 2.0);
+                        sum += weight * StandardNormal::pdf(x) * StandardNormal::cdf((b - rho * x) / sqrt(1 - rho * rho));
+                    }
+                    expected = sum * h / 3.0;
+                }
+                BOOST_CHECK(abs(BivariateNormal::cdf(a, b, rho) - expected) < 1e-12);
+            }
+        }
+    }
+    // Independence, and M(0, 0, rho) = 1/4 + asin(rho) / (2 pi) where the quadrature above
+    // is not accurate enough
+    BOOST_CHECK(abs(BivariateNormal::cdf(0.3, -0.8, 0) - StandardNormal::cdf(0.3) * StandardNormal::cdf(-0.8)) < 1e-15);
+    double nearOne[] = { -0.9999, -0.97, 0.5, 0.95, 0.999, 0.9999 };
+    for (size_t k = 0; k < sizeof(nearOne) / sizeof(double); ++k)
+    {
+        double expected = 0.25 + asin(nearOne[k]) / (2 * M_PI);
+        BOOST_CHECK(abs(BivariateNormal::cdf(0, 0, nearOne[k]) - expected) < 1e-15);
+    }
+}
+
+
+test_suite* NormalDistributionTest::suite() 
+{
+    test_suite* suite = BOOST_TEST_SUITE("Normal Distribution Tests");
+    suite->add(BOOST_TEST_CASE(&NormalDistributionTest::testCdfAgainstBoost));
+    suite->add(BOOST_TEST_CASE(&NormalDistributionTest::testCdfInstructionSets));
+    suite->add(BOOST_TEST_CASE(&NormalDistributionTest::testPdf));
+    suite->add(BOOST_TEST_CASE(&NormalDistributionTest::testBivariateCdf));
+
+    return suite;
+}
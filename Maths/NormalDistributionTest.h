@@ -0,0 +1,21 @@
+#ifndef XLLBASIC_test_normaldistribution
+#define XLLBASIC_test_normaldistribution
+
+#include <iostream>
+#include <boost/test/unit_test.hpp>
+#include <boost/math/distributions/normal.hpp>
+#include "NormalDistribution.h"
+
+class NormalDistributionTest 
+{
+public:
+    static void testCdfAgainstBoost();
+    // The vectorised array form must agree with the scalar form for every instruction set
+    static void testCdfInstructionSets();
+    static void testPdf();
+    static void testBivariateCdf();
+
+    static boost::unit_test_framework::test_suite* suite();
+};
+
+#endif
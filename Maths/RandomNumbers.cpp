@@ -0,0 +1,65 @@
+#include "RandomNumbers.h"
+
+#include <cmath>
+
+namespace XLLBasicLibrary
+{
+    namespace
+    {
+        const uint32_t philoxMultiplier0 = 0xD2511F53;
+        const uint32_t philoxMultiplier1 = 0xCD9E8D57;
+        // Weyl sequence increments of the key: the golden ratio and sqrt(3) - 1
+        const uint32_t philoxWeyl0 = 0x9E3779B9;
+        const uint32_t philoxWeyl1 = 0xBB67AE85;
+        const int philoxRounds = 10;
+
+        const double twoPi = 6.283185307179586476925286766559;
+
+        // A uniform in (0, 1) from 64 random bits, using the top 53
+        double toUniform(uint32_t high, uint32_t low)
+        {
+            uint64_t bits = (((uint64_t)high << 32) | low) >> 11;
+            return ((double)bits + 0.5) * (1.0 / 9007199254740992.0); // 2^-53
+        }
+    }
+
+    void Philox4x32::generate(uint32_t counter[4]) const
+    {
+        uint32_t k0 = key0, k1 = key1;
+        uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+        for (int round = 0; round < philoxRounds; ++round)
+        {
+            uint64_t product0 = (uint64_t)philoxMultiplier0 * c0;
+            uint64_t product1 = (uint64_t)philoxMultiplier1 * c2;
+            uint32_t next0 = (uint32_t)(product1 >> 32) ^ c1 ^ k0;
+            uint32_t next2 = (uint32_t)(product0 >> 32) ^ c3 ^ k1;
+            c1 = (uint32_t)product1;
+            c3 = (uint32_t)product0;
+            c0 = next0;
+            c2 = next2;
+            k0 += philoxWeyl0;
+            k1 += philoxWeyl1;
+        }
+        counter[0] = c0;
+        counter[1] = c1;
+        counter[2] = c2;
+        counter[3] = c3;
+    }
+
+    void Philox4x32::getNormals(uint64_t stream, size_t n, double *normals) const
+    {
+        for (size_t i = 0; i < n; i += 2)
+        {
+            uint64_t block = i / 2;
+            uint32_t counter[4] = { (uint32_t)block, (uint32_t)(block >> 32), (uint32_t)stream, (uint32_t)(stream >> 32) };
+            generate(counter);
+            double radius = sqrt(-2.0 * log(toUniform(counter[0], counter[1])));
+            double angle = twoPi * toUniform(counter[2], counter[3]);
+            normals[i] = radius * cos(angle);
+            if (i + 1 < n)
+            {
+                normals[i + 1] = radius * sin(angle);
+            }
+        }
+    }
+}
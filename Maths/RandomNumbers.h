@@ -0,0 +1,39 @@
+#ifndef XLLBASIC_RANDOMNUMBERS_INCLUDED
+#define XLLBASIC_RANDOMNUMBERS_INCLUDED
+#pragma once
+
+#include <cstddef> // size_t
+#include <stdint.h>
+
+namespace XLLBasicLibrary
+{
+    /*======================================================================================
+    Philox4x32
+
+    The Philox4x32-10 counter based generator of Salmon, Moraes, Dror and Shaw, "Parallel
+    random numbers: as easy as 1, 2, 3" (SC11). Each call maps a 128 bit counter and a 64
+    bit key to 128 random bits with no state in between, so any number of threads can
+    draw from independent, reproducible streams without sharing or skipping ahead: stream
+    s, block b is simply the counter (s, b).
+
+    Monte Carlo code uses the seed as the key and the path number as the stream, so a path
+    has the same random numbers however the paths are shared between threads.
+    =======================================================================================*/
+    class Philox4x32
+    {
+    public:
+        explicit Philox4x32(uint64_t seed) : key0((uint32_t)seed), key1((uint32_t)(seed >> 32)) {};
+
+        // The 4 random words for counter (counter[0], ..., counter[3]), overwriting counter
+        void generate(uint32_t counter[4]) const;
+
+        // Fills normals[0], ..., normals[n-1] with independent N(0,1) draws from stream
+        // number stream. Uses Box-Muller on 53 bit uniforms, two normals per counter.
+        void getNormals(uint64_t stream, size_t n, double *normals) const;
+
+    private:
+        uint32_t key0, key1;
+    };
+}
+
+#endif
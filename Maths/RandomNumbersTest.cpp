@@ -0,0 +1,76 @@
+#include "RandomNumbersTest.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace std;
+using namespace boost::unit_test_framework;
+using namespace XLLBasicLibrary;
+
+void RandomNumbersTest::testPhiloxKnownAnswers()
+{
+    BOOST_TEST_MESSAGE("Testing Philox4x32-10 against its known answer vectors ...");
+
+    uint32_t zero[4] = { 0, 0, 0, 0 };
+    Philox4x32(0).generate(zero);
+    BOOST_CHECK(zero[0] == 0x6627e8d5 && zero[1] == 0xe169c58d && zero[2] == 0xbc57ac4c && zero[3] == 0x9b00dbd8);
+
+    uint32_t ones[4] = { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff };
+    Philox4x32(0xffffffffffffffffULL).generate(ones);
+    BOOST_CHECK(ones[0] == 0x408f276d && ones[1] == 0x41c83b0e && ones[2] == 0xa20bc7c6 && ones[3] == 0x6d5451fd);
+
+    // The digits of pi; the key is (0xa4093822, 0x299f31d0)
+    uint32_t pi[4] = { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 };
+    Philox4x32(0x299f31d0a4093822ULL).generate(pi);
+    BOOST_CHECK(pi[0] == 0xd16cfe09 && pi[1] == 0x94fdcceb && pi[2] == 0x5001e420 && pi[3] == 0x24126ea1);
+}
+
+void RandomNumbersTest::testNormals()
+{
+    BOOST_TEST_MESSAGE("Testing Philox normals ...");
+
+    Philox4x32 generator(42);
+    const size_t streams = 2000, n = 251;
+    vector<double> normals(n);
+    double sum = 0, sumOfSquares = 0, sumOfFourthPowers = 0, sumOfLagProducts = 0;
+    for (size_t stream = 0; stream < streams; ++stream)
+    {
+        generator.getNormals(stream, n, &normals[0]);
+        for (size_t i = 0; i < n; ++i)
+        {
+            sum += normals[i];
+            sumOfSquares += normals[i] * normals[i];
+            sumOfFourthPowers += pow(normals[i], 4);
+            sumOfLagProducts += (i > 0) ? normals[i] * normals[i - 1] : 0;
+        }
+    }
+    double count = (double)(streams * n);
+    // Each bound is about 5 standard errors
+    BOOST_CHECK(abs(sum / count) < 5 / sqrt(count));
+    BOOST_CHECK(abs(sumOfSquares / count - 1) < 5 * sqrt(2 / count));
+    BOOST_CHECK(abs(sumOfFourthPowers / count - 3) < 5 * sqrt(96 / count));
+    BOOST_CHECK(abs(sumOfLagProducts / count) < 5 / sqrt(count));
+
+    // A stream is reproducible, does not depend on how many numbers are drawn from it and
+    // differs from the other streams and seeds
+    vector<double> first(5), again(6), other(5), otherSeed(5);
+    generator.getNormals(7, 5, &first[0]);
+    generator.getNormals(7, 6, &again[0]);
+    generator.getNormals(8, 5, &other[0]);
+    Philox4x32(43).getNormals(7, 5, &otherSeed[0]);
+    for (size_t i = 0; i < 5; ++i)
+    {
+        BOOST_CHECK(first[i] == again[i]);
+        BOOST_CHECK(first[i] != other[i]);
+        BOOST_CHECK(first[i] != otherSeed[i]);
+    }
+}
+
+test_suite* RandomNumbersTest::suite()
+{
+    test_suite* suite = BOOST_TEST_SUITE("Random Numbers Suite");
+    suite->add(BOOST_TEST_CASE(&RandomNumbersTest::testPhiloxKnownAnswers));
+    suite->add(BOOST_TEST_CASE(&RandomNumbersTest::testNormals));
+
+    return suite;
+}
@@ -0,0 +1,18 @@
+#ifndef XLLBASIC_test_randomnumbers
+#define XLLBASIC_test_randomnumbers
+
+#include <iostream>
+#include <boost/test/unit_test.hpp>
+#include "RandomNumbers.h"
+
+class RandomNumbersTest 
+{
+public:
+    // Known answers from the Random123 distribution
+    static void testPhiloxKnownAnswers();
+    static void testNormals();
+
+    static boost::unit_test_framework::test_suite* suite();
+};
+
+#endif
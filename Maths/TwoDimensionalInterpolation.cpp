@@ -12,9 +12,9 @@ namespace XLLBasicLibrary
     TwoDimensionalInterpolator::TwoDimensionalInterpolator(
         vector<double> xVector,
         vector<double> yVector,
-        vector<vector<double> > zMatrix,
+        Matrix zMatrix,
         bool extrapolate) :
-        x(xVector), y(yVector), z(zMatrix), allowExtrapolation(extrapolate)
+        x(std::move(xVector)), y(std::move(yVector)), z(std::move(zMatrix)), allowExtrapolation(extrapolate)
     {
         className = "TwoDimensionalInterpolation";
         if (!isOk())
@@ -23,25 +23,25 @@ namespace XLLBasicLibrary
         }
     }
 
+    TwoDimensionalInterpolator::TwoDimensionalInterpolator(
+        vector<double> xVector,
+        vector<double> yVector,
+        const vector<vector<double> > &zMatrix,
+        bool extrapolate) :
+        TwoDimensionalInterpolator(std::move(xVector), std::move(yVector), Matrix(zMatrix), extrapolate)
+    {
+    }
 
     bool TwoDimensionalInterpolator::isOk() 
     {
-        size_t zRows = z.size();
-        size_t zColumns = z[0].size();
+        size_t zRows = z.getRows();
+        size_t zColumns = z.getColumns();
 
         if ((x.size() < 2) || (y.size() < 2) || (zRows < 2) || (zColumns < 2))
         {
             errorMessage = className + ": The input x, y or z data does not have sufficient data";
             return false;
         }
-        for (size_t i = 1; i < zRows; ++i)
-        {
-            if (z[i].size() != zColumns)
-            {
-                errorMessage = className + ": Columns do not have consistent dimension";
-                return false;
-            }
-        }
         if (!is_strictly_increasing(x.begin(), x.end()))
         {
             errorMessage = className + ": X inputs not structly increasing";
@@ -79,48 +79,83 @@ namespace XLLBasicLibrary
         return false;
     }
 
-    size_t TwoDimensionalInterpolator::locateX(double xInput) const
+    /*======================================================================================
+    GridSlice
+    
+    ======================================================================================*/
+    GridSlice::GridSlice(const vector<double> &yVector, vector<double> coefficients, bool xInRange, bool extrapolate) :
+        y(yVector), coefficients(std::move(coefficients)), xInRange(xInRange), allowExtrapolation(extrapolate)
     {
-        if (xInput < getXStart())
+    }
+
+    bool GridSlice::isInRange(double yInput) const
+    {
+        if (allowExtrapolation)
         {
-            return 0;
+            return true;
         }
-        else if (xInput > getXEnd())
+        return xInRange && (yInput >= y.front()) && (yInput <= y.back());
+    }
+
+    double GridSlice::getRate(double yInput) const
+    {
+        if (!isInRange(yInput))
         {
-            return x.size() - 2;
+            return numeric_limits<double>::quiet_NaN();
         }
-        size_t index = 0;
-        while ((index < x.size()) && (x[index] < xInput))
+        return interpolate(locateGridInterval(&y[0], y.size(), yInput), yInput);
+    }
+
+    double GridSlice::getRate(double yInput, size_t &yIndex) const
+    {
+        if (!isInRange(yInput))
         {
-            ++index;
+            return numeric_limits<double>::quiet_NaN();
         }
-        if (index > 0)
+        yIndex = locateGridInterval(&y[0], y.size(), yInput, yIndex);
+        return interpolate(yIndex, yInput);
+    }
+
+    double GridSlice::getRate(double yInput, size_t &yIndex, double &derivative) const
+    {
+        if (!isInRange(yInput))
         {
-            --index;
+            derivative = numeric_limits<double>::quiet_NaN();
+            return derivative;
         }
-        return index;
+        yIndex = locateGridInterval(&y[0], y.size(), yInput, yIndex);
+        const double *c = &coefficients[4 * yIndex];
+        double h = y[yIndex + 1] - y[yIndex];
+        double u = (yInput - y[yIndex]) / h;
+        derivative = ((3.0 * c[3] * u + 2.0 * c[2]) * u + c[1]) / h;
+        return interpolate(yIndex, yInput);
+    }
+
+    double GridSlice::interpolate(size_t j, double yInput) const
+    {
+        const double *c = &coefficients[4 * j];
+        double u = (yInput - y[j]) / (y[j + 1] - y[j]);
+        return ((c[3] * u + c[2]) * u + c[1]) * u + c[0];
+    }
+
+    size_t TwoDimensionalInterpolator::locateX(double xInput) const
+    {
+        return locateGridInterval(&x[0], x.size(), xInput);
     }
 
     size_t TwoDimensionalInterpolator::locateY(double yInput) const 
     {
-        if (yInput < getYStart())
-        {
-            return 0;
-        }
-        else if (yInput > getYEnd())
-        {
-            return y.size() - 2;
-        }
-        size_t index = 0;
-        while ((index < y.size()) && (y[index] < yInput))
-        {
-            ++index;
-        }
-        if (index > 0)
-        {
-            --index;
-        }
-        return index;
+        return locateGridInterval(&y[0], y.size(), yInput);
+    }
+
+    size_t TwoDimensionalInterpolator::locateX(double xInput, size_t hint) const
+    {
+        return locateGridInterval(&x[0], x.size(), xInput, hint);
+    }
+
+    size_t TwoDimensionalInterpolator::locateY(double yInput, size_t hint) const 
+    {
+        return locateGridInterval(&y[0], y.size(), yInput, hint);
     }
 
 
@@ -131,71 +166,208 @@ namespace XLLBasicLibrary
     BilinearInterpolator::BilinearInterpolator(
         vector<double> xVector, 
         vector<double> yVector, 
-        vector<vector<double> > zMatrix,
+        Matrix zMatrix,
         bool extrapolate) :
-        TwoDimensionalInterpolator(xVector, yVector, zMatrix, extrapolate)
+        TwoDimensionalInterpolator(std::move(xVector), std::move(yVector), std::move(zMatrix), extrapolate)
+    {
+        className = "BilinearInterpolator";
+    };
+
+    BilinearInterpolator::BilinearInterpolator(
+        vector<double> xVector, 
+        vector<double> yVector, 
+        const vector<vector<double> > &zMatrix,
+        bool extrapolate) :
+        TwoDimensionalInterpolator(std::move(xVector), std::move(yVector), zMatrix, extrapolate)
     {
         className = "BilinearInterpolator";
     };
 
     double BilinearInterpolator::getRate(double xInput, double yInput) const
     {
-        if (!isInRange(xInput, yInput))
+        if (allowExtrapolation)
         {
-            return numeric_limits<double>::quiet_NaN();
+            return getKernel<Extrapolate, UncheckedRange>().getRate(xInput, yInput);
         }
+        return getKernel<NoExtrapolation, NaNOutOfRange>().getRate(xInput, yInput);
+    }
 
-        size_t i = locateX(xInput);
-        double x1 = x[i], x2 = x[i + 1];
-
-        size_t j = locateY(yInput);
-        double y1 = y[j], y2 = y[j + 1];
+    double BilinearInterpolator::getRate(double xInput, double yInput, GridCursor &cursor) const
+    {
+        if (allowExtrapolation)
+        {
+            return getKernel<Extrapolate, UncheckedRange>().getRate(xInput, yInput, cursor);
+        }
+        return getKernel<NoExtrapolation, NaNOutOfRange>().getRate(xInput, yInput, cursor);
+    }
 
-        double z1 = z[j][i],
-               z2 = z[j+1][i],
-               z3 = z[j][i+1],
-               z4 = z[j+1][i+1];
+    double BilinearInterpolator::getRate(double xInput, double yInput, GridCursor &cursor, double &derivative) const
+    {
+        if (allowExtrapolation)
+        {
+            return getKernel<Extrapolate, UncheckedRange>().getRate(xInput, yInput, cursor, derivative);
+        }
+        return getKernel<NoExtrapolation, NaNOutOfRange>().getRate(xInput, yInput, cursor, derivative);
+    }
 
-      double t = (xInput-x1)/(x2-x1);
-      double u = (yInput-y1)/(y2-y1);
-      return (1-t)*(1-u)*z1 + t*(1-u)*z3 + t*u*z4 + (1-t)*u*z2;
+    GridSlice BilinearInterpolator::getSlice(double xInput) const
+    {
+        // Along y the interpolant is linear between the values at the nodes y_j
+        size_t i = locateX(xInput);
+        double t = (xInput - x[i]) / (x[i + 1] - x[i]);
+        vector<double> coefficients(4 * (y.size() - 1), 0.0);
+        double lower = (1 - t) * z(0, i) + t * z(0, i + 1);
+        for (size_t j = 0; j < y.size() - 1; ++j)
+        {
+            double upper = (1 - t) * z(j + 1, i) + t * z(j + 1, i + 1);
+            coefficients[4 * j] = lower;
+            coefficients[4 * j + 1] = upper - lower;
+            lower = upper;
+        }
+        bool xInRange = (xInput >= getXStart()) && (xInput <= getXEnd());
+        return GridSlice(y, std::move(coefficients), xInRange, allowExtrapolation);
     }
 
    /*======================================================================================
    BicubicInterpolator
     
    ======================================================================================*/
+    namespace
+    {
+        // On [v_i, v_i+1] a cubic spline with values f and second derivatives m is the
+        // polynomial p_0 + p_1 s + p_2 s^2 + p_3 s^3 in s = (v - v_i) / h. Writes p.
+        void splineCellCoefficients(double h, double f0, double f1, double m0, double m1, double *p)
+        {
+            double scale = h * h / 6.0;
+            p[0] = f0;
+            p[1] = f1 - f0 - scale * (2.0 * m0 + m1);
+            p[2] = scale * 3.0 * m0;
+            p[3] = scale * (m1 - m0);
+        }
+    }
+
     BicubicInterpolator::BicubicInterpolator(
         vector<double> xVector, 
         vector<double> yVector, 
-        vector<vector<double> > zMatrix, 
+        Matrix zMatrix, 
         bool extrapolate) :
-        TwoDimensionalInterpolator(xVector, yVector, zMatrix, extrapolate) 
+        TwoDimensionalInterpolator(std::move(xVector), std::move(yVector), std::move(zMatrix), extrapolate) 
     {
         className = "BicubicInterpolator";
+        calculateCoefficients();
+    }
 
-        for (size_t i = 0; i < y.size(); ++i) 
+    BicubicInterpolator::BicubicInterpolator(
+        vector<double> xVector, 
+        vector<double> yVector, 
+        const vector<vector<double> > &zMatrix, 
+        bool extrapolate) :
+        TwoDimensionalInterpolator(std::move(xVector), std::move(yVector), zMatrix, extrapolate) 
+    {
+        className = "BicubicInterpolator";
+        calculateCoefficients();
+    }
+
+    void BicubicInterpolator::calculateCoefficients()
+    {
+        size_t nx = x.size(), ny = y.size();
+
+        // rowCoefficients[4 * (k * (nx - 1) + i) + a]: the row k spline on x cell i
+        vector<double> rowCoefficients(4 * ny * (nx - 1));
+        for (size_t k = 0; k < ny; ++k)
+        {
+            const double *row = z.getRow(k);
+            CubicSplineInterpolator rowSpline(&x[0], row, nx, 0, 0, false);
+            const vector<double> &m = rowSpline.getSecondDerivatives();
+            for (size_t i = 0; i < nx - 1; ++i)
+            {
+                splineCellCoefficients(x[i + 1] - x[i], row[i], row[i + 1], m[i], m[i + 1], 
+                    &rowCoefficients[4 * (k * (nx - 1) + i)]);
+            }
+        }
+
+        // The spline in y is linear in the row values. columnWeights[4 * (k * (ny - 1) + j) + b]
+        // is the weight of row k in the coefficient of u^b on y cell j, found by splining 
+        // the unit vector e_k
+        vector<double> columnWeights(4 * ny * (ny - 1));
+        vector<double> unit(ny, 0.0);
+        for (size_t k = 0; k < ny; ++k)
         {
-            vector<double> z_i = z[i];
-            splines.push_back(CubicSplineInterpolator(xVector, z_i, 0, 0, false));
+            unit[k] = 1.0;
+            CubicSplineInterpolator columnSpline(&y[0], &unit[0], ny, 0, 0, true);
+            const vector<double> &m = columnSpline.getSecondDerivatives();
+            for (size_t j = 0; j < ny - 1; ++j)
+            {
+                splineCellCoefficients(y[j + 1] - y[j], unit[j], unit[j + 1], m[j], m[j + 1],
+                    &columnWeights[4 * (k * (ny - 1) + j)]);
+            }
+            unit[k] = 0.0;
+        }
+
+        coefficients = vector<double>(16 * (nx - 1) * (ny - 1), 0.0);
+        for (size_t j = 0; j < ny - 1; ++j)
+        {
+            for (size_t i = 0; i < nx - 1; ++i)
+            {
+                double *c = &coefficients[16 * (j * (nx - 1) + i)];
+                for (size_t k = 0; k < ny; ++k)
+                {
+                    const double *r = &rowCoefficients[4 * (k * (nx - 1) + i)];
+                    const double *w = &columnWeights[4 * (k * (ny - 1) + j)];
+                    for (size_t a = 0; a < 4; ++a)
+                    {
+                        for (size_t b = 0; b < 4; ++b)
+                        {
+                            c[4 * a + b] += r[a] * w[b];
+                        }
+                    }
+                }
+            }
         }
     };
 
     double BicubicInterpolator::getRate(double xInput, double yInput) const
     {
-        if (!isInRange(xInput, yInput))
+        if (allowExtrapolation)
         {
-            return numeric_limits<double>::quiet_NaN();
+            return getKernel<Extrapolate, UncheckedRange>().getRate(xInput, yInput);
         }
+        return getKernel<NoExtrapolation, NaNOutOfRange>().getRate(xInput, yInput);
+    }
 
-        std::vector<double> section(splines.size());
-        for (size_t i = 0; i < splines.size(); i++)
+    double BicubicInterpolator::getRate(double xInput, double yInput, GridCursor &cursor) const
+    {
+        if (allowExtrapolation)
         {
-            section[i] = splines[i].getRate(xInput);
+            return getKernel<Extrapolate, UncheckedRange>().getRate(xInput, yInput, cursor);
         }
+        return getKernel<NoExtrapolation, NaNOutOfRange>().getRate(xInput, yInput, cursor);
+    }
 
-        CubicSplineInterpolator spline = CubicSplineInterpolator(y, section, 0, 0, true);
+    double BicubicInterpolator::getRate(double xInput, double yInput, GridCursor &cursor, double &derivative) const
+    {
+        if (allowExtrapolation)
+        {
+            return getKernel<Extrapolate, UncheckedRange>().getRate(xInput, yInput, cursor, derivative);
+        }
+        return getKernel<NoExtrapolation, NaNOutOfRange>().getRate(xInput, yInput, cursor, derivative);
+    }
 
-        return spline.getRate(yInput);
+    GridSlice BicubicInterpolator::getSlice(double xInput) const
+    {
+        // With t fixed the cell polynomial is a cubic in u with coefficients sum_a c_ab t^a
+        size_t i = locateX(xInput);
+        double t = (xInput - x[i]) / (x[i + 1] - x[i]);
+        vector<double> coefficients(4 * (y.size() - 1));
+        for (size_t j = 0; j < y.size() - 1; ++j)
+        {
+            const double *c = &this->coefficients[16 * (j * (x.size() - 1) + i)];
+            for (size_t b = 0; b < 4; ++b)
+            {
+                coefficients[4 * j + b] = ((c[12 + b] * t + c[8 + b]) * t + c[4 + b]) * t + c[b];
+            }
+        }
+        bool xInRange = (xInput >= getXStart()) && (xInput <= getXEnd());
+        return GridSlice(y, std::move(coefficients), xInRange, allowExtrapolation);
     }
-}
\ No newline at end of file
+}
@@ -4,6 +4,8 @@
 
 //#include <ql\math\interpolations\all.hpp>
 #include "maths.h"
+#include "InterpolationKernels.h"
+#include "Matrix.h"
 
 namespace XLLBasicLibrary 
 {
@@ -29,23 +31,65 @@ namespace XLLBasicLibrary
         volatility += v0, v1, v2;
 
    ======================================================================================*/
+
+   /*======================================================================================
+   GridSlice
+    
+    A TwoDimensionalInterpolator with x held fixed: the one dimensional curve y -> z(x, y),
+    returned by getSlice(x). On each y cell it is a cubic in u = (y - y_j) / (y_j+1 - y_j)
+    whose coefficients are calculated once, so a query does no interpolation in x. The 
+    values agree with the interpolator's getRate(x, y) to rounding, including NaN outside 
+    the range when the interpolator does not extrapolate.
+   ======================================================================================*/
+    class GridSlice
+    {
+    public:
+        GridSlice() : xInRange(false), allowExtrapolation(false) {};
+        // coefficients[4 * j + b] multiplies u^b on the cell [y_j, y_j+1]
+        GridSlice(const vector<double> &yVector, vector<double> coefficients, bool xInRange, bool extrapolate);
+
+        bool isInRange(double y) const;
+        double getRate(double y) const;
+        // As above, starting the search from the cell in yIndex and leaving the cell used 
+        // there, like GridCursor
+        double getRate(double y, size_t &yIndex) const;
+        // As above, also setting derivative to dz/dy
+        double getRate(double y, size_t &yIndex, double &derivative) const;
+
+        double getYStart() const   {return y.front();};
+        double getYEnd() const   {return y.back();};
+
+    private:
+        double interpolate(size_t j, double y) const;
+
+        vector<double> y, coefficients;
+        bool xInRange, allowExtrapolation;
+    };
+
     class TwoDimensionalInterpolator
     {
     public:
         // Throws a runtime error if the inputs are not correct, i.e. if 
         //  - xVector and yVector are not strictly increasing
         //  - dimensions of zMatrix are not consistent
+        // z is held as one Matrix with a row per y value. Pass the Matrix as an rvalue to
+        // move it in; the vector of vectors form copies it once into a Matrix.
+        TwoDimensionalInterpolator(
+            vector<double> xVector,
+            vector<double> yVector,
+            Matrix zMatrix,
+            bool extrapolate = false);
         TwoDimensionalInterpolator(
             vector<double> xVector,
             vector<double> yVector,
-            vector<vector<double> > zMatrix,
+            const vector<vector<double> > &zMatrix,
             bool extrapolate = false);
 
         virtual ~TwoDimensionalInterpolator()   {};
    
-        virtual void setX(vector<double> xVector)             {x = xVector;};
-        virtual void setY(vector<double> yVector)             {y = yVector;};
-        virtual void setZ(vector<vector<double> > zMatrix)    {z = zMatrix;};
+        virtual void setX(vector<double> xVector)             {x = std::move(xVector);};
+        virtual void setY(vector<double> yVector)             {y = std::move(yVector);};
+        virtual void setZ(Matrix zMatrix)                     {z = std::move(zMatrix);};
 
         virtual bool isOk();
         string getErrorMessage() const  {return errorMessage;};
@@ -54,10 +98,23 @@ namespace XLLBasicLibrary
         bool isInRange(double x, double y) const;
         // I assume yu have called isInRange(x, y) by this stage if you need to
         virtual double getRate(double x, double y) const = 0;
-
-        // given a point (xInput, yInput) we use the following methods to find the "boundary" 
+        // As above, starting the search from the cell in the cursor and leaving the cell
+        // used in the cursor
+        virtual double getRate(double x, double y, GridCursor &cursor) const {return getRate(x, y);};
+        // As above, also setting derivative to dz/dy, as GridSlice does but without building
+        // the slice
+        virtual double getRate(double x, double y, GridCursor &cursor, double &derivative) const = 0;
+        // The curve in y at x, for many queries at the same x
+        virtual GridSlice getSlice(double x) const = 0;
+
+        // given a point (xInput, yInput) we use the following methods to find the "boundary".
+        // The index i returned is that of the interval [x_i, x_i+1] containing the input, 
+        // with inputs outside the grid mapped to the first or last interval. The search is
+        // O(log n); with a hint, inputs in or next to the hinted interval are found in O(1)
         size_t locateX(double xInput) const;
         size_t locateY(double yInput) const;
+        size_t locateX(double xInput, size_t hint) const;
+        size_t locateY(double yInput, size_t hint) const;
 
         double getXStart()   const {return x.front();};
         double getXEnd()   const {return x.back();};
@@ -67,7 +124,8 @@ namespace XLLBasicLibrary
    protected:
 
         vector<double> x, y;
-        vector<vector<double> > z;
+        // z(j, i) is the value at (x_i, y_j)
+        Matrix z;
 
         bool allowExtrapolation;
         bool hasError; // used if any of the inputs are not of the assumed type
@@ -85,18 +143,40 @@ namespace XLLBasicLibrary
         BilinearInterpolator(
             vector<double> xVector, 
             vector<double> yVector, 
-            vector<vector<double> > zMatrix, 
+            Matrix zMatrix, 
+            bool extrapolate);
+        BilinearInterpolator(
+            vector<double> xVector, 
+            vector<double> yVector, 
+            const vector<vector<double> > &zMatrix, 
             bool extrapolate);
 
         ~BilinearInterpolator() {};
 
         virtual double getRate(double x, double y) const;
-
+        virtual double getRate(double x, double y, GridCursor &cursor) const;
+        virtual double getRate(double x, double y, GridCursor &cursor, double &derivative) const;
+        virtual GridSlice getSlice(double x) const;
+
+        // The kernel over this grid, for loops that interpolate it many times, see 
+        // InterpolationKernels.h
+        template <class Extrapolation, class Bounds>
+        GridKernel<BilinearCell, Extrapolation, Bounds> getKernel() const
+        {
+            return GridKernel<BilinearCell, Extrapolation, Bounds>(&x[0], x.size(), &y[0], y.size(), z.getRow(0));
+        }
     };
 
    /*======================================================================================
    BicubicInterpolator
     
+   The interpolant is a cubic spline in x along each row of z followed by a cubic spline in
+   y through the row values. Both steps are linear in z so, on each grid cell, the result 
+   is a fixed bicubic polynomial in the cell coordinates 
+        t = (x - x_i) / (x_i+1 - x_i),  u = (y - y_j) / (y_j+1 - y_j)
+   The 16 coefficients of every cell are calculated once at construction, so a query is a
+   locate and a polynomial evaluation with no allocation. Outside the grid the polynomial
+   of the nearest cell is used.
    ======================================================================================*/
     class BicubicInterpolator : public TwoDimensionalInterpolator 
     {
@@ -104,18 +184,35 @@ namespace XLLBasicLibrary
         BicubicInterpolator(
             vector<double> xVector, 
             vector<double> yVector, 
-            vector<vector<double> > zMatrix, 
+            Matrix zMatrix, 
+            bool extrapolate);
+        BicubicInterpolator(
+            vector<double> xVector, 
+            vector<double> yVector, 
+            const vector<vector<double> > &zMatrix, 
             bool extrapolate);
 
         ~BicubicInterpolator() {};
 
         virtual double getRate(double x, double y) const;
+        virtual double getRate(double x, double y, GridCursor &cursor) const;
+        virtual double getRate(double x, double y, GridCursor &cursor, double &derivative) const;
+        virtual GridSlice getSlice(double x) const;
+
+        // The kernel over this grid, for loops that interpolate it many times, see 
+        // InterpolationKernels.h
+        template <class Extrapolation, class Bounds>
+        GridKernel<BicubicCell, Extrapolation, Bounds> getKernel() const
+        {
+            return GridKernel<BicubicCell, Extrapolation, Bounds>(&x[0], x.size(), &y[0], y.size(), &coefficients[0]);
+        }
 
     protected:
-        vector<CubicSplineInterpolator> splines;
-        //vector<QuantLib::Interpolation> splines;
-
+        void calculateCoefficients();
 
+        // coefficients[16 * (j * (x.size() - 1) + i) + 4 * a + b] multiplies t^a u^b on 
+        // the cell [x_i, x_i+1] x [y_j, y_j+1]
+        vector<double> coefficients;
     };
 }
 
@@ -125,9 +125,232 @@ void Maths2DInterpTest::testBicubicInterpolator()
     CubicSplineInterpolator finalInterpolator = CubicSplineInterpolator(delta, lPoints, true);
     BOOST_CHECK(abs(interpolator.getRate(timePoint, deltaPoint) - finalInterpolator.getRate(deltaPoint)) < 1e-12);
     BOOST_CHECK(boost::math::isnan<double>(interpolator.getRate(9, 95)));
+
+    // The precomputed cell polynomials against splining the rows and then the section, 
+    // over the whole grid including the nodes
+    GridCursor cursor;
+    for (double t = 1; t <= 24; t += 0.25)
+    {
+        for (size_t i = 0; i < lVector.size(); ++i)
+        {
+            lPoints[i] = CubicSplineInterpolator(time, volatility[i], 0, 0, false).getRate(t);
+        }
+        CubicSplineInterpolator section(delta, lPoints, 0, 0, true);
+        for (double d = 10; d <= 90; d += 2.5)
+        {
+            BOOST_CHECK(abs(interpolator.getRate(t, d) - section.getRate(d)) < 1e-12);
+            BOOST_CHECK(interpolator.getRate(t, d, cursor) == interpolator.getRate(t, d));
+        }
+    }
+}
+
+
+namespace
+{
+    // An n x m grid with x = 0, 1/12, 2/12, ... and y from 5 to 95
+    shared_ptr<BilinearInterpolator> buildGrid(size_t n, size_t m)
+    {
+        vector<double> x(n), y(m);
+        vector<vector<double>> z(m, vector<double>(n));
+        for (size_t i = 0; i < n; ++i)
+        {
+            x[i] = i / 12.0;
+        }
+        for (size_t j = 0; j < m; ++j)
+        {
+            y[j] = 5.0 + 90.0 * j / (m - 1.0);
+            for (size_t i = 0; i < n; ++i)
+            {
+                z[j][i] = 0.2 + 0.001 * i + 0.0005 * abs(y[j] - 50);
+            }
+        }
+        return shared_ptr<BilinearInterpolator>(new BilinearInterpolator(x, y, z, true));
+    }
+}
+
+void Maths2DInterpTest::testHintedLocate()
+{
+    BOOST_TEST_MESSAGE("Testing hinted locate against the binary search ...");
+
+    shared_ptr<BilinearInterpolator> interpolator = buildGrid(12, 5);
+    double queries[] = { -1, 0, 0.01, 1.0 / 12.0, 0.1, 0.45, 0.5, 0.9, 11.0 / 12.0, 2, 0.2, 0.0 };
+    size_t hint = 0;
+    for (size_t k = 0; k < sizeof(queries) / sizeof(double); ++k)
+    {
+        for (size_t start = 0; start < 11; ++start)
+        {
+            BOOST_CHECK(interpolator->locateX(queries[k], start) == interpolator->locateX(queries[k]));
+        }
+        hint = interpolator->locateX(queries[k], hint);
+        BOOST_CHECK(hint == interpolator->locateX(queries[k]));
+    }
+    // An invalid hint is ignored
+    BOOST_CHECK(interpolator->locateY(50, 100) == interpolator->locateY(50));
+
+    GridCursor cursor;
+    for (double yPoint = 1; yPoint < 100; yPoint += 0.7)
+    {
+        BOOST_CHECK(interpolator->getRate(0.3, yPoint, cursor) == interpolator->getRate(0.3, yPoint));
+    }
 }
 
+void Maths2DInterpTest::testSlices()
+{
+    BOOST_TEST_MESSAGE("Testing slices against the two dimensional interpolators ...");
 
+    vector<double> time;
+    time += 1, 2, 3, 6, 12, 24;
+    vector<double> delta;
+    delta += 10, 25, 50, 75, 90;
+    vector<double> v1, v2, v3, v4, v5;
+    v1 += .17938,   .182884,    .193908,    .219688,    .248396,    .263268;
+    v2 += .17575,   .17575,     .18247,     .206225,    .234775,    .2475;
+    v3 += .175,     .175,       .18,        .205,       .235,       .2475;
+    v4 += .18825,   .18825,     .19547,     .223725,    .223725,    .2725;
+    v5 += .20128,   .204784,    .216708,    .250288,    .287796,    .307068;
+    vector<vector<double>> volatility;
+    volatility += v1, v2, v3, v4, v5;
+
+    for (int extrapolate = 0; extrapolate < 2; ++extrapolate)
+    {
+        vector<shared_ptr<TwoDimensionalInterpolator>> interpolators;
+        interpolators.push_back(shared_ptr<TwoDimensionalInterpolator>(
+            new BilinearInterpolator(time, delta, volatility, extrapolate == 1)));
+        interpolators.push_back(shared_ptr<TwoDimensionalInterpolator>(
+            new BicubicInterpolator(time, delta, volatility, extrapolate == 1)));
+        for (size_t k = 0; k < interpolators.size(); ++k)
+        {
+            // On the nodes, inside cells and off both ends of the grid
+            double xPoints[] = { 0.5, 1, 1.7, 3, 4.5, 12, 20, 24, 30 };
+            for (size_t i = 0; i < sizeof(xPoints) / sizeof(double); ++i)
+            {
+                GridSlice slice = interpolators[k]->getSlice(xPoints[i]);
+                size_t yIndex = 0;
+                GridCursor cursor;
+                for (double yPoint = 0; yPoint <= 100; yPoint += 2.5)
+                {
+                    double expected = interpolators[k]->getRate(xPoints[i], yPoint);
+                    double derivative, sliceDerivative;
+                    double rate = interpolators[k]->getRate(xPoints[i], yPoint, cursor, derivative);
+                    BOOST_CHECK(slice.isInRange(yPoint) == interpolators[k]->isInRange(xPoints[i], yPoint));
+                    if (boost::math::isnan(expected))
+                    {
+                        BOOST_CHECK(boost::math::isnan(slice.getRate(yPoint)));
+                        BOOST_CHECK(boost::math::isnan(rate) && boost::math::isnan(derivative));
+                        continue;
+                    }
+                    BOOST_CHECK_MESSAGE(abs(slice.getRate(yPoint) - expected) < 1e-14,
+                        "Slice at (" << xPoints[i] << ", " << yPoint << "): " << slice.getRate(yPoint) << " against " << expected);
+                    BOOST_CHECK(slice.getRate(yPoint, yIndex) == slice.getRate(yPoint));
+                    // The slope in y read off the grid and off the slice
+                    BOOST_CHECK(rate == expected);
+                    slice.getRate(yPoint, yIndex, sliceDerivative);
+                    BOOST_CHECK(abs(derivative - sliceDerivative) < 1e-14);
+                }
+            }
+        }
+    }
+}
+
+void Maths2DInterpTest::testMatrixStorage()
+{
+    BOOST_TEST_MESSAGE("Testing Matrix storage and views ...");
+
+    vector<vector<double>> rows;
+    rows.push_back(vector<double>({ 1, 2, 3 }));
+    rows.push_back(vector<double>({ 4, 5, 6 }));
+    Matrix matrix(rows);
+    BOOST_REQUIRE((matrix.getRows() == 2) && (matrix.getColumns() == 3));
+    BOOST_CHECK((size_t)matrix.getRow(0) % 64 == 0);
+    BOOST_CHECK((matrix(1, 2) == 6) && (matrix.getRow(1)[0] == 4));
+
+    // Moving keeps the buffer; a clone is a separate copy
+    const double *buffer = matrix.getRow(0);
+    Matrix moved(std::move(matrix));
+    BOOST_CHECK(moved.getRow(0) == buffer);
+    BOOST_CHECK(matrix.empty());
+    Matrix copy = moved.clone();
+    copy(0, 0) = 10;
+    BOOST_CHECK((moved(0, 0) == 1) && (copy(0, 0) == 10) && (copy(1, 2) == 6));
+
+    rows.push_back(vector<double>({ 7, 8 }));
+    BOOST_CHECK_THROW(Matrix ragged(rows), runtime_error);
+
+    // A row major block read as its transpose
+    double values[6] = { 1, 2, 3, 4, 5, 6 };
+    MatrixView view(values, 2, 3), transpose(values, 3, 2, true);
+    for (size_t i = 0; i < 2; ++i)
+    {
+        for (size_t j = 0; j < 3; ++j)
+        {
+            BOOST_CHECK(view(i, j) == moved(i, j));
+            BOOST_CHECK(transpose(j, i) == view(i, j));
+        }
+    }
+    Matrix fromTranspose(transpose);
+    BOOST_CHECK((fromTranspose.getRows() == 3) && (fromTranspose(2, 1) == 6) && (fromTranspose(0, 1) == 4));
+
+    // An interpolator built from a moved Matrix is the one built from vectors
+    vector<double> time, delta;
+    time += 1, 2, 3, 6;
+    delta += 10, 50, 90;
+    vector<vector<double>> volatility;
+    volatility.push_back(vector<double>({ .20, .19, .21, .24 }));
+    volatility.push_back(vector<double>({ .18, .17, .19, .22 }));
+    volatility.push_back(vector<double>({ .22, .21, .23, .26 }));
+    BicubicInterpolator fromVectors(time, delta, volatility, true);
+    BicubicInterpolator fromMatrix(time, delta, Matrix(volatility), true);
+    for (double x = 0.5; x < 7; x += 0.25)
+    {
+        for (double y = 5; y < 95; y += 2.5)
+        {
+            BOOST_CHECK(fromMatrix.getRate(x, y) == fromVectors.getRate(x, y));
+        }
+    }
+    BOOST_CHECK_THROW(BilinearInterpolator(time, delta, Matrix(2, 4), false), runtime_error);
+}
+
+void Maths2DInterpTest::testGridKernels()
+{
+    BOOST_TEST_MESSAGE("Testing GridKernel against the interpolators it implements ...");
+
+    vector<double> time, delta;
+    time += 1, 2, 3, 6;
+    delta += 10, 50, 90;
+    vector<vector<double>> volatility;
+    volatility.push_back(vector<double>({ .20, .19, .21, .24 }));
+    volatility.push_back(vector<double>({ .18, .17, .19, .22 }));
+    volatility.push_back(vector<double>({ .22, .21, .23, .26 }));
+    BilinearInterpolator bilinear(time, delta, volatility, false);
+    BicubicInterpolator bicubic(time, delta, volatility, true);
+
+    GridKernel<BilinearCell, NoExtrapolation, NaNOutOfRange> bilinearKernel = bilinear.getKernel<NoExtrapolation, NaNOutOfRange>();
+    GridKernel<BicubicCell, Extrapolate, UncheckedRange> bicubicKernel = bicubic.getKernel<Extrapolate, UncheckedRange>();
+    GridCursor cursor;
+    for (double x = 0.5; x < 7; x += 0.25)
+    {
+        for (double y = 5; y < 95; y += 2.5)
+        {
+            double expected = bilinear.getRate(x, y);
+            if (boost::math::isnan(expected))
+            {
+                BOOST_CHECK(boost::math::isnan(bilinearKernel.getRate(x, y)));
+            }
+            else
+            {
+                BOOST_CHECK(bilinearKernel.getRate(x, y) == expected);
+                BOOST_CHECK(bilinearKernel.getRate(x, y, cursor) == expected);
+            }
+            BOOST_CHECK(bicubicKernel.getRate(x, y) == bicubic.getRate(x, y));
+        }
+    }
+
+    // Unchecked, a point off the grid uses the nearest cell as extrapolation does
+    GridKernel<BilinearCell, NoExtrapolation, UncheckedRange> unchecked = bilinear.getKernel<NoExtrapolation, UncheckedRange>();
+    BilinearInterpolator extrapolating(time, delta, volatility, true);
+    BOOST_CHECK(!unchecked.isInRange(7, 50));
+    BOOST_CHECK(unchecked.getRate(7, 50) == extrapolating.getRate(7, 50));
+}
 
 test_suite* Maths2DInterpTest::suite() 
 {
@@ -135,6 +358,10 @@ test_suite* Maths2DInterpTest::suite()
 
     suite->add(BOOST_TEST_CASE(&Maths2DInterpTest::testBilinearInterpolator));
     suite->add(BOOST_TEST_CASE(&Maths2DInterpTest::testBicubicInterpolator));
+    suite->add(BOOST_TEST_CASE(&Maths2DInterpTest::testHintedLocate));
+    suite->add(BOOST_TEST_CASE(&Maths2DInterpTest::testSlices));
+    suite->add(BOOST_TEST_CASE(&Maths2DInterpTest::testMatrixStorage));
+    suite->add(BOOST_TEST_CASE(&Maths2DInterpTest::testGridKernels));
 
     return suite;
 }
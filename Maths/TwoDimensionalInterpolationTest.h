@@ -2,8 +2,8 @@
 #define XLLBASIC_2dinterp
 
 #include <iostream>
-#include <boost\test\unit_test.hpp>
-#include <boost\math\special_functions\fpclassify.hpp> // boost::math::isnan
+#include <boost/test/unit_test.hpp>
+#include <boost/math/special_functions/fpclassify.hpp> // boost::math::isnan
 #include "TwoDimensionalInterpolation.h"
 
 class Maths2DInterpTest 
@@ -12,6 +12,10 @@ class Maths2DInterpTest
 
     static void testBilinearInterpolator();
     static void testBicubicInterpolator();
+    static void testHintedLocate();
+    static void testSlices();
+    static void testMatrixStorage();
+    static void testGridKernels();
 
     static boost::unit_test_framework::test_suite* suite();
 };
@@ -66,24 +66,108 @@ namespace XLLBasicLibrary
     ArrayInterpolator::ArrayInterpolator(vector<double> xVector, 
                                          vector<double> yVector, 
                                          bool allowExtrapolation)
-        : xVector(xVector), yVector(yVector), allowExtrapolation(allowExtrapolation)
+        : xVector(move(xVector)), yVector(move(yVector)), ownsX(true), ownsY(true), 
+        allowExtrapolation(allowExtrapolation)
     {
+        bindOwnedData();
         isOk();
     }
 
+    ArrayInterpolator::ArrayInterpolator(const double *xArray, 
+                                         const double *yArray, 
+                                         size_t n,
+                                         bool allowExtrapolation)
+        : xData(xArray), yData(yArray), xSize(n), ySize(n), ownsX(false), ownsY(false), 
+        allowExtrapolation(allowExtrapolation)
+    {
+        isOk();
+    }
+
+    ArrayInterpolator::ArrayInterpolator(const ArrayInterpolator &other)
+        : xVector(other.xVector), yVector(other.yVector), 
+        xData(other.xData), yData(other.yData), xSize(other.xSize), ySize(other.ySize),
+        ownsX(other.ownsX), ownsY(other.ownsY), allowExtrapolation(other.allowExtrapolation),
+        hasError(other.hasError), errorMessage(other.errorMessage)
+    {
+        bindOwnedData();
+    }
+
+    ArrayInterpolator::ArrayInterpolator(ArrayInterpolator &&other)
+        : xVector(move(other.xVector)), yVector(move(other.yVector)), 
+        xData(other.xData), yData(other.yData), xSize(other.xSize), ySize(other.ySize),
+        ownsX(other.ownsX), ownsY(other.ownsY), allowExtrapolation(other.allowExtrapolation),
+        hasError(other.hasError), errorMessage(move(other.errorMessage))
+    {
+        bindOwnedData();
+    }
+
+    ArrayInterpolator &ArrayInterpolator::operator=(const ArrayInterpolator &other)
+    {
+        if (&other != this)
+        {
+            xVector = other.xVector;
+            yVector = other.yVector;
+            xData = other.xData;
+            yData = other.yData;
+            xSize = other.xSize;
+            ySize = other.ySize;
+            ownsX = other.ownsX;
+            ownsY = other.ownsY;
+            allowExtrapolation = other.allowExtrapolation;
+            hasError = other.hasError;
+            errorMessage = other.errorMessage;
+            bindOwnedData();
+        }
+        return *this;
+    }
+
+    ArrayInterpolator &ArrayInterpolator::operator=(ArrayInterpolator &&other)
+    {
+        if (&other != this)
+        {
+            xVector = move(other.xVector);
+            yVector = move(other.yVector);
+            xData = other.xData;
+            yData = other.yData;
+            xSize = other.xSize;
+            ySize = other.ySize;
+            ownsX = other.ownsX;
+            ownsY = other.ownsY;
+            allowExtrapolation = other.allowExtrapolation;
+            hasError = other.hasError;
+            errorMessage = move(other.errorMessage);
+            bindOwnedData();
+        }
+        return *this;
+    }
+
+    void ArrayInterpolator::bindOwnedData()
+    {
+        if (ownsX)
+        {
+            xData = xVector.empty() ? 0 : &xVector[0];
+            xSize = xVector.size();
+        }
+        if (ownsY)
+        {
+            yData = yVector.empty() ? 0 : &yVector[0];
+            ySize = yVector.size();
+        }
+    }
+
     bool ArrayInterpolator::isOk()
     {
-        if (!is_strictly_increasing(xVector.begin(), xVector.end()))
+        if (!is_strictly_increasing(xData, xData + xSize))
         {
             setOnError("ArrayInterpolator::ArrayInterpolator. X vector input not strictly monotonic");
             return false;
         }
-        if (xVector.size() != yVector.size()) 
+        if (xSize != ySize) 
         {
            setOnError("ArrayInterpolator::ArrayInterpolator. X and Y vectors do not have the same dimension");
            return false;
         }
-        if (xVector.size() < 2) 
+        if (xSize < 2) 
         {
            setOnError("ArrayInterpolator::ArrayInterpolator. X vector must have a least 2 points");
            return false; 
@@ -95,12 +179,14 @@ namespace XLLBasicLibrary
 
     void ArrayInterpolator::setXVector(vector<double> xVectorInput) 
     {
-        xVector = xVectorInput;
-        if (!is_strictly_increasing(xVector.begin(), xVector.end()))
+        xVector = move(xVectorInput);
+        ownsX = true;
+        bindOwnedData();
+        if (!is_strictly_increasing(xData, xData + xSize))
         {
             setOnError("ArrayInterpolator::setXVector. X vector input not strictly monotonic");
         }
-        if (xVector.size() != yVector.size())
+        if (xSize != ySize)
         {
             setOnError("ArrayInterpolator::setXVector. X and Y vectors do not have the same dimension");
         }
@@ -112,8 +198,10 @@ namespace XLLBasicLibrary
 
    void ArrayInterpolator::setYVector(vector<double> yVectorInput)
    {
-        yVector = yVectorInput;
-        if (xVector.size() != yVector.size())
+        yVector = move(yVectorInput);
+        ownsY = true;
+        bindOwnedData();
+        if (xSize != ySize)
         {
             setOnError("ArrayInterpolator::setYVector. X and Y vectors do not have the same dimension");
         }
@@ -133,46 +221,73 @@ namespace XLLBasicLibrary
         {
             return true;
         }
-        else if ((x >= xVector.front()) && (x <= xVector.back()))
+        else if ((x >= getRangeStart()) && (x <= getRangeEnd()))
         {
             return true;
         }
         return false;
    }
     
-   bool ArrayInterpolator::isInRange(vector<double> xInput) const 
+   bool ArrayInterpolator::isInRange(const vector<double> &xInput) const 
+    {
+        return xInput.empty() ? !hasError : isInRange(xInput.size(), &xInput[0]);
+   }
+
+   bool ArrayInterpolator::isInRange(size_t n, const double *xInput) const 
     {
-      if (hasError)
+        if (hasError)
         {
-         return false;
+            return false;
         }
         if (allowExtrapolation)
         {
             return true;
         }
-        bool allInRange = true;
-        for (vector<double>::iterator it = xInput.begin(); it != xInput.end(); ++ it) 
+        for (size_t i = 0; i < n; ++i) 
         {
-            double x = *it;
-            if (!isInRange(x))
+            if (!isInRange(xInput[i]))
             {
-                allInRange = false;
+                return false;
             }
         }
-        return allInRange;
+        return true;
    }
 
-    vector<double> ArrayInterpolator::getRate(vector<double> xInput) const
+    vector<double> ArrayInterpolator::getRate(const vector<double> &xInput) const
     {
-        vector<double> yOutput;
-        for (vector<double>::iterator it = xInput.begin(); it != xInput.end(); ++ it) 
+        vector<double> yOutput(xInput.size());
+        if (!xInput.empty())
         {
-            double x = *it;
-            yOutput.push_back(getRate(x));
+            getRate(xInput.size(), &xInput[0], &yOutput[0]);
         }
         return yOutput;
     }
 
+    void ArrayInterpolator::getRate(size_t n, const double *xInput, double *result) const
+    {
+        for (size_t i = 0; i < n; ++i) 
+        {
+            result[i] = getRate(xInput[i]);
+        }
+    }
+
+    void ArrayInterpolator::checkNoError() const
+    {
+        if (hasError)
+        {
+            throw runtime_error(errorMessage);
+        }
+    }
+
+    void ArrayInterpolator::checkRateInputs(size_t n, const double *x) const
+    {
+        checkNoError();
+        if ((allowExtrapolation == false) && !isInRange(n, x))
+        {
+			throw runtime_error("Allow extrapolation set to false and point is outside range");
+        }
+    }
+
     void ArrayInterpolator::setOnError(string errorMessageInput) 
     {
         hasError = true;
@@ -186,46 +301,28 @@ namespace XLLBasicLibrary
     LinearArrayInterpolator::LinearArrayInterpolator(vector<double> xVector, 
                                                      vector<double> yVector, 
                                                      bool inputAllowExtrapolation)
-    : ArrayInterpolator(xVector, yVector, inputAllowExtrapolation)
+    : ArrayInterpolator(move(xVector), move(yVector), inputAllowExtrapolation)
+    {}
+
+    LinearArrayInterpolator::LinearArrayInterpolator(const double *xArray, 
+                                                     const double *yArray, 
+                                                     size_t n,
+                                                     bool inputAllowExtrapolation)
+    : ArrayInterpolator(xArray, yArray, n, inputAllowExtrapolation)
     {}
 
     double LinearArrayInterpolator::getRate(double x) const
     {
-        if (hasError)
-        {
-            throw runtime_error(errorMessage);
-        }
-
-        if ((allowExtrapolation == false) && !isInRange(x))
-        {
-			throw runtime_error("Allow extrapolation set to false and point is outside range");
-        }
+        checkRateInputs(1, &x);
         // we are now either inside the range (if we do not allow extrapolation) or we allow extrapolation
         // using the "closest" points in the input arrays
+        return ArrayKernel<LinearSegment, Extrapolate, UncheckedRange>(xData, yData, NULL, xSize).getRate(x);
+    }
 
-        // We find the right place in the table by means of bisection. This will return the two "extreme" points
-        // if we are extrapolating outside the curve
-        int ilo = 0;
-        int ihi = (int) xVector.size() - 1;
-        int i;
-        while (ihi - ilo > 1) 
-        {
-            i = (ihi + ilo) >> 1;
-            if (xVector[i] > x) 
-            {
-                    ihi = i;
-            }
-            else 
-            {
-                ilo = i;
-            }
-        }
-        double h = xVector[ihi] - xVector[ilo];
-        if (h == 0) 
-        {
-            return numeric_limits<float>::quiet_NaN(); // shouldn't happen since we should check the x array is strictly monotonic but you never know
-        }
-        return LinearInterpolator(xVector[ilo], yVector[ilo], xVector[ihi], yVector[ihi]).getRate(x);
+    void LinearArrayInterpolator::getRate(size_t n, const double *x, double *result) const
+    {
+        checkRateInputs(n, x);
+        ArrayKernel<LinearSegment, Extrapolate, UncheckedRange>(xData, yData, NULL, xSize).getRate(n, x, result);
     }
 
 
@@ -234,7 +331,7 @@ namespace XLLBasicLibrary
     // CubicSplineInterpolator 
     //======================================================================================
     CubicSplineInterpolator::CubicSplineInterpolator(vector<double> xVector, vector<double> yVector, double yp1, double ypn, bool allowExtrapolation)
-        : ArrayInterpolator(xVector, yVector, allowExtrapolation), _yp1(yp1), _ypn(ypn), spline(xVector.size())
+        : ArrayInterpolator(move(xVector), move(yVector), allowExtrapolation), _yp1(yp1), _ypn(ypn)
     {
         if (!hasError)
         {
@@ -243,7 +340,7 @@ namespace XLLBasicLibrary
     }
 
     CubicSplineInterpolator::CubicSplineInterpolator(std::vector<double> xVector, std::vector<double> yVector, bool allowExtrapolation)
-        : ArrayInterpolator(xVector, yVector, allowExtrapolation), _yp1(0.0), _ypn(0.0), spline(xVector.size())
+        : ArrayInterpolator(move(xVector), move(yVector), allowExtrapolation), _yp1(0.0), _ypn(0.0)
     {
         if (!hasError)
         {
@@ -251,50 +348,40 @@ namespace XLLBasicLibrary
         }
     }
 
-    double CubicSplineInterpolator::getRate(double x) const
+    CubicSplineInterpolator::CubicSplineInterpolator(const double *xArray, const double *yArray, size_t n, double yp1, double ypn, bool allowExtrapolation)
+        : ArrayInterpolator(xArray, yArray, n, allowExtrapolation), _yp1(yp1), _ypn(ypn)
     {
-        if (hasError)
+        if (!hasError)
         {
-			throw runtime_error(errorMessage);
+            setSpline();
         }
+    }
 
-        if (!allowExtrapolation && !isInRange(x))
+    CubicSplineInterpolator::CubicSplineInterpolator(const double *xArray, const double *yArray, size_t n, bool allowExtrapolation)
+        : ArrayInterpolator(xArray, yArray, n, allowExtrapolation), _yp1(0.0), _ypn(0.0)
+    {
+        if (!hasError)
         {
-			throw runtime_error("Allow extrapolation set to false and point is outside range");
+            setSpline();
         }
+    }
 
-        // We find the right place in the table by means of bisection. This will return the two "extreme" points
-        // if we are extrapolating outside the curve
-        int klo = 0;
-        int khi = (int) spline.size() - 1;
-        int k;
-        while (khi - klo > 1) 
-        {
-            k = (khi + klo) >> 1;
-            if (xVector[k] > x) 
-            {
-                khi = k;
-            }
-            else 
-            {
-                klo = k;
-            }
-        }
+    double CubicSplineInterpolator::getRate(double x) const
+    {
+        checkRateInputs(1, &x);
+        return ArrayKernel<CubicSplineSegment, Extrapolate, UncheckedRange>(xData, yData, &spline[0], xSize).getRate(x);
+    }
 
-        double h = xVector[khi] - xVector[klo];
-        if (h == 0) 
-        {
-            return numeric_limits<float>::quiet_NaN(); // shouldn't happen since we should check the x array is strictly monotonic but you never know
-        }
-        double a = (xVector[khi] - x) / h;
-        double b = (x - xVector[klo]) / h;
-        double y = a * yVector[klo] + b * yVector[khi] + ((a*a*a - a) * spline[klo] + (b*b*b - b) * spline[khi]) * (h*h) / 6.0;
-        return y;
+    void CubicSplineInterpolator::getRate(size_t n, const double *x, double *result) const
+    {
+        checkRateInputs(n, x);
+        ArrayKernel<CubicSplineSegment, Extrapolate, UncheckedRange>(xData, yData, &spline[0], xSize).getRate(n, x, result);
     }
 
     void CubicSplineInterpolator::setSpline()
     {
-        size_t n = spline.size();
+        size_t n = xSize;
+        spline = vector<double>(n);
         std::vector<double> tempCalcuation(n);
         spline[0] = -.5;
         if (_yp1 == 0)
@@ -303,19 +390,19 @@ namespace XLLBasicLibrary
         }
         else
         {
-            tempCalcuation[0] = (3.0 / (xVector[1] - xVector[0])) * ((yVector[1] - yVector[0]) / 
-            (xVector[1] - xVector[0]) - _yp1);
+            tempCalcuation[0] = (3.0 / (xData[1] - xData[0])) * ((yData[1] - yData[0]) / 
+            (xData[1] - xData[0]) - _yp1);
         }
    
         double sig, p;
         for (size_t i = 1; i < n - 1; ++i) 
         {
-            sig = (xVector[i] - xVector[i-1]) / (xVector[i+1] - xVector[i-1]);
+            sig = (xData[i] - xData[i-1]) / (xData[i+1] - xData[i-1]);
             p = sig * spline[i-1] + 2.0;
             spline[i] = (sig - 1.0) / p;
-            tempCalcuation[i] = (yVector[i+1] - yVector[i]) / (xVector[i+1] - xVector[i]) -
-            (yVector[i] - yVector[i-1]) / (xVector[i] - xVector[i-1]);
-            tempCalcuation[i] = (6.0 * tempCalcuation[i] / (xVector[i+1] - xVector[i-1]) - 
+            tempCalcuation[i] = (yData[i+1] - yData[i]) / (xData[i+1] - xData[i]) -
+            (yData[i] - yData[i-1]) / (xData[i] - xData[i-1]);
+            tempCalcuation[i] = (6.0 * tempCalcuation[i] / (xData[i+1] - xData[i-1]) - 
             sig * tempCalcuation[i-1]) / p;
         }
         double qn, un;
@@ -326,8 +413,8 @@ namespace XLLBasicLibrary
         else 
         {
             qn = 0.5;
-            un = (3.0 / (xVector[n-1] - xVector[n-2])) * (_ypn - (yVector[n-1] - yVector[n-2]) / 
-            (xVector[n-1] - xVector[n-2]));
+            un = (3.0 / (xData[n-1] - xData[n-2])) * (_ypn - (yData[n-1] - yData[n-2]) / 
+            (xData[n-1] - xData[n-2]));
         }
         spline[n-1] = (un - qn * tempCalcuation[n-2]) / (qn * spline[n-2] + 1.0);
         for (int k = n-2; k >= 0; k--)
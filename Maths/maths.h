@@ -10,7 +10,10 @@
 */
 
 #include <vector>
-#include <boost\algorithm\cxx11\is_sorted.hpp>
+#include <limits> // quiet_NaN
+#include <stdexcept> // runtime_error
+#include <boost/algorithm/cxx11/is_sorted.hpp>
+#include "InterpolationKernels.h"
 
 using namespace std;
 
@@ -76,11 +79,31 @@ namespace XLLBasicLibrary
     /*======================================================================================
     ArrayInterpolator 
     This is built to accept x inputs that are strictly increasing 
+
+    The interpolator either owns its x and y values or is a view over arrays owned by the
+    caller. The vector constructors and setters take ownership; pass an rvalue to move the
+    values in rather than copy them. The pointer constructors copy nothing, so a curve can 
+    be built directly over existing memory (an excel xl_array for example), which must 
+    then outlive the interpolator. 
+
+    The array forms of isInRange and getRate work on caller supplied buffers and do not 
+    allocate.
+
+    getRate validates the interpolator and its inputs on every call and is virtual. A 
+    loop that interpolates one known curve many times can instead take the curve's kernel
+    (see InterpolationKernels.h) from getKernel() on the concrete class, once, and call 
+    that: it does only the checks its policies ask for and inlines into the loop.
     =======================================================================================*/
     class ArrayInterpolator : public Interpolator
     {
     public:
         ArrayInterpolator(vector<double> xVector, vector<double> yVector, bool allowExtrapolation = false);
+        ArrayInterpolator(const double *xArray, const double *yArray, size_t n, bool allowExtrapolation = false);
+        // A copy of a view is a view over the same arrays
+        ArrayInterpolator(const ArrayInterpolator &other);
+        ArrayInterpolator(ArrayInterpolator &&other);
+        ArrayInterpolator &operator=(const ArrayInterpolator &other);
+        ArrayInterpolator &operator=(ArrayInterpolator &&other);
         virtual ~ArrayInterpolator()   {};
    
         void setXVector(vector<double> xVector);
@@ -92,25 +115,43 @@ namespace XLLBasicLibrary
         // Returns true if the input x is outside the range [x_min, x_max].
         bool isInRange(double x) const;
         // Returns true if ALL elements of the vector are in the range [x_min, x_max].
-        bool isInRange(vector<double> x) const;
+        bool isInRange(const vector<double> &x) const;
+        bool isInRange(size_t n, const double *x) const;
 
         virtual double getRate(double x) const = 0;
         // The defualt behaviour here itterates over each element in the vector
         // and then calls the getRate(x) method. This DOES NOT make use of the 
         // isInRange(...) function so please call this first if in doubt
-        virtual vector<double> getRate(vector<double> x) const;
+        virtual vector<double> getRate(const vector<double> &x) const;
+        // As above, writing getRate(x[i]) to result[i] for i = 0,...,n-1
+        virtual void getRate(size_t n, const double *x, double *result) const;
 
-        double getRangeStart()   const {return xVector.front();};
-        double getRangeEnd()   const {return xVector.back();};
+        double getRangeStart()   const {return xData[0];};
+        double getRangeEnd()   const {return xData[xSize - 1];};
 
 
     protected:
         void setOnError(string errorMessage);
+        // Throws if the interpolator has an error
+        void checkNoError() const;
+        // Throws if the interpolator has an error or, without extrapolation, if any x[i] 
+        // is out of range
+        void checkRateInputs(size_t n, const double *x) const;
 
+        // Owned values. Empty when the interpolator is a view
         vector<double> xVector, yVector;
+        // The values used by the interpolator: either the owned vectors or the caller's 
+        // arrays
+        const double *xData, *yData;
+        size_t xSize, ySize;
+        bool ownsX, ownsY;
         bool allowExtrapolation;
         bool hasError; // used if any of the inputs are not of the assumed type
         string errorMessage;      
+
+    private:
+        // Points xData and yData at the owned vectors, where the values are owned
+        void bindOwnedData();
     };
 
     /*======================================================================================
@@ -124,8 +165,23 @@ namespace XLLBasicLibrary
         LinearArrayInterpolator(vector<double> xVector, 
                                 vector<double> yVector, 
                                 bool inputAllowExtrapolation = false);    
+        LinearArrayInterpolator(const double *xArray, 
+                                const double *yArray, 
+                                size_t n,
+                                bool inputAllowExtrapolation = false);    
         double getRate(double x) const;
-        vector<double> getRate(vector<double> x) const {return ArrayInterpolator::getRate(x);};
+        vector<double> getRate(const vector<double> &x) const {return ArrayInterpolator::getRate(x);};
+        // Sorted runs of x are located with a single forward walk rather than a bisection
+        // per point; a point smaller than its predecessor is bisected
+        void getRate(size_t n, const double *x, double *result) const;
+
+        // Throws a runtime_error if the interpolator has an error
+        template <class Extrapolation, class Bounds>
+        ArrayKernel<LinearSegment, Extrapolation, Bounds> getKernel() const
+        {
+            checkNoError();
+            return ArrayKernel<LinearSegment, Extrapolation, Bounds>(xData, yData, NULL, xSize);
+        }
     };
 
     /*======================================================================================
@@ -149,9 +205,33 @@ namespace XLLBasicLibrary
         CubicSplineInterpolator(vector<double> xVector, 
                                 vector<double> yVector, 
                                 bool allowExtrapolation = false);
+        // Views over caller owned arrays, see ArrayInterpolator
+        CubicSplineInterpolator(const double *xArray, 
+                                const double *yArray, 
+                                size_t n,
+                                double yp1, 
+                                double ypn, 
+                                bool allowExtrapolation = false);
+        CubicSplineInterpolator(const double *xArray, 
+                                const double *yArray, 
+                                size_t n,
+                                bool allowExtrapolation = false);
 
         double getRate(double x) const;
-        vector<double> getRate(vector<double> x) const {return ArrayInterpolator::getRate(x);};
+        vector<double> getRate(const vector<double> &x) const {return ArrayInterpolator::getRate(x);};
+        // Sorted runs of x are located with a single forward walk, as LinearArrayInterpolator
+        void getRate(size_t n, const double *x, double *result) const;
+
+        // The second derivatives of the interpolating function at the tabulated points x_i
+        const vector<double> &getSecondDerivatives() const {return spline;};
+
+        // Throws a runtime_error if the interpolator has an error
+        template <class Extrapolation, class Bounds>
+        ArrayKernel<CubicSplineSegment, Extrapolation, Bounds> getKernel() const
+        {
+            checkNoError();
+            return ArrayKernel<CubicSplineSegment, Extrapolation, Bounds>(xData, yData, &spline[0], xSize);
+        }
 
     private:
         /**
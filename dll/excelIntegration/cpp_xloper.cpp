@@ -92,7 +92,7 @@ cpp_xloper::cpp_xloper(VARIANT *pv)
 //-------------------------------------------------------------------
 // The string constructor.  Assumes null-terminated input.
 //-------------------------------------------------------------------
-cpp_xloper::cpp_xloper(char *text)
+cpp_xloper::cpp_xloper(const char *text)
 {
    Clear();
    set_to_text(&m_Op, text);
@@ -373,7 +373,7 @@ void cpp_xloper::operator=(WORD e)
    set_to_err(&m_Op, e);
 }
 //-------------------------------------------------------------------
-void cpp_xloper::operator=(char *text)
+void cpp_xloper::operator=(const char *text)
 {
    Free();
    set_to_text(&m_Op, text);
@@ -1221,7 +1221,8 @@ double *cpp_xloper::ConvertMultiToDouble(void)
 //-------------------------------------------------------------------
 xloper *cpp_xloper::ExtractXloper(bool ExceltoFree)
 {
-   static xloper ret_val;
+// One per thread so that concurrent calls do not overwrite each other's return value
+   thread_local xloper ret_val;
 
    ret_val = m_Op;
 
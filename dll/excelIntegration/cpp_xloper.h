@@ -45,7 +45,7 @@ public:
 //--------------------------------------------------------------------
    cpp_xloper();            // created as xltypeMissing
    cpp_xloper(xloper *p_oper);   // contains copy of given xloper
-   cpp_xloper(char *text);      // xltypeStr
+   cpp_xloper(const char *text); // xltypeStr
    cpp_xloper(int w);         // xltypeInt
    cpp_xloper(int w, int min, int max); // xltypeInt (or xltypeMissing)
    cpp_xloper(double d);      // xltypeNum
@@ -79,7 +79,7 @@ public:
    void operator=(bool b);      // xltypeBool
    void operator=(double);      // xltypeNum
    void operator=(WORD e);      // xltypeErr
-   void operator=(char *);      // xltypeStr
+   void operator=(const char *); // xltypeStr
    void operator=(xloper *);   // same type as passed-in xloper
    void operator=(VARIANT *);   // same type as passed-in Variant
    void operator=(xl_array *array);
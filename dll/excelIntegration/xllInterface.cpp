@@ -41,7 +41,7 @@ typedef struct
 BOOL __stdcall fnwiz_enum_proc(HWND hwnd, fnwiz_enum_struct *p_enum)
 {
 // Check if the parent window is Excel
-   if(LOWORD((DWORD)GetParent(hwnd)) != p_enum->low_hwnd)
+   if(LOWORD((DWORD_PTR)GetParent(hwnd)) != p_enum->low_hwnd)
       return TRUE; // keep iterating
 
    char class_name[CLASS_NAME_BUFFER_SIZE + 1];
@@ -77,7 +77,7 @@ bool called_from_paste_fn_dlg(void)
 
 
 
-void display_register_error(char *fn_name, int XL4_err_num, int err_num)
+void display_register_error(const char *fn_name, int XL4_err_num, int err_num)
 {
    char temp_buffer[256];
    sprintf(temp_buffer, "Could not register function %s (XL4:%d,Err:%d)", fn_name, XL4_err_num, err_num);
@@ -117,7 +117,7 @@ xloper *register_function(int fn_index)
 //-------------------------------------------------------
    cpp_xloper *fn_args = new cpp_xloper[MAX_EXCEL4_ARGS];
 
-   char *p_arg;
+   const char *p_arg;
    int i = 0, num_args = 1;
 
    do
@@ -118,11 +118,12 @@ void free_xloper(xloper *p_op, bool use_xlbits)
       int limit = p_op->val.array.rows * p_op->val.array.columns;
       xloper *p = p_op->val.array.lparray;
 
+// Without xlbits there are no flags to test: everything was allocated by the DLL
       for(int i = limit; i--; p++)
-         if(p->xltype & (xl_free | dll_free))
+         if(!use_xlbits || (p->xltype & (xl_free | dll_free)))
             free_xloper(p, use_xlbits);
 
-      if(p_op->xltype & dll_free)
+      if(!use_xlbits || (p_op->xltype & dll_free))
          free(p_op->val.array.lparray);
    }
    else if(p_op->xltype == (xltypeStr | dll_free))
@@ -146,7 +147,7 @@ char *copy_xlstring(char *xlstring)
    return p;
 }
 //-------------------------------------------------------------------
-char *new_xlstring(char *text)
+char *new_xlstring(const char *text)
 {
    int len;
 
@@ -373,7 +374,7 @@ void set_to_bool(xloper *p_op, bool b)
    p_op->val._bool = (b ? 1 : 0);
 }
 //-------------------------------------------------------------------
-void set_to_text(xloper *p_op, char *text)
+void set_to_text(xloper *p_op, const char *text)
 {
    if(!p_op) return;
 
@@ -659,7 +660,7 @@ char *vt_bstr_to_xlstring(BSTR bstr)
    if(!p || wcstombs(p + 1, bstr, len + 1) < 0)
    {
       free(p);
-      return false;
+      return NULL;
    }
 
    p[0] = (char)len;
@@ -933,7 +934,7 @@ bool vt_to_xloper(xloper &op, VARIANT *pv, bool convert_array)
 }
 
 //=====================================================
-char * __stdcall oper_type_str(xloper *pxl)
+const char * __stdcall oper_type_str(xloper *pxl)
 {
    if(pxl == NULL)
       return NULL;
@@ -951,7 +952,7 @@ char * __stdcall oper_type_str(xloper *pxl)
    }
 }
 //=====================================================
-char * __stdcall xloper_type_str(xloper *pxl)
+const char * __stdcall xloper_type_str(xloper *pxl)
 {
    if(pxl == NULL)
       return NULL;
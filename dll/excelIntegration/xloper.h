@@ -53,7 +53,7 @@ void free_xloper(xloper *p_op, bool use_xlbits);
 
 bool is_xloper_missing(xloper *p_op);
 char *copy_xlstring(char *xlstring);
-char *new_xlstring(char *text);
+char *new_xlstring(const char *text);
 bool coerce_xloper(xloper *p_op, xloper &ret_val, int target_type);
 bool coerce_to_string(xloper *p_op, char *&text); // makes new string
 bool coerce_to_double(xloper *p_op, double &d);
@@ -64,7 +64,7 @@ double *coerce_to_double_array(xloper *p_op, double invalid_value, WORD &cols, W
 void set_to_double(xloper *p_op, double d);
 void set_to_int(xloper *p_op, int w);
 void set_to_bool(xloper *p_op, bool b);
-void set_to_text(xloper *p_op, char *text);
+void set_to_text(xloper *p_op, const char *text);
 void set_to_err(xloper *p_op, WORD e);
 bool set_to_xltypeMulti(xloper *p_op, WORD rows, WORD cols);
 bool set_to_xltypeSRef(xloper *p_op, WORD rwFirst, WORD rwLast, BYTE colFirst, BYTE colLast);
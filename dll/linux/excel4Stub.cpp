@@ -0,0 +1,128 @@
+#include "excel4Stub.h"
+
+#include <stdarg.h>
+#include <mutex>
+
+namespace
+{
+    mutex stubMutex;
+    vector<Excel4StubRegistration> registrations;
+    size_t callCount = 0;
+    size_t alertCount = 0;
+    double nextRegisterId = 1;
+
+    string getString(LPXLOPER p_op)
+    {
+        if ((p_op == NULL) || ((p_op->xltype & xltypeStr) == 0) || (p_op->val.str == NULL))
+        {
+            return "";
+        }
+        return string(p_op->val.str + 1, (unsigned char)p_op->val.str[0]);
+    }
+
+    // A byte counted copy of text, freed again by xlFree
+    char *newCountedString(const string &text)
+    {
+        size_t length = text.size() > 255 ? 255 : text.size();
+        char *p = (char *)malloc(length + 2);
+        p[0] = (char)length;
+        memcpy(p + 1, text.c_str(), length);
+        p[length + 1] = 0;
+        return p;
+    }
+}
+
+vector<Excel4StubRegistration> getExcel4StubRegistrations()
+{
+    lock_guard<mutex> lock(stubMutex);
+    return registrations;
+}
+
+size_t getExcel4StubCallCount()
+{
+    lock_guard<mutex> lock(stubMutex);
+    return callCount;
+}
+
+size_t getExcel4StubAlertCount()
+{
+    lock_guard<mutex> lock(stubMutex);
+    return alertCount;
+}
+
+void resetExcel4Stub()
+{
+    lock_guard<mutex> lock(stubMutex);
+    registrations.clear();
+    callCount = 0;
+    alertCount = 0;
+}
+
+int far pascal Excel4v(int xlfn, LPXLOPER operRes, int count, LPXLOPER far opers[])
+{
+    lock_guard<mutex> lock(stubMutex);
+    ++callCount;
+    switch (xlfn)
+    {
+    case xlGetName:
+        operRes->xltype = xltypeStr;
+        operRes->val.str = newCountedString("DerivativesForExcel.xll");
+        return xlretSuccess;
+    case xlFree:
+        for (int i = 0; i < count; ++i)
+        {
+            if ((opers[i]->xltype & xltypeStr) && (opers[i]->val.str != NULL))
+            {
+                free(opers[i]->val.str);
+                opers[i]->val.str = NULL;
+            }
+        }
+        return xlretSuccess;
+    case xlfRegister:
+        {
+            // The arguments are the dll name followed by the strings in FunctionExports
+            Excel4StubRegistration registration;
+            registration.functionName = count > 1 ? getString(opers[1]) : "";
+            registration.typeText = count > 2 ? getString(opers[2]) : "";
+            registrations.push_back(registration);
+            if (operRes)
+            {
+                operRes->xltype = xltypeNum;
+                operRes->val.num = nextRegisterId++;
+            }
+            return xlretSuccess;
+        }
+    case xlcAlert:
+        ++alertCount;
+        return xlretSuccess;
+    case xlfSetName:
+        return xlretSuccess;
+    case xlGetHwnd:
+        if (operRes)
+        {
+            operRes->xltype = xltypeInt;
+            operRes->val.w = 0;
+        }
+        return xlretSuccess;
+    default:
+        return xlretFailed;
+    }
+}
+
+int far _cdecl Excel4(int xlfn, LPXLOPER operRes, int count, ...)
+{
+    LPXLOPER opers[30];
+    va_list arguments;
+    va_start(arguments, count);
+    for (int i = 0; (i < count) && (i < 30); ++i)
+    {
+        opers[i] = va_arg(arguments, LPXLOPER);
+    }
+    va_end(arguments);
+    return Excel4v(xlfn, operRes, count, opers);
+}
+
+int far pascal XLCallVer(void)
+{
+    return 0x0C00;
+}
@@ -0,0 +1,37 @@
+#ifndef derivativeExcel4Stub_INCLUDED
+#define derivativeExcel4Stub_INCLUDED
+
+#include <windows.h>
+#include "../excelIntegration/xlcall.h"
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*======================================================================================
+Excel4 stub
+
+Stands in for the Excel4 / Excel4v callbacks that xlcall32.lib provides on Windows so the
+add-in can be loaded and called on Linux. It supports the callbacks the add-in makes while
+it is opened and closed: xlGetName, xlfRegister, xlfSetName, xlcAlert, xlGetHwnd and xlFree.
+Any other callback fails with xlretFailed.
+
+Every call is counted and each xlfRegister is recorded so a test can check what the add-in
+asked excel to do.
+=======================================================================================*/
+struct Excel4StubRegistration
+{
+    string functionName;
+    string typeText;
+};
+
+vector<Excel4StubRegistration> getExcel4StubRegistrations();
+// The number of Excel4 or Excel4v calls, from any thread, since the last reset
+size_t getExcel4StubCallCount();
+// The number of xlcAlert calls since the last reset. The add-in only raises an alert
+// when a function fails to register
+size_t getExcel4StubAlertCount();
+void resetExcel4Stub();
+
+#endif
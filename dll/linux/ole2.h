@@ -0,0 +1,77 @@
+#ifndef derivativeLinuxOle2Stub_INCLUDED
+#define derivativeLinuxOle2Stub_INCLUDED
+
+/*======================================================================================
+ole2.h (Linux stub)
+
+The VARIANT and SAFEARRAY declarations used by the Variant conversions in xloper.cpp.
+There is no OLE on Linux so every SafeArray and BSTR function fails and the conversions
+return false; the C API paths that the add-in functions use do not depend on them.
+=======================================================================================*/
+
+#include "windows.h"
+
+typedef unsigned short VARTYPE;
+typedef short VARIANT_BOOL;
+typedef wchar_t *BSTR;
+
+typedef union tagCY
+{
+    int64_t int64;
+} CY;
+
+typedef struct tagSAFEARRAYBOUND
+{
+    ULONG cElements;
+    long lLbound;
+} SAFEARRAYBOUND;
+
+typedef struct tagSAFEARRAY
+{
+    WORD cDims;
+} SAFEARRAY;
+
+typedef struct tagVARIANT
+{
+    VARTYPE vt;
+    union
+    {
+        short iVal;
+        double dblVal;
+        VARIANT_BOOL boolVal;
+        ULONG ulVal;
+        CY cyVal;
+        BSTR bstrVal;
+        SAFEARRAY *parray;
+    };
+} VARIANT;
+
+enum VARENUM
+{
+    VT_EMPTY = 0,
+    VT_I2 = 2,
+    VT_R8 = 5,
+    VT_CY = 6,
+    VT_BSTR = 8,
+    VT_ERROR = 10,
+    VT_BOOL = 11,
+    VT_VARIANT = 12,
+    VT_SCODE = 10,
+    VT_VECTOR = 0x1000,
+    VT_ARRAY = 0x2000,
+    VT_BYREF = 0x4000
+};
+
+inline void VariantInit(VARIANT *var) { var->vt = VT_EMPTY; }
+inline SAFEARRAY *SafeArrayCreate(VARTYPE, unsigned int, SAFEARRAYBOUND *) { return NULL; }
+inline HRESULT SafeArrayPutElement(SAFEARRAY *, long *, void *) { return E_NOTIMPL; }
+inline HRESULT SafeArrayGetElement(SAFEARRAY *, long *, void *) { return E_NOTIMPL; }
+inline HRESULT SafeArrayGetUBound(SAFEARRAY *, unsigned int, long *) { return E_NOTIMPL; }
+inline HRESULT SafeArrayGetLBound(SAFEARRAY *, unsigned int, long *) { return E_NOTIMPL; }
+inline HRESULT SafeArrayAccessData(SAFEARRAY *, void **) { return E_NOTIMPL; }
+inline HRESULT SafeArrayUnaccessData(SAFEARRAY *) { return E_NOTIMPL; }
+inline unsigned int SafeArrayGetDim(SAFEARRAY *) { return 0; }
+inline unsigned int SysStringLen(BSTR) { return 0; }
+inline BSTR SysAllocStringLen(const wchar_t *, unsigned int) { return NULL; }
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef derivativeLinuxWindowsStub_INCLUDED
+#define derivativeLinuxWindowsStub_INCLUDED
+
+/*======================================================================================
+windows.h (Linux stub)
+
+Just enough of the Windows headers for the excel marshalling layer in dll/ to compile with
+gcc or clang, so that it can be exercised on Linux against the stub Excel4 in
+excel4Stub.cpp. Window functions report failure; nothing here talks to a real excel.
+=======================================================================================*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <wchar.h>
+
+#define far
+#define FAR
+#define pascal
+#define _cdecl
+#define __cdecl
+#define __stdcall
+#define APIENTRY
+#define WINAPI
+
+typedef unsigned char BYTE;
+typedef unsigned short WORD;
+typedef uint32_t DWORD;
+typedef uint32_t ULONG;
+typedef uintptr_t DWORD_PTR;
+typedef int BOOL;
+typedef char *LPSTR;
+typedef void *LPVOID;
+typedef void *HANDLE;
+typedef void *HWND;
+typedef intptr_t LPARAM;
+typedef int32_t HRESULT;
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#define LOWORD(l) ((WORD)((uintptr_t)(l) & 0xffff))
+#define SUCCEEDED(hr) (((HRESULT)(hr)) >= 0)
+#define FAILED(hr) (((HRESULT)(hr)) < 0)
+#define S_OK ((HRESULT)0)
+#define E_NOTIMPL ((HRESULT)0x80004001L)
+
+#define DLL_PROCESS_ATTACH 1
+#define DLL_PROCESS_DETACH 0
+
+typedef BOOL (*WNDENUMPROC)(HWND, LPARAM);
+
+inline HWND GetParent(HWND) { return NULL; }
+inline int GetClassNameA(HWND, char *className, int) { className[0] = 0; return 0; }
+inline BOOL EnumWindows(WNDENUMPROC, LPARAM) { return FALSE; }
+inline int _strnicmp(const char *a, const char *b, size_t n) { return strncasecmp(a, b, n); }
+
+#include "ole2.h"
+
+#endif
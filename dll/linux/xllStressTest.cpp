@@ -0,0 +1,331 @@
+/*======================================================================================
+xllStressTest
+
+Loads the add-in against the stub Excel4 and calls the exported functions from many
+threads at once, the way excel does during a multithreaded recalculation. It checks that
+
+ - every function is registered as thread safe ($ at the end of its type string)
+ - every call on every thread returns exactly the value of a single threaded call
+ - a returned xloper is not disturbed by calls on other threads before its owner thread
+   makes its next call, which is all excel relies on
+ - the functions never call back into excel while they calculate
+ - once warmed up, the scalar functions make no heap allocations at all
+
+Usage: xllStressTest [threads] [iterations per thread]. Returns 0 on success.
+
+Built by the xllStressTest target of the CMake build on Linux, which puts dll/linux first
+on the include path so that its windows.h and ole2.h stand in for the Windows headers.
+=======================================================================================*/
+#include "excel4Stub.h"
+#include "../xllFunctions.h"
+
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <thread>
+
+int __stdcall xlAutoOpen(void);
+int __stdcall xlAutoClose(void);
+
+namespace
+{
+    // Heap allocations made by operator new on this thread
+    thread_local size_t threadAllocations = 0;
+}
+
+void *operator new(size_t size)
+{
+    ++threadAllocations;
+    void *p = malloc(size > 0 ? size : 1);
+    if (p == NULL)
+    {
+        throw bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+namespace
+{
+    // An FP ("K") argument, laid out the way excel passes it
+    class XlArray
+    {
+    public:
+        XlArray(WORD rows, WORD columns, const vector<double> &values)
+            : memory(sizeof(xl_array) + sizeof(double) * (values.size() + 1))
+        {
+            array = (xl_array *)&memory[0];
+            array->rows = rows;
+            array->columns = columns;
+            copy(values.begin(), values.end(), array->array);
+        }
+        xl_array *get() { return array; }
+
+    private:
+        vector<char> memory;
+        xl_array *array;
+    };
+
+    // A printable copy of a returned xloper that can be compared after the original has
+    // been overwritten
+    string describe(const xloper *p_op)
+    {
+        ostringstream out;
+        out.precision(17);
+        int type = p_op->xltype & ~(xlbitXLFree | xlbitDLLFree);
+        switch (type)
+        {
+        case xltypeNum:
+            out << p_op->val.num;
+            break;
+        case xltypeStr:
+            out << "\"" << string(p_op->val.str + 1, (unsigned char)p_op->val.str[0]) << "\"";
+            break;
+        case xltypeErr:
+            out << "#ERR" << p_op->val.err;
+            break;
+        case xltypeNil:
+            out << "nil";
+            break;
+        case xltypeMulti:
+            out << "{";
+            for (int i = 0; i < p_op->val.array.rows * p_op->val.array.columns; ++i)
+            {
+                out << (i > 0 ? (i % p_op->val.array.columns == 0 ? ";" : ",") : "")
+                    << describe(&p_op->val.array.lparray[i]);
+            }
+            out << "}";
+            break;
+        default:
+            out << "type" << type;
+        }
+        if (p_op->xltype & xlbitDLLFree)
+        {
+            // Excel would hand a DLLFree xloper back through xlAutoFree, which the thread
+            // safe return path must never need
+            out << "[DLLFree]";
+        }
+        return out.str();
+    }
+
+    class StressInputs
+    {
+    public:
+        StressInputs() :
+            xArray(1, 6, { 0, 1, 2, 3, 4, 5 }),
+            yArray(1, 6, { 1.0, 1.5, 1.7, 2.6, 2.9, 3.0 }),
+            dayArray(1, 3, { 30, 90, 180 }),
+            putDeltaArray(1, 5, { 0.1, 0.25, 0.5, 0.75, 0.9 }),
+            surface(5, 3, { 24, 23, 22,   22, 21, 20,   20, 19, 18,   21, 20, 19,   23, 22, 21 }),
+            dayColumn(3, 1, { 30, 90, 180 }),
+            transposedSurface(3, 5, { 24, 22, 20, 21, 23,   23, 21, 19, 20, 22,   22, 20, 18, 19, 21 }),
+            forwardArray(1, 1, { 100 }),
+            strikeArray(4, 1, { 80, 95, 105, 120 }),
+            dayGridArray(1, 2, { 45, 150 }),
+            premiumArray(4, 1, { 20.5, 6.0, 2.2, 0.01 }),
+            discountFactorArray(1, 1, { 0.99 })
+        {
+        }
+
+        XlArray xArray, yArray, dayArray, putDeltaArray, surface;
+        // The same surface with the days down a column
+        XlArray dayColumn, transposedSurface;
+        XlArray forwardArray, strikeArray, dayGridArray, premiumArray, discountFactorArray;
+    };
+
+    const size_t numberOfCalls = 17;
+
+    // Call number i varies its scalar inputs with the iteration so threads do not all
+    // ask for the same value at the same time
+    xloper *callFunction(StressInputs &in, size_t call, size_t iteration)
+    {
+        double bump = (double)(iteration % 7);
+        switch (call)
+        {
+        case 0:
+            return Interpolate(0.5 + bump * 0.6, in.xArray.get(), in.yArray.get(), 6, "Cubic", true);
+        case 1:
+            return Interpolate(0.5 + bump * 0.6, in.xArray.get(), in.yArray.get(), 6, "Linear", false);
+        case 2:
+            return BlackVolOffSurface("c", 100, 90 + bump * 3, 60 + bump * 10,
+                in.dayArray.get(), in.putDeltaArray.get(), in.surface.get(), 1e-8, "bilinear", true);
+        case 3:
+            return BlackVolGridOffSurface("p", in.forwardArray.get(), in.strikeArray.get(),
+                in.dayGridArray.get(), in.dayArray.get(), in.putDeltaArray.get(), in.surface.get(), "");
+        case 4:
+            return Black("c", 100, 90 + bump * 3, 0.5, 0.2, 0.99);
+        case 5:
+            return BlackDelta("p", 100, 90 + bump * 3, 0.5, 0.2, 0.99);
+        case 6:
+            return BlackGreeks("c", 100, 90 + bump * 3, 0.5, 0.2, 0.99);
+        case 7:
+            return BlackImpliedSD("c", in.premiumArray.get(), in.forwardArray.get(),
+                in.strikeArray.get(), in.discountFactorArray.get());
+        case 8:
+            // An error message goes through the string path of the return buffer
+            return Black("x", 100, 90 + bump * 3, 0.5, 0.2, 0.99);
+        case 9:
+            return Interpolate(1.0, in.xArray.get(), in.dayArray.get(), 6, "Linear", false);
+        case 10:
+            return Bachelier("p", -37.63, -40 + bump * 3, 0.5, 15.0, 0.99);
+        case 11:
+            return BachelierGreeks("c", -37.63, -40 + bump * 3, 30, 15.0, 0.99);
+        case 12:
+            return BachelierImpliedSD("p", in.premiumArray.get(), in.forwardArray.get(),
+                in.strikeArray.get(), in.discountFactorArray.get());
+        case 13:
+            return Spread("c", 80, 75, 2 + bump, 0.3, 0.25, 0.8, 0.99, "");
+        case 14:
+            return SpreadDeltas("p", 80, 75, 2 + bump, 0.3, 0.25, 0.8, 0.99, "Kirk");
+        case 15:
+            return AmericanBlack("p", 80, 75 + bump, 0.3, 0.97, "BS");
+        default:
+            // Read through a strided view of the columns, must match call 2
+            return BlackVolOffSurface("c", 100, 90 + bump * 3, 60 + bump * 10,
+                in.dayColumn.get(), in.putDeltaArray.get(), in.transposedSurface.get(), 1e-8, "", true);
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    size_t threadCount = argc > 1 ? (size_t)atoi(argv[1]) : 16;
+    size_t iterations = argc > 2 ? (size_t)atoi(argv[2]) : 2000;
+    size_t failures = 0;
+
+    resetExcel4Stub();
+    xlAutoOpen();
+    vector<Excel4StubRegistration> registrations = getExcel4StubRegistrations();
+    if (registrations.size() != NUM_FUNCTIONS || getExcel4StubAlertCount() != 0)
+    {
+        cout << "Registered " << registrations.size() << " of " << NUM_FUNCTIONS << " functions" << endl;
+        ++failures;
+    }
+    for (size_t i = 0; i < registrations.size(); ++i)
+    {
+        string typeText = registrations[i].typeText;
+        if (typeText.empty() || typeText[typeText.size() - 1] != '$')
+        {
+            cout << registrations[i].functionName << " is not registered as thread safe (" << typeText << ")" << endl;
+            ++failures;
+        }
+        // Only the cache statistics change without their inputs changing
+        bool shouldBeVolatile = (registrations[i].functionName == "SurfaceCacheStatistics");
+        if (shouldBeVolatile != (typeText.find('!') != string::npos))
+        {
+            cout << registrations[i].functionName << " has the wrong volatility (" << typeText << ")" << endl;
+            ++failures;
+        }
+    }
+
+    // Expected values from a single thread
+    StressInputs inputs;
+    vector<vector<string>> expected(numberOfCalls, vector<string>(7));
+    for (size_t call = 0; call < numberOfCalls; ++call)
+    {
+        for (size_t bump = 0; bump < 7; ++bump)
+        {
+            expected[call][bump] = describe(callFunction(inputs, call, bump));
+            if ((call == numberOfCalls - 1) && (expected[call][bump] != expected[2][bump]))
+            {
+                cout << "Transposed surface gives " << expected[call][bump] << " not " << expected[2][bump] << endl;
+                ++failures;
+            }
+            if (expected[call][bump].find("[DLLFree]") != string::npos)
+            {
+                cout << "Call " << call << " returned memory for excel to free: " << expected[call][bump] << endl;
+                ++failures;
+            }
+        }
+    }
+
+    // No volatility on an extrapolated steep skew gives these strikes their delta: an error
+    // for the single value and #NUM! across the grid, never a NaN number
+    XlArray steepDeltas(1, 5, { 10, 25, 50, 75, 90 });
+    XlArray steepSurface(5, 3, { 20, 20, 20,   18, 18, 18,   14, 14, 14,   10, 10, 10,   2, 2, 2 });
+    XlArray steepStrikes(2, 1, { 130, 200 });
+    string steepSingle = describe(BlackVolOffSurface("c", 100, 130, 60,
+        inputs.dayArray.get(), steepDeltas.get(), steepSurface.get(), 1e-8, "bilinear", true));
+    string steepGrid = describe(BlackVolGridOffSurface("c", inputs.forwardArray.get(), steepStrikes.get(),
+        inputs.dayGridArray.get(), inputs.dayArray.get(), steepDeltas.get(), steepSurface.get(), ""));
+    string numError = "#ERR" + to_string(xlerrNum);
+    if ((steepSingle[0] != '"') || 
+        (steepGrid != "{" + numError + "," + numError + ";" + numError + "," + numError + "}"))
+    {
+        cout << "Steep skew gives " << steepSingle << " and " << steepGrid << endl;
+        ++failures;
+    }
+
+    // The calls that return a single number, or a fixed size row, should not touch the heap
+    // once this thread's return buffer has been used
+    size_t scalarCalls[3] = { 4, 5, 6 };
+    for (size_t k = 0; k < 3; ++k)
+    {
+        size_t call = scalarCalls[k];
+        size_t allocationsBefore = threadAllocations;
+        callFunction(inputs, call, 3);
+        size_t allocations = threadAllocations - allocationsBefore;
+        if (allocations > 0)
+        {
+            cout << "Call " << call << " made " << allocations << " heap allocations" << endl;
+            ++failures;
+        }
+    }
+
+    size_t excelCallsBefore = getExcel4StubCallCount();
+    atomic<size_t> mismatches(0), overwritten(0);
+    vector<thread> threads;
+    for (size_t t = 0; t < threadCount; ++t)
+    {
+        threads.push_back(thread([&, t]()
+        {
+            for (size_t i = 0; i < iterations; ++i)
+            {
+                size_t call = (i + t) % numberOfCalls;
+                xloper *result = callFunction(inputs, call, i);
+                string value = describe(result);
+                if (value != expected[call][i % 7])
+                {
+                    ++mismatches;
+                }
+                // Give the other threads a chance to return values of their own before
+                // looking at this one again
+                this_thread::yield();
+                if (describe(result) != value)
+                {
+                    ++overwritten;
+                }
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); ++t)
+    {
+        threads[t].join();
+    }
+    size_t excelCalls = getExcel4StubCallCount() - excelCallsBefore;
+    xlAutoClose();
+
+    cout << threadCount << " threads x " << iterations << " calls: "
+         << mismatches << " wrong results, " << overwritten << " results overwritten by other threads, "
+         << excelCalls << " calls back into excel, "
+         << XllReturnBuffer::getAllocationCount() << " return buffer allocations" << endl;
+    failures += mismatches + overwritten + excelCalls;
+    if (failures > 0)
+    {
+        cout << "*** " << failures << " failures" << endl;
+        return 1;
+    }
+    cout << "*** No errors detected" << endl;
+    return 0;
+}
@@ -1,11 +1,11 @@
 
-#include "excelIntegration\xllAddIn.h"
+#include "excelIntegration/xllAddIn.h"
 
 
 //========================================================================
-char *AddinVersionStr = "Derivative pricing";
-char *AddinName = "Pricing";
-char *DevAddinName = "Pricing - DEV";
+const char *AddinVersionStr = "Derivative pricing";
+const char *AddinName = "Pricing";
+const char *DevAddinName = "Pricing - DEV";
 
 //---------------------------------------------------------
 // Registered function argument and return types
@@ -20,12 +20,16 @@ char *DevAddinName = "Pricing - DEV";
 // struct FP (xl_array)								K
 // struct oper										P
 // struct xloper									R
+//
+// Every function ends its type string with $ to register it as thread safe, so that
+// excel can call it from all its recalculation threads. A thread safe function must
+// only return memory from its thread's XllReturnBuffer (see xllReturnBuffer.h)
 //---------------------------------------------------------
-char *FunctionExports[NUM_FUNCTIONS][MAX_EXCEL4_ARGS - 1] =
+const char *FunctionExports[NUM_FUNCTIONS][MAX_EXCEL4_ARGS - 1] =
 {
 	{
 		"Interpolate",
-		"PBKKICA",
+		"PBKKICA$",
 		"Interpolate",
 		"x, x array, y array, size, Type, Extrap",
 		"1",
@@ -44,7 +48,7 @@ char *FunctionExports[NUM_FUNCTIONS][MAX_EXCEL4_ARGS - 1] =
 	},
 	{
 		"BlackVolOffSurface",
-		"PCBBBKKKBCA",
+		"PCBBBKKKBCA$",
 		"BlackVolOffSurface",
 		"OptionType,Forward,Strike,Day,Days Array,Put Delta,Volatility,Convergence,InterpType,Extrap",
 		"1",
@@ -69,7 +73,7 @@ char *FunctionExports[NUM_FUNCTIONS][MAX_EXCEL4_ARGS - 1] =
     },
     {
         "Black",
-        "RCBBBBB",
+        "RCBBBBB$",
         "Black",
         "P/C,forward,strike,dtm,sd,df",
         "1",
@@ -88,7 +92,7 @@ char *FunctionExports[NUM_FUNCTIONS][MAX_EXCEL4_ARGS - 1] =
     },
     {
         "BlackDelta",
-        "RCBBBBB",
+        "RCBBBBB$",
         "BlackDelta",
         "P/C,forward,strike,dtm,sd,df",
         "1",
@@ -105,4 +109,204 @@ char *FunctionExports[NUM_FUNCTIONS][MAX_EXCEL4_ARGS - 1] =
         "Discount Factor",
         "",
     },
+    {
+        "BlackGreeks",
+        "RCBBBBB$",
+        "BlackGreeks",
+        "P/C,forward,strike,dtm,sd,df",
+        "1",
+        AddinName,
+        "",
+        "",
+        "Returns the row {premium, delta, gamma, vega, theta, rho} of a Black 76 option on a "
+        "future / forward. Vega and rho are per 1.00 change, theta is per year",
+        // Help text line (optional)
+        "(P)ut or (C)all",
+        "Forward",
+        "Strike",
+        "Days to maturity",
+        "Standard Deviation (=vol*sqrt(time))",
+        "Discount Factor",
+        "",
+    },
+    {
+        "BlackImpliedSD",
+        "RCKKKK$",
+        "BlackImpliedSD",
+        "P/C,premium,forward,strike,df",
+        "1",
+        AddinName,
+        "",
+        "",
+        "Returns the implied standard deviation (=vol*sqrt(time)) of each Black 76 option "
+        "premium as a column. Premiums with no implied standard deviation return #NUM!",
+        // Help text line (optional)
+        "(P)ut or (C)all",
+        "Premium array",
+        "Forward (single value or array)",
+        "Strike array",
+        "Discount Factor (single value or array)",
+        "",
+    },
+    {
+        "Bachelier",
+        "RCBBBBB$",
+        "Bachelier",
+        "P/C,forward,strike,dtm,sd,df",
+        "1",
+        AddinName,
+        "",
+        "",
+        "Returns the PV premium of a Bachelier (normal) option on a future / forward. The "
+        "forward and strike may be negative",
+        // Help text line (optional)
+        "(P)ut or (C)all",
+        "Forward",
+        "Strike",
+        "Days to maturity",
+        "Standard Deviation (=normal vol*sqrt(time))",
+        "Discount Factor",
+        "",
+    },
+    {
+        "BachelierGreeks",
+        "RCBBBBB$",
+        "BachelierGreeks",
+        "P/C,forward,strike,dtm,sd,df",
+        "1",
+        AddinName,
+        "",
+        "",
+        "Returns the row {premium, delta, gamma, vega, theta, rho} of a Bachelier option on a "
+        "future / forward. Vega is per 1.00 change in normal vol, rho per 1.00, theta per year",
+        // Help text line (optional)
+        "(P)ut or (C)all",
+        "Forward",
+        "Strike",
+        "Days to maturity",
+        "Standard Deviation (=normal vol*sqrt(time))",
+        "Discount Factor",
+        "",
+    },
+    {
+        "BachelierImpliedSD",
+        "RCKKKK$",
+        "BachelierImpliedSD",
+        "P/C,premium,forward,strike,df",
+        "1",
+        AddinName,
+        "",
+        "",
+        "Returns the implied standard deviation (=normal vol*sqrt(time)) of each Bachelier "
+        "option premium as a column. Premiums with no implied standard deviation return #NUM!",
+        // Help text line (optional)
+        "(P)ut or (C)all",
+        "Premium array",
+        "Forward (single value or array)",
+        "Strike array",
+        "Discount Factor (single value or array)",
+        "",
+    },
+    {
+        "Spread",
+        "RCBBBBBBBC$",
+        "Spread",
+        "P/C,forward1,forward2,strike,sd1,sd2,correlation,df,approximation",
+        "1",
+        AddinName,
+        "",
+        "",
+        "Returns the PV premium of an option on the spread of two futures / forwards by the "
+        "Kirk or Bjerksund Stensland approximation",
+        // Help text line (optional)
+        "(P)ut or (C)all on forward1 - forward2",
+        "Forward 1",
+        "Forward 2",
+        "Strike of the spread (may be negative, forward2 + strike must be > 0)",
+        "Standard Deviation 1 (=vol*sqrt(time))",
+        "Standard Deviation 2 (=vol*sqrt(time))",
+        "Correlation of the log forwards",
+        "Discount Factor",
+        "Kirk or BS (Bjerksund Stensland, default = BS)",
+        "",
+    },
+    {
+        "SpreadDeltas",
+        "RCBBBBBBBC$",
+        "SpreadDeltas",
+        "P/C,forward1,forward2,strike,sd1,sd2,correlation,df,approximation",
+        "1",
+        AddinName,
+        "",
+        "",
+        "Returns the row {premium, delta1, delta2} of an option on the spread of two futures / "
+        "forwards by the Kirk or Bjerksund Stensland approximation",
+        // Help text line (optional)
+        "(P)ut or (C)all on forward1 - forward2",
+        "Forward 1",
+        "Forward 2",
+        "Strike of the spread (may be negative, forward2 + strike must be > 0)",
+        "Standard Deviation 1 (=vol*sqrt(time))",
+        "Standard Deviation 2 (=vol*sqrt(time))",
+        "Correlation of the log forwards",
+        "Discount Factor",
+        "Kirk or BS (Bjerksund Stensland, default = BS)",
+        "",
+    },
+    {
+        "AmericanBlack",
+        "RCBBBBC$",
+        "AmericanBlack",
+        "P/C,forward,strike,sd,df,approximation",
+        "1",
+        AddinName,
+        "",
+        "",
+        "Returns the PV premium of an American option on a future by the Barone-Adesi Whaley "
+        "or Bjerksund Stensland 2002 approximation",
+        // Help text line (optional)
+        "(P)ut or (C)all",
+        "Forward",
+        "Strike",
+        "Standard Deviation (=vol*sqrt(time))",
+        "Discount Factor",
+        "BAW (Barone-Adesi Whaley, default = BAW) or BS (Bjerksund Stensland 2002)",
+        "",
+    },
+    {
+        "SurfaceCacheStatistics",
+        "R!$",
+        "SurfaceCacheStatistics",
+        "",
+        "1",
+        AddinName,
+        "",
+        "",
+        "Returns the row {hits, misses, evictions, surfaces} of the volatility surface cache "
+        "used by BlackVolOffSurface",
+        // Help text line (optional)
+        "",
+    },
+    {
+        "BlackVolGridOffSurface",
+        "RCKKKKKKC$",
+        "BlackVolGridOffSurface",
+        "OptionType,Forward,Strikes,Days,Days Array,Put Delta,Volatility,InterpType",
+        "1",
+        AddinName,
+        "",
+        "",
+        "The volatilities of Black-Scholes options for a grid of strikes (rows) and days "
+        "(columns) from a delta based surface. Same assumptions as BlackVolOffSurface",
+        // Help text line (optional)
+        "Option Type = (P)ut or (C)all",
+        "Market forward (single value or one per day)",
+        "Option strikes",
+        "Days to interpolate to",
+        "Days array (NB Time is explicitly assumed to be *DAYS*)",
+        "Delta array (NB Delta is explicitly assumed to be for a *PUT* option)",
+        "Volatility Surface",
+        "Bilinear or Bicubic (default = bilinear)",
+        "",
+    },
 };
@@ -0,0 +1,56 @@
+#include "xlArrayView.h"
+
+/*======================================================================================
+XlVectorView
+=======================================================================================*/
+XlVectorView XlVectorView::broadcast(size_t size) const
+{
+    return (n == 1) ? XlVectorView(values, size, 0) : *this;
+}
+
+vector<double> XlVectorView::toVector() const
+{
+    if (isContiguous())
+    {
+        return vector<double>(values, values + n);
+    }
+    vector<double> output(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        output[i] = values[i * stride];
+    }
+    return output;
+}
+
+/*======================================================================================
+XlArrayView
+=======================================================================================*/
+XlArrayView::XlArrayView(const xl_array *array)
+    : values(array ? array->array : NULL),
+    rows(array ? array->rows : 0),
+    columns(array ? array->columns : 0)
+{
+}
+
+XlVectorView XlArrayView::asVector() const
+{
+    return isVector() ? XlVectorView(values, rows * columns) : XlVectorView();
+}
+
+XlVectorView XlArrayView::getRow(size_t i, size_t firstColumn) const
+{
+    if ((i >= rows) || (firstColumn >= columns))
+    {
+        return XlVectorView();
+    }
+    return XlVectorView(values + i * columns + firstColumn, columns - firstColumn);
+}
+
+XlVectorView XlArrayView::getColumn(size_t j, size_t firstRow) const
+{
+    if ((j >= columns) || (firstRow >= rows))
+    {
+        return XlVectorView();
+    }
+    return XlVectorView(values + firstRow * columns + j, rows - firstRow, columns);
+}
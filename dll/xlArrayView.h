@@ -0,0 +1,77 @@
+#ifndef derivativeXlArrayView_INCLUDED
+#define derivativeXlArrayView_INCLUDED
+
+#include <windows.h>
+#include "excelIntegration/xl_array.h"
+
+#include <vector>
+
+using namespace std;
+
+/*======================================================================================
+XlVectorView
+
+A read only view of n doubles that are stride apart. A stride of 1 is a contiguous run
+that can be handed straight to the pointer based library functions; a stride of 0 repeats
+one value, which is how a single input is applied to every point of a calculation.
+=======================================================================================*/
+class XlVectorView
+{
+public:
+    XlVectorView() : values(NULL), n(0), stride(1) {};
+    XlVectorView(const double *values, size_t n, size_t stride = 1)
+        : values(values), n(n), stride(stride) {};
+
+    size_t size() const                     {return n;};
+    bool empty() const                      {return n == 0;};
+    double operator[](size_t i) const       {return values[i * stride];};
+    bool isContiguous() const               {return (stride == 1) || (n <= 1);};
+    // The first value. Only a contiguous view can be read through this pointer
+    const double *data() const              {return values;};
+
+    // The view repeated n times when it holds a single value
+    XlVectorView broadcast(size_t n) const;
+    // A copy of the values
+    vector<double> toVector() const;
+
+private:
+    const double *values;
+    size_t n;
+    size_t stride;
+};
+
+/*======================================================================================
+XlArrayView
+
+A read only view of the doubles in an FP ("K") argument, without copying them. Excel lays
+an xl_array out row by row, so a row (or an array that is a single row or column) is
+contiguous and a column of a wider array is a view with a stride of the number of columns.
+
+The view points into excel's memory and is only valid during the call that was passed the
+xl_array. A NULL xl_array is an empty view.
+=======================================================================================*/
+class XlArrayView
+{
+public:
+    XlArrayView(const xl_array *array);
+
+    size_t getRows() const                  {return rows;};
+    size_t getColumns() const               {return columns;};
+    double operator()(size_t row, size_t column) const {return values[row * columns + column];};
+
+    // True for a single row or column, including a single value
+    bool isVector() const                   {return (rows == 1) || (columns == 1);};
+    // All the values of a single row or column, which are always contiguous
+    XlVectorView asVector() const;
+    // Row i from the column firstColumn onwards
+    XlVectorView getRow(size_t i, size_t firstColumn = 0) const;
+    // Column j from the row firstRow down
+    XlVectorView getColumn(size_t j, size_t firstRow = 0) const;
+
+private:
+    const double *values;
+    size_t rows;
+    size_t columns;
+};
+
+#endif
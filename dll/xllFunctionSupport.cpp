@@ -1,9 +1,10 @@
 #include "xllFunctionSupport.h"
 
-#include <boost\algorithm\string.hpp>
+#include <boost/algorithm/string.hpp>
+#include <string.h> // strlen
 
 
-bool getPutCall(char *putOrCall, PutCall &type, string &errorMessage)
+bool getPutCall(const char *putOrCall, PutCall &type, string &errorMessage)
 {
 	string optionType(putOrCall);
 	boost::to_lower(optionType);
@@ -28,11 +29,14 @@ bool getPutCall(char *putOrCall, PutCall &type, string &errorMessage)
 returnXloperOnError
 
 =======================================================================================*/
-xloper* returnXloperOnError(string errorMessage)
+xloper* returnXloperOnError(const string &errorMessage)
 {
-    cpp_xloper outputMatrix(1, 1);
-    outputMatrix.SetArrayElement(0, 0, (char*)errorMessage.c_str());
-    return outputMatrix.ExtractXloper(false);
+    return XllReturnBuffer::getThreadBuffer().setValue(errorMessage);
+}
+
+xloper* returnXloperOnError(const char *errorMessage)
+{
+    return XllReturnBuffer::getThreadBuffer().setValue(errorMessage, strlen(errorMessage));
 }
 
 /*======================================================================================
@@ -41,9 +45,49 @@ returnXloper
 =======================================================================================*/
 xloper* returnXloper(double returnValue)
 {
-	cpp_xloper outputMatrix(1, 1);
-	outputMatrix.SetArrayElement(0, 0, returnValue);
-	return outputMatrix.ExtractXloper(false);
+	return XllReturnBuffer::getThreadBuffer().setValue(returnValue);
+}
+
+/*======================================================================================
+returnXloper
+
+=======================================================================================*/
+xloper* returnXloper(const double *outputArray, size_t n, bool asRow)
+{
+	XllReturnBuffer &outputMatrix = XllReturnBuffer::getThreadBuffer();
+	outputMatrix.setArray(asRow ? 1 : (WORD)n, asRow ? (WORD)n : 1);
+	for (WORD i = 0; i < (WORD)n; ++i)
+	{
+		outputMatrix.setArrayElement(asRow ? 0 : i, asRow ? i : 0, outputArray[i]);
+	}
+	return outputMatrix.getXloper();
+}
+
+/*======================================================================================
+returnXloper
+
+=======================================================================================*/
+xloper* returnXloper(cpp_xloper &returnValue)
+{
+	return XllReturnBuffer::getThreadBuffer().copy(returnValue);
+}
+
+/*======================================================================================
+getVectorView
+
+=======================================================================================*/
+bool getVectorView(xl_array* xlArray, XlVectorView &outputView, string &errorMessage)
+{
+    errorMessage = "";
+    XlArrayView arrayView(xlArray);
+    if (!arrayView.isVector())
+    {
+        outputView = XlVectorView();
+        errorMessage = "Input not a vector";
+        return false;
+    }
+    outputView = arrayView.asVector();
+    return true;
 }
 
 /*======================================================================================
@@ -54,103 +98,46 @@ this opperation
 =======================================================================================*/
 bool constructVector(xl_array* xlArray, vector<double> &outputVector, string &errorMessage)
 {
-    bool successful = true;
-    errorMessage = "";
-    WORD xlArray_rows, xlArray_columns;
-    cpp_xloper cppXloper(xlArray);
-    cppXloper.GetArraySize(xlArray_rows, xlArray_columns);
-    if (!((xlArray_columns == 1) || (xlArray_rows == 1)))
+    XlVectorView view;
+    if (!getVectorView(xlArray, view, errorMessage))
     {
-        successful = false;
-        errorMessage = "Input not a vector";
         return false;
     }
-    double rate;
-    outputVector = vector<double>();
-	if (xlArray_columns == 1)
-	{
-		for (WORD i = 0; i < xlArray_rows; ++i)
-		{
-			cppXloper.GetArrayElement(i, 0, rate);
-			outputVector.push_back(rate);
-		}
-	}
-	else
-	{
-		for (WORD i = 0; i < xlArray_columns; ++i)
-		{
-			cppXloper.GetArrayElement(0, i, rate);
-			outputVector.push_back(rate);
-		}
-	}
-    return successful;
+    outputVector = view.toVector();
+    return true;
 }
 
 /*======================================================================================
 extractDataFromSurface
 
-Take and *xl_array and turn it into a vector or vectors, creating detail about the success
-(or not) of this opperation.
+View an *xl_array as a matrix, creating detail about the success (or not) of this 
+opperation. Excel stores the array row by row, so the transpose is a column major view of
+the same memory
 =======================================================================================*/
 bool extractDataFromSurface(
     xl_array* surfaceInput,
 	bool transpose,
-    vector<vector<double>> &data,
+    XLLBasicLibrary::MatrixView &data,
     string &errorMessage)
 {
-    bool successful = true;
     errorMessage = "No error";
+    data = XLLBasicLibrary::MatrixView();
 
-    WORD xlArray_rows, xlArray_columns;
-    cpp_xloper cppXloper(surfaceInput);
-    cppXloper.GetArraySize(xlArray_rows, xlArray_columns);
-    if ((xlArray_columns < 2) || (xlArray_rows < 2))
+    XlArrayView surfaceView(surfaceInput);
+    if ((surfaceView.getColumns() < 2) || (surfaceView.getRows() < 2))
     {
-        successful = false;
         errorMessage = "Input surface must contain at least 2 rows and 2 columns";
-        data.clear();
-        return successful;
+        return false;
     }
-    double value;
-	vector<double> zeroVector;
-	data.clear();
 	if (transpose)
 	{
-		zeroVector = vector<double>(xlArray_rows, 0);
-		for (WORD i = 0; i < xlArray_columns; ++i)
-		{
-			data.push_back(zeroVector);
-			for (WORD j = 0; j < xlArray_rows; ++j)
-			{
-				if (!cppXloper.GetArrayElement(j, i, value))
-				{
-					successful = false;
-					errorMessage = "At least one data point is not a numeric value";
-					return successful;
-				}
-				data[i][j] = (value);
-			}
-		}
+		data = XLLBasicLibrary::MatrixView(surfaceInput->array, surfaceView.getColumns(), surfaceView.getRows(), true);
 	}
 	else
 	{
-		zeroVector = vector<double>(xlArray_columns, 0);
-		for (WORD i = 0; i < xlArray_rows; ++i)
-		{
-			data.push_back(zeroVector);
-			for (WORD j = 0; j < xlArray_columns; ++j)
-			{
-				if (!cppXloper.GetArrayElement(i, j, value))
-				{
-					successful = false;
-					errorMessage = "At least one data point is not a numeric value";
-					return successful;
-				}
-				data[i][j] = (value);
-			}
-		}
+		data = XLLBasicLibrary::MatrixView(surfaceInput->array, surfaceView.getRows(), surfaceView.getColumns());
 	}
-    return successful;
+    return true;
 }
 
 /*======================================================================================
@@ -165,72 +152,26 @@ bool extractDataFromSurface(
     vector<vector<double>> &data,
     string &errorMessage)
 {
-    bool successful = true;
     errorMessage = "No error";
 
-    WORD xlArray_rows, xlArray_columns;
-    cpp_xloper cppXloper(surfaceInput);
-    cppXloper.GetArraySize(xlArray_rows, xlArray_columns);
-    if ((xlArray_columns < 2) || (xlArray_rows < 2)) 
+    XlArrayView surfaceView(surfaceInput);
+    if ((surfaceView.getColumns() < 2) || (surfaceView.getRows() < 2)) 
     {
-        successful = false;
         errorMessage = "Input surface must contain at least 2 rows and 2 columns";
         columnHeadings = vector<double>(1, 0);
         rowHeadings = vector<double>(1, 0);
         data.clear();
         data.push_back(columnHeadings);
-        return successful;
-    }
-    double rate;
-    rowHeadings.clear();
-    for (WORD i = 1; i < xlArray_rows; ++i)
-    {
-        cppXloper.GetArrayElement(i, 0, rate);
-        rowHeadings.push_back(rate);
+        return false;
     }
-
-    columnHeadings = vector<double>(xlArray_columns - 1, 0);
-    rowHeadings = vector<double>(xlArray_rows - 1, 0);
+    // The first entry, surfaceView(0, 0), is ignored
+    rowHeadings = surfaceView.getColumn(0, 1).toVector();
+    columnHeadings = surfaceView.getRow(0, 1).toVector();
     data.clear();
-    for (size_t i = 1; i < xlArray_rows; ++i)
-    {
-        data.push_back(columnHeadings);
-    }
-
-    for (WORD i = 1; i < xlArray_rows; ++i)
+    data.reserve(surfaceView.getRows() - 1);
+    for (size_t i = 1; i < surfaceView.getRows(); ++i)
     {
-        if (!cppXloper.GetArrayElement(i, 0, rate)) 
-        {
-            successful = false;
-            errorMessage = "At least one row heading is not a numeric value";
-            return successful;
-        }
-        rowHeadings[i - 1] = (rate);
+        data.push_back(surfaceView.getRow(i, 1).toVector());
     }
-    for (WORD i = 1; i < xlArray_columns; ++i)
-    {
-        if (!cppXloper.GetArrayElement(0, i, rate)) 
-        {
-            successful = false;
-            errorMessage = "At least one column heading is not a numeric value";
-            return successful;
-        }
-        columnHeadings[i - 1] = rate;
-    }
-    for (WORD i = 1; i < xlArray_rows; ++i)
-    {
-        for (WORD j = 1; j < xlArray_columns; ++j)
-        {
-            if (!cppXloper.GetArrayElement(i, j, rate)) 
-            {
-                successful = false;
-                errorMessage = "At least one data point is not a numeric value";
-                return successful;
-            }
-            data[i - 1][j - 1] = (rate);
-        }
-    }
-    return successful;
+    return true;
 }
-
-
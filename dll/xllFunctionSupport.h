@@ -1,72 +1,114 @@
 #ifndef derivativeXLLSupportInterface_INCLUDED
 #define derivativeXLLSupportInterface_INCLUDED
 
-#include "excelIntegration\xloper.h"
-#include "excelIntegration\xl_array.h"
-#include "excelIntegration\cpp_xloper.h"
-#include "excelIntegration\xllAddIn.h"
+#include "excelIntegration/xloper.h"
+#include "excelIntegration/xl_array.h"
+#include "excelIntegration/cpp_xloper.h"
+#include "excelIntegration/xllAddIn.h"
+#include "xllReturnBuffer.h"
+#include "xlArrayView.h"
+#include "../Maths/Matrix.h"
 
 #include <vector>
 
 using namespace std;
 
 enum PutCall { PUT, CALL };
-bool getPutCall(char *putOrCall, PutCall &type, string &errorMessage);
+bool getPutCall(const char *putOrCall, PutCall &type, string &errorMessage);
 
 /*======================================================================================
 returnXloper
 
-Convert a vector of values into an *xloper so it can be sent to excel
+Convert a vector of values into an *xloper so it can be sent to excel. The values are
+returned as a column unless asRow is true. 
+
+All the returnXloper functions write into the XllReturnBuffer of the calling thread so 
+they are safe to call from excel's recalculation threads
 =======================================================================================*/
 template <typename T>
-xloper* returnXloper(vector<T> outputVector)
+xloper* returnXloper(const vector<T> &outputVector, bool asRow = false)
 {
-    WORD output_rows = (WORD)outputVector.size();
-    WORD output_columns = 1;
-    cpp_xloper outputMatrix(output_rows, output_columns);
-    for (size_t i = 0; i < output_rows; ++i)
+    WORD output_size = (WORD)outputVector.size();
+    WORD output_rows = asRow ? 1 : output_size;
+    WORD output_columns = asRow ? output_size : 1;
+    XllReturnBuffer &outputMatrix = XllReturnBuffer::getThreadBuffer();
+    outputMatrix.setArray(output_rows, output_columns);
+    for (WORD i = 0; i < output_size; ++i)
     {
         double rate = outputVector[i];
-        outputMatrix.SetArrayElement(i, 0, rate);
+        if (asRow)
+        {
+            outputMatrix.setArrayElement(0, i, rate);
+        }
+        else
+        {
+            outputMatrix.setArrayElement(i, 0, rate);
+        }
     }
-    return outputMatrix.ExtractXloper(false);
+    return outputMatrix.getXloper();
 }
 
+/*======================================================================================
+returnXloper
+
+As above for the n values of a plain array, for functions with a fixed number of 
+outputs that do not need a vector
+=======================================================================================*/
+xloper* returnXloper(const double *outputArray, size_t n, bool asRow = false);
+
 /*======================================================================================
 returnXloperOnError
 
 Converts a string (normally containing an error message) to an *xloper so it can be 
-returned to excel
+returned to excel. The xloper is a single xltypeStr
 =======================================================================================*/
-xloper* returnXloperOnError(string errorMessage);
+xloper* returnXloperOnError(const string &errorMessage);
+xloper* returnXloperOnError(const char *errorMessage);
 
 /*======================================================================================
 returnXloper
 
 Converts a double (normally the correct answer from a function) to an *xloper so it 
-can be returned to excel
+can be returned to excel. The xloper is a single xltypeNum, so this makes no heap 
+allocations
 =======================================================================================*/
 xloper* returnXloper(double returnValue);
 
+/*======================================================================================
+returnXloper
+
+Copies a cpp_xloper built up by the calling function so it can be returned to excel. Use
+this rather than cpp_xloper::ExtractXloper, which hands over memory excel must free
+=======================================================================================*/
+xloper* returnXloper(cpp_xloper &returnValue);
+
+
+/*======================================================================================
+getVectorView
+
+View an *xl_array that is a single row or column without copying it, with detail about 
+the success (or not) of this opperation. The view is only valid during the current call
+=======================================================================================*/
+bool getVectorView(xl_array* column, XlVectorView &outputView, string &errorMessage);
 
 /*======================================================================================
 constructVector
 
 Take and *xl_array and turn it into a vector and detail about the success (or not) of
-this opperation
+this opperation. Use getVectorView when the values do not need to outlive the call
 =======================================================================================*/
 bool constructVector(xl_array* column, vector<double> &outputVector, string &errorMessage);
 
 /*======================================================================================
 extractDataFromSurface
 
-Take and *xl_array and turn it into a vector or vectors, creating detail about the success 
-(or not) of this opperation. 
+View an *xl_array as a matrix, transposed if asked, without copying it, creating detail 
+about the success (or not) of this opperation. The view is only valid during the call.
 =======================================================================================*/
 bool extractDataFromSurface(
     xl_array* surfaceInput,
 	bool transpose,
-    vector<vector<double>> &data,
+    XLLBasicLibrary::MatrixView &data,
     string &errorMessage);
 
 /*======================================================================================
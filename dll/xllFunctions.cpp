@@ -1,7 +1,7 @@
 #include "xllFunctions.h"
 
 using namespace XLLBasicLibrary;
-#include <memory> // shared_ptr
+#include <memory> // shared_ptr, unique_ptr
 #include <boost/algorithm/string.hpp> // to_lower
 
 xloper* __stdcall Interpolate(
@@ -9,43 +9,43 @@ xloper* __stdcall Interpolate(
     xl_array *xArray,
     xl_array *yArray,
     int arrayInputSize,
-    char* interpolatorType,
+    const char* interpolatorType,
     bool extrapolate)
 {
 	try
 	{
 		shared_ptr<ArrayInterpolator> interpolator;
-		vector<double> xVector, yVector;
+		// The interpolator only lives for this call so it can read straight from excel's arrays
+		XlVectorView xView, yView;
 		string errorMessage;
-		if (!constructVector(xArray, xVector, errorMessage))
+		if (!getVectorView(xArray, xView, errorMessage))
 		{
 			return returnXloperOnError(errorMessage);
 		}
-		if (!constructVector(yArray, yVector, errorMessage))
+		if (!getVectorView(yArray, yView, errorMessage))
 		{
 			return returnXloperOnError(errorMessage);
 		}
-		if (xVector.size() != yVector.size())
+		if (xView.size() != yView.size())
 		{
 			return returnXloperOnError("X and Y input arrays have inconsistent dimension");
 		}
-		if ((int) xVector.size() < arrayInputSize)
+		if ((int) xView.size() < arrayInputSize)
 		{
 			return returnXloperOnError("\"Size\" input is greater than the lenght of the X and Y arrays");
 		}
-		xVector.resize(arrayInputSize);
-		yVector.resize(arrayInputSize);
+		size_t n = (arrayInputSize > 0) ? (size_t) arrayInputSize : 0;
 		string type = string(interpolatorType);
 		boost::to_lower(type);
 		if (type.compare("") == 0 || type.compare("linear") == 0)
 		{
 			interpolator = shared_ptr<ArrayInterpolator>(
-				new  LinearArrayInterpolator(xVector, yVector, extrapolate));
+				new  LinearArrayInterpolator(xView.data(), yView.data(), n, extrapolate));
 		}
 		else if (type.compare("cubic") == 0)
 		{
 			interpolator = shared_ptr<ArrayInterpolator>(
-				new  CubicSplineInterpolator(xVector, yVector, extrapolate));
+				new  CubicSplineInterpolator(xView.data(), yView.data(), n, extrapolate));
 		}
 		else
 		{
@@ -63,8 +63,82 @@ xloper* __stdcall Interpolate(
 	}
 }
 
+namespace
+{
+	// The surface for the excel inputs, from the cache if it has been seen before. Returns
+	// an empty pointer, with the reason in errorMessage, if the inputs are invalid.
+	shared_ptr<SimpleDeltaSurface> getDeltaSurface(
+		xl_array *dayArray,
+		xl_array *putDeltaArray,
+		xl_array *surface,
+		const char* type,
+		string &errorMessage)
+	{
+		if (std::string(type).compare("") == 0)
+		{
+			type = "bilinear";
+		}
+		// Hard coded explicit assumption that the time input uses days but everything in
+		// the code uses year fractions
+		double yearFraction = 1 / 365.0;
+
+		// Surfaces are cached on the content of the raw inputs so that the parsing below
+		// is only done the first time a surface is seen. Extrapolate is always set to 
+		// true to ensure we can solve for vol
+		SurfaceCacheKey key(type, true);
+		key.addArray(dayArray->rows, dayArray->columns, dayArray->array);
+		key.addArray(putDeltaArray->rows, putDeltaArray->columns, putDeltaArray->array);
+		key.addArray(surface->rows, surface->columns, surface->array);
+		SimpleDeltaSurfaceCache &cache = SimpleDeltaSurfaceCache::getGlobalCache();
+		shared_ptr<SimpleDeltaSurface> deltaSurface = cache.find(key);
+		if (deltaSurface)
+		{
+			return deltaSurface;
+		}
+
+		vector<double> timeVector;
+		if (!constructVector(dayArray, timeVector, errorMessage))
+		{
+			return shared_ptr<SimpleDeltaSurface>();
+		}
+		// The following lines convert days into year fractions
+		transform(
+			timeVector.begin(),
+			timeVector.end(),
+			timeVector.begin(),
+			[yearFraction](double days) {return days * yearFraction;});
+		// The SimpleDeltaSurface class assumes the surface data is input with the time
+		// in the x-dimenstion and delta in the y-dimension. If the inputs do not conform
+		// then the surface needs to be transposed before it can be used
+		XlArrayView timeView(dayArray);
+		bool transpose = false;
+		if (timeView.getColumns() == 1 && timeView.getRows() > 1)
+		{
+			transpose = true;
+		}
+
+		vector<double> deltaVector;
+		if (!constructVector(putDeltaArray, deltaVector, errorMessage))
+		{
+			return shared_ptr<SimpleDeltaSurface>();
+		}
+
+		// A view of excel's memory, copied once into the surface
+		MatrixView surfaceData;
+		if (!extractDataFromSurface(surface, transpose, surfaceData, errorMessage))
+		{
+			return shared_ptr<SimpleDeltaSurface>();
+		}
+
+		deltaSurface = shared_ptr<SimpleDeltaSurface>(
+			new SimpleDeltaSurface(timeVector, deltaVector, surfaceData, true, type));
+		cache.insert(key, deltaSurface);
+		return deltaSurface;
+	}
+}
+
 xloper* __stdcall BlackVolOffSurface(
-	char* optionType,
+	const char* optionType,
 	double forward,
 	double strike,
 	double day,
@@ -72,7 +146,7 @@ xloper* __stdcall BlackVolOffSurface(
 	xl_array *putDeltaArray,
 	xl_array *surface,
 	double convergenceThreshold,
-	char* type,
+	const char* type,
 	bool extrapolate)
 {
 	try
@@ -88,58 +162,116 @@ xloper* __stdcall BlackVolOffSurface(
 			return returnXloperOnError(errorMessage);
 		}
 
-		vector<double> timeVector;
-		if (!constructVector(dayArray, timeVector, errorMessage))
+		// Hard coded explicit assumption that the time input uses days but everything in
+		// the code uses year fractions
+		double yearFraction = 1 / 365.0;
+		shared_ptr<SimpleDeltaSurface> deltaSurface = 
+			getDeltaSurface(dayArray, putDeltaArray, surface, type, errorMessage);
+		if (!deltaSurface)
 		{
 			return returnXloperOnError(errorMessage);
 		}
-		// Hard coded explicit assumption that the time input uses days but everything in
-		// the code uses year fractions. The following lines convert days into year fractions
-		double yearFraction = 1 / 365.0;
-		transform(
-			timeVector.begin(),
-			timeVector.end(),
-			timeVector.begin(),
-			bind1st(multiplies<double>(), yearFraction));
-		// The SimpleDeltaSurface class assumes the surface data is input with the time
-		// in the x-dimenstion and delta in the y-dimension. If the inputs do not conform
-		// then the surface needs to be transposed before it can be used
-		WORD timeArray_rows, timeArray_columns;
-		cpp_xloper timeXloper(dayArray);
-		timeXloper.GetArraySize(timeArray_rows, timeArray_columns);
-		bool transpose = false;
-		if (timeArray_columns == 1 && timeArray_rows > 1)
+
+		// Solved once; the volatility is read off the surface at the delta found
+		double time = day * yearFraction;
+		DeltaSolverResult result = deltaSurface->solveDeltaForMoneyness(time, (strike - forward) / forward);
+		if (!result.converged)
 		{
-			transpose = true;
+			return returnXloperOnError("No positive volatility on the surface gives the strike its delta");
+		}
+		if (!deltaSurface->isInDeltaRange(time, result.delta))
+		{
+			return returnXloperOnError("Point to interpolate is outside of the surface range and extrapolation is set to false");
 		}
+		double vol = deltaSurface->getVolatilityForDelta(time, result.delta);
+		if (!(vol > 0) || (vol == numeric_limits<double>::infinity()))
+		{
+			return returnXloperOnError("The surface volatility at the strike is not positive");
+		}
+		return returnXloper(vol);
+	}
+	catch (exception &e)
+	{
+		return returnXloperOnError(e.what());
+	}
+}
 
-		vector<double> deltaVector;
-		if (!constructVector(putDeltaArray, deltaVector, errorMessage))
+xloper* __stdcall BlackVolGridOffSurface(
+	const char* optionType,
+	xl_array *forwardArray,
+	xl_array *strikeArray,
+	xl_array *dayGridArray,
+	xl_array *dayArray,
+	xl_array *putDeltaArray,
+	xl_array *surface,
+	const char* type)
+{
+	try
+	{
+		string errorMessage = "";
+		PutCall putCallType;
+		if (!getPutCall(optionType, putCallType, errorMessage))
 		{
 			return returnXloperOnError(errorMessage);
 		}
-
-		vector<vector<double>> surfaceData;
-		if (!extractDataFromSurface(surface, transpose, surfaceData, errorMessage))
+		XlVectorView forwards, strikes, days;
+		if (!getVectorView(forwardArray, forwards, errorMessage) ||
+			!getVectorView(strikeArray, strikes, errorMessage) ||
+			!getVectorView(dayGridArray, days, errorMessage))
 		{
 			return returnXloperOnError(errorMessage);
 		}
-
-		if (std::string(type).compare("") == 0)
+		// A single forward applies to every day
+		forwards = forwards.broadcast(days.size());
+		if (forwards.size() != days.size())
 		{
-			type = "bilinear";
+			return returnXloperOnError("Forward must be a single value or have the same dimension as the days");
+		}
+		// The limits of an xloper array
+		if ((strikes.size() > 65535) || (days.size() > 256))
+		{
+			return returnXloperOnError("The strike / day grid is too large to return to excel");
 		}
-		// Set extrapolate to true to ensure we can solve for vol 
-		SimpleDeltaSurface deltaSurface(timeVector, deltaVector, surfaceData, true, type);
 
-		double moneyness = (strike - forward) / forward;
-		if (!deltaSurface.isInMoneynessRange(day * yearFraction, moneyness))
+		double yearFraction = 1 / 365.0;
+		shared_ptr<SimpleDeltaSurface> deltaSurface = 
+			getDeltaSurface(dayArray, putDeltaArray, surface, type, errorMessage);
+		if (!deltaSurface)
 		{
-			return returnXloperOnError("Point to interpolate is outside of the surface range and extrapolation is set to false");
+			return returnXloperOnError(errorMessage);
 		}
 
-		double vol = deltaSurface.getVolatilityForMoneyness(day * yearFraction, moneyness);
-		return returnXloper(vol);
+		// Strikes down the rows and days across the columns, each column solved against the
+		// smile for its day. Points that are invalid, outside the surface or without a 
+		// positive volatility return #NUM!
+		XllReturnBuffer &outputMatrix = XllReturnBuffer::getThreadBuffer();
+		outputMatrix.setArray((WORD)strikes.size(), (WORD)days.size());
+		for (size_t j = 0; j < days.size(); ++j)
+		{
+			double time = days[j] * yearFraction;
+			DeltaSmile smile = deltaSurface->getSmile(time);
+			for (size_t i = 0; i < strikes.size(); ++i)
+			{
+				double vol = numeric_limits<double>::quiet_NaN();
+				if ((forwards[j] >= 1e-14) && (strikes[i] >= 1e-14) && (days[j] >= 1e-14))
+				{
+					DeltaSolverResult result = smile.solveDeltaForMoneyness((strikes[i] - forwards[j]) / forwards[j]);
+					if (result.converged && smile.isInDeltaRange(result.delta))
+					{
+						vol = smile.getVolatilityForDelta(result.delta);
+					}
+				}
+				if ((vol > 0) && (vol < numeric_limits<double>::infinity()))
+				{
+					outputMatrix.setArrayElement((WORD)i, (WORD)j, vol);
+				}
+				else
+				{
+					outputMatrix.setArrayElement((WORD)i, (WORD)j, (WORD)xlerrNum);
+				}
+			}
+		}
+		return outputMatrix.getXloper();
 	}
 	catch (exception &e)
 	{
@@ -148,7 +280,7 @@ xloper* __stdcall BlackVolOffSurface(
 }
 
 xloper* __stdcall Black(
-    char* putOrCall,
+    const char* putOrCall,
     double forward,
     double strike,
 	double dtm,
@@ -168,40 +300,183 @@ xloper* __stdcall Black(
 			return returnXloperOnError(errorMessage);
 		}
 
-		shared_ptr<Black76Option> option;
-		string putOrCallString = string(putOrCall);
-		boost::to_lower(putOrCallString);
-		if (putCallType == CALL)
+		// The option lives on the stack so that a call makes no heap allocations. The 
+		// standard deviation is strictly positive here so the option has not matured
+		double optionPremium = (putCallType == CALL) ?
+			Black76Call(forward, strike, standardDeviation, discountFactor).getPremium() :
+			Black76Put(forward, strike, standardDeviation, discountFactor).getPremium();
+		return returnXloper(optionPremium);
+	}
+	catch (exception &e)
+	{
+		return returnXloperOnError(e.what());
+	}
+
+}
+
+xloper* __stdcall BlackDelta(
+    const char* putOrCall,
+    double forward,
+    double strike,
+	double dtm,
+    double standardDeviation,
+    double discountFactor)
+{
+	try
+	{
+		if ((forward < 1e-14) || (strike < 1e-14) || (standardDeviation < 1e-14) || (discountFactor < 1e-14))
 		{
-			option = shared_ptr<Black76Call>(new
-				Black76Call(forward, strike, standardDeviation, discountFactor));
+			return returnXloperOnError("All numeric inputs to this function must be strictly positive");
 		}
-		else // (putCallType == PUT)
+
+		PutCall putCallType;
+		string errorMessage;
+		if (!getPutCall(putOrCall, putCallType, errorMessage))
 		{
-			option = shared_ptr<Black76Put>(new
-				Black76Put(forward, strike, standardDeviation, discountFactor));
+			return returnXloperOnError(errorMessage);
 		}
+		// On the stack, as in Black
+		double optionDelta = (putCallType == CALL) ?
+			Black76Call(forward, strike, standardDeviation, discountFactor).getDelta() :
+			Black76Put(forward, strike, standardDeviation, discountFactor).getDelta();
+		return returnXloper(optionDelta);
+	}
+	catch (exception &e)
+	{
+		return returnXloperOnError(e.what());
+	}
+}
 
-		double optionPremium;
-		if (standardDeviation < 1e-14)
+xloper* __stdcall BlackGreeks(
+    const char* putOrCall,
+    double forward,
+    double strike,
+    double dtm,
+    double standardDeviation,
+    double discountFactor)
+{
+	try
+	{
+		if ((forward < 1e-14) || (strike < 1e-14) || (dtm < 1e-14) || (standardDeviation < 1e-14) || (discountFactor < 1e-14))
 		{
-			optionPremium = option->getPremiumAfterMaturity(forward, discountFactor);
+			return returnXloperOnError("All numeric inputs to this function must be strictly positive");
 		}
-		else
+		PutCall putCallType;
+		string errorMessage;
+		if (!getPutCall(putOrCall, putCallType, errorMessage))
 		{
-			optionPremium = option->getPremium();
+			return returnXloperOnError(errorMessage);
 		}
-		return returnXloper(optionPremium);
+
+		// Days to maturity are converted to a year fraction as in BlackVolOffSurface
+		double time = dtm / 365.0;
+		Black76Greeks greeks = (putCallType == CALL) ?
+			Black76Call(forward, strike, standardDeviation, discountFactor).getPremiumAndGreeks(time) :
+			Black76Put(forward, strike, standardDeviation, discountFactor).getPremiumAndGreeks(time);
+		double output[6] = { greeks.premium, greeks.delta, greeks.gamma, greeks.vega, greeks.theta, greeks.rho };
+		return returnXloper(output, 6, true);
 	}
 	catch (exception &e)
 	{
 		return returnXloperOnError(e.what());
 	}
+}
+
+namespace
+{
+	// The batch implied standard deviation solvers of Black76ImpliedVolatility and 
+	// BachelierImpliedVolatility
+	typedef void (*ImpliedSolver)(size_t, const double *, const double *, const double *, const double *, const bool *, double *);
+
+	// BlackImpliedSD and BachelierImpliedSD, which differ only in the solver
+	xloper* impliedStandardDeviations(
+		ImpliedSolver solver,
+		const char* putOrCall,
+		xl_array *premiumArray,
+		xl_array *forwardArray,
+		xl_array *strikeArray,
+		xl_array *discountFactorArray)
+	{
+		try
+		{
+			PutCall putCallType;
+			string errorMessage;
+			if (!getPutCall(putOrCall, putCallType, errorMessage))
+			{
+				return returnXloperOnError(errorMessage);
+			}
+			XlVectorView premium, forward, strike, discountFactor;
+			if (!getVectorView(premiumArray, premium, errorMessage) ||
+				!getVectorView(forwardArray, forward, errorMessage) ||
+				!getVectorView(strikeArray, strike, errorMessage) ||
+				!getVectorView(discountFactorArray, discountFactor, errorMessage))
+			{
+				return returnXloperOnError(errorMessage);
+			}
+			size_t n = premium.size();
+			if (strike.size() != n)
+			{
+				return returnXloperOnError("Premium and strike arrays have inconsistent dimension");
+			}
+			// A single forward or discount factor applies to the whole chain. The solver reads
+			// contiguous arrays so only a single value is copied out to the length of the chain
+			vector<double> forwardChain, discountFactorChain;
+			if (forward.size() == 1)
+			{
+				forwardChain.assign(n, forward[0]);
+				forward = XlVectorView(&forwardChain[0], n);
+			}
+			if (discountFactor.size() == 1)
+			{
+				discountFactorChain.assign(n, discountFactor[0]);
+				discountFactor = XlVectorView(&discountFactorChain[0], n);
+			}
+			if ((forward.size() != n) || (discountFactor.size() != n))
+			{
+				return returnXloperOnError("Forward and discount factor must be single values or have the same dimension as the premiums");
+			}
+
+			unique_ptr<bool[]> isCall(new bool[n]);
+			fill(isCall.get(), isCall.get() + n, putCallType == CALL);
+			vector<double> standardDeviation(n);
+			solver(
+				n, premium.data(), forward.data(), strike.data(), discountFactor.data(), isCall.get(), &standardDeviation[0]);
+
+			XllReturnBuffer &outputMatrix = XllReturnBuffer::getThreadBuffer();
+			outputMatrix.setArray((WORD)n, 1);
+			for (size_t i = 0; i < n; ++i)
+			{
+				if (standardDeviation[i] == standardDeviation[i])
+				{
+					outputMatrix.setArrayElement((WORD)i, 0, standardDeviation[i]);
+				}
+				else // NaN
+				{
+					outputMatrix.setArrayElement((WORD)i, 0, (WORD)xlerrNum);
+				}
+			}
+			return outputMatrix.getXloper();
+		}
+		catch (exception &e)
+		{
+			return returnXloperOnError(e.what());
+		}
+	}
+}
 
+xloper* __stdcall BlackImpliedSD(
+    const char* putOrCall,
+    xl_array *premiumArray,
+    xl_array *forwardArray,
+    xl_array *strikeArray,
+    xl_array *discountFactorArray)
+{
+	return impliedStandardDeviations(&Black76ImpliedVolatility::getStandardDeviation,
+		putOrCall, premiumArray, forwardArray, strikeArray, discountFactorArray);
 }
 
-xloper* __stdcall BlackDelta(
-    char* putOrCall,
+xloper* __stdcall Bachelier(
+    const char* putOrCall,
     double forward,
     double strike,
 	double dtm,
@@ -210,38 +485,228 @@ xloper* __stdcall BlackDelta(
 {
 	try
 	{
-		if ((forward < 1e-14) || (strike < 1e-14) || (standardDeviation < 1e-14) || (discountFactor < 1e-14))
+		// Forward and strike may have any sign in the Bachelier model
+		if ((standardDeviation < 1e-14) || (discountFactor < 1e-14))
 		{
-			return returnXloperOnError("All numeric inputs to this function must be strictly positive");
+			return returnXloperOnError("Standard deviation and discount factor must be strictly positive");
+		}
+		PutCall putCallType;
+		string errorMessage;
+		if (!getPutCall(putOrCall, putCallType, errorMessage))
+		{
+			return returnXloperOnError(errorMessage);
 		}
 
-		shared_ptr<Black76Option> option;
-		string putOrCallString = string(putOrCall);
-		boost::to_lower(putOrCallString);
-		if (putOrCallString.compare("c") == 0 || putOrCallString.compare("call") == 0)
+		// On the stack, as in Black
+		double optionPremium = (putCallType == CALL) ?
+			BachelierCall(forward, strike, standardDeviation, discountFactor).getPremium() :
+			BachelierPut(forward, strike, standardDeviation, discountFactor).getPremium();
+		return returnXloper(optionPremium);
+	}
+	catch (exception &e)
+	{
+		return returnXloperOnError(e.what());
+	}
+}
+
+xloper* __stdcall BachelierGreeks(
+    const char* putOrCall,
+    double forward,
+    double strike,
+    double dtm,
+    double standardDeviation,
+    double discountFactor)
+{
+	try
+	{
+		if ((dtm < 1e-14) || (standardDeviation < 1e-14) || (discountFactor < 1e-14))
 		{
-			option = shared_ptr<Black76Call>(new
-				Black76Call(forward, strike, standardDeviation, discountFactor));
+			return returnXloperOnError("Days to maturity, standard deviation and discount factor must be strictly positive");
 		}
-		else if (putOrCallString.compare("p") == 0 || putOrCallString.compare("put") == 0)
+		PutCall putCallType;
+		string errorMessage;
+		if (!getPutCall(putOrCall, putCallType, errorMessage))
 		{
-			option = shared_ptr<Black76Put>(new
-				Black76Put(forward, strike, standardDeviation, discountFactor));
+			return returnXloperOnError(errorMessage);
+		}
+
+		// Qualified because this function has the name of the library's greeks structure
+		double time = dtm / 365.0;
+		XLLBasicLibrary::BachelierGreeks greeks = (putCallType == CALL) ?
+			BachelierCall(forward, strike, standardDeviation, discountFactor).getPremiumAndGreeks(time) :
+			BachelierPut(forward, strike, standardDeviation, discountFactor).getPremiumAndGreeks(time);
+		double output[6] = { greeks.premium, greeks.delta, greeks.gamma, greeks.vega, greeks.theta, greeks.rho };
+		return returnXloper(output, 6, true);
+	}
+	catch (exception &e)
+	{
+		return returnXloperOnError(e.what());
+	}
+}
+
+xloper* __stdcall BachelierImpliedSD(
+    const char* putOrCall,
+    xl_array *premiumArray,
+    xl_array *forwardArray,
+    xl_array *strikeArray,
+    xl_array *discountFactorArray)
+{
+	return impliedStandardDeviations(&BachelierImpliedVolatility::getStandardDeviation,
+		putOrCall, premiumArray, forwardArray, strikeArray, discountFactorArray);
+}
+
+namespace
+{
+	bool getSpreadApproximation(const char* approximationText, SpreadApproximation &approximation, string &errorMessage)
+	{
+		string type = string(approximationText);
+		boost::to_lower(type);
+		if (type.compare("") == 0 || type.compare("bs") == 0)
+		{
+			approximation = BJERKSUND_STENSLAND;
+		}
+		else if (type.compare("kirk") == 0)
+		{
+			approximation = KIRK;
 		}
 		else
 		{
-			return returnXloperOnError("Option type must be either (P)ut or (C)all");
+			errorMessage = "\"Approximation\" must be either \"Kirk\" or \"BS\"";
+			return false;
 		}
-		double optionDelta;
-		if (standardDeviation < 1e-14)
+		return true;
+	}
+}
+
+xloper* __stdcall Spread(
+    const char* putOrCall,
+    double forward1,
+    double forward2,
+    double strike,
+    double standardDeviation1,
+    double standardDeviation2,
+    double correlation,
+    double discountFactor,
+    const char* approximationText)
+{
+	try
+	{
+		PutCall putCallType;
+		SpreadApproximation approximation;
+		string errorMessage;
+		if (!getPutCall(putOrCall, putCallType, errorMessage) ||
+			!getSpreadApproximation(approximationText, approximation, errorMessage))
+		{
+			return returnXloperOnError(errorMessage);
+		}
+		// The inputs are checked by SpreadOption
+		double optionPremium = (putCallType == CALL) ?
+			SpreadCall(forward1, forward2, strike, standardDeviation1, standardDeviation2, correlation, discountFactor, approximation).getPremium() :
+			SpreadPut(forward1, forward2, strike, standardDeviation1, standardDeviation2, correlation, discountFactor, approximation).getPremium();
+		return returnXloper(optionPremium);
+	}
+	catch (exception &e)
+	{
+		return returnXloperOnError(e.what());
+	}
+}
+
+xloper* __stdcall SpreadDeltas(
+    const char* putOrCall,
+    double forward1,
+    double forward2,
+    double strike,
+    double standardDeviation1,
+    double standardDeviation2,
+    double correlation,
+    double discountFactor,
+    const char* approximationText)
+{
+	try
+	{
+		PutCall putCallType;
+		SpreadApproximation approximation;
+		string errorMessage;
+		if (!getPutCall(putOrCall, putCallType, errorMessage) ||
+			!getSpreadApproximation(approximationText, approximation, errorMessage))
+		{
+			return returnXloperOnError(errorMessage);
+		}
+		SpreadOptionDeltas deltas = (putCallType == CALL) ?
+			SpreadCall(forward1, forward2, strike, standardDeviation1, standardDeviation2, correlation, discountFactor, approximation).getPremiumAndDeltas() :
+			SpreadPut(forward1, forward2, strike, standardDeviation1, standardDeviation2, correlation, discountFactor, approximation).getPremiumAndDeltas();
+		double output[3] = { deltas.premium, deltas.delta1, deltas.delta2 };
+		return returnXloper(output, 3, true);
+	}
+	catch (exception &e)
+	{
+		return returnXloperOnError(e.what());
+	}
+}
+
+namespace
+{
+	bool getAmericanApproximation(const char* approximationText, AmericanApproximation &approximation, string &errorMessage)
+	{
+		string type = string(approximationText);
+		boost::to_lower(type);
+		if (type.compare("") == 0 || type.compare("baw") == 0)
 		{
-			return returnXloperOnError("Option past maturity");
+			approximation = BARONE_ADESI_WHALEY;
+		}
+		else if (type.compare("bs") == 0)
+		{
+			approximation = BJERKSUND_STENSLAND_2002;
 		}
 		else
 		{
-			optionDelta = option->getDelta();
+			errorMessage = "\"Approximation\" must be either \"BAW\" or \"BS\"";
+			return false;
 		}
-		return returnXloper(optionDelta);
+		return true;
+	}
+}
+
+xloper* __stdcall AmericanBlack(
+    const char* putOrCall,
+    double forward,
+    double strike,
+    double standardDeviation,
+    double discountFactor,
+    const char* approximationText)
+{
+	try
+	{
+		PutCall putCallType;
+		AmericanApproximation approximation;
+		string errorMessage;
+		if (!getPutCall(putOrCall, putCallType, errorMessage) ||
+			!getAmericanApproximation(approximationText, approximation, errorMessage))
+		{
+			return returnXloperOnError(errorMessage);
+		}
+		// The inputs are checked by AmericanBlack76
+		double optionPremium = AmericanBlack76(standardDeviation, discountFactor, approximation).getPremium(
+			putCallType == CALL, forward, strike);
+		return returnXloper(optionPremium);
+	}
+	catch (exception &e)
+	{
+		return returnXloperOnError(e.what());
+	}
+}
+
+xloper* __stdcall SurfaceCacheStatistics()
+{
+	try
+	{
+		SimpleDeltaSurfaceCache &cache = SimpleDeltaSurfaceCache::getGlobalCache();
+		vector<double> output(4);
+		output[0] = (double) cache.getHits();
+		output[1] = (double) cache.getMisses();
+		output[2] = (double) cache.getEvictions();
+		output[3] = (double) cache.getNumberOfSurfaces();
+		return returnXloper(output, true);
 	}
 	catch (exception &e)
 	{
@@ -3,9 +3,15 @@
 
 #include "xllFunctionSupport.h"
 
-#include "..\Maths\maths.h"
-#include "..\Maths\TwoDimensionalInterpolation.h"
-#include "..\Derivatives\VolatilitySurfaceDelta.h"
+#include "../Maths/maths.h"
+#include "../Maths/TwoDimensionalInterpolation.h"
+#include "../Derivatives/VolatilitySurfaceDelta.h"
+#include "../Derivatives/VolatilitySurfaceCache.h"
+#include "../Derivatives/Black76ImpliedVolatility.h"
+#include "../Derivatives/BachelierFormula.h"
+#include "../Derivatives/BachelierImpliedVolatility.h"
+#include "../Derivatives/SpreadOption.h"
+#include "../Derivatives/AmericanBlack76.h"
 
 /*======================================================================================
 Excel Pricing functions
@@ -19,11 +25,11 @@ xloper* __stdcall Interpolate(
     xl_array *xArray,
     xl_array *yArray,
     int arrayInputSize,
-    char* interpolatorType = "Linear", // Linear or Cubic                                
+    const char* interpolatorType = "Linear", // Linear or Cubic                                
     bool extrapolate = false);
 
 xloper* __stdcall BlackVolOffSurface(
-	char* optionType,
+	const char* optionType,
 	double forward,
 	double strike,
 	double day,
@@ -31,11 +37,23 @@ xloper* __stdcall BlackVolOffSurface(
 	xl_array *putDeltaArray,
 	xl_array *surface,
 	double convergenceThreshold, // hard coded. only here to keep the function signature unchanged
-	char* type,
+	const char* type,
 	bool extrapolate);
 
+// The volatility for every strike (rows) and day (columns) of the grid off one surface. 
+// Forward may be a single value or one value per day
+xloper* __stdcall BlackVolGridOffSurface(
+	const char* optionType,
+	xl_array *forwardArray,
+	xl_array *strikeArray,
+	xl_array *dayGridArray,
+	xl_array *dayArray,
+	xl_array *putDeltaArray,
+	xl_array *surface,
+	const char* type);
+
 xloper* __stdcall Black(
-    char* putOrCall, 
+    const char* putOrCall, 
     double forward, 
     double strike, 
 	double dtm,
@@ -43,13 +61,98 @@ xloper* __stdcall Black(
     double discountFactor);
 
 xloper* __stdcall BlackDelta(
-    char* putOrCall,
+    const char* putOrCall,
     double forward,
     double strike,
     double dtm,
 	double standardDeviation,
     double discountFactor);
 
+// Returns the row {premium, delta, gamma, vega, theta, rho}. See Black76Greeks for units
+xloper* __stdcall BlackGreeks(
+    const char* putOrCall,
+    double forward,
+    double strike,
+    double dtm,
+    double standardDeviation,
+    double discountFactor);
+
+// Returns a column with the implied standard deviation of each premium. Forward and 
+// discount factor may be single values that apply to every premium. Quotes with no 
+// implied standard deviation are returned as #NUM!
+xloper* __stdcall BlackImpliedSD(
+    const char* putOrCall,
+    xl_array *premiumArray,
+    xl_array *forwardArray,
+    xl_array *strikeArray,
+    xl_array *discountFactorArray);
+
+// As Black but with the Bachelier (normal) model, so forward and strike may have any sign.
+// The standard deviation is normal vol * sqrt(time), in the units of the forward
+xloper* __stdcall Bachelier(
+    const char* putOrCall,
+    double forward,
+    double strike,
+    double dtm,
+    double standardDeviation,
+    double discountFactor);
+
+// Returns the row {premium, delta, gamma, vega, theta, rho}. See BachelierGreeks for units
+xloper* __stdcall BachelierGreeks(
+    const char* putOrCall,
+    double forward,
+    double strike,
+    double dtm,
+    double standardDeviation,
+    double discountFactor);
+
+// As BlackImpliedSD with the Bachelier model
+xloper* __stdcall BachelierImpliedSD(
+    const char* putOrCall,
+    xl_array *premiumArray,
+    xl_array *forwardArray,
+    xl_array *strikeArray,
+    xl_array *discountFactorArray);
+
+// The premium of an option on F1 - F2 struck at strike. approximation is "Kirk" or 
+// "BS" (Bjerksund Stensland, the default). See SpreadOption
+xloper* __stdcall Spread(
+    const char* putOrCall,
+    double forward1,
+    double forward2,
+    double strike,
+    double standardDeviation1,
+    double standardDeviation2,
+    double correlation,
+    double discountFactor,
+    const char* approximation);
+
+// Returns the row {premium, delta1, delta2}, as Spread
+xloper* __stdcall SpreadDeltas(
+    const char* putOrCall,
+    double forward1,
+    double forward2,
+    double strike,
+    double standardDeviation1,
+    double standardDeviation2,
+    double correlation,
+    double discountFactor,
+    const char* approximation);
+
+// The premium of an American option on a future. approximation is "BAW" (Barone-Adesi 
+// Whaley, the default) or "BS" (Bjerksund Stensland 2002). See AmericanBlack76
+xloper* __stdcall AmericanBlack(
+    const char* putOrCall,
+    double forward,
+    double strike,
+    double standardDeviation,
+    double discountFactor,
+    const char* approximation);
+
+// Returns the row {hits, misses, evictions, surfaces} of the surface cache used by 
+// BlackVolOffSurface
+xloper* __stdcall SurfaceCacheStatistics();
+
 
 
 #endif
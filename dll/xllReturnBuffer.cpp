@@ -0,0 +1,173 @@
+#include "xllReturnBuffer.h"
+
+#include <algorithm> // min
+
+namespace
+{
+    // Marks the return value itself, rather than an array element, in textElements
+    const size_t returnValueIndex = (size_t)-1;
+}
+
+atomic<size_t> XllReturnBuffer::allocationCount(0);
+
+XllReturnBuffer &XllReturnBuffer::getThreadBuffer()
+{
+    thread_local XllReturnBuffer buffer;
+    return buffer;
+}
+
+size_t XllReturnBuffer::getAllocationCount()
+{
+    return allocationCount.load();
+}
+
+XllReturnBuffer::XllReturnBuffer()
+{
+    returnValue.xltype = xltypeNil;
+}
+
+xloper *XllReturnBuffer::setValue(double value)
+{
+    clear();
+    returnValue.xltype = xltypeNum;
+    returnValue.val.num = value;
+    return &returnValue;
+}
+
+xloper *XllReturnBuffer::setValue(WORD error)
+{
+    clear();
+    returnValue.xltype = xltypeErr;
+    returnValue.val.err = error;
+    return &returnValue;
+}
+
+xloper *XllReturnBuffer::setValue(const string &value)
+{
+    return setValue(value.c_str(), value.size());
+}
+
+xloper *XllReturnBuffer::setValue(const char *value, size_t length)
+{
+    clear();
+    addString(NULL, value, length);
+    return getXloper();
+}
+
+void XllReturnBuffer::setArray(WORD rows, WORD columns)
+{
+    clear();
+    size_t size = (size_t)rows * columns;
+    reserve(elements, size);
+    xloper nil;
+    nil.xltype = xltypeNil;
+    elements.assign(size, nil);
+    returnValue.xltype = xltypeMulti;
+    returnValue.val.array.rows = rows;
+    returnValue.val.array.columns = columns;
+    returnValue.val.array.lparray = elements.empty() ? NULL : &elements[0];
+}
+
+void XllReturnBuffer::setArrayElement(WORD row, WORD column, double value)
+{
+    xloper &element = elements[(size_t)row * returnValue.val.array.columns + column];
+    element.xltype = xltypeNum;
+    element.val.num = value;
+}
+
+void XllReturnBuffer::setArrayElement(WORD row, WORD column, WORD error)
+{
+    xloper &element = elements[(size_t)row * returnValue.val.array.columns + column];
+    element.xltype = xltypeErr;
+    element.val.err = error;
+}
+
+void XllReturnBuffer::setArrayElement(WORD row, WORD column, const string &value)
+{
+    addString(&elements[(size_t)row * returnValue.val.array.columns + column], value.c_str(), value.size());
+}
+
+xloper *XllReturnBuffer::copy(cpp_xloper &value)
+{
+    xloper *source = &value; // & is overloaded to return the underlying xloper
+    if ((source->xltype & ~(xlbitXLFree | xlbitDLLFree)) == xltypeMulti)
+    {
+        setArray(source->val.array.rows, source->val.array.columns);
+        for (size_t i = 0; i < elements.size(); ++i)
+        {
+            copyElement(source->val.array.lparray[i], elements[i]);
+        }
+    }
+    else
+    {
+        clear();
+        copyElement(*source, returnValue);
+    }
+    return getXloper();
+}
+
+xloper *XllReturnBuffer::getXloper()
+{
+    for (size_t i = 0; i < textElements.size(); ++i)
+    {
+        xloper &element = (textElements[i].first == returnValueIndex) ?
+            returnValue : elements[textElements[i].first];
+        element.val.str = &text[textElements[i].second];
+    }
+    return &returnValue;
+}
+
+void XllReturnBuffer::clear()
+{
+    elements.clear();
+    text.clear();
+    textElements.clear();
+}
+
+void XllReturnBuffer::copyElement(const xloper &source, xloper &target)
+{
+    target.xltype = source.xltype & ~(xlbitXLFree | xlbitDLLFree);
+    switch (target.xltype)
+    {
+    case xltypeNum:
+    case xltypeBool:
+    case xltypeErr:
+    case xltypeInt:
+        target.val = source.val;
+        break;
+    case xltypeStr:
+        addString(&target == &returnValue ? NULL : &target, source.val.str + 1, (unsigned char)source.val.str[0]);
+        break;
+    case xltypeNil:
+    case xltypeMissing:
+        break;
+    default:
+        target.xltype = xltypeErr;
+        target.val.err = xlerrValue;
+    }
+}
+
+void XllReturnBuffer::addString(xloper *element, const char *value, size_t length)
+{
+    length = min(length, (size_t)255);
+    size_t offset = text.size();
+    reserve(text, offset + length + 1);
+    text.push_back((char)length);
+    text.insert(text.end(), value, value + length);
+    reserve(textElements, textElements.size() + 1);
+    textElements.push_back(make_pair(element ? (size_t)(element - &elements[0]) : returnValueIndex, offset));
+    xloper &target = element ? *element : returnValue;
+    target.xltype = xltypeStr;
+    target.val.str = NULL; // set by getXloper once the arena can no longer move
+}
+
+template <typename T>
+void XllReturnBuffer::reserve(vector<T> &arena, size_t size)
+{
+    if (size > arena.capacity())
+    {
+        ++allocationCount;
+        // Grow geometrically so that a thread settles on its largest return value quickly
+        arena.reserve(max(size, 2 * arena.capacity()));
+    }
+}
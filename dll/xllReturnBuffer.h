@@ -0,0 +1,80 @@
+#ifndef derivativeXLLReturnBuffer_INCLUDED
+#define derivativeXLLReturnBuffer_INCLUDED
+
+#include "excelIntegration/xloper.h"
+#include "excelIntegration/cpp_xloper.h"
+
+#include <atomic>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/*======================================================================================
+XllReturnBuffer
+
+Per thread storage for the xloper that a function hands back to excel. Excel copies the
+returned value before it makes another call into the add-in on the same thread, so the
+memory only has to live until the next return on that thread. Each thread reuses its own
+buffer, so nothing is shared between the threads of a multithreaded recalculation and
+there is no malloc / xlAutoFree round trip. The returned xlopers never carry xlbitDLLFree.
+
+Array elements and the text of strings are kept in arenas that are cleared, but never
+shrunk, by each new return value. Once a thread has returned its largest value it makes
+no further heap allocations. getAllocationCount counts every time an arena had to grow.
+
+Every set... call replaces the previous return value of the calling thread.
+=======================================================================================*/
+class XllReturnBuffer
+{
+public:
+    // The buffer belonging to the calling thread
+    static XllReturnBuffer &getThreadBuffer();
+    // The number of times any thread's buffer has had to allocate memory
+    static size_t getAllocationCount();
+
+    // Scalar return values. These need no array and are what excel shows in a single cell
+    xloper *setValue(double value);
+    xloper *setValue(WORD error);
+    // Text longer than 255 characters, the limit of an excel byte string, is truncated
+    xloper *setValue(const string &text);
+    xloper *setValue(const char *text, size_t length);
+
+    // Starts a new rows x columns xltypeMulti return value with every element xltypeNil
+    void setArray(WORD rows, WORD columns);
+    void setArrayElement(WORD row, WORD column, double value);
+    void setArrayElement(WORD row, WORD column, WORD error);
+    void setArrayElement(WORD row, WORD column, const string &text);
+
+    // Copies value, and any strings or array elements it points to, into the buffer.
+    // References are not supported and are returned as #VALUE!
+    xloper *copy(cpp_xloper &value);
+
+    // The current return value of the calling thread
+    xloper *getXloper();
+
+private:
+    XllReturnBuffer();
+    XllReturnBuffer(const XllReturnBuffer &);
+    XllReturnBuffer &operator=(const XllReturnBuffer &);
+
+    void clear();
+    void copyElement(const xloper &source, xloper &target);
+    // Appends a counted string to the text arena and records that element (or the
+    // return value itself if element is NULL) points to it
+    void addString(xloper *element, const char *text, size_t length);
+    template <typename T>
+    void reserve(vector<T> &arena, size_t size);
+
+    xloper returnValue;
+    vector<xloper> elements;
+    // The arena can move as it grows so string pointers are only set by getXloper, from
+    // the (element index, offset) pairs in textElements
+    vector<char> text;
+    vector<pair<size_t, size_t>> textElements;
+
+    static atomic<size_t> allocationCount;
+};
+
+#endif